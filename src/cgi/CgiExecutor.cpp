@@ -4,18 +4,20 @@
  * Asynchronous CGI execution implementation
  *
  * Key design decisions:
- * 1. Non-blocking: Fork immediately, don't wait for output
- * 2. Pipes are non-blocking for reading/writing
- * 3. Monitored via epoll in main server loop
- * 4. Supports streaming responses as data becomes available
- * 5. Timeout enforcement via SIGALRM in child
+ * 1. Non-blocking: Spawn immediately, don't wait for output
+ * 2. posix_spawn() instead of fork(): no page table copy of the server
+ * 3. Pipes are non-blocking for reading/writing
+ * 4. Monitored via epoll in main server loop
+ * 5. Supports streaming responses as data becomes available
+ * 6. Timeout enforcement via the ServerManager timer heap
  */
 
 #include "CgiExecutor.hpp"
 
+#include <arpa/inet.h>
 #include <fcntl.h>
 #include <signal.h>
-#include <sys/wait.h>
+#include <spawn.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -24,10 +26,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <iostream>
 #include <sstream>
 #include <vector>
 
+#include "FastCgiProtocol.hpp"
+#include "common/Log.hpp"
+
 static std::string methodToString(HttpMethod method) {
   if (method == HTTP_METHOD_GET) return "GET";
   if (method == HTTP_METHOD_POST) return "POST";
@@ -44,163 +48,179 @@ CgiExecutor::CgiExecutor() {}
 CgiExecutor::~CgiExecutor() {}
 
 CgiProcess* CgiExecutor::executeAsync(const HttpRequest& request,
+                                      const sockaddr_in& peer,
                                       const std::string& script_path,
                                       const std::string& interpreter_path,
-                                      const ServerConfig& serverConfig) {
+                                      const LocationConfig& location,
+                                      int timeout_secs) {
   // Step 1: Create communication pipes
   // pipe_in: parent writes request body to child stdin
   // pipe_out: parent reads CGI output from child stdout
+  // O_CLOEXEC: only the dup2()ed copies (stdin/stdout) reach the script.
 
   int pipe_in[2];   // Parent → Child (request body)
   int pipe_out[2];  // Child → Parent (response)
 
-  if (pipe(pipe_in) == -1 || pipe(pipe_out) == -1) {
-    std::cerr << "Failed to create pipes for CGI" << std::endl;
+  if (pipe2(pipe_in, O_CLOEXEC) == -1) {
+    LOG_ERROR << "Failed to create pipes for CGI";
+    return NULL;
+  }
+  if (pipe2(pipe_out, O_CLOEXEC) == -1) {
+    LOG_ERROR << "Failed to create pipes for CGI";
     close(pipe_in[0]);
     close(pipe_in[1]);
-    close(pipe_out[0]);
-    close(pipe_out[1]);
     return NULL;
   }
 
-  // Step 2: Make pipes non-blocking
+  // Step 2: Make the parent's ends non-blocking
   // This prevents the main event loop from blocking on pipe I/O
 
   if (!setNonBlocking(pipe_in[1]) || !setNonBlocking(pipe_out[0])) {
-    std::cerr << "Failed to set pipes non-blocking" << std::endl;
-    close(pipe_in[0]);
-    close(pipe_in[1]);
-    close(pipe_out[0]);
-    close(pipe_out[1]);
+    LOG_ERROR << "Failed to set pipes non-blocking";
+    closePipes(pipe_in, pipe_out);
     return NULL;
   }
 
-  // Step 3: Fork child process
+  // Step 3: Build argv/envp in the parent (the child only execs)
 
-  pid_t pid = fork();
-  if (pid == -1) {
-    std::cerr << "Failed to fork CGI process" << std::endl;
-    close(pipe_in[0]);
-    close(pipe_in[1]);
-    close(pipe_out[0]);
-    close(pipe_out[1]);
-    return NULL;
+  // Extract script directory and filename
+  std::string script_dir = ".";
+  std::string script_name = script_path;
+  size_t last_slash = script_path.find_last_of('/');
+  if (last_slash != std::string::npos) {
+    script_dir = script_path.substr(0, last_slash);
+    script_name = script_path.substr(last_slash + 1);
   }
 
-  if (pid == 0) {
-    // CHILD PROCESS
-
-    // Setup pipes for stdin/stdout
-    dup2(pipe_in[0], STDIN_FILENO);
-    dup2(pipe_out[1], STDOUT_FILENO);
-
-    // Close all pipe ends in child
-    close(pipe_in[0]);
-    close(pipe_in[1]);
-    close(pipe_out[0]);
-    close(pipe_out[1]);
-
-    // Extract script directory and filename
-    std::string script_dir = ".";
-    std::string script_name = script_path;
-    size_t last_slash = script_path.find_last_of('/');
-    if (last_slash != std::string::npos) {
-      script_dir = script_path.substr(0, last_slash);
-      script_name = script_path.substr(last_slash + 1);
-    }
-
-    // Change to script directory
-    if (chdir(script_dir.c_str()) == -1) {
-      std::cerr << "chdir failed: " << std::strerror(errno) << std::endl;
-      kill(getpid(), SIGKILL);
-    }
-
-    // Prepare environment variables
-    // INFO: Use full path for SCRIPT_FILENAME env var
-    std::map<std::string, std::string> env_map =
-        prepareEnvironment(request, script_path, serverConfig);
-#ifdef DEBUG
-    std::cout << "[CGI ENV] script=" << script_path << std::endl;
-    for (std::map<std::string, std::string>::const_iterator it =
-             env_map.begin();
-         it != env_map.end(); ++it) {
-      std::cerr << "[CGI ENV] " << it->first << "=" << it->second << std::endl;
-    }
+  // INFO: Use full path for SCRIPT_FILENAME env var
+  std::vector<std::string> env =
+      prepareEnvironment(request, peer, script_path, location);
+  LOG_DEBUG << "[CGI ENV] script=" << script_path;
+  for (size_t i = 0; i < env.size(); ++i) LOG_DEBUG << "[CGI ENV] " << env[i];
+  std::vector<char*> envp = createEnvArray(env);
+
+  // The script runs from its own directory: prefix with ./ so relative
+  // paths work with /usr/bin/env and direct execution
+  std::string relative_script = "./" + script_name;
+  std::vector<char*> args;
+  if (!interpreter_path.empty())
+    args.push_back(const_cast<char*>(interpreter_path.c_str()));
+  args.push_back(const_cast<char*>(relative_script.c_str()));
+  args.push_back(NULL);
+
+  // Step 4: Spawn the child
+  // posix_spawn() uses clone(CLONE_VM | CLONE_VFORK) in glibc: the page
+  // tables of the server (caches, client buffers) are never copied, so
+  // the cost does not grow with its RSS as fork() does. File actions
+  // replace what the forked child used to do by hand.
+
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawnattr_init(&attr);
+
+  posix_spawn_file_actions_adddup2(&actions, pipe_in[0], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, pipe_out[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addchdir_np(&actions, script_dir.c_str());
+#if __GLIBC_PREREQ(2, 34)
+  // Listeners, epoll and client sockets are not all O_CLOEXEC.
+  posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
 #endif
-    char** envp = createEnvArray(env_map);
-
-    // Prepare arguments - use just the script filename after chdir
-    // Prefix with ./ for relative paths to work with /usr/bin/env and direct
-    // execution
-    std::string relative_script = "./" + script_name;
-    // We use a vector to hold the allocated pointers so we can track them if
-    // needed, though in a successful execve they are replaced, and on failure
-    // we kill the process. so we do not need to delete them manually since the
-    // process will wipe memory it self
-
-    char* args[3];
-    args[0] = NULL;
-    args[1] = NULL;
-    args[2] = NULL;
-
-    if (!interpreter_path.empty()) {
-      args[0] = new char[interpreter_path.size() + 1];
-      std::strcpy(args[0], interpreter_path.c_str());
-
-      args[1] = new char[relative_script.size() + 1];
-      std::strcpy(args[1], relative_script.c_str());
-    } else {
-      args[0] = new char[relative_script.size() + 1];
-      std::strcpy(args[0], relative_script.c_str());
-    }
 
-    const char* exec_path = args[0];
-    execve(exec_path, args, envp);
-
-    // If execve fails
-    std::cerr << "execve failed: " << std::strerror(errno) << std::endl;
-    kill(getpid(), SIGKILL);
+  // Own process group: on cgi_timeout the whole group is killed, so
+  // grandchildren (e.g. a shell's subprocesses) cannot outlive the CGI
+  // while holding inherited client sockets open.
+  posix_spawnattr_setpgroup(&attr, 0);
+  // The server ignores SIGPIPE; scripts get the default action back.
+  sigset_t defaults;
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &defaults);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP |
+                                      POSIX_SPAWN_SETSIGDEF);
+
+  pid_t pid = -1;
+  int err = posix_spawn(&pid, args[0], &actions, &attr, &args[0], &envp[0]);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attr);
+
+  if (err != 0) {
+    // Missing interpreter/script, bad script_dir...: reported here since
+    // the parent waits for the exec.
+    LOG_ERROR << "Failed to spawn CGI " << script_path << ": "
+              << std::strerror(err);
+    closePipes(pipe_in, pipe_out);
+    return NULL;
+  }
 
-  } else {
-    // PARENT PROCESS
+  // PARENT PROCESS
+  // Close unused pipe ends
+  close(pipe_in[0]);   // Don't read from input pipe
+  close(pipe_out[1]);  // Don't write to output pipe
 
-    // Close unused pipe ends
-    close(pipe_in[0]);   // Don't read from input pipe
-    close(pipe_out[1]);  // Don't write to output pipe
+  // Write request body to child stdin
+  // Handled asynchronously by Client/ServerManager via CgiProcess
 
-    // Write request body to child stdin
-    // Handled asynchronously by Client/ServerManager via CgiProcess
+  // Create CgiProcess tracker object
+  // The Client will own this and clean it up when done
+  std::string body = bodyToString(request.getBody());
+  return new CgiProcess(script_path, interpreter_path,
+                        pipe_in[1],  // Pass write end to CgiProcess
+                        pipe_out[0], pid, timeout_secs, body);
+}
 
-    // Create CgiProcess tracker object
-    // The Client will own this and clean it up when done
-    std::string body = bodyToString(request.getBody());
-    CgiProcess* proc =
-        new CgiProcess(script_path, interpreter_path,
-                       pipe_in[1],           // Pass write end to CgiProcess
-                       pipe_out[0], pid, 5,  // 5 second timeout
-                       body);
+CgiProcess* CgiExecutor::executeFastCgi(const HttpRequest& request,
+                                        const sockaddr_in& peer,
+                                        const std::string& script_path,
+                                        const LocationConfig& location,
+                                        FastCgiUpstream& upstream,
+                                        int timeout_secs) {
+  bool keepConn = false;
+  int sock = upstream.acquire(keepConn);
+  if (sock == -1) {
+    LOG_ERROR << "Failed to connect to FastCGI server "
+              << upstream.getAddress();
+    return NULL;
+  }
 
-    return proc;
+  // The FastCGI server does not share our working directory.
+  std::string filename = script_path;
+  if (filename.empty() || filename[0] != '/') {
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) != NULL) {
+      if (filename.compare(0, 2, "./") == 0) filename.erase(0, 2);
+      filename = std::string(cwd) + "/" + filename;
+    }
   }
 
-  return NULL;  // Should not reach here
-}
+  std::vector<std::string> params =
+      prepareEnvironment(request, peer, filename, location);
+  // One request per connection at a time, so the id is always 1.
+  std::string records;
+  fastcgi::appendBeginRequest(records, 1, keepConn);
+  fastcgi::appendParams(records, 1, params);
+  fastcgi::appendStdin(records, 1, bodyToString(request.getBody()));
 
-std::map<std::string, std::string> CgiExecutor::prepareEnvironment(
-    const HttpRequest& request, const std::string& script_path,
-    const ServerConfig& serverConfig) {
-  std::map<std::string, std::string> env;
+  return new CgiProcess(filename, sock, &upstream, keepConn, timeout_secs,
+                        records);
+}
 
-  // Step 1: Core CGI/HTTP Variables
+std::vector<std::string> CgiExecutor::prepareEnvironment(
+    const HttpRequest& request, const sockaddr_in& peer,
+    const std::string& script_path, const LocationConfig& location) {
+  // Step 1: Variables fixed by the configuration (GATEWAY_INTERFACE,
+  // SERVER_NAME, SERVER_PORT...), built once per location at load time
+  const std::vector<std::string>& fixed = location.getCgiEnvironment();
+  const HttpHeaderTable& headers = request.getHeaders();
+  std::vector<std::string> env;
+  env.reserve(fixed.size() + headers.size() + 10);
+  env.assign(fixed.begin(), fixed.end());
 
-  env["GATEWAY_INTERFACE"] = "CGI/1.1";
-  env["SERVER_PROTOCOL"] = "HTTP/1.1";
-  env["SERVER_SOFTWARE"] = "Webserv/1.0";
-  env["REQUEST_METHOD"] = methodToString(request.getMethod());
+  env.push_back("REQUEST_METHOD=" + methodToString(request.getMethod()));
 
   // Step 2: Path and Script Variables
 
-  env["SCRIPT_FILENAME"] = script_path;
+  env.push_back("SCRIPT_FILENAME=" + script_path);
 
   std::string uri = request.getPath();
   if (!request.getQuery().empty()) {
@@ -210,7 +230,7 @@ std::map<std::string, std::string> CgiExecutor::prepareEnvironment(
   size_t question_mark = uri.find('?');
   std::string script_name =
       (question_mark != std::string::npos) ? uri.substr(0, question_mark) : uri;
-  env["SCRIPT_NAME"] = script_name;
+  env.push_back("SCRIPT_NAME=" + script_name);
 
   // Step 3: Query String
   // QUERY_STRING: Everything after the '?' in the URI
@@ -219,67 +239,67 @@ std::map<std::string, std::string> CgiExecutor::prepareEnvironment(
   if (question_mark != std::string::npos && question_mark + 1 < uri.length()) {
     query_string = uri.substr(question_mark + 1);
   }
-  env["QUERY_STRING"] = query_string;
+  env.push_back("QUERY_STRING=" + query_string);
 
   // Step 4: Content/Body Information
 
   std::ostringstream len;
-  len << request.getBody().size();
-  env["CONTENT_LENGTH"] = len.str();
-  std::string ct = request.getHeader("content-type");
-  if (!ct.empty()) env["CONTENT_TYPE"] = ct;
-
-  // Step 5: Client/Server Connection Information
-
-  env["REMOTE_ADDR"] =
-      "127.0.0.1";  // TODO: Extract from socket via getpeername()
-  env["REQUEST_URI"] = uri;
-
-  // Step 5b: Server identification (CGI/1.1 spec)
-  env["SERVER_NAME"] = serverConfig.getServerName();
-  std::ostringstream port_ss;
-  port_ss << serverConfig.getPort();
-  env["SERVER_PORT"] = port_ss.str();
-  env["PATH_INFO"] =
-      request.getPath();  // We only support direct script execution for now
-  env["PATH_TRANSLATED"] = "";     // Corresponding physical path
-  env["REDIRECT_STATUS"] = "200";  // Required by php-cgi in some setups
+  len << request.getBodySize();
+  env.push_back("CONTENT_LENGTH=" + len.str());
+  HttpHeaderView ct = request.getHeader(HTTP_HEADER_CONTENT_TYPE);
+  if (!ct.empty()) env.push_back("CONTENT_TYPE=" + ct.str());
+
+  // Step 5: Client Connection Information
+
+  // Address as accept4() returned it; the text form is only built here.
+  char address[INET_ADDRSTRLEN];
+  if (inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address)))
+    env.push_back(std::string("REMOTE_ADDR=") + address);
+  env.push_back("REQUEST_URI=" + uri);
+  // We only support direct script execution for now
+  env.push_back("PATH_INFO=" + request.getPath());
 
   // Step 6: HTTP Request Headers as HTTP_* variables
 
-  const std::map<std::string, std::string>& headers = request.getHeaders();
-  for (std::map<std::string, std::string>::const_iterator it = headers.begin();
-       it != headers.end(); ++it) {
-    std::string key = it->first;
-    std::string env_key = "HTTP_";
-    for (size_t i = 0; i < key.length(); ++i) {
-      char c = key[i];
+  for (size_t h = 0; h < headers.size(); ++h) {
+    // Repeated headers: only the last one, as with a lookup by name
+    if (!headers.isLastWithName(h)) continue;
+    HttpHeaderView key = headers.nameAt(h);
+    HttpHeaderView value = headers.valueAt(h);
+    std::string var = "HTTP_";
+    var.reserve(5 + key.length + 1 + value.length);
+    for (size_t i = 0; i < key.length; ++i) {
+      char c = key.data[i];
       if (c == '-')
-        env_key += '_';
+        var += '_';
       else
-        env_key += toupper(c);
+        var += toupper(c);
     }
-    env[env_key] = it->second;
+    var += '=';
+    var.append(value.data, value.length);
+    env.push_back(var);
   }
 
   return env;
 }
 
-char** CgiExecutor::createEnvArray(
-    const std::map<std::string, std::string>& env_map) {
-  char** envp = new char*[env_map.size() + 1];
-  int i = 0;
-  for (std::map<std::string, std::string>::const_iterator it = env_map.begin();
-       it != env_map.end(); ++it) {
-    std::string s = it->first + "=" + it->second;
-    envp[i] = new char[s.size() + 1];
-    std::strcpy(envp[i], s.c_str());
-    i++;
-  }
-  envp[i] = NULL;
+std::vector<char*> CgiExecutor::createEnvArray(
+    const std::vector<std::string>& env) {
+  std::vector<char*> envp;
+  envp.reserve(env.size() + 1);
+  for (size_t i = 0; i < env.size(); ++i)
+    envp.push_back(const_cast<char*>(env[i].c_str()));
+  envp.push_back(NULL);
   return envp;
 }
 
+void CgiExecutor::closePipes(int pipe_in[2], int pipe_out[2]) {
+  close(pipe_in[0]);
+  close(pipe_in[1]);
+  close(pipe_out[0]);
+  close(pipe_out[1]);
+}
+
 bool CgiExecutor::setNonBlocking(int fd) {
   int flags = fcntl(fd, F_GETFL, 0);
   if (flags == -1) {
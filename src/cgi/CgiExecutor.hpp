@@ -2,18 +2,21 @@
  * CgiExecutor.hpp
  *
  * Asynchronous CGI execution
- * Forks CGI process without blocking, returns immediately
+ * Spawns the CGI process without blocking, returns immediately
  * Pipes are monitored via epoll by the main server loop
  */
 
 #pragma once
 
-#include <map>
+#include <netinet/in.h>
+
 #include <string>
+#include <vector>
 
-#include "../config/ServerConfig.hpp"
+#include "../config/LocationConfig.hpp"
 #include "../http/HttpRequest.hpp"
 #include "CgiProcess.hpp"
+#include "FastCgiUpstream.hpp"
 
 class CgiExecutor {
  public:
@@ -23,41 +26,67 @@ class CgiExecutor {
   /**
    * Start asynchronous CGI execution
    *
-   * Forks child process, sets up pipes, returns immediately
+   * Spawns child process (posix_spawn), sets up pipes, returns immediately
    * The CGI process output is monitored via epoll
    *
    * @param request: HTTP request from client
+   * @param peer: Client address (REMOTE_ADDR)
    * @param script_path: Full path to CGI script
    * @param interpreter_path: Path to interpreter (empty for executable scripts)
-   * @param serverConfig: Server configuration for environment variables
+   * @param location: Matched location (precomputed static environment)
+   * @param timeout_secs: Execution deadline (cgi_timeout), enforced by the
+   *                      ServerManager timer heap
    * @return Pointer to CgiProcess to track execution
-   *         NULL if fork/pipe creation failed
+   *         NULL if pipe creation or spawn failed (including a missing
+   *         script or interpreter)
    */
   CgiProcess* executeAsync(const HttpRequest& request,
+                           const sockaddr_in& peer,
                            const std::string& script_path,
                            const std::string& interpreter_path,
-                           const ServerConfig& serverConfig);
+                           const LocationConfig& location,
+                           int timeout_secs);
+
+  /**
+   * Send the request to a FastCGI server instead of forking
+   *
+   * Takes a connection from upstream and encodes the whole request (same
+   * variables as CGI, as FCGI_PARAMS) for the Client to write once the
+   * socket is writable.
+   *
+   * @return Pointer to CgiProcess in FastCGI mode
+   *         NULL if no connection could be opened
+   */
+  CgiProcess* executeFastCgi(const HttpRequest& request,
+                             const sockaddr_in& peer,
+                             const std::string& script_path,
+                             const LocationConfig& location,
+                             FastCgiUpstream& upstream, int timeout_secs);
 
  private:
   /**
    * Prepare environment variables for CGI
    *
    * @param request: HTTP request
+   * @param peer: Client address (REMOTE_ADDR)
    * @param script_path: CGI script path
-   * @param serverConfig: Server configuration
-   * @return Map of environment variables
+   * @param location: Location whose static variables start the list
+   * @return "NAME=value" strings
    */
-  std::map<std::string, std::string> prepareEnvironment(
-      const HttpRequest& request, const std::string& script_path,
-      const ServerConfig& serverConfig);
+  std::vector<std::string> prepareEnvironment(const HttpRequest& request,
+                                              const sockaddr_in& peer,
+                                              const std::string& script_path,
+                                              const LocationConfig& location);
 
   /**
-   * Convert environment map to C-style array for execve
+   * NULL-terminated pointer array for posix_spawn
    *
-   * @param env_map: Environment variable map
-   * @return Allocated char** array (caller must free)
+   * @param env: Environment strings (must outlive the returned array)
+   * @return Pointers into env, nothing to free
    */
-  char** createEnvArray(const std::map<std::string, std::string>& env_map);
+  std::vector<char*> createEnvArray(const std::vector<std::string>& env);
+
+  void closePipes(int pipe_in[2], int pipe_out[2]);
 
   /**
    * Set up a pipe as non-blocking
@@ -14,6 +14,9 @@
 #include <ctime>
 #include <sstream>
 
+#include "FastCgiUpstream.hpp"
+#include "common/Log.hpp"
+
 CgiProcess::CgiProcess(const std::string& script_path,
                        const std::string& interpreter, int pipe_in_write,
                        int pipe_out_read, pid_t pid, int timeout_secs,
@@ -27,46 +30,100 @@ CgiProcess::CgiProcess(const std::string& script_path,
       body_bytes_written_(0),
       headers_complete_(false),
       status_code_(200),
+      upstream_(NULL),
+      keep_conn_(false),
+      records_(),
+      state_(RUNNING),
+      start_time_(time(NULL)),
+      timeout_secs_(timeout_secs) {}
+
+CgiProcess::CgiProcess(const std::string& script_path, int socket,
+                       FastCgiUpstream* upstream, bool keepConn,
+                       int timeout_secs, const std::string& records)
+    : pid_(0),
+      script_path_(script_path),
+      interpreter_(),
+      pipe_in_write_(-1),
+      pipe_out_read_(socket),
+      request_body_(records),
+      body_bytes_written_(0),
+      headers_complete_(false),
+      status_code_(200),
+      upstream_(upstream),
+      keep_conn_(keepConn),
+      records_(),
       state_(RUNNING),
       start_time_(time(NULL)),
       timeout_secs_(timeout_secs) {}
 
 CgiProcess::~CgiProcess() {
   if (pid_ > 0) {
-      kill(pid_, SIGKILL);
+      // The child leads its own process group (see CgiExecutor).
+      kill(-pid_, SIGKILL);
   }
+  closePipeIn();
+  closePipeOut();
 }
 
 bool CgiProcess::appendResponseData(const char* data, size_t len) {
-  // Append to raw response
-  complete_response_.append(data, len);
-
   // If headers are already successfully parsed, just append to body
   if (headers_complete_) {
     response_body_.append(data, len);
     return true;
   }
 
-  return tryParseHeaders();
+  header_buffer_.append(data, len);
+  if (tryParseHeaders()) return true;
+  if (header_buffer_.size() > MAX_HEADER_SIZE) state_ = FAILED;
+  return false;
+}
+
+void CgiProcess::takeResponseBody(std::string& out) {
+  out.clear();
+  out.swap(response_body_);
+}
+
+void CgiProcess::appendRecordData(const char* data, size_t len) {
+  std::string out;
+  std::string err;
+  if (!records_.feed(data, len, out, err)) state_ = FAILED;
+  if (!err.empty())
+    LOG_WARN << "[FastCGI " << script_path_ << "] " << err;
+  if (!out.empty() && state_ != FAILED)
+    appendResponseData(out.data(), out.size());
+}
+
+void CgiProcess::releaseConnection() {
+  if (pipe_out_read_ == -1) return;
+  if (upstream_ && keep_conn_) {
+    bool reusable = records_.isEnded() && state_ != FAILED &&
+                    records_.getProtocolStatus() == fastcgi::REQUEST_COMPLETE &&
+                    isRequestBodySent();
+    upstream_->release(pipe_out_read_, reusable);
+  } else {
+    close(pipe_out_read_);
+  }
+  pipe_out_read_ = -1;
 }
 
 bool CgiProcess::tryParseHeaders() {
   // Look for header/body separator
-  size_t sep_pos = complete_response_.find("\r\n\r\n");
+  size_t sep_pos = header_buffer_.find("\r\n\r\n");
   if (sep_pos == std::string::npos) {
-    sep_pos = complete_response_.find("\n\n");
+    sep_pos = header_buffer_.find("\n\n");
     if (sep_pos == std::string::npos) {
       // Separator not found yet
       return false;
     }
     // Found \n\n
-    response_headers_ = complete_response_.substr(0, sep_pos);
-    response_body_ = complete_response_.substr(sep_pos + 2);
+    response_headers_ = header_buffer_.substr(0, sep_pos);
+    response_body_ = header_buffer_.substr(sep_pos + 2);
   } else {
     // Found \r\n\r\n
-    response_headers_ = complete_response_.substr(0, sep_pos);
-    response_body_ = complete_response_.substr(sep_pos + 4);
+    response_headers_ = header_buffer_.substr(0, sep_pos);
+    response_body_ = header_buffer_.substr(sep_pos + 4);
   }
+  std::string().swap(header_buffer_);
 
   headers_complete_ = true;
 
@@ -13,6 +13,10 @@
 #include <ctime>
 #include <string>
 
+#include "FastCgiProtocol.hpp"
+
+class FastCgiUpstream;
+
 class CgiProcess {
  public:
   enum State {
@@ -37,6 +41,20 @@ class CgiProcess {
              int pipe_in_write, int pipe_out_read, pid_t pid, int timeout_secs,
              const std::string& request_body = "");
 
+  /**
+   * Track a request sent to a FastCGI server (no child process)
+   * The single socket is exposed as getPipeOut(); getRequestBody() holds
+   * the encoded records still to be written to it.
+   *
+   * @param socket: Connected (or connecting) socket from upstream
+   * @param upstream: Pool the socket came from
+   * @param keepConn: records ask to keep the connection (see acquire())
+   * @param records: BEGIN_REQUEST + PARAMS + STDIN records
+   */
+  CgiProcess(const std::string& script_path, int socket,
+             FastCgiUpstream* upstream, bool keepConn, int timeout_secs,
+             const std::string& records);
+
   ~CgiProcess();
 
   // ========== State Management ==========
@@ -54,8 +72,12 @@ class CgiProcess {
   }
 
   int getPipeOut() const { return pipe_out_read_; }
+  // FastCGI: goes through releaseConnection(), so a request cut short
+  // (timeout, client gone) still gives its keep-alive slot back.
   void closePipeOut() {
-    if (pipe_out_read_ != -1) {
+    if (upstream_ != NULL) {
+      releaseConnection();
+    } else if (pipe_out_read_ != -1) {
       close(pipe_out_read_);
       pipe_out_read_ = -1;
     }
@@ -64,10 +86,30 @@ class CgiProcess {
   // ========== Data Management ==========
   /**
    * Append data read from CGI output
+   * Only the header section is buffered whole; after the separator, body
+   * bytes wait in response_body_ until the client drains them with
+   * takeResponseBody(). Output larger than MAX_HEADER_SIZE without a
+   * separator marks the process FAILED.
    * @return true if complete (headers received), false if still reading
    */
   bool appendResponseData(const char* data, size_t len);
 
+  // Moves the body bytes read so far into out (out is overwritten).
+  void takeResponseBody(std::string& out);
+
+  // ========== FastCGI ==========
+  bool isFastCgi() const { return upstream_ != NULL; }
+  /**
+   * Append raw bytes read from the FastCGI socket
+   * STDOUT content goes through appendResponseData(), STDERR is logged.
+   * A malformed record stream marks the process FAILED.
+   */
+  void appendRecordData(const char* data, size_t len);
+  bool isRequestEnded() const { return records_.isEnded(); }
+  // Hand the socket back to the upstream if the connection can carry
+  // another request, otherwise close it. Either way getPipeOut() is -1.
+  void releaseConnection();
+
   // Input body management
   const std::string& getRequestBody() const { return request_body_; }
   size_t getBodyBytesWritten() const { return body_bytes_written_; }
@@ -77,8 +119,7 @@ class CgiProcess {
   }
 
   const std::string& getResponseHeaders() const { return response_headers_; }
-  const std::string& getResponseBody() const { return response_body_; }
-  const std::string& getCompleteResponse() const { return complete_response_; }
+  size_t pendingBodySize() const { return response_body_.size(); }
 
   bool isHeadersComplete() const { return headers_complete_; }
 
@@ -108,13 +149,20 @@ class CgiProcess {
   std::string request_body_;   // Body to send to CGI
   size_t body_bytes_written_;  // buffer offset for writing
 
+  static const size_t MAX_HEADER_SIZE = 8192;
+
   // ========== Response Data ==========
-  std::string complete_response_;  // Raw CGI output (headers + body)
-  std::string response_headers_;   // Parsed headers section
-  std::string response_body_;      // Parsed body section
+  std::string header_buffer_;     // Raw CGI output until the separator
+  std::string response_headers_;  // Parsed headers section
+  std::string response_body_;     // Body bytes not yet taken by the client
   bool headers_complete_;  // True once we've found header/body separator
   int status_code_;
 
+  // ========== FastCGI ==========
+  FastCgiUpstream* upstream_;  // NULL for fork/exec CGI
+  bool keep_conn_;
+  fastcgi::RecordParser records_;
+
   // ========== State ==========
   State state_;
   time_t start_time_;
@@ -0,0 +1,122 @@
+/**
+ * FastCgiProtocol.cpp
+ *
+ * Record layout (all integers big-endian):
+ *   version, type, requestId(2), contentLength(2), paddingLength, reserved
+ *   followed by contentLength bytes of content and paddingLength of padding.
+ */
+
+#include "FastCgiProtocol.hpp"
+
+namespace fastcgi {
+
+static void appendHeader(std::string& out, RecordType type, unsigned short id,
+                         size_t content_len) {
+  out += static_cast<char>(VERSION_1);
+  out += static_cast<char>(type);
+  out += static_cast<char>((id >> 8) & 0xff);
+  out += static_cast<char>(id & 0xff);
+  out += static_cast<char>((content_len >> 8) & 0xff);
+  out += static_cast<char>(content_len & 0xff);
+  out += '\0';  // padding: content is not aligned, the spec allows it
+  out += '\0';  // reserved
+}
+
+// Splits content into as many records as needed, then the empty record
+// that ends the stream.
+static void appendStream(std::string& out, RecordType type, unsigned short id,
+                         const std::string& content) {
+  size_t offset = 0;
+  while (offset < content.size()) {
+    size_t len = content.size() - offset;
+    if (len > MAX_CONTENT) len = MAX_CONTENT;
+    appendHeader(out, type, id, len);
+    out.append(content, offset, len);
+    offset += len;
+  }
+  appendHeader(out, type, id, 0);
+}
+
+// Name-value pair lengths: 1 byte below 128, otherwise 4 bytes with the
+// high bit set.
+static void appendLength(std::string& out, size_t len) {
+  if (len < 128) {
+    out += static_cast<char>(len);
+    return;
+  }
+  out += static_cast<char>(((len >> 24) & 0x7f) | 0x80);
+  out += static_cast<char>((len >> 16) & 0xff);
+  out += static_cast<char>((len >> 8) & 0xff);
+  out += static_cast<char>(len & 0xff);
+}
+
+void appendBeginRequest(std::string& out, unsigned short id, bool keepConn) {
+  appendHeader(out, BEGIN_REQUEST, id, 8);
+  out += static_cast<char>((RESPONDER >> 8) & 0xff);
+  out += static_cast<char>(RESPONDER & 0xff);
+  out += static_cast<char>(keepConn ? KEEP_CONN : 0);
+  out.append(5, '\0');
+}
+
+void appendParams(std::string& out, unsigned short id,
+                  const std::vector<std::string>& params) {
+  std::string content;
+  for (size_t i = 0; i < params.size(); ++i) {
+    const std::string& param = params[i];
+    std::string::size_type eq = param.find('=');
+    if (eq == std::string::npos) continue;
+    appendLength(content, eq);
+    appendLength(content, param.size() - eq - 1);
+    content.append(param, 0, eq);
+    content.append(param, eq + 1, std::string::npos);
+  }
+  appendStream(out, PARAMS, id, content);
+}
+
+void appendStdin(std::string& out, unsigned short id, const std::string& body) {
+  appendStream(out, STDIN, id, body);
+}
+
+RecordParser::RecordParser()
+    : buffer_(), ended_(false), app_status_(0), protocol_status_(0) {}
+
+bool RecordParser::feed(const char* data, size_t len, std::string& stdout_data,
+                        std::string& stderr_data) {
+  if (ended_) return len == 0;
+  buffer_.append(data, len);
+
+  size_t pos = 0;
+  while (buffer_.size() - pos >= HEADER_SIZE) {
+    const unsigned char* h =
+        reinterpret_cast<const unsigned char*>(buffer_.data() + pos);
+    if (h[0] != VERSION_1) return false;
+    size_t content_len = (static_cast<size_t>(h[4]) << 8) | h[5];
+    size_t total = HEADER_SIZE + content_len + h[6];
+    if (buffer_.size() - pos < total) break;
+
+    const char* content = buffer_.data() + pos + HEADER_SIZE;
+    if (h[1] == STDOUT) {
+      stdout_data.append(content, content_len);
+    } else if (h[1] == STDERR) {
+      stderr_data.append(content, content_len);
+    } else if (h[1] == END_REQUEST && content_len >= 8) {
+      const unsigned char* b = reinterpret_cast<const unsigned char*>(content);
+      unsigned long status = (static_cast<unsigned long>(b[0]) << 24) |
+                             (static_cast<unsigned long>(b[1]) << 16) |
+                             (static_cast<unsigned long>(b[2]) << 8) | b[3];
+      app_status_ = static_cast<int>(status);
+      protocol_status_ = b[4];
+      ended_ = true;
+    }
+    pos += total;
+    if (ended_) {
+      bool trailing = pos != buffer_.size();
+      buffer_.clear();
+      return !trailing;
+    }
+  }
+  buffer_.erase(0, pos);
+  return true;
+}
+
+}  // namespace fastcgi
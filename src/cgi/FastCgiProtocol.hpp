@@ -0,0 +1,69 @@
+/**
+ * FastCgiProtocol.hpp
+ *
+ * FastCGI 1.0 record encoding/decoding (responder role only)
+ * Requests are built as one byte string (BEGIN_REQUEST, PARAMS, STDIN)
+ * and written to the socket as it becomes writable; the response stream
+ * is split back into STDOUT/STDERR content and the END_REQUEST status.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace fastcgi {
+
+enum RecordType {
+  BEGIN_REQUEST = 1,
+  ABORT_REQUEST = 2,
+  END_REQUEST = 3,
+  PARAMS = 4,
+  STDIN = 5,
+  STDOUT = 6,
+  STDERR = 7
+};
+
+enum ProtocolStatus { REQUEST_COMPLETE = 0, CANT_MPX_CONN = 1 };
+
+static const unsigned char VERSION_1 = 1;
+static const unsigned short RESPONDER = 1;
+static const unsigned char KEEP_CONN = 1;
+static const size_t HEADER_SIZE = 8;
+static const size_t MAX_CONTENT = 65535;
+
+// Each append* writes complete records, terminator record included.
+void appendBeginRequest(std::string& out, unsigned short id, bool keepConn);
+// params: "NAME=value" strings, the same array execve() gets for CGI
+void appendParams(std::string& out, unsigned short id,
+                  const std::vector<std::string>& params);
+void appendStdin(std::string& out, unsigned short id, const std::string& body);
+
+class RecordParser {
+ public:
+  RecordParser();
+
+  /**
+   * Consume bytes read from the socket
+   * STDOUT content is appended to stdout_data, STDERR to stderr_data.
+   * @return false if the stream is malformed (bad version, data after
+   *         END_REQUEST)
+   */
+  bool feed(const char* data, size_t len, std::string& stdout_data,
+            std::string& stderr_data);
+
+  bool isEnded() const { return ended_; }
+  int getAppStatus() const { return app_status_; }
+  int getProtocolStatus() const { return protocol_status_; }
+  // Bytes of an incomplete record still waiting for the rest.
+  size_t pendingBytes() const { return buffer_.size(); }
+
+ private:
+  std::string buffer_;
+  bool ended_;
+  int app_status_;
+  int protocol_status_;
+};
+
+}  // namespace fastcgi
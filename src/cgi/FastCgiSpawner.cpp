@@ -0,0 +1,159 @@
+/**
+ * FastCgiSpawner.cpp
+ */
+
+#include "FastCgiSpawner.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "../common/Log.hpp"
+#include "../common/namespaces.hpp"
+#include "FastCgiUpstream.hpp"
+
+FastCgiSpawner::FastCgiSpawner() : pools_() {}
+
+FastCgiSpawner::~FastCgiSpawner() { stop(); }
+
+void FastCgiSpawner::start(const std::vector<ServerConfig>& servers) {
+  for (size_t s = 0; s < servers.size(); ++s) {
+    const std::vector<LocationConfig>& locations = servers[s].getLocations();
+    for (size_t l = 0; l < locations.size(); ++l) {
+      const LocationConfig& loc = locations[l];
+      if (loc.getFastCgiSpawn().empty()) continue;
+      addPool(loc.getFastCgiPass(), loc.getFastCgiSpawn(),
+              loc.getFastCgiWorkers());
+    }
+  }
+}
+
+void FastCgiSpawner::addPool(const std::string& address,
+                             const std::string& program, int workers) {
+  // Several locations may share one address: a single pool serves them.
+  for (size_t i = 0; i < pools_.size(); ++i) {
+    if (pools_[i].address == address) return;
+  }
+
+  Pool pool;
+  pool.address = address;
+  pool.program = program;
+  pool.listen_fd = bindSocket(address);
+  pool.workers.assign(workers, -1);
+  pool.started_at.assign(workers, 0);
+  pools_.push_back(pool);
+
+  Pool& added = pools_.back();
+  for (size_t i = 0; i < added.workers.size(); ++i) spawnWorker(added, i);
+  LOG_INFO << "FastCGI: " << workers << " x " << program << " on " << address;
+}
+
+int FastCgiSpawner::bindSocket(const std::string& address) {
+  sockaddr_storage addr;
+  socklen_t addr_len = 0;
+  if (!FastCgiUpstream::resolve(address, addr, addr_len))
+    throw std::runtime_error("fastcgi_spawn: cannot resolve " + address);
+
+  int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1)
+    throw std::runtime_error("fastcgi_spawn: socket() failed for " + address);
+  if (addr.ss_family == AF_UNIX) {
+    // Left over by a previous run that did not shut down cleanly.
+    unlink(reinterpret_cast<sockaddr_un*>(&addr)->sun_path);
+  } else {
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  }
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == -1 ||
+      listen(fd, SOMAXCONN) == -1) {
+    std::string reason = std::strerror(errno);
+    close(fd);
+    throw std::runtime_error("fastcgi_spawn: cannot listen on " + address +
+                             ": " + reason);
+  }
+  return fd;
+}
+
+pid_t FastCgiSpawner::spawnWorker(Pool& pool, size_t slot) {
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t parent = getpid();
+  pid_t pid = fork();
+  if (pid == -1) {
+    LOG_ERROR << "fastcgi_spawn: fork failed: " << std::strerror(errno);
+    return -1;
+  }
+
+  if (pid == 0) {
+    // Workers must not outlive the server, even if it is SIGKILLed.
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != parent) _exit(1);
+
+    // FastCGI convention: the listening socket is fd 0.
+    dup2(pool.listen_fd, STDIN_FILENO);
+    // Respawns happen from inside the event loop: drop every inherited
+    // descriptor (clients, epoll, other pools) except stdio.
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    if (max_fd < 0 || max_fd > 65536) max_fd = 65536;
+    for (int fd = 3; fd < max_fd; ++fd) close(fd);
+    signal(SIGPIPE, SIG_DFL);  // ignored dispositions survive execve()
+
+    char* args[2];
+    args[0] = const_cast<char*>(pool.program.c_str());
+    args[1] = NULL;
+    execv(args[0], args);
+    // The child has no log writer: straight to stderr.
+    std::cerr << "fastcgi_spawn: execv " << pool.program
+              << " failed: " << std::strerror(errno) << std::endl;
+    _exit(127);
+  }
+
+  pool.workers[slot] = pid;
+  pool.started_at[slot] = std::time(NULL);
+  return pid;
+}
+
+bool FastCgiSpawner::handleExit(pid_t pid) {
+  for (size_t p = 0; p < pools_.size(); ++p) {
+    Pool& pool = pools_[p];
+    for (size_t i = 0; i < pool.workers.size(); ++i) {
+      if (pool.workers[i] != pid) continue;
+      pool.workers[i] = -1;
+      if (std::time(NULL) - pool.started_at[i] < MIN_LIFETIME_SECONDS) {
+        LOG_ERROR << "fastcgi_spawn: " << pool.program
+                  << " exited right after start, not restarting";
+        return true;
+      }
+      spawnWorker(pool, i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FastCgiSpawner::stop() {
+  for (size_t p = 0; p < pools_.size(); ++p) {
+    Pool& pool = pools_[p];
+    for (size_t i = 0; i < pool.workers.size(); ++i) {
+      if (pool.workers[i] > 0) kill(pool.workers[i], SIGTERM);
+    }
+    for (size_t i = 0; i < pool.workers.size(); ++i) {
+      if (pool.workers[i] > 0) waitpid(pool.workers[i], NULL, 0);
+      pool.workers[i] = -1;
+    }
+    if (pool.listen_fd != -1) close(pool.listen_fd);
+    const std::string& prefix = config::section::fastcgi_unix_prefix;
+    if (pool.address.compare(0, prefix.size(), prefix) == 0)
+      unlink(pool.address.substr(prefix.size()).c_str());
+  }
+  pools_.clear();
+}
@@ -0,0 +1,63 @@
+/**
+ * FastCgiSpawner.hpp
+ *
+ * Managed FastCGI worker pools (fastcgi_spawn)
+ * For every fastcgi_pass address with a fastcgi_spawn program, the server
+ * binds the listening socket itself and runs N copies of the program with
+ * that socket as stdin (FCGI_LISTENSOCK_FILENO), the way spawn-fcgi does.
+ * php-cgi, fcgiwrap and most FastCGI libraries accept connections from it
+ * directly. Workers that exit are restarted by whoever reaps children
+ * (ServerManager or WorkerSupervisor) through handleExit().
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "../config/ServerConfig.hpp"
+
+class FastCgiSpawner {
+ public:
+  FastCgiSpawner();
+  ~FastCgiSpawner();  // stop()
+
+  // Bind every pool's socket and start its workers.
+  // Throws std::runtime_error if a socket cannot be bound.
+  void start(const std::vector<ServerConfig>& servers);
+
+  /**
+   * A child exited: restart it if it was one of our workers
+   * Workers that die within MIN_LIFETIME_SECONDS are not restarted (a
+   * broken program would otherwise be forked in a tight loop).
+   * @return true if pid belonged to a pool
+   */
+  bool handleExit(pid_t pid);
+
+  // SIGTERM every worker, close the sockets and unlink unix socket files.
+  void stop();
+
+ private:
+  static const int MIN_LIFETIME_SECONDS = 1;
+
+  struct Pool {
+    std::string address;
+    std::string program;
+    int listen_fd;
+    std::vector<pid_t> workers;
+    std::vector<time_t> started_at;
+  };
+
+  FastCgiSpawner(const FastCgiSpawner&);
+  FastCgiSpawner& operator=(const FastCgiSpawner&);
+
+  void addPool(const std::string& address, const std::string& program,
+               int workers);
+  static int bindSocket(const std::string& address);
+  pid_t spawnWorker(Pool& pool, size_t slot);
+
+  std::vector<Pool> pools_;
+};
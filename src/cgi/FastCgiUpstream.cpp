@@ -0,0 +1,105 @@
+/**
+ * FastCgiUpstream.cpp
+ */
+
+#include "FastCgiUpstream.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "../common/Log.hpp"
+#include "../common/namespaces.hpp"
+
+FastCgiUpstream::FastCgiUpstream(const std::string& address,
+                                 size_t max_keepalive)
+    : address_(address),
+      addr_(),
+      addr_len_(0),
+      resolved_(false),
+      max_keepalive_(max_keepalive),
+      keepalive_open_(0),
+      idle_() {
+  resolved_ = resolve(address_, addr_, addr_len_);
+  if (!resolved_)
+    LOG_WARN << "cannot resolve fastcgi_pass " << address_;
+}
+
+FastCgiUpstream::~FastCgiUpstream() {
+  for (size_t i = 0; i < idle_.size(); ++i) close(idle_[i]);
+}
+
+bool FastCgiUpstream::resolve(const std::string& address,
+                              sockaddr_storage& addr, socklen_t& addr_len) {
+  std::memset(&addr, 0, sizeof(addr));
+  const std::string& prefix = config::section::fastcgi_unix_prefix;
+  if (address.compare(0, prefix.size(), prefix) == 0) {
+    std::string path = address.substr(prefix.size());
+    sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&addr);
+    if (path.empty() || path.size() >= sizeof(un->sun_path)) return false;
+    un->sun_family = AF_UNIX;
+    std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+    addr_len = sizeof(sockaddr_un);
+    return true;
+  }
+
+  std::string::size_type colon = address.rfind(':');
+  if (colon == std::string::npos) return false;
+  std::string host = address.substr(0, colon);
+  std::string port = address.substr(colon + 1);
+
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = NULL;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 ||
+      result == NULL)
+    return false;
+  std::memcpy(&addr, result->ai_addr, result->ai_addrlen);
+  addr_len = result->ai_addrlen;
+  freeaddrinfo(result);
+  return true;
+}
+
+int FastCgiUpstream::acquire(bool& keepConn) {
+  keepConn = true;
+  while (!idle_.empty()) {
+    int fd = idle_.back();
+    idle_.pop_back();
+    // The server may have closed an idle connection (restart, its own idle
+    // timeout): EOF or an error here means it is no longer usable.
+    char probe;
+    ssize_t n = recv(fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return fd;
+    close(fd);
+    --keepalive_open_;
+  }
+
+  if (!resolved_) return -1;
+  int fd = socket(addr_.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  0);
+  if (fd == -1) return -1;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr_), addr_len_) == -1 &&
+      errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+  keepConn = keepalive_open_ < max_keepalive_;
+  if (keepConn) ++keepalive_open_;
+  return fd;
+}
+
+void FastCgiUpstream::release(int fd, bool reusable) {
+  if (fd < 0) return;
+  if (reusable) {
+    idle_.push_back(fd);
+    return;
+  }
+  close(fd);
+  --keepalive_open_;
+}
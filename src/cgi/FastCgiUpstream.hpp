@@ -0,0 +1,58 @@
+/**
+ * FastCgiUpstream.hpp
+ *
+ * Connections to one FastCGI server (a fastcgi_pass address)
+ * Up to max_keepalive connections carry FCGI_KEEP_CONN: after END_REQUEST
+ * the socket goes back to an idle list and the next request skips
+ * connect(). Past that limit requests get one-shot connections that the
+ * application closes. The limit exists because prefork servers (php-cgi,
+ * fcgiwrap, spawned pools) serve one connection per worker until it
+ * closes: if every worker held one of our idle connections, new
+ * connections would sit in the accept queue forever.
+ * All sockets are non-blocking; a new connect() may still be in progress
+ * when acquire() returns (the first EPOLLOUT tells the outcome).
+ */
+
+#pragma once
+
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+class FastCgiUpstream {
+ public:
+  // address: "unix:/path" or "host:port" (already validated by the parser)
+  FastCgiUpstream(const std::string& address, size_t max_keepalive);
+  ~FastCgiUpstream();
+
+  const std::string& getAddress() const { return address_; }
+
+  // Idle connection if there is one still open, otherwise a new one.
+  // keepConn tells whether the request may ask to keep it open (and the
+  // connection must then be handed back with release()).
+  // @return socket fd, or -1 if the address cannot be reached
+  int acquire(bool& keepConn);
+  // Keep-alive connection done with its request: back to the idle list if
+  // reusable, otherwise closed.
+  void release(int fd, bool reusable);
+
+  /**
+   * Resolve a fastcgi_pass address
+   * @return false if the host cannot be resolved
+   */
+  static bool resolve(const std::string& address, sockaddr_storage& addr,
+                      socklen_t& addr_len);
+
+ private:
+  FastCgiUpstream(const FastCgiUpstream&);
+  FastCgiUpstream& operator=(const FastCgiUpstream&);
+
+  std::string address_;
+  sockaddr_storage addr_;
+  socklen_t addr_len_;
+  bool resolved_;
+  size_t max_keepalive_;
+  size_t keepalive_open_;  // idle + in use
+  std::vector<int> idle_;
+};
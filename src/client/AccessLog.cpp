@@ -0,0 +1,191 @@
+#include "AccessLog.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstdio>
+#include <ctime>
+
+#include "common/Log.hpp"
+#include "common/TimeUtils.hpp"
+
+static const char* methodName(HttpMethod method) {
+  switch (method) {
+    case HTTP_METHOD_GET:
+      return "GET";
+    case HTTP_METHOD_POST:
+      return "POST";
+    case HTTP_METHOD_DELETE:
+      return "DELETE";
+    case HTTP_METHOD_HEAD:
+      return "HEAD";
+    default:
+      return "-";
+  }
+}
+
+static const char* protocolName(HttpVersion version) {
+  if (version == HTTP_VERSION_1_0) return "HTTP/1.0";
+  if (version == HTTP_VERSION_1_1) return "HTTP/1.1";
+  return "-";
+}
+
+// "18/Oct/2026:09:15:02 +0200", recalculado una vez por segundo.
+static const char* timeLocal() {
+  static time_t cached = -1;
+  static char text[32];
+  time_t now = time(NULL);
+  if (now != cached) {
+    struct tm tm;
+    localtime_r(&now, &tm);
+    size_t len = strftime(text, sizeof(text), "%d/%b/%Y:%H:%M:%S", &tm);
+    // %z no es C++98: el desfase se escribe a mano desde tm_gmtoff.
+    long offset = tm.tm_gmtoff / 60;
+    char sign = offset < 0 ? '-' : '+';
+    if (offset < 0) offset = -offset;
+    std::snprintf(text + len, sizeof(text) - len, " %c%02ld%02ld", sign,
+                  offset / 60, offset % 60);
+    cached = now;
+  }
+  return text;
+}
+
+static void assignHeader(std::string& out, const HttpRequest& request,
+                         HttpHeaderId id) {
+  HttpHeaderView value = request.getHeader(id);
+  out.assign(value.data, value.length);
+}
+
+AccessLog::Entry::Entry()
+    : peer(),
+      start(0),
+      method(HTTP_METHOD_UNKNOWN),
+      version(HTTP_VERSION_UNKNOWN),
+      path(),
+      query(),
+      host(),
+      referer(),
+      userAgent(),
+      status(0),
+      bodyBytes(0) {}
+
+AccessLog::AccessLog(int sink, const LogFormat& format)
+    : _sink(sink), _format(format), _line() {}
+
+void AccessLog::capture(Entry& entry, const HttpRequest& request,
+                        const sockaddr_in& peer, long start) const {
+  entry.peer = peer;
+  entry.start = start;
+  entry.method = request.getMethod();
+  entry.version = request.getVersion();
+  entry.status = 0;
+  entry.bodyBytes = 0;
+  // Solo las cadenas que el formato imprime.
+  if (_format.uses(LogFormat::REQUEST) ||
+      _format.uses(LogFormat::REQUEST_URI) || _format.uses(LogFormat::URI)) {
+    entry.path = request.getPath();
+    entry.query = request.getQuery();
+  }
+  if (_format.uses(LogFormat::HOST))
+    assignHeader(entry.host, request, HTTP_HEADER_HOST);
+  if (_format.uses(LogFormat::HTTP_REFERER))
+    assignHeader(entry.referer, request, HTTP_HEADER_REFERER);
+  if (_format.uses(LogFormat::HTTP_USER_AGENT))
+    assignHeader(entry.userAgent, request, HTTP_HEADER_USER_AGENT);
+}
+
+void AccessLog::write(const Entry& entry) {
+  _line.clear();
+  const std::vector<LogFormat::Piece>& pieces = _format.getPieces();
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    if (pieces[i].variable == LogFormat::LITERAL)
+      _line += pieces[i].text;
+    else
+      appendVariable(pieces[i].variable, entry);
+  }
+  _line += '\n';
+  logging::write(_sink, _line.data(), _line.size());
+}
+
+void AccessLog::appendVariable(LogFormat::Variable variable,
+                               const Entry& entry) {
+  switch (variable) {
+    case LogFormat::REMOTE_ADDR: {
+      char address[INET_ADDRSTRLEN];
+      if (inet_ntop(AF_INET, &entry.peer.sin_addr, address, sizeof(address)))
+        _line += address;
+      break;
+    }
+    case LogFormat::REMOTE_PORT:
+      appendNumber(ntohs(entry.peer.sin_port));
+      break;
+    case LogFormat::TIME_LOCAL:
+      _line += timeLocal();
+      break;
+    case LogFormat::REQUEST:
+      _line += methodName(entry.method);
+      _line += ' ';
+      _line += entry.path;
+      if (!entry.query.empty()) {
+        _line += '?';
+        _line += entry.query;
+      }
+      _line += ' ';
+      _line += protocolName(entry.version);
+      break;
+    case LogFormat::REQUEST_METHOD:
+      _line += methodName(entry.method);
+      break;
+    case LogFormat::REQUEST_URI:
+      _line += entry.path;
+      if (!entry.query.empty()) {
+        _line += '?';
+        _line += entry.query;
+      }
+      break;
+    case LogFormat::URI:
+      _line += entry.path;
+      break;
+    case LogFormat::SERVER_PROTOCOL:
+      _line += protocolName(entry.version);
+      break;
+    case LogFormat::STATUS:
+      appendNumber(static_cast<unsigned long>(entry.status));
+      break;
+    case LogFormat::BODY_BYTES_SENT:
+      appendNumber(entry.bodyBytes);
+      break;
+    case LogFormat::REQUEST_TIME: {
+      long elapsed = time_utils::monotonicMs() - entry.start;
+      if (elapsed < 0) elapsed = 0;
+      char seconds[32];
+      std::snprintf(seconds, sizeof(seconds), "%ld.%03ld", elapsed / 1000,
+                    elapsed % 1000);
+      _line += seconds;
+      break;
+    }
+    case LogFormat::HOST:
+      appendOrDash(entry.host);
+      break;
+    case LogFormat::HTTP_REFERER:
+      appendOrDash(entry.referer);
+      break;
+    case LogFormat::HTTP_USER_AGENT:
+      appendOrDash(entry.userAgent);
+      break;
+    default:
+      break;
+  }
+}
+
+void AccessLog::appendNumber(unsigned long value) {
+  char digits[24];
+  int len = std::snprintf(digits, sizeof(digits), "%lu", value);
+  _line.append(digits, static_cast<size_t>(len));
+}
+
+void AccessLog::appendOrDash(const std::string& value) {
+  if (value.empty())
+    _line += '-';
+  else
+    _line += value;
+}
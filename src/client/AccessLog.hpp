@@ -0,0 +1,64 @@
+#ifndef ACCESSLOG_HPP
+#define ACCESSLOG_HPP
+
+#include <netinet/in.h>
+
+#include <cstddef>
+#include <string>
+
+#include "config/LogFormat.hpp"
+#include "http/HttpRequest.hpp"
+
+// -----------------------------------------------------------------------------
+// ACCESS LOG - una linea por respuesta (directiva access_log de un server)
+// -----------------------------------------------------------------------------
+// El formato llega ya troceado (LogFormat); aqui solo se rellenan los trozos
+// y la linea se encola en el sink del fichero (common/Log): quien escribe en
+// disco es el hilo de logging, nunca el bucle de eventos.
+//
+// Dos pasos, porque la respuesta de un CGI se termina cuando el parser ya
+// puede ir por la siguiente peticion:
+//   - capture(): copia de la peticion lo que usa el formato (en un Entry
+//     del Client, que conserva la capacidad de sus strings)
+//   - write(): con status y bytes de body ya conocidos, formatea y encola
+// -----------------------------------------------------------------------------
+
+class AccessLog {
+ public:
+  struct Entry {
+    Entry();
+
+    sockaddr_in peer;
+    long start;  // ms (reloj monotono), primer byte de la peticion
+    HttpMethod method;
+    HttpVersion version;
+    std::string path;
+    std::string query;
+    std::string host;
+    std::string referer;
+    std::string userAgent;
+    int status;
+    size_t bodyBytes;
+  };
+
+  // sink: de logging::openSink() para el fichero del access_log.
+  AccessLog(int sink, const LogFormat& format);
+
+  void capture(Entry& entry, const HttpRequest& request,
+               const sockaddr_in& peer, long start) const;
+  void write(const Entry& entry);
+
+ private:
+  AccessLog(const AccessLog&);
+  AccessLog& operator=(const AccessLog&);
+
+  void appendVariable(LogFormat::Variable variable, const Entry& entry);
+  void appendNumber(unsigned long value);
+  void appendOrDash(const std::string& value);  // "-" si esta vacio
+
+  int _sink;
+  LogFormat _format;
+  std::string _line;  // se reutiliza linea a linea
+};
+
+#endif  // ACCESSLOG_HPP
@@ -1,10 +1,19 @@
 #include "Client.hpp"
 #include "ErrorUtils.hpp"
 #include "RequestProcessorUtils.hpp"
+#include "SessionUtils.hpp"
 
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+
+#include "cgi/CgiProcess.hpp"
+#include "common/TimeUtils.hpp"
+#include "module/ModuleExchange.hpp"
+#include "network/ServerManager.hpp"
+
 // =============================================================================
 // FUNCIONES AUXILIARES (solo usadas dentro de la clase)
 // =============================================================================
@@ -14,33 +23,75 @@ void Client::handleExpect100() {
   if (_parser.getState() == PARSING_BODY &&
       _parser.getRequest().hasExpect100Continue() && !_sent100Continue) {
     std::string continueMsg("HTTP/1.1 100 Continue\r\n\r\n");
-    enqueueResponse(
-        std::vector<char>(continueMsg.begin(), continueMsg.end()), false);
+    std::vector<char> data(continueMsg.begin(), continueMsg.end());
+    enqueueResponse(data, false);
     _sent100Continue = true;
   }
 }
 
-void Client::enqueueResponse(const std::vector<char>& data, bool closeAfter) {
-  // Añade una respuesta a la cola. Si no hay nada enviando, la pone en _outBuffer.
-  std::string payload(data.begin(), data.end());
-  if (_outBuffer.empty()) {
-    _outBuffer = payload;
-    _closeAfterWrite = closeAfter;
-    _state = STATE_WRITING_RESPONSE;
-    return;
-  }
-  _responseQueue.push(PendingResponse(payload, closeAfter));
+void Client::enqueueResponse(std::vector<char>& data, bool closeAfter,
+                             const SharedFd& file, off_t fileOffset,
+                             size_t fileLength) {
+  // Añade la respuesta al final de la cadena de salida. Las respuestas
+  // pipelined se acumulan y handleWrite() las manda juntas con writev().
+  _output.append(SharedBuffer::adopt(data));
+  _output.appendFile(file, fileOffset, fileLength);
+  // Una vez encolada una respuesta con "Connection: close", se cierra al
+  // terminar de enviar la cadena.
+  if (closeAfter) _closeAfterWrite = true;
+  _state = STATE_WRITING_RESPONSE;
+  _lastActivity = time_utils::monotonicMs();  // arranca send_timeout
+}
+
+void Client::beginAccessLog(const HttpRequest& request) {
+  _accessLog =
+      _serverManager ? _serverManager->getAccessLog(selectServer(request)) : 0;
+  if (_accessLog)
+    _accessLog->capture(_accessEntry, request, _peer, _requestStart);
+}
+
+void Client::logAccess(int status, size_t bodyBytes) {
+  if (_accessLog == 0) return;
+  _accessEntry.status = status;
+  _accessEntry.bodyBytes = bodyBytes;
+  _accessLog->write(_accessEntry);
+  _accessLog = 0;
+}
+
+bool Client::serveFromCache(const std::string& key, const HttpRequest& request,
+                            bool shouldClose) {
+  SharedBuffer headers;
+  SharedBuffer body;
+  if (!_responseCache->lookup(key, headers, body)) return false;
+
+  // Solo la parte que depende de esta peticion se construye aqui; el resto
+  // son los mismos bytes compartidos por todos los aciertos.
+  std::string prefix =
+      request.getVersion() == HTTP_VERSION_1_0 ? "HTTP/1.0" : "HTTP/1.1";
+  prefix += " 200 OK\r\nconnection: ";
+  prefix += shouldClose ? "close\r\n" : "keep-alive\r\n";
+  std::string cookie = sessionCookieFor(request);
+  if (!cookie.empty()) prefix += "set-cookie: " + cookie + "\r\n";
+
+  _output.append(SharedBuffer(prefix));
+  _output.append(headers);
+  _output.append(body);
+  if (shouldClose) _closeAfterWrite = true;
+  _state = STATE_WRITING_RESPONSE;
+  logAccess(200, body.size());
+  return true;
 }
 
 void Client::buildResponse() {
   const HttpRequest& request = _parser.getRequest();
-  bool handled = _processor.process(request, _configs, _listenPort,
+  const ServerConfig* server = selectServer(request);
+  bool handled = _processor.process(request, server,
                                     _parser.getErrorStatusCode(), _response);
   if (!handled) {
-    // process() devolvió false: es CGI, ejecutar CgiExecutor
+    // process() devolvió false: handler (modulo) o CGI
+    if (startModuleIfNeeded(request)) return;
     if (startCgiIfNeeded(request)) return;
     // No se pudo ejecutar CGI (sin config o fallo) → 501
-    const ServerConfig* server = selectServerByPort(_listenPort, _configs);
     buildErrorResponse(_response, request, 501, true, server);
   }
 }
@@ -50,12 +101,47 @@ bool Client::handleCompleteRequest() {
   const HttpRequest& request = _parser.getRequest();
   bool shouldClose =
       (_parser.getState() == ERROR) || request.shouldCloseConnection();
+  beginAccessLog(request);
+
+  // Cache de respuestas: un acierto no pasa por process() ni serialize().
+  std::string cacheKey;
+  if (_responseCache && _parser.getState() != ERROR) {
+    cacheKey = ResponseCache::makeKey(selectServer(request), request);
+    if (!cacheKey.empty() && serveFromCache(cacheKey, request, shouldClose))
+      return shouldClose;
+  }
+
   buildResponse();
-  if (_cgiProcess) {
-    return true;  // CGI arrancado, respuesta vendrá más tarde
+  if (_cgiProcess || _module) {
+    return true;  // CGI o handler asincrono: la respuesta vendrá más tarde
   }
+  if (!cacheKey.empty())
+    _responseCache->store(cacheKey, _response, _processor.getResolvedPath());
   std::vector<char> serialized = _response.serialize();
-  enqueueResponse(serialized, shouldClose);
+  if (_response.hasFileBody() && !_response.isHeadOnly() &&
+      !_response.getFileParts().empty()) {
+    // multipart/byteranges: la cabecera de cada parte en memoria y su trozo
+    // del fichero detras, con sendfile() como un body normal.
+    enqueueResponse(serialized, shouldClose);
+    const std::vector<HttpResponse::FilePart>& parts = _response.getFileParts();
+    for (size_t i = 0; i < parts.size(); ++i) {
+      _output.append(SharedBuffer(parts[i].header));
+      _output.appendFile(_response.getBodyFile(), parts[i].offset,
+                         parts[i].length);
+    }
+  } else if (_response.hasFileBody() && !_response.isHeadOnly()) {
+    // Solo las cabeceras pasan por memoria; el body sale del fichero.
+    enqueueResponse(serialized, shouldClose, _response.getBodyFile(),
+                    _response.getBodyFileOffset(),
+                    _response.getBodyFileLength());
+  } else if (_response.hasSharedBody() && !_response.isHeadOnly()) {
+    // Body compartido (CompressionCache): se encola el mismo buffer.
+    enqueueResponse(serialized, shouldClose);
+    _output.append(_response.getSharedBody());
+  } else {
+    enqueueResponse(serialized, shouldClose);
+  }
+  logAccess(_response.getStatusCode(), _response.getBodySize());
   return shouldClose;
 }
 
@@ -63,70 +149,220 @@ bool Client::handleCompleteRequest() {
 // CONSTRUCTOR, DESTRUCTOR, GETTERS
 // =============================================================================
 
-Client::Client(int fd, const std::vector<ServerConfig>* configs, int listenPort)
+Client::Client(int fd, const std::vector<ServerConfig>* configs, int listenPort,
+               const VirtualHostTable* vhosts)
     : _savedShouldClose(false),
       _savedVersion(HTTP_VERSION_1_1),
+      _savedServer(0),
       _fd(fd),
       _listenPort(listenPort),
+      _peer(),
       _configs(configs),
+      _vhosts(vhosts),
+      _server(0),
+      _serverHost(),
       _state(STATE_IDLE),
-      _lastActivity(std::time(0)),
-      _outBuffer(),
-      _responseQueue(),
+      _lastActivity(time_utils::monotonicMs()),
+      _requestStart(_lastActivity),
+      _cgiStart(0),
+      _keepAliveIdle(false),
+      _output(),
+      _readSize(config::section::default_client_read_size),
+      _drainSocket(false),
       _parser(),
       _response(),
       _serverManager(0),
       _cgiProcess(0),
+      _cgiHeadersSent(false),
+      _cgiChunked(false),
+      _cgiPaused(false),
+      _cgiBodyRemaining(-1),
+      _cgiGzip(false),
+      _cgiCoding(CONTENT_CODING_IDENTITY),
+      _cgiCompressor(0),
+      _module(0),
+      _moduleLoop(0),
+      _moduleHeadOnly(false),
+      _responseCache(0),
+      _accessLog(0),
+      _accessEntry(),
       _closeAfterWrite(false),
       _sent100Continue(false) {
-  const ServerConfig* server = selectServerByPort(listenPort, configs);
-  if (server) _parser.setMaxBodySize(server->getMaxBodySize());
+  _parser.setMaxBodySize(portMaxBodySize());
 }
 
-Client::~Client() {}
+Client::~Client() {
+  abortCgi();
+  endModule();
+  delete _moduleLoop;
+}
+
+void Client::recycle() {
+  abortCgi();
+  endModule();
+  _output.clear();  // cierra los ficheros pendientes de enviar
+  _parser.clear();
+  _response.clear();
+  _state = STATE_CLOSED;
+}
+
+void Client::reopen(int fd, int listenPort) {
+  recycle();
+  _fd = fd;
+  _listenPort = listenPort;
+  _state = STATE_IDLE;
+  _lastActivity = time_utils::monotonicMs();
+  _requestStart = _lastActivity;
+  _cgiStart = 0;
+  _keepAliveIdle = false;
+  _closeAfterWrite = false;
+  _sent100Continue = false;
+  _savedShouldClose = false;
+  _savedVersion = HTTP_VERSION_1_1;
+  _savedServer = 0;
+  _server = 0;
+  _serverHost.clear();
+  _accessLog = 0;
+  _parser.setMaxBodySize(portMaxBodySize());
+}
+
+const ServerConfig* Client::selectServer(const HttpRequest& request) {
+  HttpHeaderView host = request.getHeader(HTTP_HEADER_HOST);
+  if (_server != 0 && host.length == _serverHost.size() &&
+      _serverHost.compare(0, host.length, host.data, host.length) == 0)
+    return _server;
+  _serverHost.assign(host.data, host.length);
+  _server = _vhosts ? _vhosts->resolve(_listenPort, host.data, host.length)
+                    : selectServerByPort(_listenPort, _configs);
+  return _server;
+}
+
+size_t Client::portMaxBodySize() const {
+  if (_vhosts) return _vhosts->maxBodySize(_listenPort);
+  const ServerConfig* server = selectServerByPort(_listenPort, _configs);
+  return server ? server->getMaxBodySize() : 0;
+}
 
 int Client::getFd() const { return _fd; }
 
+void Client::setPeer(const sockaddr_in& peer) { _peer = peer; }
+
+const sockaddr_in& Client::getPeer() const { return _peer; }
+
 ClientState Client::getState() const { return _state; }
 
-bool Client::needsWrite() const { return !_outBuffer.empty(); }
+// Tambien con la cadena vacia si solo falta cerrar: la salida de un CGI sin
+// longitud puede haberse enviado entera antes de su EOF.
+bool Client::needsWrite() const { return !_output.empty() || _closeAfterWrite; }
 
-bool Client::hasPendingData() const {
-  return !_outBuffer.empty() || !_responseQueue.empty();
+bool Client::hasPendingData() const { return !_output.empty(); }
+
+// =============================================================================
+// TIMEOUTS
+// =============================================================================
+// Un solo deadline por cliente, segun lo que se este esperando:
+//   - CGI en marcha:       arranque (o ultima salida una vez enviadas las
+//                          cabeceras) + cgi_timeout; con el pipe parado
+//                          por backpressure, ultimo envio + send_timeout
+//   - handler asincrono:   igual que un CGI, con cgi_timeout; mientras
+//                          haya salida sin enviar, send_timeout
+//   - respuesta pendiente: ultimo envio + send_timeout
+//   - leyendo body:        ultima lectura + client_body_timeout
+//   - entre peticiones:    ultima actividad + keepalive_timeout
+//   - resto (cabeceras):   primer byte (o accept) + client_header_timeout
+
+long Client::getDeadline(const GlobalConfig& global) const {
+  if (_cgiProcess && _cgiPaused)
+    return _lastActivity + global.getSendTimeout() * 1000L;
+  if (_cgiProcess) return _cgiStart + _cgiProcess->getTimeoutSeconds() * 1000L;
+  if (_module && !_output.empty())
+    return _lastActivity + global.getSendTimeout() * 1000L;
+  if (_module)
+    return std::max(_cgiStart, _lastActivity) + global.getCgiTimeout() * 1000L;
+  if (!_output.empty()) return _lastActivity + global.getSendTimeout() * 1000L;
+  if (_parser.getState() == PARSING_BODY)
+    return _lastActivity + global.getClientBodyTimeout() * 1000L;
+  if (_state == STATE_IDLE && _keepAliveIdle)
+    return _lastActivity + global.getKeepaliveTimeout() * 1000L;
+  return _requestStart + global.getClientHeaderTimeout() * 1000L;
 }
 
-time_t Client::getLastActivity() const { return _lastActivity; }
+bool Client::handleTimeout() {
+  if (_module) {
+    // Un handler que no termina: como un CGI colgado.
+    if (_cgiHeadersSent) {
+      logAccess(_accessEntry.status, _accessEntry.bodyBytes);
+      endModule();
+      return true;
+    }
+    endModule();
+    sendCgiError(HTTP_STATUS_GATEWAY_TIMEOUT);
+    feedParser();
+    processRequests();
+    return false;
+  }
+  if (_cgiProcess == 0) return true;
+  // Respuesta ya a medias: no cabe un 504, solo cortar.
+  if (_cgiHeadersSent) {
+    logAccess(_accessEntry.status, _accessEntry.bodyBytes);
+    abortCgi();
+    return true;
+  }
+
+  abortCgi();
+  sendCgiError(HTTP_STATUS_GATEWAY_TIMEOUT);
+  // Peticiones pipelined que esperaban al CGI.
+  feedParser();
+  processRequests();
+  return false;
+}
 
 // =============================================================================
 // MANEJO DE EVENTOS (llamados desde el bucle epoll)
 // =============================================================================
 
+// Level-triggered: una lectura por evento (epoll vuelve a avisar si queda
+// algo). Edge-triggered: hasta EAGAIN, porque no habra otro aviso hasta que
+// lleguen datos nuevos.
 void Client::handleRead() {
-  // 1) Leer datos del socket
-  char buffer[4096];
-  ssize_t bytesRead = recv(_fd, buffer, sizeof(buffer), 0);
+  while (true) {
+    // 1) Leer datos del socket, directamente al buffer del parser
+    size_t space = 0;
+    char* buffer = _parser.prepareRead(_readSize, space);
+    ssize_t bytesRead = _serverManager
+                            ? _serverManager->receive(_fd, buffer, space)
+                            : recv(_fd, buffer, space, 0);
 
-  if (bytesRead > 0) {
-    _lastActivity = std::time(0);
-    if (_state == STATE_IDLE) _state = STATE_READING_HEADER;
+    if (bytesRead < 0 && errno == EINTR) continue;
+    if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    if (bytesRead <= 0) {
+      _state = STATE_CLOSED;  // Cliente cerró la conexión o error en recv
+      return;
+    }
+
+    _lastActivity = time_utils::monotonicMs();
+    if (_state == STATE_IDLE) {
+      _state = STATE_READING_HEADER;
+      _requestStart = _lastActivity;
+      _keepAliveIdle = false;
+    }
 
     // 2) Pasar al parser
-    _parser.consume(std::string(buffer, bytesRead));
+    _parser.commitRead(static_cast<size_t>(bytesRead));
+    feedParser();
 
     // 3) Expect: 100-continue (respuesta intermedia si el cliente la espera)
     handleExpect100();
 
     processRequests();
 
-    // 5) Si el parser marcó error, construir y enviar respuesta de error
+    // 4) Si el parser marcó error, construir y enviar respuesta de error
     if (_parser.getState() == ERROR) {
       handleCompleteRequest();
       return;
     }
-  } else if (bytesRead == 0) {
-    _state = STATE_CLOSED;  // Cliente cerró la conexión
-  } else {
-    _state = STATE_CLOSED;  // Error en recv
+    // Lo que quede en el socket tras un "Connection: close" se descarta.
+    if (!_drainSocket || _closeAfterWrite) return;
   }
 }
 
@@ -134,7 +370,7 @@ void Client::processRequests() {
   while (_parser.getState() == COMPLETE) {
     // If a CGI process is running, we cannot start another one or process
     // responses yet. We just wait (parser buffer holds next request).
-    if (_cgiProcess) return;
+    if (_cgiProcess || _module) return;
 
     bool shouldClose = handleCompleteRequest();
 
@@ -143,56 +379,89 @@ void Client::processRequests() {
     // so we can parse the *next* request (if any) later.
     // BUT we must have saved the necessary info from the request first
     // (done in startCgiIfNeeded).
-    if (_cgiProcess) {
+    if (_cgiProcess || _module) {
        _response.clear();
        _parser.reset();
+       _parser.setMaxBodySize(portMaxBodySize());
        return;
     }
 
     if (shouldClose) return;
     _response.clear();
     _parser.reset();
+    _parser.setMaxBodySize(portMaxBodySize());
     _sent100Continue = false;
-    _parser.consume("");
+    feedParser();
   }
 }
 
+// parse() + decidir donde va el body en cuanto se conocen las cabeceras:
+// una subida (POST a una location con upload_store que no es CGI) se vuelca
+// a un temporal en upload_store pasado client_body_buffer_size; todo lo
+// demas (tambien el body para un handler) se queda en memoria.
+void Client::feedParser() {
+  _parser.parse();
+  if (!_parser.needsBodyStorage()) return;
+
+  const HttpRequest& request = _parser.getRequest();
+  const ServerConfig* server = selectServer(request);
+  // Hasta aqui regia el limite mas alto del puerto; el resto del body se
+  // mide con el del virtual host.
+  if (server) _parser.setMaxBodySize(server->getMaxBodySize());
+  const LocationConfig* location =
+      server ? matchLocation(*server, request) : 0;
+  if (request.getMethod() != HTTP_METHOD_POST || location == 0 ||
+      location->getUploadStore().empty() || !location->getHandler().empty()) {
+    _parser.storeBodyInMemory();
+    return;
+  }
+  std::string scriptPath = resolvePath(*server, location, request.getPath());
+  if (isCgiRequest(scriptPath) || isCgiRequestByConfig(location, scriptPath)) {
+    _parser.storeBodyInMemory();
+    return;
+  }
+  _parser.spillBodyTo(location->getUploadStore(), server->getBodyBufferSize());
+}
+
 
 
 // ============================
-// ESCRITURA AL SOCKET (EPOLLOUT)
+// ESCRITURA AL SOCKET
 // ============================
-// - Intenta enviar parte de _outBuffer con send().
-// - Borra del buffer lo que se haya enviado.
-// - Si termina y hay mas respuestas en cola, las saca una a una.
-// - Si no hay nada mas y no hay que cerrar, vuelve a STATE_IDLE.
+// - ServerManager la llama con EPOLLOUT y tambien en cuanto hay algo
+//   encolado: casi siempre cabe entero en el socket y no hace falta pedir
+//   EPOLLOUT a epoll.
+// - Una syscall por pasada: writev() de los bloques en memoria pendientes
+//   (cabeceras, bodies y respuestas pipelined) o sendfile() de un fichero.
+//   Edge-triggered: pasadas hasta vaciar la cadena o hasta EAGAIN.
+// - Los envios parciales solo avanzan offsets dentro de _output.
+// - Si la cadena queda vacia: cerrar (Connection: close) o volver a IDLE.
 
 void Client::handleWrite() {
-  if (_outBuffer.empty()) return;
-
-  ssize_t bytesSent = send(_fd, _outBuffer.c_str(), _outBuffer.size(), 0);
-  if (bytesSent > 0) {
-    _lastActivity = std::time(0);
-    _outBuffer.erase(0, bytesSent);
-  } else if (bytesSent < 0) {
-    _state = STATE_CLOSED;
+  if (_output.empty()) {
+    if (_closeAfterWrite) _state = STATE_CLOSED;
     return;
   }
 
-  // Si hemos enviado todo el buffer actual:
-  if (_outBuffer.empty()) {
-    if (_closeAfterWrite == true) {
+  do {
+    ssize_t bytesSent = _output.flush(_fd);
+    if (bytesSent < 0) {
       _state = STATE_CLOSED;
       return;
     }
-    if (_responseQueue.empty() == false) {
-      PendingResponse next = _responseQueue.front();
-      _responseQueue.pop();
-      _outBuffer = next.data;
-      _closeAfterWrite = next.closeAfter;
-      _state = STATE_WRITING_RESPONSE;
+    if (bytesSent == 0) break;  // socket lleno: esperar a EPOLLOUT
+    _lastActivity = time_utils::monotonicMs();
+  } while (_drainSocket && !_output.empty());
+
+  // Hay sitio otra vez: volver a leer la salida del CGI.
+  if (_cgiPaused && _output.size() < CGI_OUTPUT_LOW_WATER) resumeCgiOutput();
+
+  if (_output.empty()) {
+    if (_closeAfterWrite == true) {
+      _state = STATE_CLOSED;
       return;
     }
     _state = STATE_IDLE;
+    _keepAliveIdle = true;
   }
 }
@@ -1,19 +1,30 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
 
+#include <netinet/in.h>
+#include <sys/types.h>
+
 #include <ctime>
-#include <queue>
 #include <string>
 #include <vector>
 
+#include "AccessLog.hpp"
+#include "OutputChain.hpp"
 #include "RequestProcessor.hpp"
+#include "ResponseCache.hpp"
+#include "common/SharedFd.hpp"
+#include "config/GlobalConfig.hpp"
 #include "config/ServerConfig.hpp"
+#include "config/VirtualHostTable.hpp"
+#include "http/ContentEncoding.hpp"
 #include "http/HttpParser.hpp"
 #include "http/HttpRequest.hpp"
 #include "http/HttpResponse.hpp"
 
 class ServerManager;
 class CgiProcess;
+class ModuleEventLoop;
+class ModuleExchange;
 
 // -----------------------------------------------------------------------------
 // TIPOS (fuera de la clase, visibles y reutilizables)
@@ -27,12 +38,6 @@ enum ClientState {
   STATE_CLOSED
 };
 
-struct PendingResponse {
-  std::string data;
-  bool closeAfter;
-  PendingResponse(const std::string& d, bool c) : data(d), closeAfter(c) {}
-};
-
 // -----------------------------------------------------------------------------
 // CLIENT - Representa una conexión TCP con un cliente
 // -----------------------------------------------------------------------------
@@ -46,17 +51,41 @@ class Client {
   // Saved request state for CGI
   bool _savedShouldClose;
   HttpVersion _savedVersion;
+  const ServerConfig* _savedServer;
  public:
   // ---- Constructor y destructor ----
-  Client(int fd, const std::vector<ServerConfig>* configs, int listenPort);
+  // vhosts: tabla (puerto, Host) del worker; sin ella (tests) se usa el
+  // primer server del puerto.
+  Client(int fd, const std::vector<ServerConfig>* configs, int listenPort,
+         const VirtualHostTable* vhosts = 0);
   ~Client();
 
+  // ---- Reutilizacion (ClientPool) ----
+  // recycle(): suelta todo lo de la conexion (CGI, ficheros, buffers) sin
+  // liberar la capacidad ya reservada. reopen(): la deja como recien creada
+  // para otra conexion.
+  void recycle();
+  void reopen(int fd, int listenPort);
+  // Direccion del cliente tal cual la da accept4() (binario, orden de red);
+  // solo se pasa a texto donde se imprime.
+  void setPeer(const sockaddr_in& peer);
+  const sockaddr_in& getPeer() const;
+
   // ---- Getters (para que el bucle principal sepa el estado) ----
   int getFd() const;
   ClientState getState() const;
   bool needsWrite() const;
   bool hasPendingData() const;
-  time_t getLastActivity() const;
+
+  // ---- Timeouts (ServerManager guarda un temporizador por cliente) ----
+  // Instante (ms, reloj monotono) en el que vence el timeout que aplica al
+  // estado actual: CGI, envio, body, cabeceras o keep-alive.
+  long getDeadline(const GlobalConfig& global) const;
+  // Vencido el deadline: true si hay que cerrar la conexion. Un CGI que se
+  // pasa de tiempo se mata y se responde 504 sin cerrar (o se cierra, si
+  // su respuesta ya habia empezado a enviarse). Igual con un handler
+  // (modulo) que no termina.
+  bool handleTimeout();
 
   // ---- Manejo de eventos (llamados desde ServerManager/epoll) ----
   void setServerManager(ServerManager* serverManager);
@@ -75,15 +104,30 @@ class Client {
   // ---- Datos del socket y conexión ----
   int _fd;
   int _listenPort;
+  sockaddr_in _peer;
   const std::vector<ServerConfig>* _configs;
+  const VirtualHostTable* _vhosts;
+  // Virtual host de la ultima peticion y el Host con el que se eligio: en
+  // keep-alive las siguientes suelen traer el mismo y no se vuelve a buscar.
+  const ServerConfig* _server;
+  std::string _serverHost;
   ClientState _state;
-  time_t _lastActivity;
+  long _lastActivity;      // ms, ultimo recv/send/pipe con datos
+  long _requestStart;      // ms, primer byte de la peticion en curso
+  long _cgiStart;          // ms, arranque del CGI en curso
+  bool _keepAliveIdle;     // ya se respondio algo y se espera otra peticion
 
   // ---- Buffers ----
-  std::string _outBuffer;  // Respuesta lista para enviar
-  std::queue<PendingResponse> _responseQueue;
+  // Respuestas listas para enviar (cabeceras, bodies y ficheros), en orden.
+  OutputChain _output;
 
   // ---- Parser y respuesta HTTP ----
+  // recv() escribe directo en el buffer de entrada del parser, _readSize
+  // bytes como minimo por lectura (client_read_size).
+  size_t _readSize;
+  // edge_triggered on: epoll avisa una sola vez por cambio, asi que se lee y
+  // se escribe hasta EAGAIN. Si no, una lectura/escritura por evento.
+  bool _drainSocket;
   HttpParser _parser;
   HttpResponse _response;
   RequestProcessor _processor;
@@ -91,6 +135,37 @@ class Client {
   // ---- CGI (si hay script en ejecución) ----
   ServerManager* _serverManager;
   CgiProcess* _cgiProcess;
+  // La salida del CGI se reenvia segun llega: cabeceras en cuanto estan
+  // completas y luego el body por trozos (chunked si el script no manda
+  // Content-Length). Si _output pasa de CGI_OUTPUT_HIGH_WATER se deja de
+  // leer el pipe hasta que baje de CGI_OUTPUT_LOW_WATER.
+  static const size_t CGI_OUTPUT_HIGH_WATER = 64 * 1024;
+  static const size_t CGI_OUTPUT_LOW_WATER = 16 * 1024;
+  bool _cgiHeadersSent;
+  bool _cgiChunked;
+  bool _cgiPaused;         // pipe fuera de epoll (backpressure)
+  long _cgiBodyRemaining;  // Content-Length del script aun por enviar; -1 = sin
+  // gzip on en la location del script: su body (si es de un tipo
+  // comprimible) sale comprimido con _cgiCoding, por trozos, en chunked.
+  bool _cgiGzip;
+  ContentCoding _cgiCoding;
+  ContentCompressor* _cgiCompressor;  // 0 = body sin comprimir
+
+  // ---- Handler (modulo .so) con una respuesta asincrona en curso ----
+  // Usa el mismo estado de envio que el CGI (_cgiHeadersSent, _cgiChunked,
+  // _cgiBodyRemaining, _cgiStart); sus fds van por registerCgiPipe().
+  ModuleExchange* _module;       // 0 = ninguno
+  ModuleEventLoop* _moduleLoop;  // se crea con el primer handler
+  bool _moduleHeadOnly;          // HEAD, 204 o 304: el body se descarta
+
+  // ---- Cache de respuestas del worker (0 = desactivada) ----
+  ResponseCache* _responseCache;
+
+  // ---- access_log del server de la peticion en curso (0 = no se loguea) ----
+  // La linea se escribe al encolar la respuesta entera (o, en CGI, al
+  // terminar el script): _accessEntry guarda mientras tanto la peticion.
+  AccessLog* _accessLog;
+  AccessLog::Entry _accessEntry;
 
   // ---- Flags ----
   bool _closeAfterWrite;
@@ -98,13 +173,41 @@ class Client {
 
   // ---- Funciones auxiliares (solo usadas dentro de la clase) ----
   bool handleCompleteRequest();  // Request parseada → construir y encolar respuesta
-  void enqueueResponse(const std::vector<char>& data, bool closeAfter);
+  // Se queda con el contenido de data (swap, sin copia).
+  void enqueueResponse(std::vector<char>& data, bool closeAfter,
+                       const SharedFd& file = SharedFd(), off_t fileOffset = 0,
+                       size_t fileLength = 0);
+  // Acierto en _responseCache: encola la respuesta cacheada sin process().
+  bool serveFromCache(const std::string& key, const HttpRequest& request,
+                      bool shouldClose);
   void handleExpect100();  // Expect: 100-continue
+  void beginAccessLog(const HttpRequest& request);
+  void logAccess(int status, size_t bodyBytes);
   bool startCgiIfNeeded(const HttpRequest& request);
-  void finalizeCgiResponse();
+  void startCgiCompression();  // gzip on: Content-Encoding + compresor
+  void sendCgiHeaders();
+  void streamCgiOutput(bool eof);  // encola lo leido del script
+  void finishCgi();                // EOF del pipe: cerrar la respuesta
+  void sendCgiError(int status);   // 502/504 antes de enviar cabeceras
+  void resumeCgiOutput();          // fin del backpressure
+  void onCgiOutput(int pipe_fd);   // reenviar lo nuevo del script
+  void handleFastCgiSocket(int sock, size_t events);
+  void abortCgi();  // mata el CGI y suelta sus pipes (timeout, destructor)
+  // Location con 'handler': true si ya hay respuesta (o arranco asincrona).
+  bool startModuleIfNeeded(const HttpRequest& request);
+  void sendModuleHeaders(bool complete, size_t length);
+  void pumpModule();  // encola lo escrito por el modulo; cierra si termino
+  void onModuleEvent(int fd, size_t events);
+  void endModule();  // lo borra: fuera de epoll y abort() si no termino
 
   // Invocado cuando el parser marca una HttpRequest como completa.
   void processRequests();
+  // parse() + elegir donde se guarda el body (memoria o temporal).
+  void feedParser();
+  // Server { } que atiende la peticion segun su Host (cacheado en _server).
+  const ServerConfig* selectServer(const HttpRequest& request);
+  // Limite de body mientras no se conoce el Host: el mayor del puerto.
+  size_t portMaxBodySize() const;
 };
 
 #endif  // CLIENT_HPP
@@ -1,8 +1,10 @@
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <cstdlib>
 #include <sstream>
 
 #include "Client.hpp"
@@ -10,11 +12,22 @@
 #include "RequestProcessorUtils.hpp"
 #include "cgi/CgiExecutor.hpp"
 #include "cgi/CgiProcess.hpp"
+#include "common/TimeUtils.hpp"
 #include "http/HttpHeaderUtils.hpp"
 #include "network/ServerManager.hpp"
 
 void Client::setServerManager(ServerManager* serverManager) {
   _serverManager = serverManager;
+  if (serverManager) {
+    const GlobalConfig& global = serverManager->getGlobalConfig();
+    _readSize = static_cast<size_t>(global.getClientReadSize());
+    _drainSocket = global.getEdgeTriggered();
+  }
+  _processor.setOpenFileCache(serverManager ? serverManager->getOpenFileCache()
+                                            : 0);
+  _processor.setCompressionCache(
+      serverManager ? serverManager->getCompressionCache() : 0);
+  _responseCache = serverManager ? serverManager->getResponseCache() : 0;
 }
 
 static void parseCgiHeaders(const std::string& headers,
@@ -33,7 +46,10 @@ static void parseCgiHeaders(const std::string& headers,
     std::string keyLower = key;
     std::transform(keyLower.begin(), keyLower.end(), keyLower.begin(),
                    ::tolower);
-    if (keyLower == "status") continue;
+    // Status va en la status line; el framing del body lo pone el servidor.
+    if (keyLower == "status" || keyLower == "transfer-encoding" ||
+        keyLower == "connection")
+      continue;
     response.setHeader(key, value);
   }
 }
@@ -41,13 +57,13 @@ static void parseCgiHeaders(const std::string& headers,
 bool Client::startCgiIfNeeded(const HttpRequest& request) {
   if (_configs == 0 || _serverManager == 0) return false;
 
-  const ServerConfig* server = selectServerByPort(_listenPort, _configs);
+  const ServerConfig* server = selectServer(request);
   if (server == 0) return false;
 
-  const LocationConfig* location = matchLocation(*server, request.getPath());
+  const LocationConfig* location = matchLocation(*server, request);
   if (location == 0) return false;
 
-  if (server && request.getBody().size() > server->getMaxBodySize()) {
+  if (server && request.getBodySize() > server->getMaxBodySize()) {
     buildErrorResponse(_response, request, HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE,
                        true, server);
     return true;
@@ -65,47 +81,264 @@ bool Client::startCgiIfNeeded(const HttpRequest& request) {
   }
 
   CgiExecutor exec;
-  _cgiProcess = exec.executeAsync(request, scriptPath, interpreterPath, *server);
-  if (_cgiProcess == 0) {
-    buildErrorResponse(_response, request, 500, true, server);
-    return true;
+  int timeout = _serverManager->getGlobalConfig().getCgiTimeout();
+  const std::string& fastcgiPass = location->getFastCgiPass();
+  if (!fastcgiPass.empty()) {
+    // FastCGI: un solo socket (pedir y leer) hacia un servidor ya arrancado.
+    FastCgiUpstream* upstream = _serverManager->getFastCgiUpstream(fastcgiPass);
+    if (upstream)
+      _cgiProcess = exec.executeFastCgi(request, _peer, scriptPath,
+                                        *location, *upstream, timeout);
+    if (_cgiProcess == 0) {
+      buildErrorResponse(_response, request, HTTP_STATUS_BAD_GATEWAY, true,
+                         server);
+      return true;
+    }
+    _serverManager->registerCgiPipe(_cgiProcess->getPipeOut(),
+                                    EPOLLIN | EPOLLOUT | EPOLLRDHUP, this);
+  } else {
+    _cgiProcess = exec.executeAsync(request, _peer, scriptPath,
+                                    interpreterPath, *location, timeout);
+    if (_cgiProcess == 0) {
+      buildErrorResponse(_response, request, 500, true, server);
+      return true;
+    }
+    _serverManager->registerCgiPipe(_cgiProcess->getPipeOut(),
+                                    EPOLLIN | EPOLLRDHUP, this);
+    _serverManager->registerCgiPipe(_cgiProcess->getPipeIn(),
+                                    EPOLLOUT | EPOLLRDHUP, this);
   }
 
-  _serverManager->registerCgiPipe(_cgiProcess->getPipeOut(),
-                                  EPOLLIN | EPOLLRDHUP, this);
-  _serverManager->registerCgiPipe(_cgiProcess->getPipeIn(),
-                                  EPOLLOUT | EPOLLRDHUP, this);
-
 
   _state = STATE_READING_BODY;
-  
+  _cgiStart = time_utils::monotonicMs();
+  _cgiHeadersSent = false;
+  _cgiChunked = false;
+  _cgiPaused = false;
+  _cgiBodyRemaining = -1;
+  _cgiGzip = location->getGzip() && request.getMethod() != HTTP_METHOD_HEAD;
+  _cgiCoding = _cgiGzip ? negotiateContentCoding(request.getHeader(
+                              HTTP_HEADER_ACCEPT_ENCODING))
+                        : CONTENT_CODING_IDENTITY;
+
   // Save request state needed for finalization
   _savedShouldClose = request.shouldCloseConnection();
   _savedVersion = request.getVersion();
+  _savedServer = server;
   
   return true;
 }
 
-void Client::finalizeCgiResponse() {
+// gzip on: un 200 de tipo comprimible que el script no haya codificado ya
+// sale comprimido. El Content-Length del script sigue limitando lo que se
+// lee de el, pero la longitud comprimida no se conoce hasta el final.
+void Client::startCgiCompression() {
+  if (!_cgiGzip || _response.getStatusCode() != HTTP_STATUS_OK ||
+      _response.hasHeader("Content-Encoding") ||
+      !isCompressibleType(_response.getHeader("Content-Type")))
+    return;
+  _response.setHeader("Vary", "Accept-Encoding");
+  if (_cgiCoding == CONTENT_CODING_IDENTITY) return;
+  _cgiCompressor = new ContentCompressor();
+  if (!_cgiCompressor->start(_cgiCoding, COMPRESSION_LEVEL_STREAM)) {
+    delete _cgiCompressor;
+    _cgiCompressor = 0;
+    return;
+  }
+  _response.setHeader("Content-Encoding", contentCodingName(_cgiCoding));
+}
+
+// Cabeceras del script -> status line + cabeceras HTTP. El body se enmarca
+// con el Content-Length del script si lo da (y no se comprime); si no,
+// chunked (HTTP/1.1) o cierre de conexion (HTTP/1.0).
+void Client::sendCgiHeaders() {
+  _response.clear();
   _response.setStatusCode(_cgiProcess->getStatusCode());
   if (_savedVersion == HTTP_VERSION_1_0)
     _response.setVersion("HTTP/1.0");
   else
     _response.setVersion("HTTP/1.1");
+  parseCgiHeaders(_cgiProcess->getResponseHeaders(), _response);
+  startCgiCompression();
+
+  std::string length = _response.getHeader("Content-Length");
+  char* end = 0;
+  long declared = length.empty() ? -1 : std::strtol(length.c_str(), &end, 10);
+  if (declared >= 0 && *end == '\0') _cgiBodyRemaining = declared;
+  if (_cgiBodyRemaining < 0 || _cgiCompressor) {
+    _response.removeHeader("Content-Length");
+    if (_savedVersion == HTTP_VERSION_1_1) {
+      _response.setHeader("Transfer-Encoding", "chunked");
+      _cgiChunked = true;
+    } else {
+      _savedShouldClose = true;
+    }
+  }
   _response.setHeader("Connection", _savedShouldClose ? "close" : "keep-alive");
 
-  parseCgiHeaders(_cgiProcess->getResponseHeaders(), _response);
-  _response.setBody(_cgiProcess->getResponseBody());
+  std::vector<char> head = _response.serializeHead();
+  _output.append(SharedBuffer::adopt(head));
+  _response.clear();
+  _cgiHeadersSent = true;
+  _accessEntry.status = _cgiProcess->getStatusCode();
+  _accessEntry.bodyBytes = 0;
+}
+
+void Client::streamCgiOutput(bool eof) {
+  if (!_cgiHeadersSent) sendCgiHeaders();
+
+  std::string data;
+  _cgiProcess->takeResponseBody(data);
+  // Lo que pase del Content-Length anunciado romperia la siguiente respuesta.
+  if (_cgiBodyRemaining >= 0) {
+    if (data.size() > static_cast<size_t>(_cgiBodyRemaining))
+      data.resize(static_cast<size_t>(_cgiBodyRemaining));
+    _cgiBodyRemaining -= static_cast<long>(data.size());
+  }
+  // Cada trozo sale con Z_SYNC_FLUSH: el navegador puede ir mostrando la
+  // pagina sin esperar al final del script.
+  if (_cgiCompressor && (!data.empty() || eof)) {
+    std::vector<char> compressed;
+    if (!_cgiCompressor->write(data.data(), data.size(), eof, compressed))
+      _savedShouldClose = true;  // stream roto: que el cliente no lo reuse
+    data.assign(compressed.begin(), compressed.end());
+  }
+
+  if (!data.empty()) {
+    std::vector<char> chunk;
+    if (_cgiChunked) {
+      std::ostringstream size;
+      size << std::hex << data.size() << "\r\n";
+      std::string sizeLine = size.str();
+      chunk.reserve(sizeLine.size() + data.size() + 2);
+      chunk.insert(chunk.end(), sizeLine.begin(), sizeLine.end());
+      chunk.insert(chunk.end(), data.begin(), data.end());
+      chunk.push_back('\r');
+      chunk.push_back('\n');
+    } else {
+      chunk.assign(data.begin(), data.end());
+    }
+    _accessEntry.bodyBytes += chunk.size();
+    _output.append(SharedBuffer::adopt(chunk));
+  }
+
+  if (eof) {
+    if (_cgiChunked) {
+      _output.append(SharedBuffer(std::string("0\r\n\r\n")));
+      _accessEntry.bodyBytes += 5;
+    } else if (_cgiBodyRemaining != 0) {
+      // Sin longitud (HTTP/1.0) o el script escribio menos de lo anunciado:
+      // solo el cierre marca el final del body.
+      _savedShouldClose = true;
+    }
+    if (_savedShouldClose) _closeAfterWrite = true;
+    logAccess(_accessEntry.status, _accessEntry.bodyBytes);
+  }
+  _state = STATE_WRITING_RESPONSE;
+  _lastActivity = time_utils::monotonicMs();
+}
+
+void Client::finishCgi() {
+  if (_cgiProcess->isHeadersComplete())
+    streamCgiOutput(true);
+  else
+    sendCgiError(HTTP_STATUS_BAD_GATEWAY);  // el script no dio cabeceras
+  // FastCGI: la conexion vuelve al pool si la peticion termino limpia.
+  if (_cgiProcess->isFastCgi() && _cgiProcess->getPipeOut() != -1) {
+    _serverManager->unregisterCgiPipe(_cgiProcess->getPipeOut());
+    _cgiProcess->releaseConnection();
+  }
+  abortCgi();
 
-  std::vector<char> serialized = _response.serialize();
-  enqueueResponse(serialized, _savedShouldClose);
-  
   // Resume processing requests (in case pipelined data is waiting)
+  feedParser();
   processRequests();
 }
 
+void Client::sendCgiError(int status) {
+  HttpRequest request;
+  request.setVersion(_savedVersion == HTTP_VERSION_1_0 ? "HTTP/1.0"
+                                                       : "HTTP/1.1");
+  buildErrorResponse(_response, request, status, _savedShouldClose,
+                     _savedServer);
+  std::vector<char> serialized = _response.serialize();
+  enqueueResponse(serialized, _savedShouldClose);
+  logAccess(status, _response.getBodySize());
+  _response.clear();
+}
+
+void Client::resumeCgiOutput() {
+  uint32_t events = EPOLLIN | EPOLLRDHUP;
+  if (_cgiProcess->isFastCgi() && !_cgiProcess->isRequestBodySent())
+    events |= EPOLLOUT;
+  _serverManager->resumeCgiPipe(_cgiProcess->getPipeOut(), events);
+  _cgiPaused = false;
+}
+
+// Datos nuevos del script ya metidos en _cgiProcess (pipe o FastCGI).
+void Client::onCgiOutput(int pipe_fd) {
+  if (_cgiProcess->getState() == CgiProcess::FAILED) {
+    finishCgi();  // cabeceras demasiado grandes o registros corruptos: 502
+    return;
+  }
+  if (!_cgiProcess->isHeadersComplete()) return;
+  // Una vez respondiendo, cgi_timeout cuenta desde la ultima salida.
+  _cgiStart = _lastActivity;
+  streamCgiOutput(false);
+  if (_output.size() >= CGI_OUTPUT_HIGH_WATER) {
+    _serverManager->pauseCgiPipe(pipe_fd);
+    _cgiPaused = true;
+  }
+}
+
+// FastCGI: el mismo socket lleva la peticion (EPOLLOUT hasta escribir todos
+// los registros) y la respuesta (EPOLLIN hasta FCGI_END_REQUEST).
+void Client::handleFastCgiSocket(int sock, size_t events) {
+  if ((events & EPOLLOUT) && !_cgiProcess->isRequestBodySent()) {
+    const std::string& records = _cgiProcess->getRequestBody();
+    size_t offset = _cgiProcess->getBodyBytesWritten();
+    ssize_t written = send(sock, records.data() + offset,
+                           records.size() - offset, MSG_NOSIGNAL);
+    if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      finishCgi();  // connect() rechazado o conexion caida: 502
+      return;
+    }
+    if (written > 0) {
+      _cgiProcess->advanceBodyBytesWritten(static_cast<size_t>(written));
+      _lastActivity = time_utils::monotonicMs();
+    }
+    if (_cgiProcess->isRequestBodySent())
+      _serverManager->modifyCgiPipe(sock, EPOLLIN | EPOLLRDHUP);
+  }
+
+  if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) return;
+  char buffer[16384];
+  ssize_t bytes = recv(sock, buffer, sizeof(buffer), 0);
+  if (bytes > 0) {
+    _lastActivity = time_utils::monotonicMs();
+    _cgiProcess->appendRecordData(buffer, static_cast<size_t>(bytes));
+    if (_cgiProcess->isRequestEnded() &&
+        _cgiProcess->getState() != CgiProcess::FAILED) {
+      finishCgi();
+      return;
+    }
+    onCgiOutput(sock);
+    return;
+  }
+  if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+  finishCgi();  // el servidor cerro sin FCGI_END_REQUEST
+}
+
 void Client::handleCgiPipe(int pipe_fd, size_t events) {
+  if (_module) {
+    onModuleEvent(pipe_fd, events);  // fd de un handler asincrono
+    return;
+  }
   if (_cgiProcess == 0) return;
+  if (_cgiProcess->isFastCgi()) {
+    handleFastCgiSocket(pipe_fd, events);
+    return;
+  }
 
   if (pipe_fd == _cgiProcess->getPipeIn() && (events & EPOLLOUT)) {
     const std::string& body = _cgiProcess->getRequestBody();
@@ -115,7 +348,7 @@ void Client::handleCgiPipe(int pipe_fd, size_t events) {
           write(pipe_fd, body.c_str() + offset, body.size() - offset);
       if (written > 0) {
         _cgiProcess->advanceBodyBytesWritten(static_cast<size_t>(written));
-        _lastActivity = std::time(0);
+        _lastActivity = time_utils::monotonicMs();
       }
       // Note: if written < 0 with EAGAIN/EWOULDBLOCK, we'll retry on next
       // EPOLLOUT This is correct for non-blocking I/O - offset not advanced,
@@ -130,36 +363,38 @@ void Client::handleCgiPipe(int pipe_fd, size_t events) {
 
   if (pipe_fd == _cgiProcess->getPipeOut() &&
       (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
-    char buffer[4096];
+    char buffer[16384];
     ssize_t bytes = read(pipe_fd, buffer, sizeof(buffer));
     if (bytes > 0) {
+      _lastActivity = time_utils::monotonicMs();
       _cgiProcess->appendResponseData(buffer, static_cast<size_t>(bytes));
-      _lastActivity = std::time(0);
-      return;
-    }
-    if (bytes == 0) {
-      // EOF - Pipe closed by CGI process
-      _serverManager->unregisterCgiPipe(pipe_fd);
-      _cgiProcess->closePipeOut();
-      finalizeCgiResponse();
-      delete _cgiProcess;
-      _cgiProcess = 0;
-      return;
-    }
-    if (bytes < 0) {
-      // Check for non-blocking I/O errors
-      if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        // No data available right now, try again later
-        return;
-      }
-      // Real error occurred
-      _serverManager->unregisterCgiPipe(pipe_fd);
-      _cgiProcess->closePipeOut();
-      // TODO: Maybe set error 500 in response?
-      finalizeCgiResponse();
-      delete _cgiProcess;
-      _cgiProcess = 0;
+      onCgiOutput(pipe_fd);
       return;
     }
+    // Check for non-blocking I/O errors: no data available right now
+    if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    // EOF (pipe closed by CGI process) or real error
+    finishCgi();
+  }
+}
+
+void Client::abortCgi() {
+  if (_cgiProcess == 0) return;
+  // Sin esto el pipe seguiria en epoll apuntando a un Client borrado.
+  if (_serverManager) {
+    if (_cgiProcess->getPipeIn() != -1)
+      _serverManager->unregisterCgiPipe(_cgiProcess->getPipeIn());
+    if (_cgiProcess->getPipeOut() != -1)
+      _serverManager->unregisterCgiPipe(_cgiProcess->getPipeOut());
   }
+  _cgiProcess->closePipeIn();
+  _cgiProcess->closePipeOut();  // FastCGI: devuelve su hueco de keep-alive
+  delete _cgiProcess;  // SIGKILL al hijo; reapChildren() lo recoge
+  _cgiProcess = 0;
+  _cgiHeadersSent = false;
+  _cgiChunked = false;
+  _cgiPaused = false;
+  _cgiBodyRemaining = -1;
+  delete _cgiCompressor;
+  _cgiCompressor = 0;
 }
@@ -0,0 +1,250 @@
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#include "Client.hpp"
+#include "ErrorUtils.hpp"
+#include "RequestProcessorUtils.hpp"
+#include "common/Log.hpp"
+#include "common/TimeUtils.hpp"
+#include "http/HttpHeaderUtils.hpp"
+#include "module/HandlerModule.hpp"
+#include "module/ModuleExchange.hpp"
+#include "network/ServerManager.hpp"
+
+// Cabeceras del modulo -> HttpResponse. El framing del body y Connection
+// los pone el servidor.
+static void copyModuleHeaders(const ModuleExchange::HeaderList& headers,
+                              HttpResponse& response) {
+  for (size_t i = 0; i < headers.size(); ++i) {
+    std::string key = http_header_utils::toLowerCopy(headers[i].first);
+    if (key == "transfer-encoding" || key == "connection") continue;
+    response.setHeader(headers[i].first, headers[i].second);
+  }
+}
+
+// Content-Length fijado por el modulo; -1 si no hay o no es un numero.
+static long declaredLength(const HttpResponse& response) {
+  std::string length = response.getHeader("Content-Length");
+  if (length.empty()) return -1;
+  char* end = 0;
+  long declared = std::strtol(length.c_str(), &end, 10);
+  return (declared >= 0 && *end == '\0') ? declared : -1;
+}
+
+static bool isBodylessStatus(int status) {
+  return status == 204 || status == 304;
+}
+
+// Los fds del modulo entran en epoll como los pipes de un CGI: sus eventos
+// llegan a Client::handleCgiPipe().
+class ClientModuleLoop : public ModuleEventLoop {
+ public:
+  ClientModuleLoop(ServerManager& serverManager, Client& client)
+      : _serverManager(serverManager), _client(client) {}
+
+  // Fichero regular, fd ya registrado...: el modulo recibe -1.
+  bool addFd(int fd, uint32_t events) {
+    try {
+      _serverManager.registerCgiPipe(fd, events, &_client);
+    } catch (const std::exception& e) {
+      LOG_WARN << "handler: cannot watch fd " << fd << ": " << e.what();
+      return false;
+    }
+    return true;
+  }
+  void modifyFd(int fd, uint32_t events) {
+    _serverManager.modifyCgiPipe(fd, events);
+  }
+  void removeFd(int fd) { _serverManager.unregisterCgiPipe(fd); }
+
+ private:
+  ServerManager& _serverManager;
+  Client& _client;
+};
+
+bool Client::startModuleIfNeeded(const HttpRequest& request) {
+  if (_configs == 0 || _serverManager == 0) return false;
+
+  const ServerConfig* server = selectServer(request);
+  if (server == 0) return false;
+  const LocationConfig* location = matchLocation(*server, request);
+  if (location == 0 || location->getHandler().empty()) return false;
+
+  HandlerModule* module =
+      _serverManager->getHandlerModule(location->getHandler());
+  if (module == 0) {
+    buildErrorResponse(_response, request, 500, true, server);
+    return true;
+  }
+
+  _savedShouldClose = request.shouldCloseConnection();
+  _savedVersion = request.getVersion();
+  _savedServer = server;
+  _moduleHeadOnly = request.getMethod() == HTTP_METHOD_HEAD;
+  _cgiHeadersSent = false;
+  _cgiChunked = false;
+  _cgiBodyRemaining = -1;
+  _cgiStart = time_utils::monotonicMs();
+
+  if (_moduleLoop == 0)
+    _moduleLoop = new ClientModuleLoop(*_serverManager, *this);
+  _module = new ModuleExchange(*module, request, *_moduleLoop);
+  _module->setUnsent(_output.size());
+  int result = _module->start();
+
+  if (result == WEBSERV_ERROR) {
+    endModule();
+    buildErrorResponse(_response, request, 500, true, server);
+    return true;
+  }
+
+  if (result == WEBSERV_OK) {
+    // Terminada en la misma llamada: sale como una respuesta normal, con
+    // Content-Length (serialize() pone el del body).
+    std::string body;
+    _module->takeOutput(body);
+    int status = _module->getStatus();
+    _response.clear();
+    _response.setStatusCode(status);
+    _response.setVersion(_savedVersion == HTTP_VERSION_1_0 ? "HTTP/1.0"
+                                                           : "HTTP/1.1");
+    copyModuleHeaders(_module->getHeaders(), _response);
+    long declared = declaredLength(_response);
+    if (isBodylessStatus(status))
+      body.clear();
+    else if (declared >= 0 && body.size() > static_cast<size_t>(declared))
+      body.resize(static_cast<size_t>(declared));
+    _response.setHeader("Connection",
+                        _savedShouldClose ? "close" : "keep-alive");
+    _response.setBody(body);
+    _response.setHeadOnly(_moduleHeadOnly);
+    endModule();
+    return true;
+  }
+
+  // Asincrona: el parser pasa a la siguiente peticion y el modulo sigue
+  // desde sus callbacks (handleCgiPipe -> onModuleEvent).
+  _module->detach();
+  _state = STATE_READING_BODY;
+  pumpModule();
+  return true;
+}
+
+// Status + cabeceras del modulo. El body se enmarca con el Content-Length
+// del modulo si lo da; si no, con la longitud si ya termino; si no,
+// chunked (HTTP/1.1) o cierre de conexion (HTTP/1.0).
+void Client::sendModuleHeaders(bool complete, size_t length) {
+  int status = _module->getStatus();
+  _response.clear();
+  _response.setStatusCode(status);
+  _response.setVersion(_savedVersion == HTTP_VERSION_1_0 ? "HTTP/1.0"
+                                                         : "HTTP/1.1");
+  copyModuleHeaders(_module->getHeaders(), _response);
+
+  if (isBodylessStatus(status)) {
+    _moduleHeadOnly = true;
+  } else {
+    _cgiBodyRemaining = declaredLength(_response);
+    if (_cgiBodyRemaining < 0) _response.removeHeader("Content-Length");
+    if (_cgiBodyRemaining < 0 && complete) {
+      std::ostringstream size;
+      size << length;
+      _response.setHeader("Content-Length", size.str());
+      _cgiBodyRemaining = static_cast<long>(length);
+    } else if (_cgiBodyRemaining < 0 && _savedVersion == HTTP_VERSION_1_1) {
+      _response.setHeader("Transfer-Encoding", "chunked");
+      _cgiChunked = !_moduleHeadOnly;
+    } else if (_cgiBodyRemaining < 0) {
+      _savedShouldClose = true;
+    }
+  }
+  _response.setHeader("Connection", _savedShouldClose ? "close" : "keep-alive");
+
+  std::vector<char> head = _response.serializeHead();
+  _output.append(SharedBuffer::adopt(head));
+  _response.clear();
+  _module->markHeadersSent();
+  _cgiHeadersSent = true;
+  _state = STATE_WRITING_RESPONSE;
+  _accessEntry.status = status;
+  _accessEntry.bodyBytes = 0;
+}
+
+// Despues de cada llamada al modulo: encolar lo que haya escrito. Las
+// cabeceras esperan al primer byte del body (o al final), para que el modulo
+// pueda cambiar status y cabeceras hasta ahi.
+void Client::pumpModule() {
+  std::string data;
+  _module->takeOutput(data);
+  bool finished = _module->isFinished();
+  if (!_cgiHeadersSent) {
+    if (data.empty() && !finished) return;
+    sendModuleHeaders(finished, data.size());
+  }
+
+  if (_moduleHeadOnly) data.clear();
+  // Lo que pase del Content-Length anunciado romperia la siguiente respuesta.
+  if (_cgiBodyRemaining >= 0) {
+    if (data.size() > static_cast<size_t>(_cgiBodyRemaining))
+      data.resize(static_cast<size_t>(_cgiBodyRemaining));
+    _cgiBodyRemaining -= static_cast<long>(data.size());
+  }
+
+  if (!data.empty()) {
+    std::vector<char> chunk;
+    if (_cgiChunked) {
+      std::ostringstream size;
+      size << std::hex << data.size() << "\r\n";
+      std::string sizeLine = size.str();
+      chunk.reserve(sizeLine.size() + data.size() + 2);
+      chunk.insert(chunk.end(), sizeLine.begin(), sizeLine.end());
+      chunk.insert(chunk.end(), data.begin(), data.end());
+      chunk.push_back('\r');
+      chunk.push_back('\n');
+    } else {
+      chunk.assign(data.begin(), data.end());
+    }
+    _accessEntry.bodyBytes += chunk.size();
+    _output.append(SharedBuffer::adopt(chunk));
+    // Como en CGI: una vez respondiendo, el timeout cuenta desde la ultima
+    // salida.
+    _lastActivity = time_utils::monotonicMs();
+    _cgiStart = _lastActivity;
+    _state = STATE_WRITING_RESPONSE;
+  }
+
+  if (!finished) return;
+  if (_cgiChunked) {
+    _output.append(SharedBuffer(std::string("0\r\n\r\n")));
+    _accessEntry.bodyBytes += 5;
+  } else if (!_moduleHeadOnly && _cgiBodyRemaining != 0) {
+    // Sin longitud (HTTP/1.0) o el modulo escribio menos de lo anunciado:
+    // solo el cierre marca el final del body.
+    _savedShouldClose = true;
+  }
+  if (_savedShouldClose) _closeAfterWrite = true;
+  _state = STATE_WRITING_RESPONSE;
+  logAccess(_accessEntry.status, _accessEntry.bodyBytes);
+  endModule();
+
+  // Peticiones pipelined que esperaban al modulo.
+  feedParser();
+  processRequests();
+}
+
+void Client::onModuleEvent(int fd, size_t events) {
+  _module->setUnsent(_output.size());
+  _module->dispatch(fd, static_cast<uint32_t>(events));
+  pumpModule();
+}
+
+void Client::endModule() {
+  if (_module == 0) return;
+  delete _module;  // quita sus fds de epoll y abort() si no llego a finish()
+  _module = 0;
+  _moduleHeadOnly = false;
+  _cgiHeadersSent = false;
+  _cgiChunked = false;
+  _cgiBodyRemaining = -1;
+}
@@ -0,0 +1,98 @@
+#include "CompressionCache.hpp"
+
+#include <unistd.h>
+
+#include <vector>
+
+CompressionCache::CompressionCache(size_t maxBytes, size_t maxObjectBytes)
+    : _maxBytes(maxBytes),
+      _maxObject(maxObjectBytes),
+      _usedBytes(0),
+      _entries(),
+      _lru() {}
+
+CompressionCache::~CompressionCache() {}
+
+bool CompressionCache::enabled() const { return _maxBytes > 0; }
+
+size_t CompressionCache::maxObject() const { return _maxObject; }
+
+bool CompressionCache::get(const std::string& path, const OpenFileInfo& info,
+                           ContentCoding coding, SharedBuffer& out) {
+  if (info.fd.get() < 0 || info.size < 0 ||
+      static_cast<size_t>(info.size) > _maxObject)
+    return false;
+  if (lookup(path, info, coding, out)) return true;
+  if (!compressFile(info, coding, out)) return false;
+  store(makeKey(path, coding), info, out);
+  return true;
+}
+
+bool CompressionCache::lookup(const std::string& path,
+                              const OpenFileInfo& info, ContentCoding coding,
+                              SharedBuffer& out) {
+  EntryMap::iterator it = _entries.find(makeKey(path, coding));
+  if (it == _entries.end()) return false;
+  const Entry& entry = it->second;
+  if (entry.inode != info.inode || entry.mtime != info.mtime ||
+      entry.mtimeNsec != info.mtimeNsec || entry.size != info.size) {
+    erase(it);
+    return false;
+  }
+  _lru.splice(_lru.begin(), _lru, entry.lruPos);
+  out = entry.data;
+  return true;
+}
+
+std::string CompressionCache::makeKey(const std::string& path,
+                                      ContentCoding coding) {
+  std::string key = path;
+  key += ' ';
+  key += contentCodingName(coding);
+  return key;
+}
+
+bool CompressionCache::compressFile(const OpenFileInfo& info,
+                                    ContentCoding coding, SharedBuffer& out) {
+  size_t length = static_cast<size_t>(info.size);
+  std::vector<char> raw(length);
+  size_t done = 0;
+  while (done < length) {
+    ssize_t n = pread(info.fd.get(), &raw[done], length - done,
+                      static_cast<off_t>(done));
+    if (n <= 0) return false;  // error o fichero truncado mientras tanto
+    done += static_cast<size_t>(n);
+  }
+  std::vector<char> compressed;
+  if (!compressContent(length > 0 ? &raw[0] : "", length, coding,
+                       COMPRESSION_LEVEL_DEFAULT, compressed))
+    return false;
+  out = SharedBuffer::adopt(compressed);
+  return true;
+}
+
+void CompressionCache::store(const std::string& key, const OpenFileInfo& info,
+                             const SharedBuffer& data) {
+  if (!enabled()) return;
+  Entry entry;
+  entry.data = data;
+  entry.inode = info.inode;
+  entry.mtime = info.mtime;
+  entry.mtimeNsec = info.mtimeNsec;
+  entry.size = info.size;
+  entry.bytes = key.size() + data.size();
+  if (entry.bytes > _maxBytes) return;
+  while (_usedBytes + entry.bytes > _maxBytes && !_lru.empty())
+    erase(_entries.find(_lru.back()));
+
+  _lru.push_front(key);
+  entry.lruPos = _lru.begin();
+  _entries[key] = entry;
+  _usedBytes += entry.bytes;
+}
+
+void CompressionCache::erase(EntryMap::iterator it) {
+  _usedBytes -= it->second.bytes;
+  _lru.erase(it->second.lruPos);
+  _entries.erase(it);
+}
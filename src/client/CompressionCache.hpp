@@ -0,0 +1,76 @@
+#ifndef COMPRESSIONCACHE_HPP
+#define COMPRESSIONCACHE_HPP
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+
+#include "OpenFileCache.hpp"
+#include "common/SharedBuffer.hpp"
+#include "http/ContentEncoding.hpp"
+
+// -----------------------------------------------------------------------------
+// COMPRESSION CACHE - ficheros estaticos ya comprimidos (gzip on), en RAM
+// -----------------------------------------------------------------------------
+// Clave: ruta resuelta + codificacion (gzip/deflate). Cada entrada recuerda
+// inodo/mtime/tamaño del fichero que se comprimio; si no coinciden con los
+// de la peticion actual (el fichero cambio) se vuelve a comprimir. Asi cada
+// version de un fichero se comprime una sola vez por worker.
+//
+// Limites: bytes comprimidos totales (LRU) y tamaño maximo del fichero
+// original; lo que pase de maxObject no se comprime al vuelo en absoluto.
+// -----------------------------------------------------------------------------
+
+class CompressionCache {
+ public:
+  // maxBytes == 0 -> no se guarda nada: get() comprime en cada llamada.
+  CompressionCache(size_t maxBytes, size_t maxObjectBytes);
+  ~CompressionCache();
+
+  bool enabled() const;
+  size_t maxObject() const;
+
+  // Version comprimida del fichero abierto en info.fd (info.size bytes).
+  // false si no se pudo leer o comprimir: se sirve sin comprimir.
+  bool get(const std::string& path, const OpenFileInfo& info,
+           ContentCoding coding, SharedBuffer& out);
+  // Solo la cache: no lee ni comprime nada, y basta con los datos de
+  // stat() (info.fd puede no estar abierto). false si no esta o es de otra
+  // version del fichero.
+  bool lookup(const std::string& path, const OpenFileInfo& info,
+              ContentCoding coding, SharedBuffer& out);
+
+ private:
+  struct Entry {
+    SharedBuffer data;
+    ino_t inode;
+    time_t mtime;
+    long mtimeNsec;
+    off_t size;
+    size_t bytes;
+    std::list<std::string>::iterator lruPos;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  CompressionCache(const CompressionCache&);
+  CompressionCache& operator=(const CompressionCache&);
+
+  static std::string makeKey(const std::string& path, ContentCoding coding);
+  static bool compressFile(const OpenFileInfo& info, ContentCoding coding,
+                           SharedBuffer& out);
+  void store(const std::string& key, const OpenFileInfo& info,
+             const SharedBuffer& data);
+  void erase(EntryMap::iterator it);
+
+  size_t _maxBytes;
+  size_t _maxObject;
+  size_t _usedBytes;
+
+  EntryMap _entries;
+  std::list<std::string> _lru;  // front = usada mas recientemente
+};
+
+#endif  // COMPRESSIONCACHE_HPP
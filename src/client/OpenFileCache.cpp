@@ -0,0 +1,234 @@
+#include "OpenFileCache.hpp"
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/Log.hpp"
+#include "http/HttpResponse.hpp"
+
+// Todo lo que puede hacer que una entrada (o su "no existe") quede obsoleta.
+static const uint32_t WATCH_MASK = IN_MODIFY | IN_ATTRIB | IN_CREATE |
+                                   IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_DELETE_SELF | IN_MOVE_SELF;
+
+OpenFileInfo::OpenFileInfo()
+    : exists(false),
+      isDir(false),
+      isReg(false),
+      fd(),
+      size(0),
+      mtime(0),
+      mtimeNsec(0),
+      inode(0),
+      contentType() {}
+
+static void fillInfo(const std::string& path, const struct stat& st,
+                     OpenFileInfo& info) {
+  info.exists = true;
+  info.isDir = S_ISDIR(st.st_mode);
+  info.isReg = S_ISREG(st.st_mode);
+  info.size = st.st_size;
+  info.mtime = st.st_mtim.tv_sec;
+  info.mtimeNsec = st.st_mtim.tv_nsec;
+  info.inode = st.st_ino;
+  if (info.isReg) info.contentType = HttpResponse::contentTypeFor(path);
+}
+
+OpenFileCache::OpenFileCache(size_t maxEntries, time_t inactiveSeconds)
+    : _maxEntries(maxEntries),
+      _inactive(inactiveSeconds),
+      _inotifyFd(-1),
+      _entries(),
+      _lru(),
+      _watchDirs(),
+      _dirWatches() {
+  if (_maxEntries == 0) return;
+  _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_inotifyFd < 0) {
+    LOG_WARN << "inotify_init1 failed, open_file_cache disabled";
+    _maxEntries = 0;
+  }
+}
+
+OpenFileCache::~OpenFileCache() {
+  if (_inotifyFd >= 0) close(_inotifyFd);
+}
+
+bool OpenFileCache::enabled() const { return _maxEntries > 0; }
+
+int OpenFileCache::getInotifyFd() const { return _inotifyFd; }
+
+bool OpenFileCache::load(const std::string& path, OpenFileInfo& info) {
+  info = OpenFileInfo();
+  struct stat st;
+  int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    // Existe pero no se puede leer (403) o no existe (404): stat() lo dice.
+    if (stat(path.c_str(), &st) != 0) return false;
+  } else if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  fillInfo(path, st, info);
+  if (fd >= 0) {
+    if (info.isReg)
+      info.fd = SharedFd(fd);
+    else
+      close(fd);
+  }
+  return true;
+}
+
+bool OpenFileCache::loadStat(const std::string& path, OpenFileInfo& info) {
+  info = OpenFileInfo();
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return false;
+  fillInfo(path, st, info);
+  return true;
+}
+
+bool OpenFileCache::lookup(const std::string& path, OpenFileInfo& info) {
+  if (!enabled()) return load(path, info);
+
+  std::string key = normalize(path);
+  time_t now = std::time(NULL);
+  EntryMap::iterator it = _entries.find(key);
+  if (it != _entries.end()) {
+    if (now - it->second.lastUsed <= _inactive) {
+      _lru.splice(_lru.begin(), _lru, it->second.lruPos);
+      it->second.lastUsed = now;
+      info = it->second.info;
+      return info.exists;
+    }
+    erase(it);
+  }
+
+  load(key, info);
+  // Sin watch no nos enterariamos de los cambios: no se cachea.
+  if (!watchDir(parentDir(key))) return info.exists;
+
+  _lru.push_front(key);
+  Entry& entry = _entries[key];
+  entry.info = info;
+  entry.lastUsed = now;
+  entry.lruPos = _lru.begin();
+  while (_entries.size() > _maxEntries) erase(_entries.find(_lru.back()));
+  return info.exists;
+}
+
+void OpenFileCache::invalidate(const std::string& path) {
+  EntryMap::iterator it = _entries.find(normalize(path));
+  if (it != _entries.end()) erase(it);
+}
+
+void OpenFileCache::handleEvents() {
+  if (_inotifyFd < 0) return;
+
+  // long[] para que el buffer quede alineado para struct inotify_event.
+  long buffer[4096 / sizeof(long)];
+  ssize_t len = read(_inotifyFd, buffer, sizeof(buffer));
+  if (len <= 0) return;
+
+  const char* bytes = reinterpret_cast<const char*>(buffer);
+  const char* end = bytes + len;
+  while (bytes < end) {
+    const struct inotify_event* ev =
+        reinterpret_cast<const struct inotify_event*>(bytes);
+    bytes += sizeof(struct inotify_event) + ev->len;
+
+    if (ev->mask & IN_Q_OVERFLOW) {
+      clearAll();  // se han perdido eventos: no nos fiamos de nada
+      continue;
+    }
+    std::map<int, std::vector<std::string> >::iterator w =
+        _watchDirs.find(ev->wd);
+    if (w == _watchDirs.end()) continue;
+    std::vector<std::string> dirs = w->second;
+
+    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+      // El propio directorio ha desaparecido o se ha movido.
+      for (size_t i = 0; i < dirs.size(); ++i) {
+        invalidateDir(dirs[i]);
+        _dirWatches.erase(dirs[i]);
+      }
+      _watchDirs.erase(w);
+      if (!(ev->mask & IN_IGNORED)) inotify_rm_watch(_inotifyFd, ev->wd);
+      continue;
+    }
+    if (ev->len == 0) continue;
+    // Crear/borrar/renombrar dentro del directorio cambia su propio mtime.
+    if (ev->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) {
+      for (size_t i = 0; i < dirs.size(); ++i) invalidate(dirs[i]);
+    }
+    for (size_t i = 0; i < dirs.size(); ++i) {
+      std::string child = dirs[i] == "/" ? "/" : dirs[i] + "/";
+      invalidate(child + ev->name);
+    }
+  }
+}
+
+void OpenFileCache::expireInactive(time_t now) {
+  // El LRU esta ordenado por lastUsed: basta con mirar el final.
+  while (!_lru.empty()) {
+    EntryMap::iterator it = _entries.find(_lru.back());
+    if (now - it->second.lastUsed <= _inactive) break;
+    erase(it);
+  }
+}
+
+// "./www//css/" -> "./www/css": una sola clave por fichero.
+std::string OpenFileCache::normalize(const std::string& path) {
+  std::string out;
+  out.reserve(path.size());
+  for (size_t i = 0; i < path.size(); ++i) {
+    if (path[i] == '/' && !out.empty() && out[out.size() - 1] == '/')
+      continue;
+    out += path[i];
+  }
+  while (out.size() > 1 && out[out.size() - 1] == '/')
+    out.erase(out.size() - 1);
+  return out;
+}
+
+std::string OpenFileCache::parentDir(const std::string& path) {
+  std::string::size_type slash = path.rfind('/');
+  if (slash == std::string::npos) return ".";
+  if (slash == 0) return "/";
+  return path.substr(0, slash);
+}
+
+bool OpenFileCache::watchDir(const std::string& dir) {
+  if (_dirWatches.count(dir)) return true;
+  int wd = inotify_add_watch(_inotifyFd, dir.c_str(), WATCH_MASK);
+  if (wd < 0) return false;
+  _dirWatches[dir] = wd;
+  _watchDirs[wd].push_back(dir);
+  return true;
+}
+
+void OpenFileCache::erase(EntryMap::iterator it) {
+  _lru.erase(it->second.lruPos);
+  _entries.erase(it);
+}
+
+// Borra la entrada del directorio y todas las que cuelgan de el.
+void OpenFileCache::invalidateDir(const std::string& dir) {
+  invalidate(dir);
+  std::string prefix = dir == "/" ? "/" : dir + "/";
+  EntryMap::iterator it = _entries.lower_bound(prefix);
+  while (it != _entries.end() &&
+         it->first.compare(0, prefix.size(), prefix) == 0) {
+    EntryMap::iterator next = it;
+    ++next;
+    erase(it);
+    it = next;
+  }
+}
+
+void OpenFileCache::clearAll() {
+  _entries.clear();
+  _lru.clear();
+}
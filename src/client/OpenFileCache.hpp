@@ -0,0 +1,100 @@
+#ifndef OPENFILECACHE_HPP
+#define OPENFILECACHE_HPP
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/SharedFd.hpp"
+
+// Resultado de mirar una ruta en disco (open + fstat).
+struct OpenFileInfo {
+  bool exists;
+  bool isDir;
+  bool isReg;
+  SharedFd fd;  // solo para ficheros regulares legibles
+  off_t size;
+  time_t mtime;
+  long mtimeNsec;
+  ino_t inode;
+  std::string contentType;  // precalculado con HttpResponse::contentTypeFor
+
+  OpenFileInfo();
+};
+
+// -----------------------------------------------------------------------------
+// OPEN FILE CACHE - estilo open_file_cache de nginx
+// -----------------------------------------------------------------------------
+// Guarda, por ruta resuelta, el fd abierto, tamaño, mtime, inodo y
+// Content-Type de los ficheros estaticos (y tambien los "no existe" y los
+// directorios, para que la busqueda de index no haga un stat() por
+// candidato). Un acierto no cuesta ninguna syscall.
+//
+// Invalidacion: cada directorio con entradas cacheadas tiene un watch de
+// inotify. ServerManager mete getInotifyFd() en epoll y llama a
+// handleEvents(); cualquier cambio (escritura, rename, borrado, chmod...)
+// borra la entrada afectada. Si no se puede poner el watch, no se cachea.
+//
+// Tamaño: LRU de maxEntries entradas; las que no se usan en
+// inactiveSeconds se descartan en expireInactive().
+// -----------------------------------------------------------------------------
+
+class OpenFileCache {
+ public:
+  // maxEntries == 0 -> cache desactivada (lookup() siempre va a disco).
+  OpenFileCache(size_t maxEntries, time_t inactiveSeconds);
+  ~OpenFileCache();
+
+  bool enabled() const;
+  int getInotifyFd() const;  // -1 si la cache esta desactivada
+
+  // Rellena info para path. Devuelve info.exists.
+  bool lookup(const std::string& path, OpenFileInfo& info);
+  // Para cambios hechos por el propio servidor (DELETE, upload): no esperar
+  // al evento de inotify.
+  void invalidate(const std::string& path);
+
+  void handleEvents();  // leer inotify (EPOLLIN en getInotifyFd())
+  void expireInactive(time_t now);
+
+  // Sin cache: open + fstat directamente.
+  static bool load(const std::string& path, OpenFileInfo& info);
+  // Solo stat(), sin abrir: lo mismo que load() salvo info.fd (vacio). Para
+  // lo que se responde sin body (HEAD, 304).
+  static bool loadStat(const std::string& path, OpenFileInfo& info);
+
+ private:
+  struct Entry {
+    OpenFileInfo info;
+    time_t lastUsed;
+    std::list<std::string>::iterator lruPos;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  OpenFileCache(const OpenFileCache&);
+  OpenFileCache& operator=(const OpenFileCache&);
+
+  static std::string normalize(const std::string& path);
+  static std::string parentDir(const std::string& path);
+  bool watchDir(const std::string& dir);
+  void erase(EntryMap::iterator it);
+  void invalidateDir(const std::string& dir);
+  void clearAll();
+
+  size_t _maxEntries;
+  time_t _inactive;
+  int _inotifyFd;
+
+  EntryMap _entries;
+  std::list<std::string> _lru;  // front = usada mas recientemente
+
+  // inotify devuelve el mismo wd si dos rutas llegan al mismo directorio.
+  std::map<int, std::vector<std::string> > _watchDirs;
+  std::map<std::string, int> _dirWatches;
+};
+
+#endif  // OPENFILECACHE_HPP
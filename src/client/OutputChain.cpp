@@ -0,0 +1,106 @@
+#include "OutputChain.hpp"
+
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <vector>
+
+OutputChain::OutputChain() : _segments(), _pending(0) {}
+
+OutputChain::~OutputChain() {}
+
+void OutputChain::append(const SharedBuffer& buffer) {
+  if (buffer.empty()) return;
+  Segment seg;
+  seg.buffer = buffer;
+  seg.offset = 0;
+  seg.fileOffset = 0;
+  seg.fileRemaining = 0;
+  _segments.push_back(seg);
+  _pending += buffer.size();
+}
+
+void OutputChain::appendFile(const SharedFd& file, off_t offset,
+                             size_t length) {
+  if (!file.valid() || length == 0) return;
+  if (length <= INLINE_FILE_MAX) {
+    std::vector<char> bytes(length);
+    ssize_t got = pread(file.get(), &bytes[0], length, offset);
+    if (got == static_cast<ssize_t>(length)) {
+      append(SharedBuffer::adopt(bytes));
+      return;
+    }
+    // Lectura corta: lo dejamos en manos de sendfile(), que cerrara la
+    // conexion si el fichero realmente se ha truncado.
+  }
+  Segment seg;
+  seg.offset = 0;
+  seg.file = file;
+  seg.fileOffset = offset;
+  seg.fileRemaining = length;
+  _segments.push_back(seg);
+  _pending += length;
+}
+
+bool OutputChain::empty() const { return _segments.empty(); }
+
+size_t OutputChain::size() const { return _pending; }
+
+void OutputChain::clear() {
+  _segments.clear();
+  _pending = 0;
+}
+
+ssize_t OutputChain::flush(int fd) {
+  if (_segments.empty()) return 0;
+  if (_segments.front().file.valid()) return flushFile(fd);
+  return flushMemory(fd);
+}
+
+// writev() de los bloques en memoria del principio de la cadena (hasta el
+// primer fichero o MAX_IOV bloques). Despues avanza offsets y descarta los
+// segmentos completos.
+ssize_t OutputChain::flushMemory(int fd) {
+  struct iovec iov[MAX_IOV];
+  int count = 0;
+  for (std::deque<Segment>::iterator it = _segments.begin();
+       it != _segments.end() && count < MAX_IOV && !it->file.valid(); ++it) {
+    iov[count].iov_base = const_cast<char*>(it->buffer.data() + it->offset);
+    iov[count].iov_len = it->buffer.size() - it->offset;
+    ++count;
+  }
+
+  ssize_t sent = writev(fd, iov, count);
+  if (sent < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+  size_t left = static_cast<size_t>(sent);
+  _pending -= left;
+  while (left > 0) {
+    Segment& seg = _segments.front();
+    size_t avail = seg.buffer.size() - seg.offset;
+    if (left < avail) {
+      seg.offset += left;
+      break;
+    }
+    left -= avail;
+    _segments.pop_front();
+  }
+  return sent;
+}
+
+ssize_t OutputChain::flushFile(int fd) {
+  Segment& seg = _segments.front();
+  ssize_t sent =
+      sendfile(fd, seg.file.get(), &seg.fileOffset, seg.fileRemaining);
+  if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+  // 0 con bytes pendientes = el fichero se ha truncado: ya no podemos
+  // cumplir el Content-Length anunciado.
+  if (sent <= 0) return -1;
+
+  seg.fileRemaining -= static_cast<size_t>(sent);
+  _pending -= static_cast<size_t>(sent);
+  if (seg.fileRemaining == 0) _segments.pop_front();
+  return sent;
+}
@@ -0,0 +1,69 @@
+#ifndef OUTPUTCHAIN_HPP
+#define OUTPUTCHAIN_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <deque>
+
+#include "common/SharedBuffer.hpp"
+#include "common/SharedFd.hpp"
+
+// -----------------------------------------------------------------------------
+// OUTPUT CHAIN - Cola de salida de un Client
+// -----------------------------------------------------------------------------
+// Lista de segmentos pendientes de enviar, en orden: bloques en memoria
+// (cabeceras, bodies, respuestas pipelined) y rangos de fichero (sendfile).
+// Cada segmento guarda su offset de lectura: un envío parcial solo avanza el
+// offset, nunca se hace erase()/memmove de los bytes restantes.
+//
+// flush() hace UNA syscall por llamada:
+//   - writev() con todos los bloques en memoria consecutivos del principio
+//     (16 respuestas pipelined pequeñas salen en una sola llamada), o
+//   - sendfile() si el primer segmento es un fichero.
+// -----------------------------------------------------------------------------
+
+class OutputChain {
+ public:
+  OutputChain();
+  ~OutputChain();
+
+  void append(const SharedBuffer& buffer);
+  // Ficheros pequeños (<= INLINE_FILE_MAX) se leen con pread() y se
+  // encolan como memoria: asi tambien entran en el writev() por lotes.
+  void appendFile(const SharedFd& file, off_t offset, size_t length);
+
+  bool empty() const;
+  size_t size() const;  // bytes pendientes (memoria + ficheros)
+  void clear();
+
+  // Envia lo que acepte el socket. Devuelve los bytes enviados (0 si el
+  // socket esta lleno: EAGAIN), o -1 si hay que cerrar la conexion (error de
+  // envio o fichero truncado).
+  ssize_t flush(int fd);
+
+ private:
+  // Max. bloques por writev(); IOV_MAX es 1024 pero con esto basta para
+  // vaciar cualquier rafaga de pipelining razonable en una llamada.
+  static const int MAX_IOV = 64;
+  static const size_t INLINE_FILE_MAX = 16 * 1024;
+
+  struct Segment {
+    SharedBuffer buffer;  // valido si no es fichero
+    size_t offset;        // bytes de buffer ya enviados
+    SharedFd file;        // valido si es un rango de fichero
+    off_t fileOffset;     // siguiente byte del fichero a enviar
+    size_t fileRemaining;
+  };
+
+  OutputChain(const OutputChain&);
+  OutputChain& operator=(const OutputChain&);
+
+  ssize_t flushMemory(int fd);
+  ssize_t flushFile(int fd);
+
+  std::deque<Segment> _segments;
+  size_t _pending;
+};
+
+#endif  // OUTPUTCHAIN_HPP
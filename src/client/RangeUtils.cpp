@@ -0,0 +1,75 @@
+#include "RangeUtils.hpp"
+
+#include <limits>
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Numero decimal desde p; satura en el maximo de off_t (un offset enorme es
+// simplemente un rango que no cae dentro del fichero).
+static const char* parseOffset(const char* p, const char* end, off_t& out) {
+  const off_t max = std::numeric_limits<off_t>::max();
+  out = 0;
+  for (; p < end && isDigit(*p); ++p) {
+    off_t digit = *p - '0';
+    out = (out > (max - digit) / 10) ? max : out * 10 + digit;
+  }
+  return p;
+}
+
+RangeResult parseRangeHeader(const HttpHeaderView& value, off_t size,
+                             std::vector<ByteRange>& ranges) {
+  ranges.clear();
+  const char* p = value.data;
+  const char* end = p + value.length;
+  static const char UNIT[] = "bytes=";
+  const std::size_t unitLength = sizeof(UNIT) - 1;
+  if (value.length < unitLength) return RANGE_IGNORE;
+  for (std::size_t i = 0; i < unitLength; ++i) {
+    char c = p[i];
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+    if (c != UNIT[i]) return RANGE_IGNORE;
+  }
+  p += unitLength;
+
+  std::size_t specs = 0;
+  off_t total = 0;
+  while (p < end) {
+    if (*p == ' ' || *p == '\t' || *p == ',') {
+      ++p;
+      continue;
+    }
+    if (++specs > MAX_BYTE_RANGES) return RANGE_IGNORE;
+
+    ByteRange range;
+    if (*p == '-') {
+      // -N: los ultimos N bytes
+      off_t suffix;
+      const char* next = parseOffset(p + 1, end, suffix);
+      if (next == p + 1) return RANGE_IGNORE;
+      p = next;
+      if (suffix == 0 || size == 0) continue;  // no satisfacible
+      range.first = suffix < size ? size - suffix : 0;
+      range.last = size - 1;
+    } else {
+      // N- o N-M
+      const char* next = parseOffset(p, end, range.first);
+      if (next == p || next == end || *next != '-') return RANGE_IGNORE;
+      p = next + 1;
+      range.last = size - 1;
+      if (p < end && isDigit(*p)) {
+        off_t last;
+        p = parseOffset(p, end, last);
+        if (last < range.first) return RANGE_IGNORE;
+        if (last < range.last) range.last = last;
+      }
+      if (range.first >= size) continue;  // no satisfacible
+    }
+    if (p < end && *p != ',' && *p != ' ' && *p != '\t') return RANGE_IGNORE;
+
+    total += range.last - range.first + 1;
+    if (total > size) return RANGE_IGNORE;
+    ranges.push_back(range);
+  }
+  if (specs == 0) return RANGE_IGNORE;
+  return ranges.empty() ? RANGE_UNSATISFIABLE : RANGE_SATISFIABLE;
+}
@@ -0,0 +1,33 @@
+#ifndef RANGE_UTILS_HPP
+#define RANGE_UTILS_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "../http/HttpHeaderTable.hpp"
+
+// Un rango ya recortado al tamaño del fichero: [first, last], ambos
+// incluidos (como en Content-Range).
+struct ByteRange {
+  off_t first;
+  off_t last;
+};
+
+enum RangeResult {
+  RANGE_IGNORE,        // sin Range util: se envia el fichero entero (200)
+  RANGE_SATISFIABLE,   // 206 con los rangos de ranges
+  RANGE_UNSATISFIABLE  // 416: ningun rango cae dentro del fichero
+};
+
+// Mas rangos que esto en una peticion se ignoran (200 con todo el fichero).
+static const std::size_t MAX_BYTE_RANGES = 32;
+
+// Range: bytes=0-99,200-,-500 sobre un fichero de size bytes (RFC 9110
+// 14.1.2). Un header mal formado, de otra unidad, con demasiados rangos o
+// que pide en total mas bytes que el fichero (rangos solapados) se ignora.
+RangeResult parseRangeHeader(const HttpHeaderView& value, off_t size,
+                             std::vector<ByteRange>& ranges);
+
+#endif  // RANGE_UTILS_HPP
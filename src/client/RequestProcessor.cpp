@@ -4,27 +4,43 @@
 #include "RequestProcessorUtils.hpp"
 #include "ResponseUtils.hpp"
 #include "StaticPathHandler.hpp"
+#include "common/Log.hpp"
+
+RequestProcessor::RequestProcessor()
+    : _fileCache(0), _compressionCache(0), _resolvedPath() {}
+
+void RequestProcessor::setOpenFileCache(OpenFileCache* cache) {
+  _fileCache = cache;
+}
+
+void RequestProcessor::setCompressionCache(CompressionCache* cache) {
+  _compressionCache = cache;
+}
+
+const std::string& RequestProcessor::getResolvedPath() const {
+  return _resolvedPath;
+}
 
 // Función principal del procesador de peticiones.
 // Flujo general:
 // 1) Inicializar status, body, shouldClose
-// 2) Matching virtual host (ServerConfig por puerto)
+// 2) Virtual host (ServerConfig por puerto y Host): lo elige el Client
 // 3) Matching location (LocationConfig por URI)
 // 4) Validaciones (método, tamaño body, redirect)
 // 5) Resolver path real (root/alias + uri)
-// 6) Si es CGI → retorna false para que Client ejecute CgiExecutor
+// 6) Si es CGI o handler → retorna false para que Client ejecute
+//    CgiExecutor o el modulo
 // 7) Si no, servir estático o errores, retorna true
 bool RequestProcessor::process(const HttpRequest& request,
-                               const std::vector<ServerConfig>* configs,
-                               int listenPort, int parseErrorCode,
+                               const ServerConfig* server, int parseErrorCode,
                                HttpResponse& response) {
   int statusCode = HTTP_STATUS_OK;
   std::string resolvedPath = "";
   bool isCgi = false;
   std::vector<char> body;
   bool shouldClose = request.shouldCloseConnection();
-  const ServerConfig* server = 0;
   const LocationConfig* location = 0;
+  _resolvedPath.clear();
 
   // 1) Errores primero: si el parser falló, respondemos con el código adecuado
   if (parseErrorCode != 0 || request.getMethod() == HTTP_METHOD_UNKNOWN) {
@@ -35,9 +51,8 @@ bool RequestProcessor::process(const HttpRequest& request,
     return true;
   }
 
-  // 2) Seleccionar servidor por puerto y buscar location que coincida con el path
-  server = selectServerByPort(listenPort, configs);
-  if (server) location = matchLocation(*server, request.getPath());
+  // 2) Buscar la location que coincida con el path
+  if (server) location = matchLocation(*server, request);
 
   if (location) {
     // Hay location: validar y resolver la ruta real en disco
@@ -55,20 +70,21 @@ bool RequestProcessor::process(const HttpRequest& request,
     }
 
     resolvedPath = resolvePath(*server, location, request.getPath());
-    std::cout << " DEBUG: Intentando abrir: [" << resolvedPath << "]"
-              << std::endl;
-    isCgi =
-        isCgiRequest(resolvedPath) || isCgiRequestByConfig(location, resolvedPath);
+    _resolvedPath = resolvedPath;
+    LOG_DEBUG << "Intentando abrir: [" << resolvedPath << "]";
+    isCgi = !location->getHandler().empty() || isCgiRequest(resolvedPath) ||
+            isCgiRequestByConfig(location, resolvedPath);
 
     if (isCgi) {
-      // CGI: delegar a Client::startCgiIfNeeded → CgiExecutor.
+      // CGI: delegar a Client::startCgiIfNeeded → CgiExecutor (o a
+      // Client::startModuleIfNeeded si la location tiene handler).
       // No rellenar response; el Client ejecutará el script y construirá la respuesta.
       return false;
     }
 
     // Servir archivo estático (o error 403/404)
     if (handleStaticPath(request, server, location, resolvedPath, body,
-                         response))
+                         response, _fileCache, _compressionCache))
       return true;
   } else {
     // No hay location que coincida -> 404
@@ -6,6 +6,8 @@
 #include "../config/ServerConfig.hpp"
 #include "../http/HttpRequest.hpp"
 #include "../http/HttpResponse.hpp"
+#include "CompressionCache.hpp"
+#include "OpenFileCache.hpp"
 
 // El cerebro del servidor: es quien decide que hacer con la peticion dado un
 // HttpRequest y la configuración, construye un HttpResponse (estático, CGI,
@@ -13,13 +15,26 @@
 // HttpResponse sin enviarlo al cliente.
 class RequestProcessor {
  public:
+  RequestProcessor();
+
+  // Cache de ficheros abiertos del worker (0 = sin cache).
+  void setOpenFileCache(OpenFileCache* cache);
+  // Ficheros comprimidos del worker para 'gzip on' (0 = no se comprimen).
+  void setCompressionCache(CompressionCache* cache);
+
+  // Ruta en disco resuelta por el ultimo process() ("" si no hubo location).
+  const std::string& getResolvedPath() const;
+
   // Retorna true si la petición fue manejada (respuesta lista).
   // Retorna false si es CGI y debe delegarse a Client::startCgiIfNeeded.
-  bool process(const HttpRequest& request,
-               const std::vector<ServerConfig>* configs, int listenPort,
+  // server: virtual host ya elegido por el Client (0 = sin config).
+  bool process(const HttpRequest& request, const ServerConfig* server,
                int parseErrorCode, HttpResponse& response);
 
  private:
+  OpenFileCache* _fileCache;
+  CompressionCache* _compressionCache;
+  std::string _resolvedPath;
 };
 
 #endif  // REQUEST_PROCESSOR_HPP
@@ -12,30 +12,10 @@ const ServerConfig* selectServerByPort(
 }
 
 const LocationConfig* matchLocation(const ServerConfig& server,
-                                    const std::string& uri) {
-  const std::vector<LocationConfig>& locations = server.getLocations();
-  if (locations.empty()) return 0;
-
-  size_t bestLen = 0;
-  const LocationConfig* bestLoc = 0;
-
-  for (size_t i = 0; i < locations.size(); ++i) {
-    const std::string& path = locations[i].getPath();
-    if (path.empty()) continue;
-    if (uri.compare(0, path.size(), path) == 0) {
-      if (path == "/" || uri.size() == path.size() || uri[path.size()] == '/') {
-        if (path.size() > bestLen) {
-          bestLen = path.size();
-          bestLoc = &locations[i];
-        }
-      }
-    }
-  }
-
-  if (bestLoc) return bestLoc;
-
-  // por defecto, usar la primera location.
-  return &locations[0];
+                                    const HttpRequest& request) {
+  if (request.getRouteServer() != &server)
+    request.setRoute(&server, server.matchLocation(request.getPath()));
+  return request.getRouteLocation();
 }
 
 std::string resolvePath(const ServerConfig& server,
@@ -78,6 +58,8 @@ std::string getFileExtension(const std::string& path) {
 bool isCgiRequestByConfig(const LocationConfig* location,
                           const std::string& path) {
   if (location == 0) return false;
+  // fastcgi_pass: todo lo que cae en la location va al servidor FastCGI.
+  if (!location->getFastCgiPass().empty()) return true;
   std::string ext = getFileExtension(path);
   if (ext.empty()) return false;
   return !location->getCgiPath(ext).empty();
@@ -102,7 +84,7 @@ int validateLocation(const HttpRequest& request, const ServerConfig* server,
     return 405;
 
   // 3) Body size (usar limite del server por ahora)
-  if (server && request.getBody().size() > server->getMaxBodySize()) return 413;
+  if (server && request.getBodySize() > server->getMaxBodySize()) return 413;
 
   return 0;
 }
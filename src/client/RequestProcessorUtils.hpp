@@ -11,8 +11,10 @@
 const ServerConfig* selectServerByPort(
     int port, const std::vector<ServerConfig>* configs);
 
+// Location de la petición dentro de server. Se busca una sola vez (trie
+// de ServerConfig) y queda guardada en el request para las demás fases.
 const LocationConfig* matchLocation(const ServerConfig& server,
-                                    const std::string& uri);
+                                    const HttpRequest& request);
 
 std::string resolvePath(const ServerConfig& server,
                         const LocationConfig* location, const std::string& uri);
@@ -0,0 +1,157 @@
+#include "ResponseCache.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "http/ContentEncoding.hpp"
+
+ResponseCache::ResponseCache(size_t maxBytes, size_t maxObjectBytes,
+                             OpenFileCache* files)
+    : _maxBytes(maxBytes),
+      _maxObject(maxObjectBytes),
+      _usedBytes(0),
+      _files(files),
+      _entries(),
+      _lru() {}
+
+ResponseCache::~ResponseCache() {}
+
+bool ResponseCache::enabled() const { return _maxBytes > 0; }
+
+std::string ResponseCache::makeKey(const ServerConfig* server,
+                                   const HttpRequest& request) {
+  const char* method;
+  if (request.getMethod() == HTTP_METHOD_GET)
+    method = "GET";
+  else if (request.getMethod() == HTTP_METHOD_HEAD)
+    method = "HEAD";
+  else
+    return "";
+  // Las condicionales se deciden con stat() en StaticPathHandler (304 sin
+  // abrir el fichero) y los Range piden un 206: no tiene sentido guardarlas
+  // ni servir un 200 de aqui.
+  if (request.hasHeader(HTTP_HEADER_IF_NONE_MATCH) ||
+      request.hasHeader(HTTP_HEADER_IF_MODIFIED_SINCE) ||
+      request.hasHeader(HTTP_HEADER_RANGE))
+    return "";
+
+  // La codificacion negociada entra en la clave: con gzip_static el mismo
+  // path se sirve como fichero.gz a unos clientes y sin comprimir a otros.
+  std::ostringstream key;
+  key << static_cast<const void*>(server) << ' ' << method << ' '
+      << contentCodingName(negotiateContentCoding(
+             request.getHeader(HTTP_HEADER_ACCEPT_ENCODING)))
+      << ' ' << request.getPath();
+  return key.str();
+}
+
+bool ResponseCache::lookup(const std::string& key, SharedBuffer& headers,
+                           SharedBuffer& body) {
+  EntryMap::iterator it = _entries.find(key);
+  if (it == _entries.end()) return false;
+  if (!isFresh(it->second)) {
+    erase(it);
+    return false;
+  }
+  _lru.splice(_lru.begin(), _lru, it->second.lruPos);
+  headers = it->second.headers;
+  body = it->second.body;
+  return true;
+}
+
+void ResponseCache::store(const std::string& key, const HttpResponse& response,
+                          const std::string& resolvedPath) {
+  if (!enabled() || key.empty()) return;
+  if (response.getStatusCode() != HTTP_STATUS_OK || !response.hasFileBody() ||
+      response.getBodyFileOffset() != 0 ||
+      response.getBodyFileLength() > _maxObject)
+    return;
+
+  // Cabeceras sin la parte que depende de cada peticion.
+  HttpResponse shared(response);
+  shared.removeHeader("Connection");
+  shared.removeHeader("Set-Cookie");
+  std::vector<char> serialized = shared.serialize();
+  static const char CRLF[] = "\r\n";
+  std::vector<char>::iterator statusEnd =
+      std::search(serialized.begin(), serialized.end(), CRLF, CRLF + 2);
+  if (statusEnd == serialized.end()) return;
+  std::vector<char> headerBytes(statusEnd + 2, serialized.end());
+
+  std::vector<char> bodyBytes;
+  if (!response.isHeadOnly()) {
+    size_t length = response.getBodyFileLength();
+    bodyBytes.resize(length);
+    if (length > 0 && pread(response.getBodyFile().get(), &bodyBytes[0],
+                            length, 0) != static_cast<ssize_t>(length))
+      return;
+  }
+
+  Entry entry;
+  if (!addValidator(entry, response.getBodyFilePath())) return;
+  if (resolvedPath != response.getBodyFilePath() &&
+      !addValidator(entry, resolvedPath))
+    return;
+  entry.bytes = key.size() + headerBytes.size() + bodyBytes.size();
+  if (entry.bytes > _maxBytes) return;
+  entry.headers = SharedBuffer::adopt(headerBytes);
+  entry.body = SharedBuffer::adopt(bodyBytes);
+
+  EntryMap::iterator old = _entries.find(key);
+  if (old != _entries.end()) erase(old);
+  while (_usedBytes + entry.bytes > _maxBytes && !_lru.empty())
+    erase(_entries.find(_lru.back()));
+
+  _lru.push_front(key);
+  entry.lruPos = _lru.begin();
+  _entries[key] = entry;
+  _usedBytes += entry.bytes;
+}
+
+bool ResponseCache::statPath(const std::string& path, OpenFileInfo& info) {
+  if (_files) return _files->lookup(path, info);
+
+  struct stat st;
+  info = OpenFileInfo();
+  if (stat(path.c_str(), &st) != 0) return false;
+  info.exists = true;
+  info.size = st.st_size;
+  info.mtime = st.st_mtim.tv_sec;
+  info.mtimeNsec = st.st_mtim.tv_nsec;
+  info.inode = st.st_ino;
+  return true;
+}
+
+bool ResponseCache::addValidator(Entry& entry, const std::string& path) {
+  OpenFileInfo info;
+  if (path.empty() || !statPath(path, info)) return false;
+  Validator v;
+  v.path = path;
+  v.inode = info.inode;
+  v.mtime = info.mtime;
+  v.mtimeNsec = info.mtimeNsec;
+  v.size = info.size;
+  entry.validators.push_back(v);
+  return true;
+}
+
+bool ResponseCache::isFresh(const Entry& entry) {
+  for (size_t i = 0; i < entry.validators.size(); ++i) {
+    const Validator& v = entry.validators[i];
+    OpenFileInfo info;
+    if (!statPath(v.path, info) || info.inode != v.inode ||
+        info.mtime != v.mtime || info.mtimeNsec != v.mtimeNsec ||
+        info.size != v.size)
+      return false;
+  }
+  return true;
+}
+
+void ResponseCache::erase(EntryMap::iterator it) {
+  _usedBytes -= it->second.bytes;
+  _lru.erase(it->second.lruPos);
+  _entries.erase(it);
+}
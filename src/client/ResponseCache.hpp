@@ -0,0 +1,94 @@
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OpenFileCache.hpp"
+#include "common/SharedBuffer.hpp"
+#include "http/HttpRequest.hpp"
+#include "http/HttpResponse.hpp"
+
+// -----------------------------------------------------------------------------
+// RESPONSE CACHE - respuestas estaticas pequeñas ya serializadas, en RAM
+// -----------------------------------------------------------------------------
+// Clave: virtual host (server { } elegido por puerto y Host) + metodo
+// (GET/HEAD) + codificacion aceptada (Accept-Encoding) + path de la
+// peticion. Un acierto se sirve sin pasar por RequestProcessor::process() ni
+// serialize(): el Client encola los buffers compartidos (refcount, sin
+// copia) tal cual.
+//
+// Lo unico que depende de cada peticion (version en la status line,
+// Connection y Set-Cookie de sesion) NO se guarda: el Client lo antepone
+// en cada acierto. Se guardan:
+//   headers = resto de cabeceras + Content-Length + linea vacia
+//   body    = contenido del fichero (vacio para la forma HEAD)
+//
+// Validacion: cada entrada recuerda inodo/mtime/tamaño de la ruta resuelta
+// y del fichero servido (distintos para un index de directorio). Si algo
+// cambia en disco, la entrada se descarta. Con open_file_cache activa la
+// comprobacion no cuesta syscalls.
+//
+// Limites: bytes totales (LRU) y tamaño maximo por objeto.
+// -----------------------------------------------------------------------------
+
+class ResponseCache {
+ public:
+  // maxBytes == 0 -> cache desactivada. files puede ser 0 (se usa stat()).
+  ResponseCache(size_t maxBytes, size_t maxObjectBytes, OpenFileCache* files);
+  ~ResponseCache();
+
+  bool enabled() const;
+
+  // "" si la peticion no se puede cachear (metodo distinto de GET/HEAD,
+  // condicional: If-None-Match / If-Modified-Since, o con Range).
+  static std::string makeKey(const ServerConfig* server,
+                             const HttpRequest& request);
+
+  // true si hay entrada valida; headers/body comparten los bytes cacheados.
+  bool lookup(const std::string& key, SharedBuffer& headers,
+              SharedBuffer& body);
+  // Guarda response si es cacheable (200, body de fichero pequeño).
+  void store(const std::string& key, const HttpResponse& response,
+             const std::string& resolvedPath);
+
+ private:
+  struct Validator {
+    std::string path;
+    ino_t inode;
+    time_t mtime;
+    long mtimeNsec;
+    off_t size;
+  };
+  struct Entry {
+    SharedBuffer headers;
+    SharedBuffer body;
+    std::vector<Validator> validators;
+    size_t bytes;
+    std::list<std::string>::iterator lruPos;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  ResponseCache(const ResponseCache&);
+  ResponseCache& operator=(const ResponseCache&);
+
+  bool statPath(const std::string& path, OpenFileInfo& info);
+  bool addValidator(Entry& entry, const std::string& path);
+  bool isFresh(const Entry& entry);
+  void erase(EntryMap::iterator it);
+
+  size_t _maxBytes;
+  size_t _maxObject;
+  size_t _usedBytes;
+  OpenFileCache* _files;
+
+  EntryMap _entries;
+  std::list<std::string> _lru;  // front = usada mas recientemente
+};
+
+#endif  // RESPONSECACHE_HPP
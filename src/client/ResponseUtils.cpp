@@ -15,6 +15,9 @@ std::string getErrorDescription(int statusCode) {
   if (statusCode == HTTP_STATUS_FORBIDDEN) return "Forbidden\n";
   if (statusCode == HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE)
     return "Request Entity Too Large\n";
+  if (statusCode == HTTP_STATUS_URI_TOO_LONG) return "URI Too Long\n";
+  if (statusCode == HTTP_STATUS_REQUEST_HEADER_FIELDS_TOO_LARGE)
+    return "Request Header Fields Too Large\n";
   return "Bad Request\n";  // Por defecto para 400 u otros errores de parseo
 }
 
@@ -31,7 +34,10 @@ void fillBaseResponse(HttpResponse& response, const HttpRequest& request, int st
     // que ha enviado sus propios headers), no lo sobreescribimos.
     if (!response.hasHeader("content-type"))
         response.setContentType(request.getPath());
-    response.setBody(body);
+    // Un body de fichero (StaticPathHandler) ya fijado tiene prioridad: el
+    // vector body llega vacio en ese caso.
+    if (!response.hasFileBody())
+        response.setBody(body);
     if (request.getMethod() == HTTP_METHOD_HEAD) {
         response.setHeadOnly(true);
     }
@@ -40,12 +40,8 @@ std::string extractIdFromCookie(const std::string& cookieHeader)
     return result;
 }
 
-void addSessionCookieIfNeeded(HttpResponse& response, const HttpRequest& request, int statusCode)
+std::string sessionCookieFor(const HttpRequest& request)
 {
-    // only add cookie for 200-299 responses
-    if (statusCode < 200 || statusCode > 299)
-        return;
-
     // list of ids we created that are valid
     static std::set<std::string> validSessions;
 
@@ -58,7 +54,7 @@ void addSessionCookieIfNeeded(HttpResponse& response, const HttpRequest& request
     }
 
     // see what cookie the client sends
-    std::string headerCookie = request.getHeader("cookie");
+    std::string headerCookie = request.getHeader(HTTP_HEADER_COOKIE).str();
     std::string receivedId = extractIdFromCookie(headerCookie);
 
     // check if the id they send exists in our list
@@ -73,7 +69,18 @@ void addSessionCookieIfNeeded(HttpResponse& response, const HttpRequest& request
     {
         std::string newId = createSessionId();
         validSessions.insert(newId);
-        std::string cookieValue = "id=" + newId + "; Path=/";
-        response.setHeader("Set-Cookie", cookieValue);
+        return "id=" + newId + "; Path=/";
     }
+    return "";
+}
+
+void addSessionCookieIfNeeded(HttpResponse& response, const HttpRequest& request, int statusCode)
+{
+    // only add cookie for 200-299 responses
+    if (statusCode < 200 || statusCode > 299)
+        return;
+
+    std::string cookieValue = sessionCookieFor(request);
+    if (cookieValue != "")
+        response.setHeader("Set-Cookie", cookieValue);
 }
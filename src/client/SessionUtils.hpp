@@ -4,6 +4,10 @@
 #include "../http/HttpRequest.hpp"
 #include "../http/HttpResponse.hpp"
 
+// valor de Set-Cookie con una sesion nueva, o "" si la cookie "id" del
+// cliente ya es valida (la usa tambien la cache de respuestas)
+std::string sessionCookieFor(const HttpRequest& request);
+
 // si el cliente no tiene cookie "id" valida, le mandamos una nueva con Set-Cookie
 // solo se usa en respuestas 200-299
 void addSessionCookieIfNeeded(HttpResponse& response, const HttpRequest& request, int statusCode);
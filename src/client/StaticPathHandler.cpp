@@ -4,36 +4,357 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cstring>
 #include <ctime>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <utility>
 
 #include "AutoindexRenderer.hpp"
+#include "CompressionCache.hpp"
 #include "ErrorUtils.hpp"
+#include "RangeUtils.hpp"
 #include "RequestProcessorUtils.hpp"
 #include "ResponseUtils.hpp"
 #include "common/StringUtils.hpp"
+#include "common/TimeUtils.hpp"
+#include "http/ContentEncoding.hpp"
 #include "http/HttpResponse.hpp"
 
-static bool readFileToBody(const std::string& path, std::vector<char>& out) {
-  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
-  if (!file.is_open()) return false;
+// Solo un GET incondicional va a enviar el contenido. HEAD, If-None-Match /
+// If-Modified-Since y DELETE se resuelven con stat() sin abrir el fichero.
+static bool needsOpenFile(const HttpRequest& request) {
+  return request.getMethod() == HTTP_METHOD_GET &&
+         !request.hasHeader(HTTP_HEADER_IF_NONE_MATCH) &&
+         !request.hasHeader(HTTP_HEADER_IF_MODIFIED_SINCE);
+}
+
+// Consulta la ruta en la open file cache (o en disco si no hay cache).
+static bool lookupPath(OpenFileCache* cache, const std::string& path,
+                       OpenFileInfo& info, bool openFile) {
+  if (cache) return cache->lookup(path, info);
+  if (openFile) return OpenFileCache::load(path, info);
+  return OpenFileCache::loadStat(path, info);
+}
 
-  out.clear();
-  char c;
-  while (file.get(c)) out.push_back(c);
+// Asigna el fichero ya abierto como body de la respuesta sin leerlo: el
+// Client lo enviara con sendfile() directamente desde el page cache.
+static bool setFileBody(const std::string& path, const OpenFileInfo& info,
+                        HttpResponse& response) {
+  if (!info.isReg || !info.fd.valid()) return false;
+  response.setFileBody(info.fd, 0, static_cast<size_t>(info.size), path);
+  response.setHeader("Content-Type", info.contentType);
   return true;
 }
 
-static bool getPathInfo(const std::string& path, bool& isDir, bool& isReg) {
-  struct stat st;
-  if (stat(path.c_str(), &st) != 0) return false;
-  isDir = S_ISDIR(st.st_mode);
-  isReg = S_ISREG(st.st_mode);
+// "inodo-tamaño-mtime" en hexadecimal, como Apache: cambia si el fichero se
+// reescribe o se sustituye por otro.
+static std::string makeETag(const OpenFileInfo& info) {
+  std::ostringstream tag;
+  tag << '"' << std::hex << static_cast<unsigned long>(info.inode) << '-'
+      << static_cast<unsigned long>(info.size) << '-'
+      << static_cast<unsigned long>(info.mtime) << '"';
+  return tag.str();
+}
+
+// If-None-Match: "*" o lista de entity-tags separadas por comas. Comparacion
+// debil (se ignora "W/"), la que pide la RFC 9110 para este header.
+static bool matchesETag(const HttpHeaderView& header, const std::string& etag) {
+  const char* p = header.data;
+  const char* end = p + header.length;
+  while (p < end) {
+    if (*p == ' ' || *p == '\t' || *p == ',') {
+      ++p;
+      continue;
+    }
+    if (*p == '*') return true;
+    if (end - p > 2 && p[0] == 'W' && p[1] == '/') p += 2;
+    if (*p != '"') return false;
+    const void* close = std::memchr(p + 1, '"', end - p - 1);
+    if (close == 0) return false;
+    const char* next = static_cast<const char*>(close) + 1;
+    if (static_cast<size_t>(next - p) == etag.size() &&
+        std::memcmp(p, etag.data(), etag.size()) == 0)
+      return true;
+    p = next;
+  }
+  return false;
+}
+
+// If-None-Match manda; If-Modified-Since solo cuenta si no viene aquel. Una
+// fecha que no se entiende se ignora (se envia el fichero entero).
+static bool isNotModified(const HttpRequest& request, const std::string& etag,
+                          time_t mtime) {
+  if (request.hasHeader(HTTP_HEADER_IF_NONE_MATCH))
+    return matchesETag(request.getHeader(HTTP_HEADER_IF_NONE_MATCH), etag);
+  HttpHeaderView since = request.getHeader(HTTP_HEADER_IF_MODIFIED_SINCE);
+  time_t date;
+  return !since.empty() &&
+         time_utils::parseHttpDate(since.data, since.length, date) &&
+         mtime <= date;
+}
+
+// ETag, Last-Modified y el Cache-Control de la location (expires y
+// cache_control).
+static void setCacheHeaders(HttpResponse& response,
+                            const LocationConfig* location,
+                            const OpenFileInfo& info,
+                            const std::string& etag) {
+  response.setHeader("ETag", etag);
+  response.setHeader("Last-Modified", time_utils::formatHttpDate(info.mtime));
+  if (!location) return;
+
+  std::string cacheControl;
+  if (location->getExpires() >= 0)
+    cacheControl = "max-age=" + string_utils::toString(location->getExpires());
+  if (!location->getCacheControl().empty()) {
+    if (!cacheControl.empty()) cacheControl += ", ";
+    cacheControl += location->getCacheControl();
+  }
+  if (!cacheControl.empty()) response.setHeader("Cache-Control", cacheControl);
+}
+
+// If-Range: el Range solo se aplica si el cliente tiene esta misma version:
+// el mismo ETag (comparacion fuerte) o exactamente su Last-Modified.
+static bool ifRangeMatches(const HttpRequest& request, const std::string& etag,
+                           time_t mtime) {
+  if (!request.hasHeader(HTTP_HEADER_IF_RANGE)) return true;
+  HttpHeaderView value = request.getHeader(HTTP_HEADER_IF_RANGE);
+  if (!value.empty() && value.data[0] == '"')
+    return value.length == etag.size() &&
+           std::memcmp(value.data, etag.data(), etag.size()) == 0;
+  time_t date;
+  return time_utils::parseHttpDate(value.data, value.length, date) &&
+         date == mtime;
+}
+
+// Separador de multipart/byteranges: un contador de 20 cifras, como nginx.
+static std::string makeBoundary() {
+  static unsigned long counter = static_cast<unsigned long>(std::time(NULL));
+  std::ostringstream boundary;
+  boundary << std::setw(20) << std::setfill('0') << ++counter;
+  return boundary.str();
+}
+
+static std::string contentRange(const ByteRange& range, off_t size) {
+  std::ostringstream value;
+  value << "bytes " << range.first << '-' << range.last << '/' << size;
+  return value.str();
+}
+
+/**
+ * @brief Range sobre un fichero ya abierto y asignado entero como body.
+ * Un rango: el body pasa a ser ese trozo del fichero (sendfile() desde su
+ * offset, sin leer nada antes). Varios: multipart/byteranges, con la
+ * cabecera de cada parte en memoria y los trozos tambien con sendfile().
+ * @return false si el Range se ignora (se queda el 200 con todo el fichero)
+ */
+static bool serveRanges(const HttpRequest& request, const ServerConfig* server,
+                        const std::string& path, const OpenFileInfo& info,
+                        HttpResponse& response) {
+  std::vector<ByteRange> ranges;
+  RangeResult result = parseRangeHeader(request.getHeader(HTTP_HEADER_RANGE),
+                                        info.size, ranges);
+  if (result == RANGE_IGNORE) return false;
+
+  if (result == RANGE_UNSATISFIABLE) {
+    response.setBody(std::string());  // fuera el fichero: body de error
+    buildErrorResponse(response, request, HTTP_STATUS_RANGE_NOT_SATISFIABLE,
+                       false, server);
+    response.setHeader("Content-Range",
+                       "bytes */" + string_utils::toString(info.size));
+    return true;
+  }
+
+  if (ranges.size() == 1) {
+    const ByteRange& range = ranges[0];
+    response.setFileBody(info.fd, range.first,
+                         static_cast<size_t>(range.last - range.first + 1),
+                         path);
+    response.setHeader("Content-Range", contentRange(range, info.size));
+  } else {
+    std::string boundary = makeBoundary();
+    std::vector<HttpResponse::FilePart> parts;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      HttpResponse::FilePart part;
+      part.header = "\r\n--" + boundary + "\r\nContent-Type: " +
+                    info.contentType + "\r\nContent-Range: " +
+                    contentRange(ranges[i], info.size) + "\r\n\r\n";
+      part.offset = ranges[i].first;
+      part.length = static_cast<size_t>(ranges[i].last - ranges[i].first + 1);
+      parts.push_back(part);
+    }
+    HttpResponse::FilePart close;
+    close.header = "\r\n--" + boundary + "--\r\n";
+    close.offset = 0;
+    close.length = 0;
+    parts.push_back(close);
+    response.setMultipartFileBody(info.fd, parts, path);
+    response.setHeader("Content-Type",
+                       "multipart/byteranges; boundary=" + boundary);
+  }
+  std::vector<char> empty;
+  fillBaseResponse(response, request, HTTP_STATUS_PARTIAL_CONTENT,
+                   request.shouldCloseConnection(), empty);
   return true;
 }
 
+// gzip_static: si existe path.gz y el cliente acepta gzip, se sirve ese
+// fichero (con su propio ETag; los Range van sobre los bytes comprimidos)
+// con el Content-Type del original.
+static bool selectGzipStatic(const HttpRequest& request,
+                             const std::string& path, OpenFileCache* cache,
+                             std::string& gzPath, OpenFileInfo& info,
+                             HttpResponse& response) {
+  if (!acceptsContentCoding(request.getHeader(HTTP_HEADER_ACCEPT_ENCODING),
+                            CONTENT_CODING_GZIP))
+    return false;
+  std::string candidate = path + ".gz";
+  OpenFileInfo gzInfo;
+  if (!lookupPath(cache, candidate, gzInfo, needsOpenFile(request)) ||
+      !gzInfo.isReg)
+    return false;
+  gzInfo.contentType = info.contentType;
+  info = gzInfo;
+  gzPath = candidate;
+  response.setHeader("Content-Encoding", "gzip");
+  return true;
+}
+
+/**
+ * @brief gzip on: el fichero comprimido al vuelo (una vez por version del
+ * fichero gracias a la CompressionCache) como body compartido con la cache.
+ * ETag debil: los bytes dependen del nivel de zlib, no solo del fichero. Sin
+ * Range (200 entero) ni Accept-Ranges.
+ * Un acierto de la cache no abre el fichero. Un HEAD nunca comprime: sin la
+ * version en cache sale sin Content-Length.
+ * @return false si no se pudo comprimir: se sirve el fichero tal cual
+ */
+static bool serveCompressed(const HttpRequest& request,
+                            const LocationConfig* location,
+                            const std::string& path, OpenFileInfo& info,
+                            ContentCoding coding,
+                            CompressionCache* compression,
+                            HttpResponse& response) {
+  std::string contentType = info.contentType;
+  SharedBuffer data;
+  if (!compression->lookup(path, info, coding, data) &&
+      request.getMethod() != HTTP_METHOD_HEAD) {
+    if (!info.fd.valid() && !OpenFileCache::load(path, info)) return false;
+    if (!compression->get(path, info, coding, data)) return false;
+  }
+
+  setCacheHeaders(response, location, info, "W/" + makeETag(info));
+  response.setHeader("Content-Type", contentType);
+  response.setHeader("Content-Encoding", contentCodingName(coding));
+  std::vector<char> empty;
+  fillBaseResponse(response, request, HTTP_STATUS_OK,
+                   request.shouldCloseConnection(), empty);
+  if (data.empty())
+    response.setLengthUnknown();
+  else
+    response.setSharedBody(data);
+  return true;
+}
+
+/**
+ * @brief Respuesta para un fichero regular (pedido directamente o como index
+ * de un directorio).
+ * 304 y HEAD salen solo de los datos de stat(); el fichero se abre (si la open
+ * file cache no lo tenia ya abierto) solo para el body de un GET.
+ * Con gzip_static / gzip en la location, los tipos comprimibles llevan
+ * siempre Vary: Accept-Encoding (tambien el 304 y la version sin comprimir).
+ * @return true si la respuesta queda completa (304, 206, 416, 403 o
+ * comprimida al vuelo)
+ */
+static bool serveFile(const HttpRequest& request, const ServerConfig* server,
+                      const LocationConfig* location, std::string path,
+                      OpenFileInfo info, HttpResponse& response,
+                      OpenFileCache* cache, CompressionCache* compression) {
+  HttpMethod method = request.getMethod();
+  ContentCoding coding = CONTENT_CODING_IDENTITY;
+  if ((method == HTTP_METHOD_GET || method == HTTP_METHOD_HEAD) && location &&
+      (location->getGzipStatic() || location->getGzip()) &&
+      isCompressibleType(info.contentType)) {
+    response.setHeader("Vary", "Accept-Encoding");
+    if (!location->getGzipStatic() ||
+        !selectGzipStatic(request, path, cache, path, info, response)) {
+      if (location->getGzip() && compression &&
+          info.size >= static_cast<off_t>(config::section::gzip_min_length) &&
+          static_cast<size_t>(info.size) <= compression->maxObject())
+        coding = negotiateContentCoding(
+            request.getHeader(HTTP_HEADER_ACCEPT_ENCODING));
+    }
+  }
+  std::string contentType = info.contentType;
+
+  // Comprimido al vuelo: mismo validador que el original pero debil.
+  std::string etag = makeETag(info);
+  if ((method == HTTP_METHOD_GET || method == HTTP_METHOD_HEAD) &&
+      isNotModified(request, etag, info.mtime)) {
+    if (coding != CONTENT_CODING_IDENTITY) etag = "W/" + etag;
+    setCacheHeaders(response, location, info, etag);
+    std::vector<char> empty;
+    fillBaseResponse(response, request, HTTP_STATUS_NOT_MODIFIED,
+                     request.shouldCloseConnection(), empty);
+    response.removeHeader("Content-Type");
+    response.removeHeader("Content-Encoding");
+    return true;
+  }
+
+  if (coding != CONTENT_CODING_IDENTITY &&
+      serveCompressed(request, location, path, info, coding, compression,
+                      response))
+    return true;
+
+  if (method == HTTP_METHOD_HEAD) {
+    setCacheHeaders(response, location, info, etag);
+    response.setHeader("Accept-Ranges", "bytes");
+    response.setHeader("Content-Type", contentType);
+    response.setHeader("Content-Length", string_utils::toString(info.size));
+    return false;
+  }
+
+  // Solo se hizo stat() (peticion condicional que no ha dado 304): ahora si
+  // hace falta el fichero abierto.
+  if (!info.fd.valid() && OpenFileCache::load(path, info)) {
+    info.contentType = contentType;
+    etag = makeETag(info);
+  }
+  if (!setFileBody(path, info, response)) {
+    // No se puede abrir el archivo (sin permisos) -> 403.
+    buildErrorResponse(response, request, HTTP_STATUS_FORBIDDEN, false,
+                       server);
+    return true;
+  }
+  setCacheHeaders(response, location, info, etag);
+  response.setHeader("Accept-Ranges", "bytes");
+  if (method == HTTP_METHOD_GET && request.hasHeader(HTTP_HEADER_RANGE) &&
+      ifRangeMatches(request, etag, info.mtime))
+    return serveRanges(request, server, path, info, response);
+  return false;
+}
+
+// gzip on: el listado de autoindex se comprime entero antes de enviarlo.
+static void compressGeneratedBody(const HttpRequest& request,
+                                  const LocationConfig* location,
+                                  std::vector<char>& body,
+                                  HttpResponse& response) {
+  if (!location->getGzip() || body.size() < config::section::gzip_min_length)
+    return;
+  response.setHeader("Vary", "Accept-Encoding");
+  ContentCoding coding =
+      negotiateContentCoding(request.getHeader(HTTP_HEADER_ACCEPT_ENCODING));
+  std::vector<char> compressed;
+  if (coding == CONTENT_CODING_IDENTITY ||
+      !compressContent(&body[0], body.size(), coding,
+                       COMPRESSION_LEVEL_DEFAULT, compressed))
+    return;
+  body.swap(compressed);
+  response.setHeader("Content-Encoding", contentCodingName(coding));
+}
+
 static bool isImageExtension(const std::string& name) {
   std::string::size_type dot = name.rfind('.');
   if (dot == std::string::npos) return false;
@@ -98,7 +419,8 @@ static bool handleDirectory(const HttpRequest& request,
                             const ServerConfig* server,
                             const LocationConfig* location,
                             const std::string& path, std::vector<char>& body,
-                            HttpResponse& response) {
+                            HttpResponse& response, OpenFileCache* cache,
+                            CompressionCache* compression) {
   std::vector<std::string> indexes;
 
   if (location) {
@@ -114,6 +436,7 @@ static bool handleDirectory(const HttpRequest& request,
   bool foundIndex = false;
   std::string indexPath;
   std::string indexName;
+  OpenFileInfo indexInfo;
   for (size_t i = 0; i < indexes.size(); ++i) {
     indexPath = path;
     if (!indexPath.empty() && indexPath[indexPath.size() - 1] != '/')
@@ -121,9 +444,8 @@ static bool handleDirectory(const HttpRequest& request,
     indexPath += indexes[i];
     indexName = indexes[i];
 
-    bool isDir = false;
-    bool isReg = false;
-    if (getPathInfo(indexPath, isDir, isReg) && isReg) {
+    if (lookupPath(cache, indexPath, indexInfo, needsOpenFile(request)) &&
+        indexInfo.isReg) {
       foundIndex = true;
       break;
     }
@@ -143,21 +465,16 @@ static bool handleDirectory(const HttpRequest& request,
       response.setHeader("Location", redirectPath);
       return true;
     }
-    if (!readFileToBody(indexPath, body)) {
-      // No se puede abrir el archivo (no existe o sin permisos) -> 403.
-      buildErrorResponse(response, request, HTTP_STATUS_FORBIDDEN, false,
-                         server);
-      return true;
-    }
-    // El index es un archivo estatico normal: fijamos el Content-Type
-    // usando la extension real del fichero (index.html, index.css, ...).
-    response.setContentType(indexPath);
-    return false;
+    // El index es un archivo estatico normal: el Content-Type sale de la
+    // extension real del fichero (index.html, index.css, ...).
+    return serveFile(request, server, location, indexPath, indexInfo,
+                     response, cache, compression);
   }
 
   if (location && location->getAutoIndex()) {
     body = generateAutoIndexBody(path, request.getPath());
     response.setHeader("Content-Type", "text/html");
+    compressGeneratedBody(request, location, body, response);
     return false;
   }
 
@@ -167,8 +484,11 @@ static bool handleDirectory(const HttpRequest& request,
 
 static bool handleRegularFile(const HttpRequest& request,
                               const ServerConfig* server,
-                              const std::string& path, std::vector<char>& body,
-                              HttpResponse& response) {
+                              const LocationConfig* location,
+                              const std::string& path,
+                              const OpenFileInfo& info, std::vector<char>& body,
+                              HttpResponse& response, OpenFileCache* cache,
+                              CompressionCache* compression) {
   if (request.getMethod() == HTTP_METHOD_POST) {
     buildErrorResponse(response, request, HTTP_STATUS_METHOD_NOT_ALLOWED, false,
                        server);
@@ -178,6 +498,7 @@ static bool handleRegularFile(const HttpRequest& request,
     // in case unlink is not allowed use std::remove
     // if (std::remove(path.c_str()) == 0) {
     if (unlink(path.c_str()) == 0) {
+      if (cache) cache->invalidate(path);
       body.clear();
       return false;
     }
@@ -186,20 +507,16 @@ static bool handleRegularFile(const HttpRequest& request,
     return true;
   }
 
-  if (!readFileToBody(path, body)) {
-    buildErrorResponse(response, request, HTTP_STATUS_FORBIDDEN, false, server);
-    return true;
-  }
-  // Archivo estatico leido correctamente: asignamos Content-Type segun su
-  // extension.
-  response.setContentType(path);
-  return false;
+  // Archivo estatico: body de fichero + Content-Type segun su extension (ya
+  // calculado en OpenFileInfo), o 304 si el cliente ya lo tiene.
+  return serveFile(request, server, location, path, info, response, cache,
+                   compression);
 }
 
 static bool handleUpload(const HttpRequest& request, const ServerConfig* server,
                          const LocationConfig* location,
                          const std::string& path, std::vector<char>& body,
-                         HttpResponse& response) {
+                         HttpResponse& response, OpenFileCache* cache) {
   (void)body;
   std::string uploadStore = location->getUploadStore();
   if (uploadStore.empty()) {
@@ -227,6 +544,24 @@ static bool handleUpload(const HttpRequest& request, const ServerConfig* server,
 
   std::string fullPath = uploadStore + filename;
 
+  if (request.hasBodyWriteError()) {
+    buildErrorResponse(response, request, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                       true, server);
+    return true;
+  }
+  // Body grande: ya esta en un temporal dentro de upload_store, solo hay
+  // que renombrarlo (sin copiar bytes).
+  if (request.isBodyInFile()) {
+    if (!request.moveBodyFileTo(fullPath)) {
+      buildErrorResponse(response, request, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                         true, server);
+      return true;
+    }
+    if (cache) cache->invalidate(fullPath);
+    response.setStatusCode(HTTP_STATUS_CREATED);
+    return true;
+  }
+
   std::ofstream outFile(fullPath.c_str(), std::ios::out | std::ios::binary);
   if (!outFile.is_open()) {
     buildErrorResponse(response, request, HTTP_STATUS_INTERNAL_SERVER_ERROR,
@@ -239,6 +574,7 @@ static bool handleUpload(const HttpRequest& request, const ServerConfig* server,
     outFile.write(&reqBody[0], reqBody.size());
   }
   outFile.close();
+  if (cache) cache->invalidate(fullPath);
 
   response.setStatusCode(HTTP_STATUS_CREATED);
   // Podemos opcionalmente devolver un pequeño mensaje en el body:
@@ -248,27 +584,30 @@ static bool handleUpload(const HttpRequest& request, const ServerConfig* server,
 
 bool handleStaticPath(const HttpRequest& request, const ServerConfig* server,
                       const LocationConfig* location, const std::string& path,
-                      std::vector<char>& body, HttpResponse& response) {
+                      std::vector<char>& body, HttpResponse& response,
+                      OpenFileCache* cache, CompressionCache* compression) {
   // POST con upload_store: subida de archivo.
   if (request.getMethod() == HTTP_METHOD_POST && location &&
       !location->getUploadStore().empty()) {
-    return handleUpload(request, server, location, path, body, response);
+    return handleUpload(request, server, location, path, body, response,
+                        cache);
   }
 
-  bool isDir = false;
-  bool isReg = false;
-  if (!getPathInfo(path, isDir, isReg)) {
+  OpenFileInfo info;
+  if (!lookupPath(cache, path, info, needsOpenFile(request))) {
     buildErrorResponse(response, request, HTTP_STATUS_NOT_FOUND, false, server);
     return true;
   }
 
-  if (isDir)
-    return handleDirectory(request, server, location, path, body, response);
+  if (info.isDir)
+    return handleDirectory(request, server, location, path, body, response,
+                           cache, compression);
 
-  if (!isReg) {
+  if (!info.isReg) {
     buildErrorResponse(response, request, HTTP_STATUS_FORBIDDEN, false, server);
     return true;
   }
 
-  return handleRegularFile(request, server, path, body, response);
+  return handleRegularFile(request, server, location, path, info, body,
+                           response, cache, compression);
 }
@@ -8,9 +8,14 @@
 #include "../config/ServerConfig.hpp"
 #include "../http/HttpRequest.hpp"
 #include "../http/HttpResponse.hpp"
+#include "CompressionCache.hpp"
+#include "OpenFileCache.hpp"
 
+// cache puede ser 0 (open_file_cache off): se consulta el disco cada vez.
+// compression puede ser 0: 'gzip on' no comprime ficheros (solo autoindex).
 bool handleStaticPath(const HttpRequest& request, const ServerConfig* server,
                       const LocationConfig* location, const std::string& path,
-                      std::vector<char>& body, HttpResponse& response);
+                      std::vector<char>& body, HttpResponse& response,
+                      OpenFileCache* cache, CompressionCache* compression);
 
 #endif  // STATIC_PATH_HANDLER_HPP
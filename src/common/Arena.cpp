@@ -0,0 +1,73 @@
+#include "Arena.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+Arena::Arena(size_t chunkSize)
+    : chunkSize_(chunkSize), first_(NULL), current_(NULL), offset_(0),
+      used_(0) {}
+
+Arena::~Arena() {
+  while (first_ != NULL) {
+    Chunk* next = first_->next;
+    std::free(first_);
+    first_ = next;
+  }
+}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+  if (align == 0) align = 1;
+  // The rounding below masks with ~(align - 1).
+  if ((align & (align - 1)) != 0)
+    throw std::invalid_argument("Arena: alignment is not a power of two");
+  if (current_ != NULL) {
+    size_t start = (offset_ + align - 1) & ~(align - 1);
+    if (start + bytes <= current_->size) {
+      used_ += start + bytes - offset_;
+      offset_ = start + bytes;
+      return chunkData(current_) + start;
+    }
+  }
+
+  // current_ is always the last chunk: append a new one.
+  Chunk* chunk = newChunk(bytes);
+  if (current_ == NULL)
+    first_ = chunk;
+  else
+    current_->next = chunk;
+  current_ = chunk;
+  offset_ = bytes;
+  used_ += bytes;
+  return chunkData(chunk);
+}
+
+void Arena::reset() {
+  if (first_ == NULL) return;
+  Chunk* extra = first_->next;
+  while (extra != NULL) {
+    Chunk* next = extra->next;
+    std::free(extra);
+    extra = next;
+  }
+  first_->next = NULL;
+  current_ = first_;
+  offset_ = 0;
+  used_ = 0;
+}
+
+size_t Arena::bytesUsed() const { return used_; }
+
+Arena::Chunk* Arena::newChunk(size_t minBytes) {
+  size_t size = minBytes > chunkSize_ ? minBytes : chunkSize_;
+  void* memory = std::malloc(sizeof(Chunk) + size);
+  if (memory == NULL) throw std::bad_alloc();
+  Chunk* chunk = static_cast<Chunk*>(memory);
+  chunk->next = NULL;
+  chunk->size = size;
+  return chunk;
+}
+
+// sizeof(Chunk) is a multiple of the pointer size, so data stays aligned.
+char* Arena::chunkData(Chunk* chunk) {
+  return reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+}
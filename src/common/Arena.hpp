@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Bump allocator for data that lives exactly as long as one request.
+//
+// allocate() carves memory from the current chunk; nothing is freed one by
+// one. reset() releases everything at once and keeps the first chunk, so a
+// long-lived owner (a pooled Client's response) stops calling malloc once the
+// first chunk has been sized by its first request. Extra chunks, needed only
+// by unusually large requests, are returned on reset().
+class Arena {
+ public:
+  explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+  ~Arena();
+
+  // align must be a power of two (0 means 1); anything else throws
+  // std::invalid_argument.
+  void* allocate(size_t bytes, size_t align);
+  void reset();
+
+  size_t bytesUsed() const;  // since the last reset(), including padding
+
+  static const size_t DEFAULT_CHUNK_SIZE = 4096;
+
+ private:
+  struct Chunk {
+    Chunk* next;
+    size_t size;  // usable bytes after the header
+  };
+
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+  Chunk* newChunk(size_t minBytes);
+  static char* chunkData(Chunk* chunk);
+
+  size_t chunkSize_;
+  Chunk* first_;    // kept across reset()
+  Chunk* current_;  // chunk being carved
+  size_t offset_;   // next free byte in current_
+  size_t used_;
+};
+
+// Standard (C++98) allocator over an Arena, for node-based containers whose
+// elements all die together (HttpResponse headers). deallocate() is a no-op;
+// the memory comes back on Arena::reset().
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  ArenaAllocator(const ArenaAllocator& other) : arena_(other.arena_) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+  ~ArenaAllocator() {}
+
+  pointer address(reference value) const { return &value; }
+  const_pointer address(const_reference value) const { return &value; }
+
+  pointer allocate(size_type count, const void* = 0) {
+    return static_cast<pointer>(
+        arena_->allocate(count * sizeof(T), alignment()));
+  }
+  void deallocate(pointer, size_type) {}
+
+  size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+  void construct(pointer p, const T& value) { new (p) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  ArenaAllocator& operator=(const ArenaAllocator&);
+
+  // No alignof in C++98: the largest power of two dividing sizeof(T) (its
+  // lowest set bit), capped at 8. T's alignment divides sizeof(T), so this
+  // is always enough for fundamental types up to 8 bytes.
+  static size_type alignment() {
+    size_type lowest = sizeof(T) & (~sizeof(T) + 1);
+    return lowest < 8 ? lowest : 8;
+  }
+
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() != b.arena();
+}
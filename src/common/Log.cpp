@@ -0,0 +1,366 @@
+#include "Log.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// stdout, stderr and the access_log files.
+const int MAX_SINKS = 32;
+// Powers of two. A few ms of a busy access log fit with room to spare.
+const std::size_t CONSOLE_RING_SIZE = 256 * 1024;
+const std::size_t FILE_RING_SIZE = 4 * 1024 * 1024;
+// Writer pause when every ring is empty and futex() is not available (the
+// writer normally sleeps on writer_idle_ until a line arrives).
+const long IDLE_SLEEP_NS = 10 * 1000 * 1000;
+// flush() gives up after this many 1 ms waits (a stuck terminal).
+const int FLUSH_MAX_WAITS = 2000;
+
+const char* const kLevelNames[] = {"debug", "info", "warn", "error"};
+
+// head: bytes queued, only moved by the producer. tail: bytes written,
+// only moved by the writer. Both only grow; a byte lives at
+// data[offset & mask].
+struct Sink {
+  int fd;
+  char* data;
+  std::size_t mask;
+  std::size_t head;
+  std::size_t tail;
+  unsigned long dropped;  // lines, reset by the writer when it reports them
+  std::string path;       // producer side only (openSink)
+};
+
+Sink sinks_[MAX_SINKS];
+int sink_count_ = 0;  // published with release once a sink is ready
+
+pthread_t writer_;
+bool writer_running_ = false;  // producer side only
+int writer_stop_ = 0;
+// 1 while the writer sleeps (or is about to) on this futex word; whoever
+// sets it back to 0 wakes it.
+int writer_idle_ = 0;
+bool hooks_installed_ = false;
+
+std::size_t loadAcquire(const std::size_t* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(std::size_t* p, std::size_t value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+void initSink(Sink& sink, int fd, std::size_t size) {
+  sink.fd = fd;
+  sink.data = static_cast<char*>(std::malloc(size));
+  sink.mask = size - 1;
+  sink.head = 0;
+  sink.tail = 0;
+  sink.dropped = 0;
+}
+
+void initConsole() {
+  if (sink_count_ != 0) return;
+  initSink(sinks_[logging::STDOUT_SINK], STDOUT_FILENO, CONSOLE_RING_SIZE);
+  initSink(sinks_[logging::STDERR_SINK], STDERR_FILENO, CONSOLE_RING_SIZE);
+  __atomic_store_n(&sink_count_, 2, __ATOMIC_RELEASE);
+}
+
+// Writes every iovec, resuming after short writes. false on error (the
+// batch is then dropped: retrying a broken fd would spin).
+bool writeAll(int fd, iovec* iov, int count) {
+  while (count > 0) {
+    ssize_t written = writev(fd, iov, count);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    std::size_t left = static_cast<std::size_t>(written);
+    while (count > 0 && left >= iov->iov_len) {
+      left -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+      iov->iov_len -= left;
+    }
+  }
+  return true;
+}
+
+// Everything queued on |sink| in one writev() (two iovecs when the bytes
+// wrap around the end of the ring). false when there was nothing.
+bool drainSink(Sink& sink) {
+  std::size_t tail = sink.tail;
+  std::size_t head = loadAcquire(&sink.head);
+  unsigned long dropped =
+      __atomic_exchange_n(&sink.dropped, 0UL, __ATOMIC_RELAXED);
+  if (head == tail && dropped == 0) return false;
+
+  iovec iov[3];
+  int count = 0;
+  if (head != tail) {
+    std::size_t size = sink.mask + 1;
+    std::size_t offset = tail & sink.mask;
+    std::size_t length = head - tail;
+    std::size_t first = length < size - offset ? length : size - offset;
+    iov[count].iov_base = sink.data + offset;
+    iov[count++].iov_len = first;
+    if (first < length) {
+      iov[count].iov_base = sink.data;
+      iov[count++].iov_len = length - first;
+    }
+  }
+  char note[64];
+  if (dropped != 0) {
+    int len = std::snprintf(note, sizeof(note),
+                            "[log] %lu lines dropped (ring full)\n", dropped);
+    iov[count].iov_base = note;
+    iov[count++].iov_len = static_cast<std::size_t>(len);
+  }
+  writeAll(sink.fd, iov, count);
+  storeRelease(&sink.tail, head);
+  return true;
+}
+
+bool hasQueued(int count) {
+  for (int i = 0; i < count; ++i) {
+    if (loadAcquire(&sinks_[i].head) != sinks_[i].tail ||
+        __atomic_load_n(&sinks_[i].dropped, __ATOMIC_RELAXED) != 0)
+      return true;
+  }
+  return false;
+}
+
+// Producer side, after queueing. A single load while the writer is busy;
+// the syscall only for the first line after it went to sleep.
+void wakeWriter() {
+  // Pairs with the fence in idleWait(): either the writer sees the new
+  // head, or this sees writer_idle_ == 1.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&writer_idle_, __ATOMIC_RELAXED) == 0) return;
+  if (__atomic_exchange_n(&writer_idle_, 0, __ATOMIC_ACQ_REL) == 0) return;
+  syscall(SYS_futex, &writer_idle_, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// Writer side, nothing written in the last pass: block until wakeWriter().
+void idleWait() {
+  __atomic_store_n(&writer_idle_, 1, __ATOMIC_SEQ_CST);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  // A line queued before writer_idle_ was set did not wake anybody.
+  int count = __atomic_load_n(&sink_count_, __ATOMIC_ACQUIRE);
+  if (hasQueued(count) ||
+      __atomic_load_n(&writer_stop_, __ATOMIC_ACQUIRE) != 0) {
+    __atomic_store_n(&writer_idle_, 0, __ATOMIC_RELAXED);
+    return;
+  }
+  // Returns at once if a producer already reset the word.
+  if (syscall(SYS_futex, &writer_idle_, FUTEX_WAIT_PRIVATE, 1, NULL, NULL,
+              0) == -1 &&
+      errno == ENOSYS) {
+    struct timespec pause = {0, IDLE_SLEEP_NS};
+    nanosleep(&pause, NULL);
+  }
+  __atomic_store_n(&writer_idle_, 0, __ATOMIC_RELAXED);
+}
+
+void* writerMain(void*) {
+  while (true) {
+    bool stopping = __atomic_load_n(&writer_stop_, __ATOMIC_ACQUIRE) != 0;
+    int count = __atomic_load_n(&sink_count_, __ATOMIC_ACQUIRE);
+    bool wrote = false;
+    for (int i = 0; i < count; ++i) wrote = drainSink(sinks_[i]) || wrote;
+    if (stopping) break;
+    if (!wrote) idleWait();
+  }
+  return NULL;
+}
+
+void stopWriter() {
+  if (!writer_running_) return;
+  __atomic_store_n(&writer_stop_, 1, __ATOMIC_RELEASE);
+  wakeWriter();
+  pthread_join(writer_, NULL);
+  writer_running_ = false;
+  writer_stop_ = 0;
+}
+
+// The parent's writer did not survive fork() and its queued lines are the
+// parent's to write.
+void afterForkInChild() {
+  writer_running_ = false;
+  writer_stop_ = 0;
+  writer_idle_ = 0;
+  for (int i = 0; i < sink_count_; ++i) {
+    sinks_[i].tail = sinks_[i].head;
+    sinks_[i].dropped = 0;
+  }
+}
+
+void shutdownAtExit() {
+  logging::flush();
+  stopWriter();
+}
+
+void startWriter() {
+  if (!hooks_installed_) {
+    pthread_atfork(NULL, NULL, afterForkInChild);
+    std::atexit(shutdownAtExit);
+    hooks_installed_ = true;
+  }
+  // Signals stay with the event loop thread (the supervisor relies on its
+  // waitpid() being interrupted).
+  sigset_t all;
+  sigset_t previous;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &previous);
+  writer_running_ = pthread_create(&writer_, NULL, writerMain, NULL) == 0;
+  pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+// "2026/10/18 09:15:02", rebuilt once per second.
+const char* timestamp() {
+  static time_t cached = -1;
+  static char text[20];
+  time_t now = time(NULL);
+  if (now != cached) {
+    struct tm tm;
+    localtime_r(&now, &tm);
+    strftime(text, sizeof(text), "%Y/%m/%d %H:%M:%S", &tm);
+    cached = now;
+  }
+  return text;
+}
+
+}  // namespace
+
+namespace logging {
+
+int openSink(const std::string& path) {
+  initConsole();
+  for (int i = 0; i < sink_count_; ++i) {
+    if (sinks_[i].path == path) return i;
+  }
+  if (sink_count_ == MAX_SINKS) {
+    errno = EMFILE;
+    return -1;
+  }
+  int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) return -1;
+  Sink& sink = sinks_[sink_count_];
+  initSink(sink, fd, FILE_RING_SIZE);
+  sink.path = path;
+  __atomic_store_n(&sink_count_, sink_count_ + 1, __ATOMIC_RELEASE);
+  return sink_count_ - 1;
+}
+
+void write(int sink, const char* data, std::size_t len) {
+  initConsole();
+  if (sink < 0 || sink >= sink_count_) return;
+  Sink& target = sinks_[sink];
+  if (!writer_running_) startWriter();
+  if (!writer_running_) {
+    // No thread (pthread_create failed): write in place.
+    ssize_t ignored = ::write(target.fd, data, len);
+    (void)ignored;
+    return;
+  }
+
+  std::size_t size = target.mask + 1;
+  std::size_t head = target.head;
+  std::size_t used = head - loadAcquire(&target.tail);
+  if (len > size - used) {
+    __atomic_fetch_add(&target.dropped, 1UL, __ATOMIC_RELAXED);
+    wakeWriter();
+    return;
+  }
+  std::size_t offset = head & target.mask;
+  std::size_t first = len < size - offset ? len : size - offset;
+  std::memcpy(target.data + offset, data, first);
+  std::memcpy(target.data, data + first, len - first);
+  storeRelease(&target.head, head + len);
+  wakeWriter();
+}
+
+void flush() {
+  if (!writer_running_) return;
+  for (int wait = 0; wait < FLUSH_MAX_WAITS; ++wait) {
+    bool empty = true;
+    for (int i = 0; i < sink_count_ && empty; ++i)
+      empty = loadAcquire(&sinks_[i].tail) == sinks_[i].head;
+    if (empty) return;
+    struct timespec pause = {0, 1000 * 1000};
+    nanosleep(&pause, NULL);
+  }
+}
+
+Line::Line(int level) : level_(level), length_(0) {
+  const char* stamp = timestamp();
+  append(stamp, std::strlen(stamp));
+  append(" [", 2);
+  const char* name = kLevelNames[level];
+  append(name, std::strlen(name));
+  append("] ", 2);
+}
+
+Line::~Line() {
+  buffer_[length_++] = '\n';  // append() always leaves room for it
+  write(level_ >= WEBSERV_LOG_WARN ? STDERR_SINK : STDOUT_SINK, buffer_,
+        length_);
+}
+
+Line& Line::operator<<(const char* text) {
+  append(text, std::strlen(text));
+  return *this;
+}
+
+Line& Line::operator<<(const std::string& text) {
+  append(text.data(), text.size());
+  return *this;
+}
+
+Line& Line::operator<<(char c) {
+  append(&c, 1);
+  return *this;
+}
+
+Line& Line::operator<<(int value) { return *this << static_cast<long>(value); }
+
+Line& Line::operator<<(unsigned value) {
+  return *this << static_cast<unsigned long>(value);
+}
+
+Line& Line::operator<<(long value) {
+  char digits[24];
+  int len = std::snprintf(digits, sizeof(digits), "%ld", value);
+  append(digits, static_cast<std::size_t>(len));
+  return *this;
+}
+
+Line& Line::operator<<(unsigned long value) {
+  char digits[24];
+  int len = std::snprintf(digits, sizeof(digits), "%lu", value);
+  append(digits, static_cast<std::size_t>(len));
+  return *this;
+}
+
+void Line::append(const char* data, std::size_t len) {
+  std::size_t room = sizeof(buffer_) - 1 - length_;
+  if (len > room) len = room;
+  std::memcpy(buffer_ + length_, data, len);
+  length_ += len;
+}
+
+}  // namespace logging
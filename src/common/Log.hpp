@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Levels, as numbers so WEBSERV_LOG_LEVEL can be given with -D.
+#define WEBSERV_LOG_DEBUG 0
+#define WEBSERV_LOG_INFO 1
+#define WEBSERV_LOG_WARN 2
+#define WEBSERV_LOG_ERROR 3
+#define WEBSERV_LOG_OFF 4
+
+// Lines below this level are not compiled in:
+// -DWEBSERV_LOG_LEVEL=0 keeps the debug ones, 4 drops everything.
+#ifndef WEBSERV_LOG_LEVEL
+#define WEBSERV_LOG_LEVEL WEBSERV_LOG_INFO
+#endif
+
+// LOG_INFO << "Server listening on port " << port;
+//
+// Under the threshold the condition is a constant and the whole statement
+// (operands included) is dead code. Otherwise the line is formatted into a
+// stack buffer and queued when the statement ends; no flush, no syscall.
+// An expression rather than an if/else, so it is safe as the body of an
+// unbraced if.
+#define WEBSERV_LOG(level)      \
+  ((level) < WEBSERV_LOG_LEVEL) \
+      ? (void)0                 \
+      : ::logging::Voidify() & ::logging::Line(level)
+
+#define LOG_DEBUG WEBSERV_LOG(WEBSERV_LOG_DEBUG)
+#define LOG_INFO WEBSERV_LOG(WEBSERV_LOG_INFO)
+#define LOG_WARN WEBSERV_LOG(WEBSERV_LOG_WARN)
+#define LOG_ERROR WEBSERV_LOG(WEBSERV_LOG_ERROR)
+
+// Asynchronous logging.
+//
+// Every sink (stdout, stderr, each access_log file) has a single-producer
+// single-consumer byte ring. The event loop is the only producer: it copies
+// whole lines in and moves on. A background thread, started on the first
+// line, drains the rings with one writev() per sink and pass, so a burst of
+// requests turns into a few large writes instead of one flushed write each.
+// With every ring empty the writer sleeps on a futex; the next line wakes
+// it, so an idle process does not wake up and a line is not held back.
+//
+// The event loop never waits for the disk or the terminal: when a ring is
+// full the line is dropped and counted, and the writer reports how many
+// were lost once it catches up.
+//
+// fork(): a child discards the lines its parent still has queued (the
+// parent writes them) and starts its own writer when it first logs.
+// Lines still queued when the process is killed by a signal are lost;
+// exit() and flush() write them out.
+namespace logging {
+
+const int STDOUT_SINK = 0;
+const int STDERR_SINK = 1;
+
+// Opens |path| for appending (created 0644) and returns its sink id, the
+// same one for a path already open; -1 with errno set on failure.
+int openSink(const std::string& path);
+
+// Queues |len| bytes on |sink|. Callers pass whole lines: the writer may
+// split a batch only between two calls.
+void write(int sink, const char* data, std::size_t len);
+
+// Blocks until everything queued so far is written (shutdown, before
+// handing stdout/stderr to someone else).
+void flush();
+
+// One log line: "2026/10/18 09:15:02 [info] message\n". INFO and DEBUG go
+// to stdout, WARN and ERROR to stderr. Longer lines are truncated.
+class Line {
+ public:
+  explicit Line(int level);
+  ~Line();
+
+  Line& operator<<(const char* text);
+  Line& operator<<(const std::string& text);
+  Line& operator<<(char c);
+  Line& operator<<(int value);
+  Line& operator<<(unsigned value);
+  Line& operator<<(long value);
+  Line& operator<<(unsigned long value);
+
+ private:
+  Line(const Line&);
+  Line& operator=(const Line&);
+
+  void append(const char* data, std::size_t len);
+
+  int level_;
+  std::size_t length_;
+  char buffer_[1024];
+};
+
+// Turns "Line(level) << ..." into void for the ?: in WEBSERV_LOG (& binds
+// looser than <<).
+class Voidify {
+ public:
+  void operator&(const Line&) const {}
+};
+
+}  // namespace logging
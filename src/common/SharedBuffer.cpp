@@ -0,0 +1,49 @@
+#include "SharedBuffer.hpp"
+
+SharedBuffer::SharedBuffer() : block_(0) {}
+
+SharedBuffer::SharedBuffer(const std::string& data) : block_(0) {
+  if (data.empty()) return;
+  block_ = new Block;
+  block_->bytes.assign(data.begin(), data.end());
+  block_->refs = 1;
+}
+
+SharedBuffer::SharedBuffer(const SharedBuffer& other) : block_(other.block_) {
+  if (block_) ++block_->refs;
+}
+
+SharedBuffer& SharedBuffer::operator=(const SharedBuffer& other) {
+  if (this != &other) {
+    if (other.block_) ++other.block_->refs;
+    release();
+    block_ = other.block_;
+  }
+  return *this;
+}
+
+SharedBuffer::~SharedBuffer() { release(); }
+
+SharedBuffer SharedBuffer::adopt(std::vector<char>& data) {
+  SharedBuffer buffer;
+  if (data.empty()) return buffer;
+  buffer.block_ = new Block;
+  buffer.block_->bytes.swap(data);
+  buffer.block_->refs = 1;
+  return buffer;
+}
+
+const char* SharedBuffer::data() const {
+  return block_ ? &block_->bytes[0] : 0;
+}
+
+std::size_t SharedBuffer::size() const {
+  return block_ ? block_->bytes.size() : 0;
+}
+
+bool SharedBuffer::empty() const { return size() == 0; }
+
+void SharedBuffer::release() {
+  if (block_ && --block_->refs == 0) delete block_;
+  block_ = 0;
+}
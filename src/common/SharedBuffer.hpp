@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Reference-counted, immutable byte buffer.
+//
+// Copies share the same bytes; the last copy frees them. Lets the output
+// chain (and any cache) hold serialized response bytes without copying them
+// again every time they are queued.
+class SharedBuffer {
+ public:
+  SharedBuffer();
+  explicit SharedBuffer(const std::string& data);
+  SharedBuffer(const SharedBuffer& other);
+  SharedBuffer& operator=(const SharedBuffer& other);
+  ~SharedBuffer();
+
+  // Takes the contents of data without copying (data is left empty).
+  static SharedBuffer adopt(std::vector<char>& data);
+
+  const char* data() const;
+  std::size_t size() const;
+  bool empty() const;
+
+ private:
+  struct Block {
+    std::vector<char> bytes;
+    int refs;
+  };
+  Block* block_;
+
+  void release();
+};
@@ -0,0 +1,41 @@
+#include "SharedFd.hpp"
+
+#include <unistd.h>
+
+SharedFd::SharedFd() : fd_(-1), refs_(0) {}
+
+SharedFd::SharedFd(int fd) : fd_(fd), refs_(0) {
+  if (fd_ >= 0) refs_ = new int(1);
+}
+
+SharedFd::SharedFd(const SharedFd& other)
+    : fd_(other.fd_), refs_(other.refs_) {
+  if (refs_) ++(*refs_);
+}
+
+SharedFd& SharedFd::operator=(const SharedFd& other) {
+  if (this != &other) {
+    if (other.refs_) ++(*other.refs_);
+    release();
+    fd_ = other.fd_;
+    refs_ = other.refs_;
+  }
+  return *this;
+}
+
+SharedFd::~SharedFd() { release(); }
+
+int SharedFd::get() const { return fd_; }
+
+bool SharedFd::valid() const { return fd_ >= 0; }
+
+void SharedFd::reset() { release(); }
+
+void SharedFd::release() {
+  if (refs_ && --(*refs_) == 0) {
+    close(fd_);
+    delete refs_;
+  }
+  fd_ = -1;
+  refs_ = 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Reference-counted file descriptor.
+//
+// Copies share the same descriptor; the last copy to be destroyed (or reset)
+// closes it. Used for file-backed response bodies: the HttpResponse, the
+// Client output queue and any cache can hold the same open file without
+// knowing who is the last user.
+class SharedFd {
+ public:
+  SharedFd();
+  explicit SharedFd(int fd);  // takes ownership of fd (-1 = empty)
+  SharedFd(const SharedFd& other);
+  SharedFd& operator=(const SharedFd& other);
+  ~SharedFd();
+
+  int get() const;
+  bool valid() const;
+  void reset();
+
+ private:
+  int fd_;
+  int* refs_;
+
+  void release();
+};
@@ -0,0 +1,90 @@
+#include "TimeUtils.hpp"
+
+#include <time.h>
+
+#include <cstring>
+
+namespace {
+
+const char kDays[] = "SunMonTueWedThuFriSat";
+const char kMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// Days since 1970-01-01 of a proleptic Gregorian date (month 1-12), without
+// timegm(), which is not POSIX.
+long daysFromCivil(long year, long month, long day) {
+  year -= month <= 2;
+  long era = (year >= 0 ? year : year - 399) / 400;
+  long yoe = year - era * 400;
+  long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+bool parseDigits(const char* p, std::size_t count, long& out) {
+  out = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (p[i] < '0' || p[i] > '9') return false;
+    out = out * 10 + (p[i] - '0');
+  }
+  return true;
+}
+
+void putDigits(char* p, long value, std::size_t count) {
+  for (std::size_t i = count; i > 0; --i) {
+    p[i - 1] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+}
+
+}  // namespace
+
+namespace time_utils {
+
+long monotonicMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+std::string formatHttpDate(time_t t) {
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  char out[] = "Thu, 01 Jan 1970 00:00:00 GMT";
+  std::memcpy(out, kDays + tm.tm_wday * 3, 3);
+  putDigits(out + 5, tm.tm_mday, 2);
+  std::memcpy(out + 8, kMonths + tm.tm_mon * 3, 3);
+  putDigits(out + 12, tm.tm_year + 1900, 4);
+  putDigits(out + 17, tm.tm_hour, 2);
+  putDigits(out + 20, tm.tm_min, 2);
+  putDigits(out + 23, tm.tm_sec, 2);
+  return std::string(out, sizeof(out) - 1);
+}
+
+bool parseHttpDate(const char* value, std::size_t len, time_t& out) {
+  // "Sun, 06 Nov 1994 08:49:37 GMT"
+  //  0    5  8   12   17 20 23 26
+  static const std::size_t kLength = 29;
+  if (len != kLength || value[3] != ',' || value[4] != ' ' ||
+      value[7] != ' ' || value[11] != ' ' || value[16] != ' ' ||
+      value[19] != ':' || value[22] != ':' ||
+      std::memcmp(value + 25, " GMT", 4) != 0)
+    return false;
+
+  long month = 0;
+  while (month < 12 && std::memcmp(kMonths + month * 3, value + 8, 3) != 0)
+    ++month;
+  long day, year, hour, minute, second;
+  if (month == 12 || !parseDigits(value + 5, 2, day) ||
+      !parseDigits(value + 12, 4, year) || !parseDigits(value + 17, 2, hour) ||
+      !parseDigits(value + 20, 2, minute) ||
+      !parseDigits(value + 23, 2, second))
+    return false;
+  if (day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    return false;
+
+  out = static_cast<time_t>(daysFromCivil(year, month + 1, day) * 86400 +
+                            hour * 3600 + minute * 60 + second);
+  return true;
+}
+
+}  // namespace time_utils
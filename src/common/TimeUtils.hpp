@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+
+namespace time_utils {
+
+// Milliseconds on CLOCK_MONOTONIC: immune to wall clock jumps, only
+// meaningful as a difference (deadlines, timeouts).
+long monotonicMs();
+
+// IMF-fixdate (RFC 9110): "Sun, 06 Nov 1994 08:49:37 GMT". Does not depend
+// on the locale.
+std::string formatHttpDate(time_t t);
+// Inverse of formatHttpDate(). false for anything else, including the
+// obsolete RFC 850 and asctime() forms (callers then ignore the header).
+bool parseHttpDate(const char* value, std::size_t len, time_t& out);
+
+}  // namespace time_utils
@@ -89,14 +89,75 @@ static const std::string missing_semicolon_at_the_end_of_directive =
     "Directive must end with semicolon: ";
 static const std::string semicolon_must_be_attached_to_the_last_word =
     "Semicolon must be attached to the last word: ";
+static const std::string invalid_worker_processes =
+    "worker_processes must be 'auto' or a number between 1 and 1024";
+static const std::string missing_args_in_worker_processes =
+    "Missing arguments in 'worker_processes' directive";
+static const std::string invalid_open_file_cache =
+    "open_file_cache must be 'off' or 'max=N [inactive=time]'";
+static const std::string invalid_response_cache =
+    "response_cache must be 'off' or 'size=N [max_object=N]'";
+static const std::string invalid_duration =
+    "Invalid time value (expected e.g. 30, 30s, 5m, 1h, 7d): ";
+static const std::string invalid_body_buffer_size =
+    "client_body_buffer_size takes exactly one positive size";
+static const std::string invalid_timeout =
+    "Timeout directives take exactly one positive time value";
+static const std::string invalid_edge_triggered =
+    "edge_triggered must be 'on' or 'off'";
+static const std::string invalid_client_read_size =
+    "client_read_size takes one size between 1k and 1m";
+static const std::string invalid_event_backend =
+    "event_backend must be 'auto', 'epoll' or 'io_uring'";
+static const std::string invalid_fastcgi_pass =
+    "fastcgi_pass must be 'unix:/path' or 'host:port' [keepalive=N], or "
+    "'.ext /interpreter'";
+static const std::string invalid_fastcgi_spawn =
+    "fastcgi_spawn takes a program path and an optional worker count (1-256)";
+static const std::string fastcgi_spawn_without_pass =
+    "fastcgi_spawn requires a fastcgi_pass address in the same location";
+static const std::string invalid_handler =
+    "handler takes the path of one module (.so)";
+static const std::string handler_with_cgi =
+    "handler cannot share a location with cgi or fastcgi_pass";
+static const std::string duplicate_default_server =
+    "More than one default_server for port ";
+static const std::string invalid_listen_option =
+    "listen options are default_server, backlog=N, deferred and "
+    "fastopen=N: ";
+static const std::string duplicate_listen_options =
+    "backlog=, deferred and fastopen= set by more than one server on port ";
+static const std::string invalid_server_name =
+    "server_name takes host names, optionally with a leading '*.' wildcard: ";
+static const std::string invalid_expires =
+    "expires takes 'off', 'max' or one time value (e.g. 1h, 7d)";
+static const std::string missing_args_in_cache_control =
+    "Missing arguments in 'cache_control' directive";
+static const std::string invalid_gzip =
+    "gzip and gzip_static must be 'on' or 'off'";
+static const std::string invalid_gzip_cache =
+    "gzip_cache must be 'off' or 'size=N [max_object=N]'";
+static const std::string invalid_access_log =
+    "access_log takes 'off', or a file path and an optional format";
+static const std::string unknown_log_variable =
+    "Unknown variable in access_log format: ";
 }  // namespace errors
 
 namespace section {
 static const std::string server = "server";
 static const std::string listen = "listen";
+// listen 8080 default_server; -> answers Host values no server_name matches
+static const std::string default_server = "default_server";
+// listen 80 backlog=4096 deferred fastopen=256; -> listening socket options,
+// one set per port (every server on the port shares the socket)
+static const std::string listen_backlog = "backlog=";
+static const std::string listen_deferred = "deferred";
+static const std::string listen_fastopen = "fastopen=";
+static const int max_listen_backlog = 65535;
 static const std::string host = "host";
 static const std::string server_name = "server_name";
 static const std::string client_max_body_size = "client_max_body_size";
+static const std::string client_body_buffer_size = "client_body_buffer_size";
 static const std::string location = "location";
 static const std::string error_page = "error_page";
 static const std::string root = "root";
@@ -122,6 +183,7 @@ static const int default_return_code = 302;
 static const int default_port = 8080;
 static const std::string default_host_name = "127.0.0.1";
 static const size_t max_body_size = 1048576;
+static const size_t body_buffer_size = 16384;  // larger upload bodies spill
 static const int max_port = 65535;
 static const std::string method_get = "GET";
 static const std::string method_post = "POST";
@@ -129,6 +191,78 @@ static const std::string method_delete = "DELETE";
 static const std::string method_head = "HEAD";
 static const std::string cgi = "cgi";
 static const std::string cgi_fast = "fastcgi_pass";
+static const std::string fastcgi_unix_prefix = "unix:";
+static const std::string fastcgi_spawn = "fastcgi_spawn";
+static const std::string fastcgi_keepalive = "keepalive=";
+static const int default_fastcgi_workers = 4;
+static const int max_fastcgi_workers = 256;
+static const std::string handler = "handler";
+static const std::string worker_processes = "worker_processes";
+static const std::string worker_processes_auto = "auto";
+static const int default_worker_processes = 1;
+static const int max_worker_processes = 1024;
+static const std::string open_file_cache = "open_file_cache";
+static const std::string open_file_cache_off = "off";
+static const std::string open_file_cache_max = "max=";
+static const std::string open_file_cache_inactive = "inactive=";
+static const int default_open_file_cache_inactive = 60;  // seconds
+static const std::string response_cache = "response_cache";
+static const std::string response_cache_off = "off";
+static const std::string response_cache_size = "size=";
+static const std::string response_cache_max_object = "max_object=";
+static const long default_response_cache_max_object = 64 * 1024;
+static const std::string client_header_timeout = "client_header_timeout";
+static const std::string client_body_timeout = "client_body_timeout";
+static const std::string keepalive_timeout = "keepalive_timeout";
+static const std::string send_timeout = "send_timeout";
+static const std::string cgi_timeout = "cgi_timeout";
+static const int default_client_timeout = 60;  // seconds
+static const int default_cgi_timeout = 5;      // seconds
+// edge_triggered on; -> client sockets in EPOLLET, read/written until EAGAIN
+static const std::string edge_triggered = "edge_triggered";
+static const std::string edge_triggered_on = "on";
+static const std::string edge_triggered_off = "off";
+// client_read_size 64k; -> bytes asked for in each recv() on a client
+static const std::string client_read_size = "client_read_size";
+static const long default_client_read_size = 16 * 1024;
+static const long min_client_read_size = 1024;
+static const long max_client_read_size = 1024 * 1024;
+// event_backend io_uring; -> io_uring instead of epoll: readiness, plus
+// accept and recv in the ring on 6.0+
+static const std::string event_backend = "event_backend";
+static const std::string event_backend_auto = "auto";
+static const std::string event_backend_epoll = "epoll";
+static const std::string event_backend_io_uring = "io_uring";
+// expires 7d; -> "Cache-Control: max-age=604800" on static files
+static const std::string expires = "expires";
+static const std::string expires_off = "off";
+static const std::string expires_max = "max";
+static const int expires_max_seconds = 315360000;  // 10 years, like nginx
+// cache_control public, immutable; -> appended to the max-age
+static const std::string cache_control = "cache_control";
+// gzip_static on; -> serve file.gz to clients that accept gzip
+static const std::string gzip_static = "gzip_static";
+// gzip on; -> compress text responses (files, autoindex, CGI) on the fly
+static const std::string gzip = "gzip";
+static const std::string gzip_on = "on";
+static const std::string gzip_off = "off";
+static const std::size_t gzip_min_length = 256;  // smaller: not worth it
+// gzip_cache size=4m max_object=1m; -> compressed files kept per worker;
+// larger files are never compressed on the fly
+static const std::string gzip_cache = "gzip_cache";
+static const std::string gzip_cache_off = "off";
+static const std::string gzip_cache_size = "size=";
+static const std::string gzip_cache_max_object = "max_object=";
+static const long default_gzip_cache_size = 4 * 1024 * 1024;
+static const long default_gzip_cache_max_object = 1024 * 1024;
+// access_log logs/access.log '$remote_addr "$request" $status'; -> one line
+// per response, written by the log thread; without a format: combined
+static const std::string access_log = "access_log";
+static const std::string access_log_off = "off";
+static const std::string access_log_combined = "combined";
+static const std::string access_log_combined_format =
+    "$remote_addr - - [$time_local] \"$request\" $status $body_bytes_sent "
+    "\"$http_referer\" \"$http_user_agent\"";
 }  // namespace section
 
 enum ParserState { OUTSIDE_BLOCK, IN_SERVER, IN_LOCATION };
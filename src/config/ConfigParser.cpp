@@ -1,6 +1,10 @@
 #include "ConfigParser.hpp"
 
+#include <unistd.h>
+
+#include <cstdlib>
 #include <fstream>
+#include <set>
 #include <sstream>
 
 #include "../common/namespaces.hpp"
@@ -27,6 +31,10 @@ const std::vector<ServerConfig>& ConfigParser::getServers() const {
   return servers_;
 }
 
+const GlobalConfig& ConfigParser::getGlobalConfig() const {
+  return global_config_;
+}
+
 //	============= PRIVATE CONSTRUCTORS ===============
 
 /**
@@ -58,6 +66,7 @@ void ConfigParser::parse() {
     std::cout << "VALID CURLY BRACKETS PAIRS: ✅\n";
   }
 
+  parseGlobalDirectives();
   loadServerBlocks();
   parseAllServerBlocks();
 }
@@ -67,7 +76,8 @@ ConfigParser::ConfigParser(const ConfigParser& other)
       clean_file_str_(other.clean_file_str_),
       servers_count_(other.servers_count_),
       raw_server_blocks_(other.raw_server_blocks_),
-      servers_(other.servers_) {}
+      servers_(other.servers_),
+      global_config_(other.global_config_) {}
 
 ConfigParser& ConfigParser::operator=(const ConfigParser& other) {
   if (this != &other) {
@@ -77,6 +87,7 @@ ConfigParser& ConfigParser::operator=(const ConfigParser& other) {
     std::swap(servers_count_, tmp.servers_count_);
     std::swap(raw_server_blocks_, tmp.raw_server_blocks_);
     std::swap(servers_, tmp.servers_);
+    std::swap(global_config_, tmp.global_config_);
   }
   return *this;
 }
@@ -237,6 +248,26 @@ void ConfigParser::parseAllServerBlocks() {
     servers_.push_back(server);
   }
 
+  // Servers sharing a port are told apart by Host; at most one of them
+  // may claim the requests no server_name matches, and at most one may set
+  // the options of the listening socket they share.
+  std::set<int> defaultPorts;
+  std::set<int> optionPorts;
+  for (size_t i = 0; i < servers_.size(); ++i) {
+    std::stringstream ss;
+    ss << servers_[i].getPort();
+    if (servers_[i].isDefaultServer() &&
+        !defaultPorts.insert(servers_[i].getPort()).second) {
+      throw ConfigException(config::errors::duplicate_default_server +
+                            ss.str());
+    }
+    if (servers_[i].hasListenOptions() &&
+        !optionPorts.insert(servers_[i].getPort()).second) {
+      throw ConfigException(config::errors::duplicate_listen_options +
+                            ss.str());
+    }
+  }
+
   for (size_t i = 0; i < servers_.size(); ++i) {
     std::cout << config::colors::magenta << "Config of Server[" << i << "]\n"
               << config::colors::reset;
@@ -244,6 +275,277 @@ void ConfigParser::parseAllServerBlocks() {
   }
 }
 
+/**
+ * Directives outside of any block (nginx "main" context):
+ * worker_processes 4;
+ * server { ... }
+ * Only lines at bracket depth 0 are considered; everything inside
+ * server/location blocks is handled by parseSingleServerBlock().
+ */
+void ConfigParser::parseGlobalDirectives() {
+  std::stringstream ss(clean_file_str_);
+  std::string line;
+  int depth = 0;
+
+  while (std::getline(ss, line)) {
+    line = config::utils::trimLine(line);
+    if (line.empty()) continue;
+
+    for (size_t i = 0; i < line.size(); ++i) {
+      if (line[i] == config::section::open_bracket) ++depth;
+      if (line[i] == config::section::close_bracket) --depth;
+    }
+    if (depth != 0 || line[line.size() - 1] == config::section::close_bracket ||
+        line[line.size() - 1] == config::section::open_bracket)
+      continue;
+
+    validateDirectiveLine(line);
+    std::vector<std::string> tokens = config::utils::tokenize(line);
+    if (tokens.empty()) continue;
+
+    const std::string directive = config::utils::removeSemicolon(tokens[0]);
+    if (directive == config::section::worker_processes) {
+      parseWorkerProcesses(tokens);
+    } else if (directive == config::section::open_file_cache) {
+      parseOpenFileCache(tokens);
+    } else if (directive == config::section::response_cache) {
+      parseResponseCache(tokens);
+    } else if (directive == config::section::gzip_cache) {
+      parseGzipCache(tokens);
+    } else if (directive == config::section::edge_triggered) {
+      parseEdgeTriggered(tokens);
+    } else if (directive == config::section::client_read_size) {
+      parseClientReadSize(tokens);
+    } else if (directive == config::section::event_backend) {
+      parseEventBackend(tokens);
+    } else if (directive == config::section::client_header_timeout ||
+               directive == config::section::client_body_timeout ||
+               directive == config::section::keepalive_timeout ||
+               directive == config::section::send_timeout ||
+               directive == config::section::cgi_timeout) {
+      parseTimeout(directive, tokens);
+    }
+  }
+}
+
+/**
+ * worker_processes 4;     -> 4 event loops (one process each)
+ * worker_processes auto;  -> one event loop per online CPU
+ */
+void ConfigParser::parseWorkerProcesses(
+    const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::missing_args_in_worker_processes);
+  }
+  std::string value = config::utils::removeSemicolon(tokens[1]);
+  if (value == config::section::worker_processes_auto) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    if (cpus > config::section::max_worker_processes)
+      cpus = config::section::max_worker_processes;
+    global_config_.setWorkerProcesses(static_cast<int>(cpus));
+    return;
+  }
+  if (value.empty() ||
+      value.find_first_not_of("0123456789") != std::string::npos) {
+    throw ConfigException(config::errors::invalid_worker_processes);
+  }
+  global_config_.setWorkerProcesses(config::utils::stringToInt(value));
+}
+
+/**
+ * open_file_cache off;                      -> default, every hit stats/opens
+ * open_file_cache max=1000;                 -> LRU of 1000 entries
+ * open_file_cache max=1000 inactive=20s;    -> drop entries unused for 20s
+ */
+void ConfigParser::parseOpenFileCache(const std::vector<std::string>& tokens) {
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    throw ConfigException(config::errors::invalid_open_file_cache);
+  }
+  std::string first = config::utils::removeSemicolon(tokens[1]);
+  if (first == config::section::open_file_cache_off) {
+    if (tokens.size() != 2)
+      throw ConfigException(config::errors::invalid_open_file_cache);
+    global_config_.setOpenFileCache(
+        0, global_config_.getOpenFileCacheInactive());
+    return;
+  }
+
+  const std::string& maxKey = config::section::open_file_cache_max;
+  if (first.compare(0, maxKey.size(), maxKey) != 0) {
+    throw ConfigException(config::errors::invalid_open_file_cache);
+  }
+  std::string maxValue = first.substr(maxKey.size());
+  if (maxValue.empty() ||
+      maxValue.find_first_not_of("0123456789") != std::string::npos) {
+    throw ConfigException(config::errors::invalid_open_file_cache);
+  }
+  int maxEntries = config::utils::stringToInt(maxValue);
+  if (maxEntries < 1) {
+    throw ConfigException(config::errors::invalid_open_file_cache);
+  }
+
+  int inactive = config::section::default_open_file_cache_inactive;
+  if (tokens.size() == 3) {
+    std::string second = config::utils::removeSemicolon(tokens[2]);
+    const std::string& inactiveKey = config::section::open_file_cache_inactive;
+    if (second.compare(0, inactiveKey.size(), inactiveKey) != 0) {
+      throw ConfigException(config::errors::invalid_open_file_cache);
+    }
+    inactive = config::utils::parseDuration(second.substr(inactiveKey.size()));
+  }
+  global_config_.setOpenFileCache(maxEntries, inactive);
+}
+
+/**
+ * response_cache off;                    -> default
+ * response_cache size=8m;                -> 8 MB of small static responses
+ * response_cache size=8m max_object=32k; -> only files up to 32 KB
+ */
+void ConfigParser::parseResponseCache(const std::vector<std::string>& tokens) {
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    throw ConfigException(config::errors::invalid_response_cache);
+  }
+  std::string first = config::utils::removeSemicolon(tokens[1]);
+  long maxObject = global_config_.getResponseCacheMaxObject();
+  if (first == config::section::response_cache_off) {
+    if (tokens.size() != 2)
+      throw ConfigException(config::errors::invalid_response_cache);
+    global_config_.setResponseCache(0, maxObject);
+    return;
+  }
+
+  const std::string& sizeKey = config::section::response_cache_size;
+  if (first.compare(0, sizeKey.size(), sizeKey) != 0) {
+    throw ConfigException(config::errors::invalid_response_cache);
+  }
+  long size = config::utils::parseSize(first.substr(sizeKey.size()));
+  if (size < 1) {
+    throw ConfigException(config::errors::invalid_response_cache);
+  }
+
+  if (tokens.size() == 3) {
+    std::string second = config::utils::removeSemicolon(tokens[2]);
+    const std::string& objectKey = config::section::response_cache_max_object;
+    if (second.compare(0, objectKey.size(), objectKey) != 0) {
+      throw ConfigException(config::errors::invalid_response_cache);
+    }
+    maxObject = config::utils::parseSize(second.substr(objectKey.size()));
+  } else if (maxObject > size) {
+    maxObject = size;
+  }
+  global_config_.setResponseCache(size, maxObject);
+}
+
+/**
+ * gzip_cache size=4m max_object=1m;  -> default
+ * gzip_cache size=16m;               -> more compressed files per worker
+ * gzip_cache off;                    -> compress on every request
+ * max_object also caps the files that 'gzip on' compresses at all.
+ */
+void ConfigParser::parseGzipCache(const std::vector<std::string>& tokens) {
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    throw ConfigException(config::errors::invalid_gzip_cache);
+  }
+  std::string first = config::utils::removeSemicolon(tokens[1]);
+  long maxObject = global_config_.getGzipCacheMaxObject();
+  if (first == config::section::gzip_cache_off) {
+    if (tokens.size() != 2)
+      throw ConfigException(config::errors::invalid_gzip_cache);
+    global_config_.setGzipCache(0, maxObject);
+    return;
+  }
+
+  const std::string& sizeKey = config::section::gzip_cache_size;
+  if (first.compare(0, sizeKey.size(), sizeKey) != 0) {
+    throw ConfigException(config::errors::invalid_gzip_cache);
+  }
+  long size = config::utils::parseSize(first.substr(sizeKey.size()));
+  if (size < 1) {
+    throw ConfigException(config::errors::invalid_gzip_cache);
+  }
+
+  if (tokens.size() == 3) {
+    std::string second = config::utils::removeSemicolon(tokens[2]);
+    const std::string& objectKey = config::section::gzip_cache_max_object;
+    if (second.compare(0, objectKey.size(), objectKey) != 0) {
+      throw ConfigException(config::errors::invalid_gzip_cache);
+    }
+    maxObject = config::utils::parseSize(second.substr(objectKey.size()));
+  } else if (maxObject > size) {
+    maxObject = size;
+  }
+  global_config_.setGzipCache(size, maxObject);
+}
+
+/**
+ * edge_triggered off;  -> default: epoll reports a socket while it is ready
+ * edge_triggered on;   -> EPOLLET: one report per change, sockets are read
+ *                         and written until EAGAIN
+ */
+void ConfigParser::parseEdgeTriggered(const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_edge_triggered);
+  }
+  std::string value = config::utils::removeSemicolon(tokens[1]);
+  if (value != config::section::edge_triggered_on &&
+      value != config::section::edge_triggered_off) {
+    throw ConfigException(config::errors::invalid_edge_triggered);
+  }
+  global_config_.setEdgeTriggered(value == config::section::edge_triggered_on);
+}
+
+/**
+ * client_read_size 64k;   -> recv() up to 64 KB at a time (large uploads)
+ */
+void ConfigParser::parseClientReadSize(const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_client_read_size);
+  }
+  global_config_.setClientReadSize(
+      config::utils::parseSize(config::utils::removeSemicolon(tokens[1])));
+}
+
+/**
+ * event_backend auto;       -> default: io_uring when the kernel supports
+ *                              it, epoll otherwise
+ * event_backend epoll;      -> always epoll
+ * event_backend io_uring;   -> io_uring (epoll, with a warning, if missing)
+ *
+ * With io_uring on Linux 6.0+ the ring accepts on the listeners and reads
+ * the client sockets itself (multishot accept/recv, provided buffers of
+ * client_read_size); older kernels only get readiness from it.
+ */
+void ConfigParser::parseEventBackend(const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_event_backend);
+  }
+  global_config_.setEventBackend(config::utils::removeSemicolon(tokens[1]));
+}
+
+/**
+ * client_header_timeout 10s;   keepalive_timeout 75s;   cgi_timeout 1m;
+ * One positive duration; a bare number means seconds.
+ */
+void ConfigParser::parseTimeout(const std::string& directive,
+                                const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_timeout);
+  }
+  int seconds =
+      config::utils::parseDuration(config::utils::removeSemicolon(tokens[1]));
+  if (directive == config::section::client_header_timeout)
+    global_config_.setClientHeaderTimeout(seconds);
+  else if (directive == config::section::client_body_timeout)
+    global_config_.setClientBodyTimeout(seconds);
+  else if (directive == config::section::keepalive_timeout)
+    global_config_.setKeepaliveTimeout(seconds);
+  else if (directive == config::section::send_timeout)
+    global_config_.setSendTimeout(seconds);
+  else
+    global_config_.setCgiTimeout(seconds);
+}
+
 void ConfigParser::parseListen(ServerConfig& server,
                                const std::vector<std::string>& tokens) {
   if (tokens.size() < 2) {
@@ -252,6 +554,26 @@ void ConfigParser::parseListen(ServerConfig& server,
   std::string value = config::utils::removeSemicolon(tokens[1]);
   size_t pos = value.find(':');
 
+  // Options after the address: listen 8080 default_server deferred;
+  for (size_t i = 2; i < tokens.size(); ++i) {
+    std::string option = config::utils::removeSemicolon(tokens[i]);
+    const std::string& backlog = config::section::listen_backlog;
+    const std::string& fastopen = config::section::listen_fastopen;
+    if (option == config::section::default_server) {
+      server.setDefaultServer(true);
+    } else if (option == config::section::listen_deferred) {
+      server.setListenDeferred(true);
+    } else if (option.compare(0, backlog.size(), backlog) == 0) {
+      server.setListenBacklog(
+          config::utils::stringToInt(option.substr(backlog.size())));
+    } else if (option.compare(0, fastopen.size(), fastopen) == 0) {
+      server.setListenFastOpen(
+          config::utils::stringToInt(option.substr(fastopen.size())));
+    } else {
+      throw ConfigException(config::errors::invalid_listen_option + option);
+    }
+  }
+
   if (pos != std::string::npos) {
     // Case: IP:PORT (127.0.0.1:8080)
     std::string first = value.substr(0, pos);
@@ -304,6 +626,24 @@ void ConfigParser::parseHost(ServerConfig& server,
   server.setHost(hostValue);
 }
 
+/**
+ * client_body_buffer_size 16k;
+ * Upload bodies up to this size stay in memory; larger ones are written to a
+ * temporary file in the upload_store directory while they arrive.
+ */
+void ConfigParser::parseBodyBufferSize(ServerConfig& server,
+                                       const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_body_buffer_size);
+  }
+  long size =
+      config::utils::parseSize(config::utils::removeSemicolon(tokens[1]));
+  if (size < 1) {
+    throw ConfigException(config::errors::invalid_body_buffer_size);
+  }
+  server.setBodyBufferSize(static_cast<size_t>(size));
+}
+
 void ConfigParser::parseMaxSizeBody(ServerConfig& server,
                                     const std::vector<std::string>& tokens) {
   const std::string& maxSizeStr = config::utils::removeSemicolon(tokens[1]);
@@ -436,9 +776,208 @@ void ConfigParser::parseCgi(LocationConfig& loc,
   loc.addCgiHandler(extension, binaryPath);
 }
 
+/**
+ * fastcgi_pass unix:/run/app.sock;   fastcgi_pass 127.0.0.1:9000 keepalive=8;
+ * The older 'fastcgi_pass .ext /interpreter;' form is still accepted as an
+ * alias of 'cgi'.
+ */
+void ConfigParser::parseFastCgiPass(LocationConfig& loc,
+                                    const std::vector<std::string>& tokens) {
+  if (tokens.size() >= 3 && !tokens[1].empty() && tokens[1][0] == '.') {
+    parseCgi(loc, tokens);
+    return;
+  }
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    throw ConfigException(config::errors::invalid_fastcgi_pass);
+  }
+  int keepalive = -1;
+  if (tokens.size() == 3) {
+    std::string opt = config::utils::removeSemicolon(tokens[2]);
+    const std::string& key = config::section::fastcgi_keepalive;
+    if (opt.compare(0, key.size(), key) != 0) {
+      throw ConfigException(config::errors::invalid_fastcgi_pass);
+    }
+    std::string count = opt.substr(key.size());
+    char* end = 0;
+    long value = std::strtol(count.c_str(), &end, 10);
+    if (count.empty() || *end != '\0' || value < 0 || value > 1024) {
+      throw ConfigException(config::errors::invalid_fastcgi_pass);
+    }
+    keepalive = static_cast<int>(value);
+  }
+  std::string address = config::utils::removeSemicolon(tokens[1]);
+  const std::string& prefix = config::section::fastcgi_unix_prefix;
+  if (address.compare(0, prefix.size(), prefix) == 0) {
+    if (address.size() == prefix.size()) {
+      throw ConfigException(config::errors::invalid_fastcgi_pass);
+    }
+  } else {
+    std::string::size_type colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 ||
+        !config::utils::isValidHost(address.substr(0, colon))) {
+      throw ConfigException(config::errors::invalid_fastcgi_pass);
+    }
+    std::string port = address.substr(colon + 1);
+    char* end = 0;
+    long value = std::strtol(port.c_str(), &end, 10);
+    if (port.empty() || *end != '\0' || value < 1 ||
+        value > config::section::max_port) {
+      throw ConfigException(config::errors::invalid_fastcgi_pass);
+    }
+  }
+  loc.setFastCgiPass(address, keepalive);
+}
+
+/**
+ * fastcgi_spawn /usr/bin/php-cgi 4;
+ * The server listens on the fastcgi_pass address itself and keeps N copies
+ * of the program running with the listening socket as their stdin.
+ */
+void ConfigParser::parseFastCgiSpawn(LocationConfig& loc,
+                                     const std::vector<std::string>& tokens) {
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    throw ConfigException(config::errors::invalid_fastcgi_spawn);
+  }
+  std::string program = config::utils::removeSemicolon(tokens[1]);
+  int workers = config::section::default_fastcgi_workers;
+  if (tokens.size() == 3) {
+    std::string count = config::utils::removeSemicolon(tokens[2]);
+    char* end = 0;
+    long value = std::strtol(count.c_str(), &end, 10);
+    if (count.empty() || *end != '\0' || value < 1 ||
+        value > config::section::max_fastcgi_workers) {
+      throw ConfigException(config::errors::invalid_fastcgi_spawn);
+    }
+    workers = static_cast<int>(value);
+  }
+  if (program.empty()) {
+    throw ConfigException(config::errors::invalid_fastcgi_spawn);
+  }
+  loc.setFastCgiSpawn(program, workers);
+}
+
+/**
+ * handler /usr/lib/webserv/api.so;
+ * Requests of the location are answered by that module inside the event
+ * loop. The file is loaded when the server starts, not here.
+ */
+void ConfigParser::parseHandler(LocationConfig& loc,
+                                const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_handler);
+  }
+  std::string path = config::utils::removeSemicolon(tokens[1]);
+  if (path.empty()) {
+    throw ConfigException(config::errors::invalid_handler);
+  }
+  loc.setHandler(path);
+}
+
+/**
+ * expires 7d;   expires max;   expires off;
+ * How long clients may reuse a static file without asking again; sent as
+ * Cache-Control max-age.
+ */
+void ConfigParser::parseExpires(LocationConfig& loc,
+                                const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_expires);
+  }
+  std::string value = config::utils::removeSemicolon(tokens[1]);
+  if (value == config::section::expires_off)
+    loc.setExpires(-1);
+  else if (value == config::section::expires_max)
+    loc.setExpires(config::section::expires_max_seconds);
+  else
+    loc.setExpires(config::utils::parseDuration(value));
+}
+
+/**
+ * cache_control public, immutable;
+ * Directives added verbatim after the max-age of 'expires'.
+ */
+void ConfigParser::parseCacheControl(LocationConfig& loc,
+                                     const std::vector<std::string>& tokens) {
+  std::string value;
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    std::string word = config::utils::removeSemicolon(tokens[i]);
+    if (word.empty()) continue;
+    if (!value.empty()) value += " ";
+    value += word;
+  }
+  if (value.empty()) {
+    throw ConfigException(config::errors::missing_args_in_cache_control);
+  }
+  loc.setCacheControl(value);
+}
+
+/**
+ * gzip_static on;   -> send "file.gz" (if present) to clients accepting gzip
+ * gzip on;          -> compress text responses on the fly
+ */
+void ConfigParser::parseGzip(LocationConfig& loc, const std::string& directive,
+                             const std::vector<std::string>& tokens) {
+  if (tokens.size() != 2) {
+    throw ConfigException(config::errors::invalid_gzip);
+  }
+  std::string value = config::utils::removeSemicolon(tokens[1]);
+  if (value != config::section::gzip_on && value != config::section::gzip_off) {
+    throw ConfigException(config::errors::invalid_gzip);
+  }
+  if (directive == config::section::gzip_static)
+    loc.setGzipStatic(value == config::section::gzip_on);
+  else
+    loc.setGzip(value == config::section::gzip_on);
+}
+
 void ConfigParser::parseServerName(ServerConfig& server,
                                    const std::vector<std::string>& tokens) {
-  server.setServerName(config::utils::removeSemicolon(tokens[1]));
+  // server_name example.com www.example.com *.example.com;
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    std::string name = config::utils::removeSemicolon(tokens[i]);
+    if (!name.empty()) server.addServerName(name);
+  }
+}
+
+/**
+ * access_log off;
+ * access_log logs/access.log;            (combined format)
+ * access_log logs/access.log combined;
+ * access_log logs/access.log '$remote_addr "$request" $status $request_time';
+ *
+ * The format is the rest of the line, without the quotes around it (single
+ * quotes leave double quotes free for the log line itself).
+ */
+void ConfigParser::parseAccessLog(ServerConfig& server,
+                                  const std::string& line) {
+  std::string rest = line.substr(config::section::access_log.size());
+  rest = rest.substr(0, rest.find_last_not_of(" ;") + 1);
+  size_t pathStart = rest.find_first_not_of(' ');
+  if (pathStart == std::string::npos) {
+    throw ConfigException(config::errors::invalid_access_log);
+  }
+  size_t pathEnd = rest.find(' ', pathStart);
+  std::string path = rest.substr(pathStart, pathEnd - pathStart);
+  std::string format;
+  if (pathEnd != std::string::npos) {
+    format = rest.substr(rest.find_first_not_of(' ', pathEnd));
+  }
+  if (format.size() >= 2 && (format[0] == '\'' || format[0] == '"') &&
+      format[format.size() - 1] == format[0]) {
+    format = format.substr(1, format.size() - 2);
+  }
+
+  if (path == config::section::access_log_off) {
+    if (!format.empty()) {
+      throw ConfigException(config::errors::invalid_access_log);
+    }
+    server.setAccessLog("", "");
+    return;
+  }
+  if (format.empty() || format == config::section::access_log_combined) {
+    format = config::section::access_log_combined_format;
+  }
+  server.setAccessLog(path, format);
 }
 
 void ConfigParser::parseLocationBlock(ServerConfig& server,
@@ -463,6 +1002,7 @@ void ConfigParser::parseLocationBlock(ServerConfig& server,
 
   LocationConfig loc;
   loc.setPath(locationPath);
+  loc.setExactMatch(modifier == config::section::exact_match_modifier);
 
   while (std::getline(ss, line)) {
     line = config::utils::trimLine(line);
@@ -511,11 +1051,30 @@ void ConfigParser::parseLocationBlock(ServerConfig& server,
     } else if (directive == config::section::uploads_bonus ||
                directive == config::section::upload_bonus) {
       parseUploadBonus(loc, locTokens);
-    } else if (directive == config::section::cgi ||
-               directive == config::section::cgi_fast) {
+    } else if (directive == config::section::cgi) {
       parseCgi(loc, locTokens);
+    } else if (directive == config::section::cgi_fast) {
+      parseFastCgiPass(loc, locTokens);
+    } else if (directive == config::section::fastcgi_spawn) {
+      parseFastCgiSpawn(loc, locTokens);
+    } else if (directive == config::section::handler) {
+      parseHandler(loc, locTokens);
+    } else if (directive == config::section::expires) {
+      parseExpires(loc, locTokens);
+    } else if (directive == config::section::cache_control) {
+      parseCacheControl(loc, locTokens);
+    } else if (directive == config::section::gzip_static ||
+               directive == config::section::gzip) {
+      parseGzip(loc, directive, locTokens);
     }
   }
+  if (!loc.getFastCgiSpawn().empty() && loc.getFastCgiPass().empty()) {
+    throw ConfigException(config::errors::fastcgi_spawn_without_pass);
+  }
+  if (!loc.getHandler().empty() &&
+      (!loc.getCgiHandlers().empty() || !loc.getFastCgiPass().empty())) {
+    throw ConfigException(config::errors::handler_with_cgi);
+  }
   server.addLocation(loc);
 }
 
@@ -547,15 +1106,19 @@ ServerConfig ConfigParser::parseSingleServerBlock(
       parseIndex(server, tokens);
     } else if (directive == config::section::client_max_body_size) {
       parseMaxSizeBody(server, tokens);
+    } else if (directive == config::section::client_body_buffer_size) {
+      parseBodyBufferSize(server, tokens);
     } else if (directive == config::section::error_page) {
       parseErrorPage(server, tokens);
+    } else if (directive == config::section::access_log) {
+      parseAccessLog(server, line);
     }
-    //	TODO: this case fail(the char '='): location = /50x.html {
     else if (directive == config::section::location) {
       parseLocationBlock(server, ss, line, tokens);
     }
     ++indexTokens;
   }
+  server.buildCgiEnvironments();
   return server;
 }
 
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "GlobalConfig.hpp"
 #include "ServerConfig.hpp"
 
 class ConfigParser {
@@ -18,6 +19,7 @@ class ConfigParser {
   const std::string& getConfigFilePath() const;
   size_t getServerCount() const;
   const std::vector<ServerConfig>& getServers() const;
+  const GlobalConfig& getGlobalConfig() const;
 
   void parse();
 
@@ -27,6 +29,7 @@ class ConfigParser {
   size_t servers_count_;
   std::vector<std::string> raw_server_blocks_;
   std::vector<ServerConfig> servers_;
+  GlobalConfig global_config_;
 
   // constructors of copy and operator
   ConfigParser(const ConfigParser& other);
@@ -41,9 +44,21 @@ class ConfigParser {
   void splitContentIntoServerBlocks(const std::string& content,
                                     const std::string& typeOfExtraction);
   void parseAllServerBlocks();
+  void parseGlobalDirectives();
+  void parseWorkerProcesses(const std::vector<std::string>& tokens);
+  void parseOpenFileCache(const std::vector<std::string>& tokens);
+  void parseResponseCache(const std::vector<std::string>& tokens);
+  void parseGzipCache(const std::vector<std::string>& tokens);
+  void parseEdgeTriggered(const std::vector<std::string>& tokens);
+  void parseClientReadSize(const std::vector<std::string>& tokens);
+  void parseEventBackend(const std::vector<std::string>& tokens);
+  void parseTimeout(const std::string& directive,
+                    const std::vector<std::string>& tokens);
   void parseListen(ServerConfig& server,
                    const std::vector<std::string>& tokens);
   void parseHost(ServerConfig& server, const std::vector<std::string>& tokens);
+  void parseBodyBufferSize(ServerConfig& server,
+                           const std::vector<std::string>& tokens);
   void parseMaxSizeBody(ServerConfig& server,
                         const std::vector<std::string>& tokens);
   void parseErrorPage(ServerConfig& server, std::vector<std::string>& tokens);
@@ -53,8 +68,22 @@ class ConfigParser {
   void parseRoot(ServerConfig& server, const std::vector<std::string>& tokens);
   void parseIndex(ServerConfig& server, const std::vector<std::string>& tokens);
   void parseCgi(LocationConfig& loc, const std::vector<std::string>& tokens);
+  void parseFastCgiPass(LocationConfig& loc,
+                        const std::vector<std::string>& tokens);
+  void parseFastCgiSpawn(LocationConfig& loc,
+                         const std::vector<std::string>& tokens);
+  void parseHandler(LocationConfig& loc,
+                    const std::vector<std::string>& tokens);
+  void parseExpires(LocationConfig& loc,
+                    const std::vector<std::string>& tokens);
+  void parseCacheControl(LocationConfig& loc,
+                         const std::vector<std::string>& tokens);
+  void parseGzip(LocationConfig& loc, const std::string& directive,
+                 const std::vector<std::string>& tokens);
   void parseServerName(ServerConfig& server,
                        const std::vector<std::string>& tokens);
+  // Takes the whole line: the format may hold quotes and spaces.
+  void parseAccessLog(ServerConfig& server, const std::string& line);
   void parseLocationBlock(ServerConfig& server, std::stringstream& ss,
                           std::string& line, std::vector<std::string>& tokens);
   ServerConfig parseSingleServerBlock(const std::string& blockContent);
@@ -251,6 +251,32 @@ long parseSize(const std::string& str) {
   return value;
 }
 
+int parseDuration(const std::string& str) {
+  char* end;
+  long value = std::strtol(str.c_str(), &end, 10);
+
+  if (str.empty() || end == str.c_str() || value < 0 ||
+      !std::isdigit(static_cast<unsigned char>(str[0]))) {
+    throw ConfigException(config::errors::invalid_duration + str);
+  }
+
+  std::string suffix = end;
+  long unit = 1;
+  if (suffix == "m")
+    unit = 60;
+  else if (suffix == "h")
+    unit = 3600;
+  else if (suffix == "d")
+    unit = 86400;
+  else if (!suffix.empty() && suffix != "s")
+    throw ConfigException(config::errors::invalid_duration + str);
+
+  if (value > std::numeric_limits<int>::max() / unit) {
+    throw ConfigException(config::errors::number_out_of_range);
+  }
+  return static_cast<int>(value * unit);
+}
+
 // ============================================================================
 // New validation functions for TDD
 // ============================================================================
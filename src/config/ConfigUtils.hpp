@@ -45,6 +45,10 @@ bool isValidPath(const std::string& path);
 /** @brief Parses a size string (e.g., "1k", "1m") into bytes.*/
 long parseSize(const std::string& str);
 
+/** @brief Parses a time string (e.g., "30", "30s", "5m", "1h", "7d") into
+ * seconds.*/
+int parseDuration(const std::string& str);
+
 // New validation functions for TDD
 
 /** @brief Validates an IPv4 address string.*/
@@ -0,0 +1,184 @@
+#include "GlobalConfig.hpp"
+
+#include "ConfigException.hpp"
+
+GlobalConfig::GlobalConfig()
+    : worker_processes_(config::section::default_worker_processes),
+      open_file_cache_max_(0),
+      open_file_cache_inactive_(
+          config::section::default_open_file_cache_inactive),
+      response_cache_size_(0),
+      response_cache_max_object_(
+          config::section::default_response_cache_max_object),
+      gzip_cache_size_(config::section::default_gzip_cache_size),
+      gzip_cache_max_object_(
+          config::section::default_gzip_cache_max_object),
+      client_header_timeout_(config::section::default_client_timeout),
+      client_body_timeout_(config::section::default_client_timeout),
+      keepalive_timeout_(config::section::default_client_timeout),
+      send_timeout_(config::section::default_client_timeout),
+      cgi_timeout_(config::section::default_cgi_timeout),
+      edge_triggered_(false),
+      client_read_size_(config::section::default_client_read_size),
+      event_backend_(config::section::event_backend_auto) {}
+
+GlobalConfig::GlobalConfig(const GlobalConfig& other)
+    : worker_processes_(other.worker_processes_),
+      open_file_cache_max_(other.open_file_cache_max_),
+      open_file_cache_inactive_(other.open_file_cache_inactive_),
+      response_cache_size_(other.response_cache_size_),
+      response_cache_max_object_(other.response_cache_max_object_),
+      gzip_cache_size_(other.gzip_cache_size_),
+      gzip_cache_max_object_(other.gzip_cache_max_object_),
+      client_header_timeout_(other.client_header_timeout_),
+      client_body_timeout_(other.client_body_timeout_),
+      keepalive_timeout_(other.keepalive_timeout_),
+      send_timeout_(other.send_timeout_),
+      cgi_timeout_(other.cgi_timeout_),
+      edge_triggered_(other.edge_triggered_),
+      client_read_size_(other.client_read_size_),
+      event_backend_(other.event_backend_) {}
+
+GlobalConfig& GlobalConfig::operator=(const GlobalConfig& other) {
+  if (this != &other) {
+    worker_processes_ = other.worker_processes_;
+    open_file_cache_max_ = other.open_file_cache_max_;
+    open_file_cache_inactive_ = other.open_file_cache_inactive_;
+    response_cache_size_ = other.response_cache_size_;
+    response_cache_max_object_ = other.response_cache_max_object_;
+    gzip_cache_size_ = other.gzip_cache_size_;
+    gzip_cache_max_object_ = other.gzip_cache_max_object_;
+    client_header_timeout_ = other.client_header_timeout_;
+    client_body_timeout_ = other.client_body_timeout_;
+    keepalive_timeout_ = other.keepalive_timeout_;
+    send_timeout_ = other.send_timeout_;
+    cgi_timeout_ = other.cgi_timeout_;
+    edge_triggered_ = other.edge_triggered_;
+    client_read_size_ = other.client_read_size_;
+    event_backend_ = other.event_backend_;
+  }
+  return *this;
+}
+
+GlobalConfig::~GlobalConfig() {}
+
+//	SETTERS
+void GlobalConfig::setWorkerProcesses(int count) {
+  if (count < 1 || count > config::section::max_worker_processes) {
+    throw ConfigException(config::errors::invalid_worker_processes);
+  }
+  worker_processes_ = count;
+}
+
+void GlobalConfig::setOpenFileCache(int maxEntries, int inactiveSeconds) {
+  if (maxEntries < 0 || inactiveSeconds < 0) {
+    throw ConfigException(config::errors::invalid_open_file_cache);
+  }
+  open_file_cache_max_ = maxEntries;
+  open_file_cache_inactive_ = inactiveSeconds;
+}
+
+void GlobalConfig::setResponseCache(long sizeBytes, long maxObjectBytes) {
+  if (sizeBytes < 0 || maxObjectBytes < 1 ||
+      (sizeBytes > 0 && maxObjectBytes > sizeBytes)) {
+    throw ConfigException(config::errors::invalid_response_cache);
+  }
+  response_cache_size_ = sizeBytes;
+  response_cache_max_object_ = maxObjectBytes;
+}
+
+void GlobalConfig::setGzipCache(long sizeBytes, long maxObjectBytes) {
+  if (sizeBytes < 0 || maxObjectBytes < 1 ||
+      (sizeBytes > 0 && maxObjectBytes > sizeBytes)) {
+    throw ConfigException(config::errors::invalid_gzip_cache);
+  }
+  gzip_cache_size_ = sizeBytes;
+  gzip_cache_max_object_ = maxObjectBytes;
+}
+
+static int checkTimeout(int seconds) {
+  if (seconds < 1) {
+    throw ConfigException(config::errors::invalid_timeout);
+  }
+  return seconds;
+}
+
+void GlobalConfig::setClientHeaderTimeout(int seconds) {
+  client_header_timeout_ = checkTimeout(seconds);
+}
+
+void GlobalConfig::setClientBodyTimeout(int seconds) {
+  client_body_timeout_ = checkTimeout(seconds);
+}
+
+void GlobalConfig::setKeepaliveTimeout(int seconds) {
+  keepalive_timeout_ = checkTimeout(seconds);
+}
+
+void GlobalConfig::setSendTimeout(int seconds) {
+  send_timeout_ = checkTimeout(seconds);
+}
+
+void GlobalConfig::setCgiTimeout(int seconds) {
+  cgi_timeout_ = checkTimeout(seconds);
+}
+
+void GlobalConfig::setEdgeTriggered(bool enabled) { edge_triggered_ = enabled; }
+
+void GlobalConfig::setClientReadSize(long bytes) {
+  if (bytes < config::section::min_client_read_size ||
+      bytes > config::section::max_client_read_size) {
+    throw ConfigException(config::errors::invalid_client_read_size);
+  }
+  client_read_size_ = bytes;
+}
+
+void GlobalConfig::setEventBackend(const std::string& name) {
+  if (name != config::section::event_backend_auto &&
+      name != config::section::event_backend_epoll &&
+      name != config::section::event_backend_io_uring) {
+    throw ConfigException(config::errors::invalid_event_backend);
+  }
+  event_backend_ = name;
+}
+
+//	GETTERS
+int GlobalConfig::getWorkerProcesses() const { return worker_processes_; }
+
+int GlobalConfig::getOpenFileCacheMax() const { return open_file_cache_max_; }
+
+int GlobalConfig::getOpenFileCacheInactive() const {
+  return open_file_cache_inactive_;
+}
+
+long GlobalConfig::getResponseCacheSize() const { return response_cache_size_; }
+
+long GlobalConfig::getResponseCacheMaxObject() const {
+  return response_cache_max_object_;
+}
+
+long GlobalConfig::getGzipCacheSize() const { return gzip_cache_size_; }
+
+long GlobalConfig::getGzipCacheMaxObject() const {
+  return gzip_cache_max_object_;
+}
+
+int GlobalConfig::getClientHeaderTimeout() const {
+  return client_header_timeout_;
+}
+
+int GlobalConfig::getClientBodyTimeout() const { return client_body_timeout_; }
+
+int GlobalConfig::getKeepaliveTimeout() const { return keepalive_timeout_; }
+
+int GlobalConfig::getSendTimeout() const { return send_timeout_; }
+
+int GlobalConfig::getCgiTimeout() const { return cgi_timeout_; }
+
+bool GlobalConfig::getEdgeTriggered() const { return edge_triggered_; }
+
+long GlobalConfig::getClientReadSize() const { return client_read_size_; }
+
+const std::string& GlobalConfig::getEventBackend() const {
+  return event_backend_;
+}
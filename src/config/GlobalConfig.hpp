@@ -0,0 +1,125 @@
+#ifndef WEBSERV_GLOBALCONFIG_HPP
+#define WEBSERV_GLOBALCONFIG_HPP
+
+#include <iostream>
+#include <string>
+
+#include "../common/namespaces.hpp"
+
+/**
+ * GlobalConfig stores the directives that live outside of any server { }
+ * block (the nginx "main" context):
+ *
+ * worker_processes 4;      # or 'auto' (one per online CPU)
+ * open_file_cache max=1000 inactive=60s;   # or 'off' (default)
+ * response_cache size=8m max_object=64k;   # or 'off' (default)
+ * gzip_cache size=4m max_object=1m;        # or 'off' (compress every time)
+ * client_header_timeout 60s;   # whole request line + headers
+ * client_body_timeout 60s;     # between two reads of the body
+ * keepalive_timeout 60s;       # idle connection between requests
+ * send_timeout 60s;            # between two writes of the response
+ * cgi_timeout 5s;              # whole CGI execution
+ * edge_triggered on;           # EPOLLET client sockets (default off)
+ * client_read_size 16k;        # bytes per recv() on a client socket
+ * event_backend auto;          # epoll, io_uring or auto (io_uring if usable)
+ * server { ... }
+ */
+class GlobalConfig {
+ public:
+  GlobalConfig();
+  GlobalConfig(const GlobalConfig& other);
+  GlobalConfig& operator=(const GlobalConfig& other);
+  ~GlobalConfig();
+
+  // Setters
+  void setWorkerProcesses(int count);
+  void setOpenFileCache(int maxEntries, int inactiveSeconds);
+  void setResponseCache(long sizeBytes, long maxObjectBytes);
+  void setGzipCache(long sizeBytes, long maxObjectBytes);
+  void setClientHeaderTimeout(int seconds);
+  void setClientBodyTimeout(int seconds);
+  void setKeepaliveTimeout(int seconds);
+  void setSendTimeout(int seconds);
+  void setCgiTimeout(int seconds);
+  void setEdgeTriggered(bool enabled);
+  void setClientReadSize(long bytes);
+  void setEventBackend(const std::string& name);
+
+  // Getters
+  int getWorkerProcesses() const;
+  int getOpenFileCacheMax() const;  // 0 = cache disabled
+  int getOpenFileCacheInactive() const;
+  long getResponseCacheSize() const;  // 0 = cache disabled
+  long getResponseCacheMaxObject() const;
+  long getGzipCacheSize() const;  // 0 = compressed files are not kept
+  long getGzipCacheMaxObject() const;  // also the on-the-fly gzip limit
+  int getClientHeaderTimeout() const;  // seconds, as every timeout below
+  int getClientBodyTimeout() const;
+  int getKeepaliveTimeout() const;
+  int getSendTimeout() const;
+  int getCgiTimeout() const;
+  bool getEdgeTriggered() const;
+  long getClientReadSize() const;
+  const std::string& getEventBackend() const;
+
+ private:
+  int worker_processes_;
+  int open_file_cache_max_;
+  int open_file_cache_inactive_;
+  long response_cache_size_;
+  long response_cache_max_object_;
+  long gzip_cache_size_;
+  long gzip_cache_max_object_;
+  int client_header_timeout_;
+  int client_body_timeout_;
+  int keepalive_timeout_;
+  int send_timeout_;
+  int cgi_timeout_;
+  bool edge_triggered_;
+  long client_read_size_;
+  std::string event_backend_;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const GlobalConfig& config) {
+  os << config::colors::blue << config::colors::bold << "Global Config:\n"
+     << config::colors::reset << "\t" << config::colors::yellow
+     << "Worker processes: " << config::colors::reset << config::colors::green
+     << config.getWorkerProcesses() << config::colors::reset << "\n\t"
+     << config::colors::yellow << "Open file cache: " << config::colors::reset
+     << config::colors::green;
+  if (config.getOpenFileCacheMax() > 0)
+    os << "max=" << config.getOpenFileCacheMax()
+       << " inactive=" << config.getOpenFileCacheInactive() << "s";
+  else
+    os << "off";
+  os << config::colors::reset << "\n\t" << config::colors::yellow
+     << "Response cache: " << config::colors::reset << config::colors::green;
+  if (config.getResponseCacheSize() > 0)
+    os << "size=" << config.getResponseCacheSize()
+       << " max_object=" << config.getResponseCacheMaxObject();
+  else
+    os << "off";
+  os << config::colors::reset << "\n\t" << config::colors::yellow
+     << "Gzip cache: " << config::colors::reset << config::colors::green;
+  if (config.getGzipCacheSize() > 0)
+    os << "size=" << config.getGzipCacheSize();
+  else
+    os << "off";
+  os << " max_object=" << config.getGzipCacheMaxObject();
+  os << config::colors::reset << "\n\t" << config::colors::yellow
+     << "Timeouts: " << config::colors::reset << config::colors::green
+     << "header=" << config.getClientHeaderTimeout()
+     << "s body=" << config.getClientBodyTimeout()
+     << "s keepalive=" << config.getKeepaliveTimeout()
+     << "s send=" << config.getSendTimeout()
+     << "s cgi=" << config.getCgiTimeout() << "s" << config::colors::reset
+     << "\n\t" << config::colors::yellow << "Client sockets: "
+     << config::colors::reset << config::colors::green
+     << (config.getEdgeTriggered() ? "edge" : "level")
+     << "-triggered, read_size=" << config.getClientReadSize()
+     << ", backend=" << config.getEventBackend() << config::colors::reset
+     << "\n";
+  return os;
+}
+
+#endif  // WEBSERV_GLOBALCONFIG_HPP
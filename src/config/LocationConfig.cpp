@@ -1,34 +1,65 @@
 #include "LocationConfig.hpp"
 
 #include <iostream>
+#include <sstream>
 
 LocationConfig::LocationConfig()
-    : autoindex_(false), redirect_code_(-1), redirect_param_count_(0) {}
+    : exact_match_(false),
+      autoindex_(false),
+      expires_(-1),
+      gzip_static_(false),
+      gzip_(false),
+      redirect_code_(-1),
+      redirect_param_count_(0),
+      fastcgi_keepalive_(-1),
+      fastcgi_workers_(config::section::default_fastcgi_workers) {}
 
 LocationConfig::LocationConfig(const LocationConfig& other)
     : path_(other.path_),
+      exact_match_(other.exact_match_),
       root_(other.root_),
       indexes_(other.indexes_),
       allowed_methods_(other.allowed_methods_),
       autoindex_(other.autoindex_),
+      expires_(other.expires_),
+      cache_control_(other.cache_control_),
+      gzip_static_(other.gzip_static_),
+      gzip_(other.gzip_),
       upload_store_(other.upload_store_),
       redirect_code_(other.redirect_code_),
       redirect_url_(other.redirect_url_),
       redirect_param_count_(other.redirect_param_count_),
-      cgi_handlers_(other.cgi_handlers_) {}
+      cgi_handlers_(other.cgi_handlers_),
+      fastcgi_pass_(other.fastcgi_pass_),
+      fastcgi_keepalive_(other.fastcgi_keepalive_),
+      fastcgi_spawn_(other.fastcgi_spawn_),
+      fastcgi_workers_(other.fastcgi_workers_),
+      handler_(other.handler_),
+      cgi_environment_(other.cgi_environment_) {}
 
 LocationConfig& LocationConfig::operator=(const LocationConfig& other) {
   if (this != &other) {
     path_ = other.path_;
+    exact_match_ = other.exact_match_;
     root_ = other.root_;
     indexes_ = other.indexes_;
     allowed_methods_ = other.allowed_methods_;
     autoindex_ = other.autoindex_;
+    expires_ = other.expires_;
+    cache_control_ = other.cache_control_;
+    gzip_static_ = other.gzip_static_;
+    gzip_ = other.gzip_;
     upload_store_ = other.upload_store_;
     redirect_code_ = other.redirect_code_;
     redirect_url_ = other.redirect_url_;
     redirect_param_count_ = other.redirect_param_count_;
     cgi_handlers_ = other.cgi_handlers_;
+    fastcgi_pass_ = other.fastcgi_pass_;
+    fastcgi_keepalive_ = other.fastcgi_keepalive_;
+    fastcgi_spawn_ = other.fastcgi_spawn_;
+    fastcgi_workers_ = other.fastcgi_workers_;
+    handler_ = other.handler_;
+    cgi_environment_ = other.cgi_environment_;
   }
   return *this;
 }
@@ -36,6 +67,7 @@ LocationConfig& LocationConfig::operator=(const LocationConfig& other) {
 LocationConfig::~LocationConfig() {}
 
 void LocationConfig::setPath(const std::string& path) { path_ = path; }
+void LocationConfig::setExactMatch(bool exact) { exact_match_ = exact; }
 void LocationConfig::setRoot(const std::string& root) { root_ = root; }
 
 void LocationConfig::addIndex(const std::string& index) {
@@ -50,6 +82,16 @@ void LocationConfig::setAutoIndex(const bool autoindex) {
   autoindex_ = autoindex;
 }
 
+void LocationConfig::setExpires(int seconds) { expires_ = seconds; }
+
+void LocationConfig::setCacheControl(const std::string& value) {
+  cache_control_ = value;
+}
+
+void LocationConfig::setGzipStatic(bool enabled) { gzip_static_ = enabled; }
+
+void LocationConfig::setGzip(bool enabled) { gzip_ = enabled; }
+
 void LocationConfig::setUploadStore(const std::string& store) {
   upload_store_ = store;
 }
@@ -72,7 +114,37 @@ void LocationConfig::addCgiHandler(const std::string& extension,
       std::pair<std::string, std::string>(extension, binaryPath));
 }
 
+void LocationConfig::setFastCgiPass(const std::string& address,
+                                    int keepalive) {
+  fastcgi_pass_ = address;
+  fastcgi_keepalive_ = keepalive;
+}
+
+void LocationConfig::setFastCgiSpawn(const std::string& program, int workers) {
+  fastcgi_spawn_ = program;
+  fastcgi_workers_ = workers;
+}
+
+void LocationConfig::setHandler(const std::string& modulePath) {
+  handler_ = modulePath;
+}
+
+void LocationConfig::buildCgiEnvironment(const std::string& serverName,
+                                         int port) {
+  std::ostringstream portStr;
+  portStr << port;
+  cgi_environment_.clear();
+  cgi_environment_.push_back("GATEWAY_INTERFACE=CGI/1.1");
+  cgi_environment_.push_back("SERVER_PROTOCOL=HTTP/1.1");
+  cgi_environment_.push_back("SERVER_SOFTWARE=Webserv/1.0");
+  cgi_environment_.push_back("SERVER_NAME=" + serverName);
+  cgi_environment_.push_back("SERVER_PORT=" + portStr.str());
+  cgi_environment_.push_back("PATH_TRANSLATED=");
+  cgi_environment_.push_back("REDIRECT_STATUS=200");  // required by php-cgi
+}
+
 const std::string& LocationConfig::getPath() const { return path_; }
+bool LocationConfig::isExactMatch() const { return exact_match_; }
 const std::string& LocationConfig::getRoot() const { return root_; }
 
 const std::vector<std::string>& LocationConfig::getIndexes() const {
@@ -85,6 +157,16 @@ const std::vector<std::string>& LocationConfig::getMethods() const {
 
 bool LocationConfig::getAutoIndex() const { return autoindex_; }
 
+int LocationConfig::getExpires() const { return expires_; }
+
+const std::string& LocationConfig::getCacheControl() const {
+  return cache_control_;
+}
+
+bool LocationConfig::getGzipStatic() const { return gzip_static_; }
+
+bool LocationConfig::getGzip() const { return gzip_; }
+
 const std::string& LocationConfig::getUploadStore() const {
   return upload_store_;
 }
@@ -114,6 +196,24 @@ const std::map<std::string, std::string>& LocationConfig::getCgiHandlers()
   return cgi_handlers_;
 }
 
+const std::string& LocationConfig::getFastCgiPass() const {
+  return fastcgi_pass_;
+}
+
+int LocationConfig::getFastCgiKeepalive() const { return fastcgi_keepalive_; }
+
+const std::string& LocationConfig::getFastCgiSpawn() const {
+  return fastcgi_spawn_;
+}
+
+int LocationConfig::getFastCgiWorkers() const { return fastcgi_workers_; }
+
+const std::string& LocationConfig::getHandler() const { return handler_; }
+
+const std::vector<std::string>& LocationConfig::getCgiEnvironment() const {
+  return cgi_environment_;
+}
+
 /**
  * this function are doing two actions is possible we need to refactor the
  * impplementation ?
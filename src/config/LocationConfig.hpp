@@ -18,9 +18,12 @@
  * - allowed HTTP methods (GET, POST, DELETE, HEAD)
  * - default index files in a vector
  * - autoindex status boolean
+ * - client caching of static files (expires, cache_control)
+ * - compression (gzip_static, gzip)
  * - file upload directory
  * - HTTP redirection
  * - CGI handlers like a map
+ * - an in-process content handler module (handler /path/module.so)
  */
 class LocationConfig {
  public:
@@ -31,29 +34,65 @@ class LocationConfig {
 
   // Setters
   void setPath(const std::string& path);
+  // 'location = /path': only that exact path, no prefix matching.
+  void setExactMatch(bool exact);
   void setRoot(const std::string& root);
   void addIndex(const std::string& index);
   void addMethod(const std::string& method);
   void setAutoIndex(bool autoindex);
+  // Seconds clients may reuse a static file without revalidating; -1 = off.
+  void setExpires(int seconds);
+  void setCacheControl(const std::string& value);
+  void setGzipStatic(bool enabled);
+  void setGzip(bool enabled);
   void setUploadStore(const std::string& store);
   void setRedirectCode(int integerCode);
   void setRedirectUrl(const std::string& redirectUrl);
   void setRedirectParamCount(int count);
   void addCgiHandler(const std::string& extension,
                      const std::string& binaryPath);
+  void setFastCgiPass(const std::string& address, int keepalive);
+  void setFastCgiSpawn(const std::string& program, int workers);
+  void setHandler(const std::string& modulePath);
+  // Fill getCgiEnvironment() once the enclosing server block is parsed.
+  void buildCgiEnvironment(const std::string& serverName, int port);
 
   // Getters
   const std::string& getPath() const;
+  bool isExactMatch() const;
   const std::string& getRoot() const;
   const std::vector<std::string>& getIndexes() const;
   const std::vector<std::string>& getMethods() const;
   bool getAutoIndex() const;
+  int getExpires() const;
+  // Extra Cache-Control directives ("public, immutable"); may be empty.
+  const std::string& getCacheControl() const;
+  // Serve "file.gz" instead of "file" to clients that accept gzip.
+  bool getGzipStatic() const;
+  // Compress text responses (files, autoindex, CGI output) on the fly.
+  bool getGzip() const;
   const std::string& getUploadStore() const;
   int getRedirectCode() const;
   const std::string& getRedirectUrl() const;
   int getRedirectParamCount() const;
   std::string getCgiPath(const std::string& extension) const;
   const std::map<std::string, std::string>& getCgiHandlers() const;
+  // "unix:/path" or "host:port"; empty when the location is not FastCGI.
+  const std::string& getFastCgiPass() const;
+  // Idle connections kept per worker process; -1 = derive from the
+  // managed pool size (0 for external servers).
+  int getFastCgiKeepalive() const;
+  // Program the server starts (and restarts) to listen on getFastCgiPass();
+  // empty when the FastCGI server is managed externally.
+  const std::string& getFastCgiSpawn() const;
+  int getFastCgiWorkers() const;
+  // Shared object that answers every request of the location inside the
+  // event loop (src/module); empty when there is none.
+  const std::string& getHandler() const;
+  // CGI/1.1 variables that only depend on the configuration
+  // (GATEWAY_INTERFACE, SERVER_NAME, SERVER_PORT...) as "NAME=value";
+  // CgiExecutor appends the per-request ones.
+  const std::vector<std::string>& getCgiEnvironment() const;
 
   // Validation
   bool isMethodAllowed(const std::string& method) const;
@@ -63,15 +102,26 @@ class LocationConfig {
 
  private:
   std::string path_;
+  bool exact_match_;
   std::string root_;
   std::vector<std::string> indexes_;
   std::vector<std::string> allowed_methods_;
   bool autoindex_;
+  int expires_;
+  std::string cache_control_;
+  bool gzip_static_;
+  bool gzip_;
   std::string upload_store_;
   int redirect_code_;
   std::string redirect_url_;
   int redirect_param_count_;
   std::map<std::string, std::string> cgi_handlers_;
+  std::string fastcgi_pass_;
+  int fastcgi_keepalive_;
+  std::string fastcgi_spawn_;
+  int fastcgi_workers_;
+  std::string handler_;
+  std::vector<std::string> cgi_environment_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
@@ -79,7 +129,7 @@ inline std::ostream& operator<<(std::ostream& os,
   os << config::colors::cyan << config::colors::bold << "Locations info:\n"
      << config::colors::reset << "\t" << config::colors::yellow
      << "Location Path: " << config::colors::reset << config::colors::green
-     << location.getPath() << config::colors::reset << "\n"
+     << (location.isExactMatch() ? "= " : "") << location.getPath() << config::colors::reset << "\n"
      << "\t" << config::colors::yellow << "Root: " << config::colors::reset
      << config::colors::green << location.getRoot() << config::colors::reset
      << "\n"
@@ -92,6 +142,23 @@ inline std::ostream& operator<<(std::ostream& os,
   }
   os << config::colors::reset << "\n";
 
+  if (location.getExpires() >= 0 || !location.getCacheControl().empty()) {
+    os << "\t" << config::colors::yellow
+       << "Expires: " << config::colors::reset << config::colors::green;
+    if (location.getExpires() >= 0) os << location.getExpires() << "s";
+    if (!location.getCacheControl().empty())
+      os << " (" << location.getCacheControl() << ")";
+    os << config::colors::reset << "\n";
+  }
+
+  if (location.getGzipStatic() || location.getGzip()) {
+    os << "\t" << config::colors::yellow
+       << "Gzip: " << config::colors::reset << config::colors::green;
+    if (location.getGzipStatic()) os << "static ";
+    if (location.getGzip()) os << "on-the-fly";
+    os << config::colors::reset << "\n";
+  }
+
   if (!location.getUploadStore().empty()) {
     os << "\t" << config::colors::yellow
        << "Upload Store: " << config::colors::reset << config::colors::green
@@ -161,6 +228,21 @@ inline std::ostream& operator<<(std::ostream& os,
          << it->second << config::colors::reset << "\n";
     }
   }
+  if (!location.getFastCgiPass().empty()) {
+    os << "\t" << config::colors::yellow << "FastCGI: " << config::colors::reset
+       << config::colors::green << location.getFastCgiPass();
+    if (location.getFastCgiKeepalive() >= 0)
+      os << " keepalive=" << location.getFastCgiKeepalive();
+    if (!location.getFastCgiSpawn().empty())
+      os << " (spawn " << location.getFastCgiSpawn() << " x"
+         << location.getFastCgiWorkers() << ")";
+    os << config::colors::reset << "\n";
+  }
+  if (!location.getHandler().empty()) {
+    os << "\t" << config::colors::yellow << "Handler: " << config::colors::reset
+       << config::colors::green << location.getHandler()
+       << config::colors::reset << "\n";
+  }
 
   return os;
 }
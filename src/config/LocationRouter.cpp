@@ -0,0 +1,177 @@
+#include "LocationRouter.hpp"
+
+#include <cstring>
+
+namespace {
+
+// FNV-1a
+std::size_t hashPath(const char* data, std::size_t len) {
+  std::size_t hash = 2166136261u;
+  for (std::size_t i = 0; i < len; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool samePath(const std::string& stored, const char* data, std::size_t len) {
+  return stored.size() == len && std::memcmp(stored.data(), data, len) == 0;
+}
+
+}  // namespace
+
+LocationRouter::LocationRouter()
+    : exact_count_(0), first_prefix_(-1), first_location_(-1) {
+  Node root;
+  root.location = -1;
+  nodes_.push_back(root);
+}
+
+void LocationRouter::add(const std::string& path, bool exact, int index) {
+  if (first_location_ < 0) first_location_ = index;
+  if (exact) {
+    addExact(path, index);
+    return;
+  }
+  if (first_prefix_ < 0) first_prefix_ = index;
+  addPrefix(path, index);
+}
+
+int LocationRouter::match(const std::string& path) const {
+  return match(path.data(), path.size());
+}
+
+int LocationRouter::match(const char* path, std::size_t len) const {
+  if (exact_count_ > 0) {
+    std::size_t mask = exact_slots_.size() - 1;
+    for (std::size_t i = hashPath(path, len) & mask;
+         exact_slots_[i].location >= 0; i = (i + 1) & mask) {
+      if (samePath(exact_slots_[i].path, path, len))
+        return exact_slots_[i].location;
+    }
+  }
+
+  int best = -1;
+  int node = 0;
+  std::size_t depth = 0;
+  while (true) {
+    const Node& current = nodes_[node];
+    // A prefix ending in '/' ("/", "/images/") is already on a boundary.
+    if (current.location >= 0 &&
+        (depth == len || path[depth] == '/' ||
+         (depth > 0 && path[depth - 1] == '/')))
+      best = current.location;
+    if (depth == len) break;
+    int child = findChild(node, path[depth]);
+    if (child < 0) break;
+    const std::string& label = nodes_[child].label;
+    if (len - depth < label.size() ||
+        std::memcmp(label.data(), path + depth, label.size()) != 0)
+      break;
+    depth += label.size();
+    node = child;
+  }
+  if (best >= 0) return best;
+  return first_prefix_ >= 0 ? first_prefix_ : first_location_;
+}
+
+void LocationRouter::addPrefix(const std::string& path, int index) {
+  int node = 0;
+  std::size_t pos = 0;
+  while (pos < path.size()) {
+    int child = findChild(node, path[pos]);
+    if (child < 0) {
+      Node leaf;
+      leaf.label = path.substr(pos);
+      leaf.location = index;
+      nodes_.push_back(leaf);
+      insertChild(node, static_cast<int>(nodes_.size()) - 1);
+      return;
+    }
+
+    std::size_t common = 0;
+    {
+      const std::string& label = nodes_[child].label;
+      while (common < label.size() && pos + common < path.size() &&
+             label[common] == path[pos + common])
+        ++common;
+      if (common == label.size()) {
+        node = child;
+        pos += common;
+        continue;
+      }
+    }
+
+    // The path diverges inside the child's label: split it in two. The
+    // new node takes the child's place (same first byte) and the child
+    // keeps the rest of its label.
+    Node split;
+    split.label = nodes_[child].label.substr(0, common);
+    split.location = -1;
+    nodes_[child].label.erase(0, common);
+    nodes_.push_back(split);
+    int splitIndex = static_cast<int>(nodes_.size()) - 1;
+    std::vector<Edge>& edges = nodes_[node].children;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+      if (edges[i].node == child) edges[i].node = splitIndex;
+    }
+    insertChild(splitIndex, child);
+    node = splitIndex;
+    pos += common;
+  }
+  if (nodes_[node].location < 0) nodes_[node].location = index;
+}
+
+void LocationRouter::addExact(const std::string& path, int index) {
+  if ((exact_count_ + 1) * 2 > exact_slots_.size()) growExact();
+  std::size_t mask = exact_slots_.size() - 1;
+  std::size_t i = hashPath(path.data(), path.size()) & mask;
+  for (; exact_slots_[i].location >= 0; i = (i + 1) & mask) {
+    if (exact_slots_[i].path == path) return;
+  }
+  exact_slots_[i].path = path;
+  exact_slots_[i].location = index;
+  ++exact_count_;
+}
+
+void LocationRouter::growExact() {
+  std::vector<ExactSlot> old;
+  old.swap(exact_slots_);
+  ExactSlot empty;
+  empty.location = -1;
+  exact_slots_.assign(old.empty() ? 8 : old.size() * 2, empty);
+  exact_count_ = 0;
+  for (std::size_t i = 0; i < old.size(); ++i) {
+    if (old[i].location >= 0) addExact(old[i].path, old[i].location);
+  }
+}
+
+// Children are sorted by first byte: binary search, since the root may
+// have one child per top-level directory.
+int LocationRouter::findChild(int node, char first) const {
+  const std::vector<Edge>& edges = nodes_[node].children;
+  std::size_t low = 0;
+  std::size_t high = edges.size();
+  while (low < high) {
+    std::size_t mid = (low + high) / 2;
+    if (edges[mid].first == first) return edges[mid].node;
+    if (static_cast<unsigned char>(edges[mid].first) <
+        static_cast<unsigned char>(first))
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return -1;
+}
+
+void LocationRouter::insertChild(int node, int child) {
+  Edge edge;
+  edge.first = nodes_[child].label[0];
+  edge.node = child;
+  std::vector<Edge>& edges = nodes_[node].children;
+  std::vector<Edge>::iterator it = edges.begin();
+  while (it != edges.end() && static_cast<unsigned char>(it->first) <
+                                  static_cast<unsigned char>(edge.first))
+    ++it;
+  edges.insert(it, edge);
+}
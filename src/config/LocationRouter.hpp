@@ -0,0 +1,68 @@
+#ifndef WEBSERV_LOCATIONROUTER_HPP
+#define WEBSERV_LOCATIONROUTER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Maps a request path to the location block that serves it.
+ *
+ * Filled by ServerConfig::addLocation() while the config is parsed and
+ * read-only afterwards. Locations are referred to by their index in the
+ * server's location vector, so copying a ServerConfig keeps it valid.
+ *
+ * - 'location = /path' goes to an open-addressing hash table and only
+ *   matches that exact path; it is checked first.
+ * - Prefix locations go to a radix trie (edges labelled with whole path
+ *   fragments). One walk down the trie finds the longest matching prefix,
+ *   so routing costs O(path length) whatever the number of locations.
+ *
+ * A prefix matches on a segment boundary: "/api" matches "/api" and
+ * "/api/x" but not "/apix"; "/img/" matches "/img/x" but not "/img"; "/"
+ * matches everything.
+ */
+class LocationRouter {
+ public:
+  LocationRouter();
+
+  // First one wins when the same path is declared twice.
+  void add(const std::string& path, bool exact, int index);
+
+  // Index of the matching location. When nothing matches: the first
+  // prefix location (the first location if all are exact), or -1 when the
+  // server has no locations.
+  int match(const char* path, std::size_t len) const;
+  int match(const std::string& path) const;
+
+ private:
+  struct Edge {
+    char first;  // first byte of the child's label (children are sorted)
+    int node;
+  };
+
+  struct Node {
+    std::string label;
+    int location;  // -1 when no location ends here
+    std::vector<Edge> children;
+  };
+
+  struct ExactSlot {
+    std::string path;
+    int location;  // -1 = empty slot
+  };
+
+  void addPrefix(const std::string& path, int index);
+  void addExact(const std::string& path, int index);
+  int findChild(int node, char first) const;
+  void insertChild(int node, int child);
+  void growExact();
+
+  std::vector<Node> nodes_;  // nodes_[0] is the root (empty label)
+  std::vector<ExactSlot> exact_slots_;  // size is 0 or a power of two
+  std::size_t exact_count_;
+  int first_prefix_;    // fallback when no prefix matches
+  int first_location_;  // fallback when there are only exact locations
+};
+
+#endif  // WEBSERV_LOCATIONROUTER_HPP
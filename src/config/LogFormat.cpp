@@ -0,0 +1,92 @@
+#include "LogFormat.hpp"
+
+#include <cctype>
+
+namespace {
+
+struct NamedVariable {
+  const char* name;
+  LogFormat::Variable variable;
+};
+
+const NamedVariable kVariables[] = {
+    {"remote_addr", LogFormat::REMOTE_ADDR},
+    {"remote_port", LogFormat::REMOTE_PORT},
+    {"time_local", LogFormat::TIME_LOCAL},
+    {"request", LogFormat::REQUEST},
+    {"request_method", LogFormat::REQUEST_METHOD},
+    {"request_uri", LogFormat::REQUEST_URI},
+    {"uri", LogFormat::URI},
+    {"server_protocol", LogFormat::SERVER_PROTOCOL},
+    {"status", LogFormat::STATUS},
+    {"body_bytes_sent", LogFormat::BODY_BYTES_SENT},
+    {"request_time", LogFormat::REQUEST_TIME},
+    {"host", LogFormat::HOST},
+    {"http_referer", LogFormat::HTTP_REFERER},
+    {"http_user_agent", LogFormat::HTTP_USER_AGENT},
+};
+
+bool isNameChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+LogFormat::Variable lookup(const std::string& name) {
+  for (std::size_t i = 0; i < sizeof(kVariables) / sizeof(kVariables[0]);
+       ++i) {
+    if (name == kVariables[i].name) return kVariables[i].variable;
+  }
+  return LogFormat::LITERAL;
+}
+
+}  // namespace
+
+LogFormat::LogFormat() : pieces_(), used_(0) {}
+
+bool LogFormat::compile(const std::string& format, std::string& unknown) {
+  pieces_.clear();
+  used_ = 0;
+  std::string text;
+  std::size_t i = 0;
+  while (i < format.size()) {
+    if (format[i] != '$') {
+      text += format[i++];
+      continue;
+    }
+    std::size_t start = i + 1;
+    std::size_t end = start;
+    while (end < format.size() && isNameChar(format[end])) ++end;
+    if (end == start) {
+      text += format[i++];
+      continue;
+    }
+
+    std::string name = format.substr(start, end - start);
+    Variable variable = lookup(name);
+    if (variable == LITERAL) {
+      unknown = "$" + name;
+      return false;
+    }
+    if (!text.empty()) {
+      Piece literal = {LITERAL, text};
+      pieces_.push_back(literal);
+      text.clear();
+    }
+    Piece piece = {variable, std::string()};
+    pieces_.push_back(piece);
+    used_ |= 1u << variable;
+    i = end;
+  }
+  if (!text.empty()) {
+    Piece literal = {LITERAL, text};
+    pieces_.push_back(literal);
+  }
+  return true;
+}
+
+const std::vector<LogFormat::Piece>& LogFormat::getPieces() const {
+  return pieces_;
+}
+
+bool LogFormat::uses(Variable variable) const {
+  return (used_ & (1u << variable)) != 0;
+}
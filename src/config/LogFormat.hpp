@@ -0,0 +1,57 @@
+#ifndef WEBSERV_LOGFORMAT_HPP
+#define WEBSERV_LOGFORMAT_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief access_log format string, split once when the config is loaded.
+ *
+ * "$remote_addr [$time_local] \"$request\" $status" becomes the pieces
+ * REMOTE_ADDR, " [", TIME_LOCAL, "] \"", REQUEST, "\" ", STATUS: writing a
+ * log line is then a walk over the pieces, with no parsing per request.
+ *
+ * A variable name runs while the characters are [A-Za-z0-9_]. A '$' that
+ * starts no name is kept as text.
+ */
+class LogFormat {
+ public:
+  enum Variable {
+    LITERAL,
+    REMOTE_ADDR,      // client address
+    REMOTE_PORT,
+    TIME_LOCAL,       // 18/Oct/2026:09:15:02 +0200
+    REQUEST,          // "GET /index.html?x=1 HTTP/1.1"
+    REQUEST_METHOD,
+    REQUEST_URI,      // path and query as received
+    URI,              // path only
+    SERVER_PROTOCOL,  // HTTP/1.1
+    STATUS,
+    BODY_BYTES_SENT,  // response body, headers not included
+    REQUEST_TIME,     // seconds with ms resolution, first byte to response
+    HOST,             // Host header
+    HTTP_REFERER,
+    HTTP_USER_AGENT,
+    VARIABLE_COUNT
+  };
+
+  struct Piece {
+    Variable variable;
+    std::string text;  // LITERAL only
+  };
+
+  LogFormat();
+
+  // false, with |unknown| set to the offending "$name", when the format
+  // uses a variable that does not exist.
+  bool compile(const std::string& format, std::string& unknown);
+
+  const std::vector<Piece>& getPieces() const;
+  bool uses(Variable variable) const;
+
+ private:
+  std::vector<Piece> pieces_;
+  unsigned used_;  // bit per Variable
+};
+
+#endif  // WEBSERV_LOGFORMAT_HPP
@@ -1,5 +1,6 @@
 #include "ServerConfig.hpp"
 
+#include <cctype>
 #include <sstream>
 #include <string>
 
@@ -8,22 +9,35 @@
 
 ServerConfig::ServerConfig()
     : listen_port_(config::section::default_port),
+      default_server_(false),
+      listen_backlog_(-1),
+      listen_deferred_(false),
+      listen_fastopen_(0),
       max_body_size_(config::section::max_body_size),
+      body_buffer_size_(config::section::body_buffer_size),
       autoindex_(false),
       redirect_code_(-1) {}
 
 ServerConfig::ServerConfig(const ServerConfig& other)
     : listen_port_(other.listen_port_),
       host_address_(other.host_address_),
-      server_name_(other.server_name_),
+      server_names_(other.server_names_),
+      default_server_(other.default_server_),
+      listen_backlog_(other.listen_backlog_),
+      listen_deferred_(other.listen_deferred_),
+      listen_fastopen_(other.listen_fastopen_),
       root_(other.root_),
       indexes_(other.indexes_),
       max_body_size_(other.max_body_size_),
+      body_buffer_size_(other.body_buffer_size_),
       error_pages_(other.error_pages_),
       locations_(other.locations_),
+      location_router_(other.location_router_),
       autoindex_(other.autoindex_),
       redirect_code_(other.redirect_code_),
-      redirect_url_(other.redirect_url_) {}
+      redirect_url_(other.redirect_url_),
+      access_log_path_(other.access_log_path_),
+      access_log_format_(other.access_log_format_) {}
 
 ServerConfig& ServerConfig::operator=(const ServerConfig& other) {
   if (this != &other) {
@@ -31,13 +45,21 @@ ServerConfig& ServerConfig::operator=(const ServerConfig& other) {
     host_address_ = other.host_address_;
     root_ = other.root_;
     indexes_ = other.indexes_;
-    server_name_ = other.server_name_;
+    server_names_ = other.server_names_;
+    default_server_ = other.default_server_;
+    listen_backlog_ = other.listen_backlog_;
+    listen_deferred_ = other.listen_deferred_;
+    listen_fastopen_ = other.listen_fastopen_;
     max_body_size_ = other.max_body_size_;
+    body_buffer_size_ = other.body_buffer_size_;
     error_pages_ = other.error_pages_;
     locations_ = other.locations_;
+    location_router_ = other.location_router_;
     autoindex_ = other.autoindex_;
     redirect_code_ = other.redirect_code_;
     redirect_url_ = other.redirect_url_;
+    access_log_path_ = other.access_log_path_;
+    access_log_format_ = other.access_log_format_;
   }
   return *this;
 }
@@ -54,8 +76,39 @@ void ServerConfig::setPort(int port) {
 
 void ServerConfig::setHost(const std::string& host) { host_address_ = host; }
 
-void ServerConfig::setServerName(const std::string& name) {
-  server_name_ = name;
+void ServerConfig::addServerName(const std::string& name) {
+  // Host matching is case-insensitive; only a leading "*." is a wildcard.
+  bool wildcard = name.compare(0, 2, "*.") == 0;
+  if (name.size() <= (wildcard ? 2u : 0u) ||
+      name.find('*', wildcard ? 1 : 0) != std::string::npos)
+    throw ConfigException(config::errors::invalid_server_name + name);
+  std::string lower(name);
+  for (size_t i = 0; i < lower.size(); ++i)
+    lower[i] = static_cast<char>(
+        std::tolower(static_cast<unsigned char>(lower[i])));
+  server_names_.push_back(lower);
+}
+
+void ServerConfig::setDefaultServer(bool isDefault) {
+  default_server_ = isDefault;
+}
+
+void ServerConfig::setListenBacklog(int backlog) {
+  if (backlog < 1 || backlog > config::section::max_listen_backlog) {
+    throw ConfigException(config::errors::invalid_listen_option + "backlog");
+  }
+  listen_backlog_ = backlog;
+}
+
+void ServerConfig::setListenDeferred(bool deferred) {
+  listen_deferred_ = deferred;
+}
+
+void ServerConfig::setListenFastOpen(int queue) {
+  if (queue < 1 || queue > config::section::max_listen_backlog) {
+    throw ConfigException(config::errors::invalid_listen_option + "fastopen");
+  }
+  listen_fastopen_ = queue;
 }
 
 void ServerConfig::setRoot(const std::string& root) { root_ = root; }
@@ -66,6 +119,8 @@ void ServerConfig::addIndex(const std::string& index) {
 
 void ServerConfig::setMaxBodySize(size_t size) { max_body_size_ = size; }
 
+void ServerConfig::setBodyBufferSize(size_t size) { body_buffer_size_ = size; }
+
 void ServerConfig::addErrorPage(int code, const std::string& path) {
   if (code < 100 || code > 599) {
     std::stringstream ss;
@@ -77,6 +132,8 @@ void ServerConfig::addErrorPage(int code, const std::string& path) {
 
 void ServerConfig::addLocation(const LocationConfig& location) {
   locations_.push_back(location);
+  location_router_.add(location.getPath(), location.isExactMatch(),
+                       static_cast<int>(locations_.size()) - 1);
 }
 
 void ServerConfig::setAutoIndex(bool autoindex) { autoindex_ = autoindex; }
@@ -91,13 +148,46 @@ void ServerConfig::setRedirectUrl(const std::string& url) {
   redirect_url_ = url;
 }
 
+void ServerConfig::buildCgiEnvironments() {
+  for (size_t i = 0; i < locations_.size(); ++i)
+    locations_[i].buildCgiEnvironment(getServerName(), listen_port_);
+}
+
+void ServerConfig::setAccessLog(const std::string& path,
+                                const std::string& format) {
+  std::string unknown;
+  if (!access_log_format_.compile(format, unknown)) {
+    throw ConfigException(config::errors::unknown_log_variable + unknown);
+  }
+  access_log_path_ = path;
+}
+
 //	GETTERS
 
 int ServerConfig::getPort() const { return listen_port_; }
 
 const std::string& ServerConfig::getHost() const { return host_address_; }
 
-const std::string& ServerConfig::getServerName() const { return server_name_; }
+const std::string& ServerConfig::getServerName() const {
+  static const std::string none;
+  return server_names_.empty() ? none : server_names_[0];
+}
+
+const std::vector<std::string>& ServerConfig::getServerNames() const {
+  return server_names_;
+}
+
+bool ServerConfig::isDefaultServer() const { return default_server_; }
+
+int ServerConfig::getListenBacklog() const { return listen_backlog_; }
+
+bool ServerConfig::getListenDeferred() const { return listen_deferred_; }
+
+int ServerConfig::getListenFastOpen() const { return listen_fastopen_; }
+
+bool ServerConfig::hasListenOptions() const {
+  return listen_backlog_ > 0 || listen_deferred_ || listen_fastopen_ > 0;
+}
 
 const std::string& ServerConfig::getRoot() const { return root_; }
 
@@ -107,6 +197,8 @@ const std::vector<std::string>& ServerConfig::getIndexVector() const {
 
 size_t ServerConfig::getMaxBodySize() const { return max_body_size_; }
 
+size_t ServerConfig::getBodyBufferSize() const { return body_buffer_size_; }
+
 const std::map<int, std::string>& ServerConfig::getErrorPages() const {
   return error_pages_;
 }
@@ -115,6 +207,12 @@ const std::vector<LocationConfig>& ServerConfig::getLocations() const {
   return locations_;
 }
 
+const LocationConfig* ServerConfig::matchLocation(
+    const std::string& path) const {
+  int index = location_router_.match(path);
+  return index < 0 ? 0 : &locations_[index];
+}
+
 bool ServerConfig::getAutoindex() const { return autoindex_; }
 
 int ServerConfig::getRedirectCode() const { return redirect_code_; }
@@ -123,4 +221,12 @@ const std::string& ServerConfig::getRedirectUrl() const {
   return redirect_url_;
 }
 
+const std::string& ServerConfig::getAccessLogPath() const {
+  return access_log_path_;
+}
+
+const LogFormat& ServerConfig::getAccessLogFormat() const {
+  return access_log_format_;
+}
+
 void ServerConfig::print() const { std::cout << *this; }
@@ -8,6 +8,8 @@
 
 #include "../common/namespaces.hpp"
 #include "LocationConfig.hpp"
+#include "LocationRouter.hpp"
+#include "LogFormat.hpp"
 
 /**
  * ServerConfig stores configuration for one server { } block
@@ -15,9 +17,13 @@
  * server {
  *     listen 8080;
  *     host 127.0.0.1;
- *     server_name example.com;
+ *     server_name example.com *.example.com;
+ *     listen 8080 default_server;  (Host values no server_name matches)
+ *     listen 8080 backlog=4096 deferred fastopen=256;  (listening socket)
  *     max_body_size 1048576 (bytes);
+ *     client_body_buffer_size 16k;  (upload bodies above this go to disk)
  *     error_page 404 /404.html;
+ *     access_log logs/access.log '$remote_addr "$request" $status';
  *     location / { ... }
  * }
  */
@@ -34,28 +40,54 @@ class ServerConfig {
   // Setters
   void setPort(int port);
   void setHost(const std::string& host);
-  void setServerName(const std::string& name);
+  // Stored lowercased; the first one is SERVER_NAME for CGI.
+  void addServerName(const std::string& name);
+  void setDefaultServer(bool isDefault);
+  // Listening socket: -1 = SOMAXCONN; TCP_DEFER_ACCEPT; TCP_FASTOPEN queue
+  // length (0 = off).
+  void setListenBacklog(int backlog);
+  void setListenDeferred(bool deferred);
+  void setListenFastOpen(int queue);
   void setRoot(const std::string& root);
   void addIndex(const std::string& index);
   void setMaxBodySize(size_t size);
+  void setBodyBufferSize(size_t size);
   void addErrorPage(int code, const std::string& path);
   void addLocation(const LocationConfig& location);
   void setAutoIndex(bool autoindex);
   void setRedirectCode(int code);
   void setRedirectUrl(const std::string& url);
+  // Empty path = access_log off. Throws on an unknown $variable.
+  void setAccessLog(const std::string& path, const std::string& format);
+  // Precompute each location's static CGI environment; called once the
+  // whole block is parsed (listen/server_name may follow the locations).
+  void buildCgiEnvironments();
 
   // Getters
   int getPort() const;
   const std::string& getHost() const;
   const std::string& getServerName() const;
+  const std::vector<std::string>& getServerNames() const;
+  bool isDefaultServer() const;
+  int getListenBacklog() const;
+  bool getListenDeferred() const;
+  int getListenFastOpen() const;
+  // Any of backlog=, deferred or fastopen= given.
+  bool hasListenOptions() const;
   const std::string& getRoot() const;
   const std::vector<std::string>& getIndexVector() const;
   size_t getMaxBodySize() const;
+  size_t getBodyBufferSize() const;
   const std::map<int, std::string>& getErrorPages() const;
   const std::vector<LocationConfig>& getLocations() const;
+  // Location that serves |path|: exact match, else longest prefix, else the
+  // first prefix location; 0 when the server has none.
+  const LocationConfig* matchLocation(const std::string& path) const;
   bool getAutoindex() const;
   int getRedirectCode() const;
   const std::string& getRedirectUrl() const;
+  const std::string& getAccessLogPath() const;
+  const LogFormat& getAccessLogFormat() const;
 
   // Debug
   void print() const;
@@ -63,15 +95,23 @@ class ServerConfig {
  private:
   int listen_port_;
   std::string host_address_;
-  std::string server_name_;
+  std::vector<std::string> server_names_;
+  bool default_server_;
+  int listen_backlog_;
+  bool listen_deferred_;
+  int listen_fastopen_;
   std::string root_;
   std::vector<std::string> indexes_;
   size_t max_body_size_;
+  size_t body_buffer_size_;
   std::map<int, std::string> error_pages_;
   std::vector<LocationConfig> locations_;
+  LocationRouter location_router_;  // indexes into locations_
   bool autoindex_;
   int redirect_code_;
   std::string redirect_url_;
+  std::string access_log_path_;
+  LogFormat access_log_format_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const ServerConfig& config) {
@@ -86,7 +126,10 @@ inline std::ostream& operator<<(std::ostream& os, const ServerConfig& config) {
      << "Server name: " << config::colors::reset << config::colors::green
      << config.getServerName() << config::colors::reset << "\n"<< config::colors::yellow
 	 << "\tMax body size: " << config::colors::reset << config::colors::green
-	 << config.getMaxBodySize() << config::colors::reset << "\n";
+	 << config.getMaxBodySize() << config::colors::reset << "\n"
+     << config::colors::yellow << "\tBody buffer size: " << config::colors::reset
+     << config::colors::green << config.getBodyBufferSize()
+     << config::colors::reset << "\n";
 
   const ServerConfig::ErrorMap& errorPages = config.getErrorPages();
   os << "\t" << config::colors::yellow << "Error pages:\n"
@@ -0,0 +1,135 @@
+#include "VirtualHostTable.hpp"
+
+#include <cstring>
+
+namespace {
+
+// FNV-1a over the name, seeded with the port.
+std::size_t hashKey(int port, const char* name, std::size_t len) {
+  std::size_t hash = 2166136261u ^ static_cast<std::size_t>(port);
+  for (std::size_t i = 0; i < len; ++i) {
+    hash ^= static_cast<unsigned char>(name[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// "Example.COM:8080" -> "example.com", "[::1]:80" -> "[::1]".
+std::size_t normalizeHost(const char* host, std::size_t len, char* out) {
+  std::size_t end = len;
+  if (len > 0 && host[0] == '[') {
+    const void* close = std::memchr(host, ']', len);
+    if (close != 0) end = static_cast<const char*>(close) - host + 1;
+  } else {
+    const void* colon = std::memchr(host, ':', len);
+    if (colon != 0) end = static_cast<const char*>(colon) - host;
+  }
+  if (end > 0 && host[end - 1] == '.') --end;
+  for (std::size_t i = 0; i < end; ++i) {
+    char c = host[i];
+    out[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+  return end;
+}
+
+}  // namespace
+
+VirtualHostTable::VirtualHostTable(const std::vector<ServerConfig>* servers)
+    : servers_(servers), slots_(), listeners_() {
+  if (servers_ == 0) return;
+
+  std::size_t names = 0;
+  for (std::size_t i = 0; i < servers_->size(); ++i)
+    names += (*servers_)[i].getServerNames().size();
+  std::size_t size = 8;
+  while (size < names * 2) size *= 2;
+  Slot empty;
+  empty.port = 0;
+  empty.server = -1;
+  slots_.assign(size, empty);
+
+  for (std::size_t i = 0; i < servers_->size(); ++i) {
+    const ServerConfig& server = (*servers_)[i];
+    int index = static_cast<int>(i);
+    int known = listenerIndex(server.getPort());
+    if (known < 0) {
+      Listener fresh;
+      fresh.port = server.getPort();
+      fresh.defaultServer = index;
+      fresh.maxBodySize = server.getMaxBodySize();
+      listeners_.push_back(fresh);
+    } else {
+      Listener& entry = listeners_[known];
+      if (server.isDefaultServer()) entry.defaultServer = index;
+      if (entry.maxBodySize != 0 &&
+          (server.getMaxBodySize() == 0 ||
+           server.getMaxBodySize() > entry.maxBodySize))
+        entry.maxBodySize = server.getMaxBodySize();
+    }
+
+    const std::vector<std::string>& serverNames = server.getServerNames();
+    for (std::size_t n = 0; n < serverNames.size(); ++n) {
+      const std::string& name = serverNames[n];
+      insert(server.getPort(), name[0] == '*' ? name.substr(1) : name, index);
+    }
+  }
+}
+
+const ServerConfig* VirtualHostTable::resolve(int port, const char* host,
+                                              std::size_t len) const {
+  if (len > 0 && len <= MAX_HOST_LENGTH) {
+    char name[MAX_HOST_LENGTH];
+    len = normalizeHost(host, len, name);
+
+    int server = find(port, name, len);
+    // Wildcards from the longest suffix down: for "a.b.example.com" try
+    // ".b.example.com", then ".example.com", then ".com".
+    for (std::size_t dot = 0; server < 0 && dot < len; ++dot) {
+      if (name[dot] == '.') server = find(port, name + dot, len - dot);
+    }
+    if (server >= 0) return &(*servers_)[server];
+  }
+  return defaultServer(port);
+}
+
+const ServerConfig* VirtualHostTable::defaultServer(int port) const {
+  int known = listenerIndex(port);
+  return known < 0 ? 0 : &(*servers_)[listeners_[known].defaultServer];
+}
+
+std::size_t VirtualHostTable::maxBodySize(int port) const {
+  int known = listenerIndex(port);
+  return known < 0 ? 0 : listeners_[known].maxBodySize;
+}
+
+// First server wins when two of them claim the same name on a port.
+void VirtualHostTable::insert(int port, const std::string& name, int server) {
+  std::size_t mask = slots_.size() - 1;
+  std::size_t i = hashKey(port, name.data(), name.size()) & mask;
+  for (; slots_[i].server >= 0; i = (i + 1) & mask) {
+    if (slots_[i].port == port && slots_[i].name == name) return;
+  }
+  slots_[i].name = name;
+  slots_[i].port = port;
+  slots_[i].server = server;
+}
+
+int VirtualHostTable::find(int port, const char* name, std::size_t len) const {
+  std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = hashKey(port, name, len) & mask;
+       slots_[i].server >= 0; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (slot.port == port && slot.name.size() == len &&
+        std::memcmp(slot.name.data(), name, len) == 0)
+      return slot.server;
+  }
+  return -1;
+}
+
+// A handful of ports at most: a linear scan beats hashing here.
+int VirtualHostTable::listenerIndex(int port) const {
+  for (std::size_t i = 0; i < listeners_.size(); ++i) {
+    if (listeners_[i].port == port) return static_cast<int>(i);
+  }
+  return -1;
+}
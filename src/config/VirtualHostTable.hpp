@@ -0,0 +1,65 @@
+#ifndef WEBSERV_VIRTUALHOSTTABLE_HPP
+#define WEBSERV_VIRTUALHOSTTABLE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ServerConfig.hpp"
+
+/**
+ * @brief Picks the server { } block for a request from its port and Host.
+ *
+ * Built once from the parsed servers; read-only afterwards. Names live in
+ * one open-addressing hash table keyed on (port, name), so the cost of a
+ * lookup does not depend on how many virtual hosts share a port:
+ * 1. exact server_name;
+ * 2. longest "*.suffix" wildcard ("*.example.com" matches
+ *    "a.example.com" and "a.b.example.com", not "example.com");
+ * 3. the port's default server: the one marked 'default_server', or the
+ *    first one declared on that port.
+ *
+ * The Host value is normalized before the lookup: port and trailing dot
+ * removed, lowercased.
+ */
+class VirtualHostTable {
+ public:
+  explicit VirtualHostTable(const std::vector<ServerConfig>* servers);
+
+  // 0 only when no server listens on |port|.
+  const ServerConfig* resolve(int port, const char* host,
+                              std::size_t len) const;
+  const ServerConfig* defaultServer(int port) const;
+  // Largest client_max_body_size among the port's servers (0 = unlimited
+  // when any of them is): the bound that applies until Host is known.
+  std::size_t maxBodySize(int port) const;
+
+  // Hostnames are at most 253 bytes; longer Host values get the default.
+  static const std::size_t MAX_HOST_LENGTH = 255;
+
+ private:
+  struct Slot {
+    std::string name;  // "*.x" wildcards are stored as ".x"
+    int port;
+    int server;        // index in servers_, -1 = empty slot
+  };
+
+  struct Listener {
+    int port;
+    int defaultServer;
+    std::size_t maxBodySize;
+  };
+
+  VirtualHostTable(const VirtualHostTable&);
+  VirtualHostTable& operator=(const VirtualHostTable&);
+
+  void insert(int port, const std::string& name, int server);
+  int find(int port, const char* name, std::size_t len) const;
+  int listenerIndex(int port) const;
+
+  const std::vector<ServerConfig>* servers_;
+  std::vector<Slot> slots_;  // power of two, at most half full
+  std::vector<Listener> listeners_;
+};
+
+#endif  // WEBSERV_VIRTUALHOSTTABLE_HPP
@@ -0,0 +1,169 @@
+#include "ContentEncoding.hpp"
+
+#include <cstring>
+
+namespace {
+
+const int WINDOW_BITS = 15;      // ventana maxima de zlib (32 KB)
+const int GZIP_WINDOW_BITS = 16;  // sumado a WINDOW_BITS: cabecera gzip
+const int MEM_LEVEL = 8;          // el valor por defecto de deflateInit()
+
+bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+bool equalsIgnoreCase(const char* data, std::size_t len, const char* lower) {
+  std::size_t i = 0;
+  for (; i < len && lower[i] != '\0'; ++i) {
+    char c = data[i];
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+    if (c != lower[i]) return false;
+  }
+  return i == len && lower[i] == '\0';
+}
+
+// p apunta justo detras de "q=". "0", "0.", "0.000" -> true.
+bool isZeroQuality(const char* p, const char* end) {
+  if (p == end || *p != '0') return false;
+  ++p;
+  if (p < end && *p == '.') {
+    ++p;
+    while (p < end && *p == '0') ++p;
+  }
+  return p == end || *p == ',' || *p == ';' || isSpace(*p);
+}
+
+bool matchesCoding(const char* token, std::size_t len, ContentCoding coding) {
+  if (equalsIgnoreCase(token, len, contentCodingName(coding))) return true;
+  return coding == CONTENT_CODING_GZIP &&
+         equalsIgnoreCase(token, len, "x-gzip");
+}
+
+int windowBits(ContentCoding coding) {
+  return coding == CONTENT_CODING_GZIP ? WINDOW_BITS + GZIP_WINDOW_BITS
+                                       : WINDOW_BITS;
+}
+
+}  // namespace
+
+bool acceptsContentCoding(const HttpHeaderView& acceptEncoding,
+                          ContentCoding coding) {
+  if (coding == CONTENT_CODING_IDENTITY) return true;
+  // -1: no aparece; 0: rechazada (q=0); 1: aceptada
+  int named = -1;
+  int wildcard = -1;
+  const char* p = acceptEncoding.data;
+  const char* end = p + acceptEncoding.length;
+  while (p < end) {
+    while (p < end && (isSpace(*p) || *p == ',')) ++p;
+    const char* token = p;
+    while (p < end && *p != ',' && *p != ';' && !isSpace(*p)) ++p;
+    std::size_t tokenLen = p - token;
+
+    int accepted = 1;
+    while (p < end && *p != ',') {
+      if (*p != ';') {
+        ++p;
+        continue;
+      }
+      ++p;
+      while (p < end && isSpace(*p)) ++p;
+      if (end - p >= 2 && (p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+        p += 2;
+        accepted = isZeroQuality(p, end) ? 0 : 1;
+      }
+    }
+
+    if (tokenLen == 0) continue;
+    if (matchesCoding(token, tokenLen, coding))
+      named = accepted;
+    else if (tokenLen == 1 && token[0] == '*')
+      wildcard = accepted;
+  }
+  if (named >= 0) return named == 1;
+  return wildcard == 1;
+}
+
+ContentCoding negotiateContentCoding(const HttpHeaderView& acceptEncoding) {
+  if (acceptEncoding.empty()) return CONTENT_CODING_IDENTITY;
+  if (acceptsContentCoding(acceptEncoding, CONTENT_CODING_GZIP))
+    return CONTENT_CODING_GZIP;
+  if (acceptsContentCoding(acceptEncoding, CONTENT_CODING_DEFLATE))
+    return CONTENT_CODING_DEFLATE;
+  return CONTENT_CODING_IDENTITY;
+}
+
+const char* contentCodingName(ContentCoding coding) {
+  if (coding == CONTENT_CODING_GZIP) return "gzip";
+  if (coding == CONTENT_CODING_DEFLATE) return "deflate";
+  return "";
+}
+
+bool isCompressibleType(const std::string& contentType) {
+  static const char* const types[] = {
+      "application/javascript", "application/json", "application/xml",
+      "image/svg+xml", 0};
+  std::size_t len = contentType.find(';');
+  if (len == std::string::npos) len = contentType.size();
+  while (len > 0 && isSpace(contentType[len - 1])) --len;
+  const char* data = contentType.data();
+  if (len > 5 && equalsIgnoreCase(data, 5, "text/")) return true;
+  for (std::size_t i = 0; types[i] != 0; ++i) {
+    if (equalsIgnoreCase(data, len, types[i])) return true;
+  }
+  return false;
+}
+
+bool compressContent(const char* data, std::size_t len, ContentCoding coding,
+                     int level, std::vector<char>& out) {
+  out.clear();
+  ContentCompressor compressor;
+  if (!compressor.start(coding, level)) return false;
+  out.reserve(len / 3 + 64);
+  return compressor.write(data, len, true, out);
+}
+
+// CONTENT COMPRESSOR --------------------------------------------------------
+ContentCompressor::ContentCompressor() : _active(false) {
+  std::memset(&_stream, 0, sizeof(_stream));
+}
+
+ContentCompressor::~ContentCompressor() { end(); }
+
+bool ContentCompressor::start(ContentCoding coding, int level) {
+  end();
+  if (coding == CONTENT_CODING_IDENTITY) return false;
+  std::memset(&_stream, 0, sizeof(_stream));
+  if (deflateInit2(&_stream, level, Z_DEFLATED, windowBits(coding), MEM_LEVEL,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+  _active = true;
+  return true;
+}
+
+bool ContentCompressor::write(const char* data, std::size_t len, bool finish,
+                              std::vector<char>& out) {
+  if (!_active) return false;
+  char buffer[16384];
+  _stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  _stream.avail_in = static_cast<uInt>(len);
+  int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+  // Con la salida llena zlib puede tener mas pendiente: se repite hasta que
+  // sobre sitio en buffer.
+  do {
+    _stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    _stream.avail_out = sizeof(buffer);
+    if (deflate(&_stream, flush) == Z_STREAM_ERROR) {
+      end();
+      return false;
+    }
+    std::size_t produced = sizeof(buffer) - _stream.avail_out;
+    out.insert(out.end(), buffer, buffer + produced);
+  } while (_stream.avail_out == 0);
+  if (finish) end();
+  return true;
+}
+
+void ContentCompressor::end() {
+  if (!_active) return;
+  deflateEnd(&_stream);
+  _active = false;
+}
@@ -0,0 +1,65 @@
+#ifndef CONTENT_ENCODING_HPP
+#define CONTENT_ENCODING_HPP
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "HttpHeaderTable.hpp"
+
+enum ContentCoding {
+  CONTENT_CODING_IDENTITY,  // sin comprimir
+  CONTENT_CODING_GZIP,
+  CONTENT_CODING_DEFLATE  // "deflate" de HTTP: formato zlib (RFC 1950)
+};
+
+// Nivel para respuestas que se comprimen una sola vez (y se cachean): el
+// por defecto de zlib. Las que se comprimen mientras se envian (CGI) usan el
+// mas rapido.
+static const int COMPRESSION_LEVEL_DEFAULT = 6;
+static const int COMPRESSION_LEVEL_STREAM = 1;
+
+// Accept-Encoding: gzip;q=0.8, deflate, *;q=0 (RFC 9110 12.5.3). Una
+// codificacion vale si aparece (o "*") con q distinto de 0; "x-gzip"
+// cuenta como gzip. Sin header: solo identity.
+bool acceptsContentCoding(const HttpHeaderView& acceptEncoding,
+                          ContentCoding coding);
+// gzip si el cliente lo acepta, si no deflate, si no identity.
+ContentCoding negotiateContentCoding(const HttpHeaderView& acceptEncoding);
+// "gzip" / "deflate" / "" para identity.
+const char* contentCodingName(ContentCoding coding);
+// text/*, JSON, JavaScript, XML, SVG: lo que merece la pena comprimir.
+// Imagenes, video o zip ya vienen comprimidos.
+bool isCompressibleType(const std::string& contentType);
+
+// Comprime data entero de una vez; out se sobrescribe.
+bool compressContent(const char* data, std::size_t len, ContentCoding coding,
+                     int level, std::vector<char>& out);
+
+// Compresion por trozos, para cuerpos que no se conocen enteros de
+// antemano (salida de un CGI).
+class ContentCompressor {
+ public:
+  ContentCompressor();
+  ~ContentCompressor();
+
+  bool start(ContentCoding coding, int level);
+  // Añade a out la salida comprimida de data. Sin finish hace un
+  // Z_SYNC_FLUSH: el cliente puede descomprimir ya todo lo enviado. Con
+  // finish cierra el stream (trailer gzip) y no admite mas datos.
+  bool write(const char* data, std::size_t len, bool finish,
+             std::vector<char>& out);
+
+ private:
+  ContentCompressor(const ContentCompressor&);
+  ContentCompressor& operator=(const ContentCompressor&);
+
+  void end();
+
+  z_stream _stream;
+  bool _active;
+};
+
+#endif  // CONTENT_ENCODING_HPP
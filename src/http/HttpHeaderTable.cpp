@@ -0,0 +1,144 @@
+#include "HttpHeaderTable.hpp"
+
+#include <cctype>
+#include <cstring>
+
+// ---- Hash perfecto de los nombres conocidos ----
+// hash = (primera | 0x20) + (última | 0x20) + 11 * longitud, módulo 32.
+// Con los 14 nombres de HttpHeaderId no hay dos en la misma casilla; la
+// tabla se generó buscando esos coeficientes (si se añade un nombre y
+// colisiona, buscar otros). "| 0x20" pasa letras a minúsculas y deja
+// igual dígitos y '-'. El nombre se compara entero después: un nombre
+// desconocido que caiga en una casilla ocupada no se confunde.
+
+static const char* const kNames[HTTP_HEADER_COUNT] = {
+    "host",           "connection",        "content-length",
+    "content-type",   "transfer-encoding", "expect",
+    "cookie",         "if-none-match",     "if-modified-since",
+    "if-range",       "range",             "accept-encoding",
+    "user-agent",     "referer"};
+
+static const std::size_t kNameLengths[HTTP_HEADER_COUNT] = {
+    4, 10, 14, 12, 17, 6, 6, 13, 17, 8, 5, 15, 10, 7};
+
+static const signed char kSlots[32] = {
+    7,  -1, -1, -1, -1, 2,  9,  -1, 0,  8,  6,  -1, 3,  11, 10, -1,
+    -1, 13, -1, -1, -1, -1, 4,  12, -1, -1, -1, 5,  -1, -1, -1, 1};
+
+static bool equalsLowerN(const char* data, const char* lower, std::size_t len) {
+  for (std::size_t i = 0; i < len; ++i) {
+    if (std::tolower(static_cast<unsigned char>(data[i])) != lower[i])
+      return false;
+  }
+  return true;
+}
+
+HttpHeaderId HttpHeaderTable::lookupId(const char* name, std::size_t len) {
+  if (len == 0) return HTTP_HEADER_OTHER;
+  unsigned hash = (static_cast<unsigned char>(name[0]) | 0x20u) +
+                  (static_cast<unsigned char>(name[len - 1]) | 0x20u) +
+                  11u * static_cast<unsigned>(len);
+  int slot = kSlots[hash & 31u];
+  if (slot < 0 || kNameLengths[slot] != len ||
+      !equalsLowerN(name, kNames[slot], len))
+    return HTTP_HEADER_OTHER;
+  return static_cast<HttpHeaderId>(slot);
+}
+
+// ---- HttpHeaderView ----
+
+bool HttpHeaderView::equalsIgnoreCase(const char* lower) const {
+  return std::strlen(lower) == length && equalsLowerN(data, lower, length);
+}
+
+bool HttpHeaderView::containsIgnoreCase(const char* lower) const {
+  std::size_t n = std::strlen(lower);
+  for (std::size_t i = 0; i + n <= length; ++i) {
+    if (equalsLowerN(data + i, lower, n)) return true;
+  }
+  return false;
+}
+
+// ---- HttpHeaderTable ----
+
+HttpHeaderTable::HttpHeaderTable() : _data(), _fields() {
+  for (int i = 0; i < HTTP_HEADER_COUNT; ++i) _known[i] = -1;
+}
+
+void HttpHeaderTable::clear() {
+  _data.clear();
+  _fields.clear();
+  for (int i = 0; i < HTTP_HEADER_COUNT; ++i) _known[i] = -1;
+}
+
+HttpHeaderId HttpHeaderTable::add(const char* name, std::size_t nameLen,
+                                  const char* value, std::size_t valueLen) {
+  Field field;
+  field.id = lookupId(name, nameLen);
+  field.nameOffset = _data.size();
+  field.nameLength = nameLen;
+  field.valueOffset = field.nameOffset + nameLen;
+  field.valueLength = valueLen;
+
+  _data.resize(field.valueOffset + valueLen);
+  char* out = _data.empty() ? 0 : &_data[0];
+  for (std::size_t i = 0; i < nameLen; ++i)
+    out[field.nameOffset + i] = static_cast<char>(
+        std::tolower(static_cast<unsigned char>(name[i])));
+  if (valueLen > 0) std::memcpy(out + field.valueOffset, value, valueLen);
+
+  if (field.id != HTTP_HEADER_OTHER)
+    _known[field.id] = static_cast<int>(_fields.size());
+  _fields.push_back(field);
+  return field.id;
+}
+
+HttpHeaderView HttpHeaderTable::view(std::size_t offset,
+                                     std::size_t length) const {
+  HttpHeaderView result;
+  result.data = length > 0 ? &_data[0] + offset : "";
+  result.length = length;
+  return result;
+}
+
+HttpHeaderView HttpHeaderTable::get(HttpHeaderId id) const {
+  if (id == HTTP_HEADER_OTHER || _known[id] < 0) return view(0, 0);
+  const Field& field = _fields[_known[id]];
+  return view(field.valueOffset, field.valueLength);
+}
+
+HttpHeaderView HttpHeaderTable::get(const char* name, std::size_t len) const {
+  HttpHeaderId id = lookupId(name, len);
+  if (id != HTTP_HEADER_OTHER) return get(id);
+  for (std::size_t i = _fields.size(); i > 0; --i) {
+    const Field& field = _fields[i - 1];
+    if (field.id == HTTP_HEADER_OTHER && field.nameLength == len &&
+        equalsLowerN(name, &_data[0] + field.nameOffset, len)) {
+      return view(field.valueOffset, field.valueLength);
+    }
+  }
+  return view(0, 0);
+}
+
+HttpHeaderView HttpHeaderTable::nameAt(std::size_t index) const {
+  return view(_fields[index].nameOffset, _fields[index].nameLength);
+}
+
+HttpHeaderView HttpHeaderTable::valueAt(std::size_t index) const {
+  return view(_fields[index].valueOffset, _fields[index].valueLength);
+}
+
+bool HttpHeaderTable::isLastWithName(std::size_t index) const {
+  const Field& field = _fields[index];
+  if (field.id != HTTP_HEADER_OTHER)
+    return _known[field.id] == static_cast<int>(index);
+  for (std::size_t i = index + 1; i < _fields.size(); ++i) {
+    const Field& later = _fields[i];
+    if (later.id == HTTP_HEADER_OTHER &&
+        later.nameLength == field.nameLength &&
+        std::memcmp(&_data[0] + later.nameOffset,
+                    &_data[0] + field.nameOffset, field.nameLength) == 0)
+      return false;
+  }
+  return true;
+}
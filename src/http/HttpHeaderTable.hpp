@@ -0,0 +1,93 @@
+#ifndef HTTP_HEADER_TABLE_HPP
+#define HTTP_HEADER_TABLE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Cabeceras que el servidor consulta: acceso directo por id, sin buscar
+// por nombre. Añadir una aquí obliga a regenerar la tabla del hash
+// perfecto en HttpHeaderTable.cpp.
+enum HttpHeaderId {
+  HTTP_HEADER_HOST,
+  HTTP_HEADER_CONNECTION,
+  HTTP_HEADER_CONTENT_LENGTH,
+  HTTP_HEADER_CONTENT_TYPE,
+  HTTP_HEADER_TRANSFER_ENCODING,
+  HTTP_HEADER_EXPECT,
+  HTTP_HEADER_COOKIE,
+  HTTP_HEADER_IF_NONE_MATCH,
+  HTTP_HEADER_IF_MODIFIED_SINCE,
+  HTTP_HEADER_IF_RANGE,
+  HTTP_HEADER_RANGE,
+  HTTP_HEADER_ACCEPT_ENCODING,
+  HTTP_HEADER_USER_AGENT,
+  HTTP_HEADER_REFERER,
+  HTTP_HEADER_COUNT,
+  HTTP_HEADER_OTHER = HTTP_HEADER_COUNT  // cualquier otra
+};
+
+// Trozo de texto dentro de la tabla (sin copia). Válido hasta el
+// siguiente add() o clear() de la tabla de la que sale.
+struct HttpHeaderView {
+  const char* data;
+  std::size_t length;
+
+  bool empty() const { return length == 0; }
+  std::string str() const { return std::string(data, length); }
+  // lower: literal en minúsculas
+  bool equalsIgnoreCase(const char* lower) const;
+  bool containsIgnoreCase(const char* lower) const;
+};
+
+// Cabeceras de una petición, sin std::map ni un string por entrada:
+//   - _data: nombres (en minúsculas) y valores, uno detrás de otro
+//   - _fields: (nombre, valor) como offsets en _data, en orden de llegada
+//   - _known: para cada HttpHeaderId, el último campo con ese nombre
+// clear() conserva la capacidad: una conexión keep-alive deja de reservar
+// memoria para cabeceras tras la primera petición.
+class HttpHeaderTable {
+ public:
+  HttpHeaderTable();
+
+  // Guarda el nombre en minúsculas. Los repetidos se conservan todos; las
+  // consultas devuelven el último (como hacía el std::map).
+  // @return id del nombre (HTTP_HEADER_OTHER si no es conocido)
+  HttpHeaderId add(const char* name, std::size_t nameLen, const char* value,
+                   std::size_t valueLen);
+  void clear();
+
+  // O(1) para cabeceras conocidas. Vista vacía si no llegó.
+  HttpHeaderView get(HttpHeaderId id) const;
+  bool has(HttpHeaderId id) const { return _known[id] >= 0; }
+  // Por nombre (sin distinguir mayúsculas): si es conocido va por id; si
+  // no, recorre los campos desde el final.
+  HttpHeaderView get(const char* name, std::size_t len) const;
+
+  // Recorrido en orden de llegada (CGI: variables HTTP_*).
+  std::size_t size() const { return _fields.size(); }
+  HttpHeaderView nameAt(std::size_t index) const;
+  HttpHeaderView valueAt(std::size_t index) const;
+  // false si un campo posterior con el mismo nombre lo reemplaza.
+  bool isLastWithName(std::size_t index) const;
+
+  // Hash perfecto sobre los nombres conocidos (sin distinguir mayúsculas).
+  static HttpHeaderId lookupId(const char* name, std::size_t len);
+
+ private:
+  struct Field {
+    std::size_t nameOffset;
+    std::size_t nameLength;
+    std::size_t valueOffset;
+    std::size_t valueLength;
+    HttpHeaderId id;
+  };
+
+  HttpHeaderView view(std::size_t offset, std::size_t length) const;
+
+  std::vector<char> _data;
+  std::vector<Field> _fields;
+  int _known[HTTP_HEADER_COUNT];  // índice en _fields, -1 si no llegó
+};
+
+#endif  // HTTP_HEADER_TABLE_HPP
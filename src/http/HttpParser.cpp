@@ -1,6 +1,19 @@
 #include "HttpParser.hpp"
 
-HttpParser::HttpParser() : _maxBodySize(0), _errorStatusCode(400) { reset(); }
+#include <cstring>
+
+HttpParser::HttpParser()
+    : _maxBodySize(0),
+      _errorStatusCode(400),
+      _in(),
+      _reqStart(0),
+      _headEnd(0),
+      _pos(0),
+      _end(0),
+      _scan(0),
+      _fields() {
+  reset();
+}
 
 HttpParser::~HttpParser() {}
 
@@ -12,29 +25,114 @@ int HttpParser::getErrorStatusCode() const {
   return (_state == ERROR) ? _errorStatusCode : 0;
 }
 
+const char* HttpParser::getHeadData() const {
+  return _in.empty() ? "" : &_in[0] + _reqStart;
+}
+
+bool HttpParser::needsBodyStorage() const {
+  return _state == PARSING_BODY && !_request.isBodyStorageDecided();
+}
+
+void HttpParser::storeBodyInMemory() { _request.setBodyInMemory(); }
+
+void HttpParser::spillBodyTo(const std::string& dir,
+                             std::size_t memoryLimit) {
+  _request.setBodySpill(dir, memoryLimit);
+}
+
+void HttpParser::clear() {
+  reset();
+  // conserva la capacidad reservada de _in
+  _reqStart = _headEnd = _pos = _end = _scan = 0;
+}
+
 void HttpParser::reset() {
-  // Limpia estado de parsing y contenedores de la petición actual. No toca _buffer
-  // (puede contener datos de la siguiente petición pipelined).
+  // Limpia estado de parsing y contenedores de la petición actual. No toca
+  // [_pos, _end) (puede contener datos de la siguiente petición pipelined);
+  // lo anterior ya no hace falta y prepareRead() lo reaprovecha.
   _state = PARSING_START_LINE;
   _stateChunk = CHUNK_SIZE;
   _request.clear();
-  _chunkBuffer.clear();
   _contentLength = 0;
   _isChunked = false;
   _bytesRead = 0;
   _chunkSize = 0;
   _errorStatusCode = 400;
+  _reqStart = _headEnd = _pos;
+  _method.offset = _method.length = 0;
+  _target = _version = _method;
+  _fields.clear();  // conserva la capacidad
   // _maxBodySize NO se resetea: se establece una vez en el constructor de Client
   // y debe persistir para que todas las peticiones Keep-Alive usen el mismo límite.
 }
 
+void HttpParser::fail(int statusCode) {
+  _errorStatusCode = statusCode;
+  _state = ERROR;
+}
+
+/*
+ * Devuelve donde escribir la siguiente lectura (al menos minSpace bytes).
+ * Antes de crecer, reaprovecha el espacio de lo ya consumido moviendo al
+ * principio solo lo que sigue vivo: la cabecera de la petición actual (las
+ * vistas apuntan ahí) y los bytes aún sin parsear.
+ */
+char* HttpParser::prepareRead(std::size_t minSpace, std::size_t& space) {
+  if (minSpace == 0) minSpace = 1;
+  if (_pos == _end && _reqStart == _pos) {
+    // Todo consumido: volver al principio sin mover nada
+    _reqStart = _headEnd = _pos = _end = _scan = 0;
+  }
+  if (_in.size() - _end < minSpace) compact();
+  if (_in.size() - _end < minSpace) {
+    std::size_t grown = _in.size() * 2;
+    if (grown < _end + minSpace) grown = _end + minSpace;
+    _in.resize(grown);
+  }
+  space = _in.size() - _end;
+  return &_in[0] + _end;
+}
+
+void HttpParser::commitRead(std::size_t len) { _end += len; }
+
+void HttpParser::compact() {
+  if (_reqStart == 0 && _headEnd == _pos) return;  // nada que recuperar
+  std::size_t headLen = _headEnd - _reqStart;
+  std::size_t pending = _end - _pos;
+  std::size_t scanned = (_scan > _pos) ? _scan - _pos : 0;
+  char* base = _in.empty() ? 0 : &_in[0];
+  if (headLen > 0) std::memmove(base, base + _reqStart, headLen);
+  if (pending > 0) std::memmove(base + headLen, base + _pos, pending);
+  _reqStart = 0;
+  _headEnd = headLen;
+  _pos = headLen;
+  _end = headLen + pending;
+  _scan = _pos + scanned;
+}
+
 /*
- * Consume los datos recibidos del cliente y los procesa.
+ * Copia los datos al buffer de entrada y los procesa. El servidor no pasa
+ * por aquí (recv() escribe directo con prepareRead()); lo usan tests y
+ * benchmarks.
  * @param data: Los datos recibidos del cliente.
  */
 void HttpParser::consume(const std::string& data) {
-  _buffer.append(data);
+  consume(data.data(), data.size());
+}
 
+void HttpParser::consume(const char* data, std::size_t len) {
+  if (len > 0) {
+    std::size_t space = 0;
+    std::memcpy(prepareRead(len, space), data, len);
+    commitRead(len);
+  }
+  parse();
+}
+
+/*
+ * Avanza la máquina de estados sobre los bytes aún no consumidos.
+ */
+void HttpParser::parse() {
   while (true) {
     State prevState = _state;
 
@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #include "HttpRequest.hpp"
 
@@ -22,27 +23,70 @@ enum StateChunk {
   CHUNK_COMPLETE
 };
 
+// Trozo de la cabecera de la peticion: (offset, longitud) relativos a
+// HttpParser::getHeadData(). No copia nada.
+struct HttpSpan {
+  std::size_t offset;
+  std::size_t length;
+};
+
+struct HttpHeaderField {
+  HttpSpan name;   // tal cual llego (sin pasar a minusculas)
+  HttpSpan value;  // sin espacios alrededor
+};
+
 class HttpParser {
  public:
   HttpParser();
   ~HttpParser();
   // Estas funciones es lo unico que otra clase puede hacer con el parser
   void reset();
+  // reset() + descarta datos pipelined pendientes (conexion nueva/reciclada).
+  void clear();
+  // Copia data al buffer de entrada y parsea (tests, benchmarks).
   void consume(const std::string& data);
+  void consume(const char* data, std::size_t len);
+
+  // ---- Lectura directa al buffer de entrada (sin copias) ----
+  // recv() escribe en prepareRead(); commitRead() anota los bytes recibidos
+  // y parse() avanza la maquina de estados sobre ellos.
+  char* prepareRead(std::size_t minSpace, std::size_t& space);
+  void commitRead(std::size_t len);
+  void parse();
+
   State getState() const;
   const HttpRequest& getRequest() const;
   int getErrorStatusCode() const;
 
+  // ---- Vistas sobre la peticion actual (validas hasta reset()) ----
+  // Request line y cabeceras siguen en el buffer de entrada; los spans
+  // son offsets desde getHeadData(), que puede moverse en cada lectura.
+  const char* getHeadData() const;
+  const HttpSpan& getMethodSpan() const { return _method; }
+  const HttpSpan& getTargetSpan() const { return _target; }
+  const HttpSpan& getVersionSpan() const { return _version; }
+  const std::vector<HttpHeaderField>& getHeaderFields() const {
+    return _fields;
+  }
+
   // Set max body size from config (client_max_body_size). Call before consume().
   void setMaxBodySize(std::size_t maxSize) { _maxBodySize = maxSize; }
 
+  // Con las cabeceras ya parseadas, el dueño decide una vez donde va el
+  // body: en memoria o, pasado memoryLimit, a un temporal dentro de dir.
+  bool needsBodyStorage() const;
+  void storeBodyInMemory();
+  void spillBodyTo(const std::string& dir, std::size_t memoryLimit);
+
+  // Request line + cabeceras: mas alla se responde 431 (o 414 si ni
+  // siquiera termino la request line).
+  static const std::size_t MAX_HEAD_SIZE = 32768;
+
  private:
   // Estado y datos internos
   State _state;
   StateChunk _stateChunk;
   HttpRequest _request;
-  std::string _buffer;       // acumulador interno para líneas/body pendientes
-  std::string _chunkBuffer;  // acumulador interno para cuerpos de chunked
   std::size_t _contentLength;
   bool _isChunked;
   std::size_t _bytesRead;
@@ -50,20 +94,37 @@ class HttpParser {
   std::size_t _maxBodySize;  // límite desde config; 0 = sin límite
   int _errorStatusCode;  // 400 por defecto; 403 para directory traversal
 
+  // ---- Buffer de entrada (se reutiliza entre peticiones y lecturas) ----
+  //   [0, _reqStart)       peticiones anteriores, ya descartables
+  //   [_reqStart, _headEnd) request line + cabeceras de la actual (vistas)
+  //   [_pos, _end)          recibido y aun sin consumir
+  // Mientras se parsean las cabeceras _headEnd == _pos.
+  std::vector<char> _in;
+  std::size_t _reqStart;
+  std::size_t _headEnd;
+  std::size_t _pos;
+  std::size_t _end;
+  std::size_t _scan;  // "\r\n" ya buscado hasta aqui: no se re-escanea
+
+  HttpSpan _method;
+  HttpSpan _target;
+  HttpSpan _version;
+  std::vector<HttpHeaderField> _fields;
+
   // Helpers generales
-  bool extractLine(std::string& line);
+  bool extractLine(std::size_t& lineStart, std::size_t& lineLen);
+  void compact();
+  void fail(int statusCode);
 
   // Start line
-  bool splitStartLine(const std::string& line, std::string& method,
-                      std::string& uri, std::string& version);
-  void parseUri(const std::string& uri);
+  bool splitStartLine(std::size_t start, std::size_t len);
+  void parseUri(const char* uri, std::size_t len);
   void parseStartLine();
 
   // Headers
-  bool splitHeaderLine(const std::string& line, std::string& key,
-                       std::string& value);
-  void handleHeader(const std::string& key, const std::string& value);
-  bool processHeaderLine(const std::string& line);
+  bool splitHeaderLine(std::size_t start, std::size_t len,
+                       HttpHeaderField& field) const;
+  void handleHeader(const HttpHeaderField& field);
   void parseHeaders();
   bool validateHeaders() const;
 
@@ -1,9 +1,15 @@
 #include <algorithm>
-#include <cstdlib>
-#include <vector>
+#include <cstring>
 
 #include "HttpParser.hpp"
 
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
 // PARSE BODY ---------------------------------------------------------------
 void HttpParser::parseBody() {
   if (_isChunked)
@@ -19,54 +25,55 @@ void HttpParser::parseBody() {
 void HttpParser::parseBodyFixedLength() {
   // Check si el tamano total esperado supera el límite.
   if (_maxBodySize > 0 && _contentLength > _maxBodySize) {
-    _errorStatusCode = 413;
-    _state = ERROR;
+    fail(413);
     return;
   }
 
   std::size_t remaining = 0;
   if (_contentLength > _bytesRead) remaining = _contentLength - _bytesRead;
 
-  std::size_t toRead = std::min(_buffer.size(), remaining);
+  std::size_t toRead = std::min(_end - _pos, remaining);
   if (toRead > 0) {
-    _request.addBody(_buffer.begin(), _buffer.begin() + toRead);
+    _request.addBody(&_in[0] + _pos, toRead);
     // necesito saber cuantos bytes del body he llevo acumulados para saber si
     // he leido todo el body.
     //  y comparar con el content-length para saber si he leido todo el body.
     _bytesRead += toRead;
-    // elimino los bytes leidos del buffer para no leerlos de nuevo.
-    _buffer.erase(0, toRead);
+    // avanzo el cursor para no leerlos de nuevo.
+    _pos += toRead;
   }
 
   if (_bytesRead == _contentLength) _state = COMPLETE;
 }
 
 bool HttpParser::parseChunkSizeLine(std::size_t& size) {
-  std::string line;
-  std::string::size_type semi;
-  char* endPtr = 0;
-  unsigned long value = 0;
-
-  if (!extractLine(line)) return false;  // falta data
-  // OJO! Según el protocolo, aquí debe haber un número. Si no hay, es un error.
-  if (line.empty()) {
-    _errorStatusCode = 400;
-    _state = ERROR;
-    return false;
-  }
+  std::size_t start = 0;
+  std::size_t len = 0;
+
+  if (!extractLine(start, len)) return false;  // falta data
+  const char* line = &_in[0] + start;
 
   // OJO! El estándar HTTP (RFC 9112) dice explícitamente: "Un receptor DEBE
   // ignorar las extensiones de chunk que no comprenda
   //  Ignorar extensiones (ej: "1a;ext=foo")
-  semi = line.find(';');
-  if (semi != std::string::npos) line = line.substr(0, semi);
-  // strtoul mueve el puntero endPtr hasta donde dejó de leer.
-  // Si endPtr se queda al principio del string (line.c_str()), significa que no
-  // pudo leer ni un solo número válido.
-  value = std::strtoul(line.c_str(), &endPtr, 16);
-  if (endPtr == line.c_str()) {
-    _errorStatusCode = 400;
-    _state = ERROR;
+  const char* semi = static_cast<const char*>(std::memchr(line, ';', len));
+  if (semi != 0) len = semi - line;
+
+  // OJO! Según el protocolo, aquí debe haber un número hexadecimal. Si no
+  // hay ni un dígito válido, o no cabe en size_t, es un error.
+  std::size_t value = 0;
+  std::size_t digits = 0;
+  for (; digits < len; ++digits) {
+    int digit = hexDigit(line[digits]);
+    if (digit < 0) break;
+    if (value > (static_cast<std::size_t>(-1) >> 4)) {
+      fail(400);
+      return false;
+    }
+    value = (value << 4) | static_cast<std::size_t>(digit);
+  }
+  if (digits == 0) {
+    fail(400);
     return false;
   }
 
@@ -95,24 +102,33 @@ bool HttpParser::handleChunkSizeState() {
 bool HttpParser::handleChunkDataState() {
   // Necesitamos datos + "\r\n"
   std::size_t needed = _chunkSize + 2;
-  // OJO! Si el buffer no tiene suficientes bytes, faltan datos.
-  if (_buffer.size() < needed) return false;  // falta data
+  std::size_t available = _end - _pos;
+  const char* data = &_in[0] + _pos;
+  // OJO! Si el buffer no tiene suficientes bytes, faltan datos. Lo que ya
+  // haya del chunk se pasa al body ahora: un chunk enorme no se queda
+  // entero en _in (la subida puede ir a disco, ver setBodySpill).
+  if (available < needed) {
+    std::size_t partial = std::min(available, _chunkSize);
+    if (partial > 0) {
+      _request.addBody(data, partial);
+      _pos += partial;
+      _chunkSize -= partial;
+      if (_maxBodySize > 0 && _request.getBodySize() > _maxBodySize) fail(413);
+    }
+    return false;  // falta data
+  }
 
-  if (_buffer[_chunkSize] != '\r' || _buffer[_chunkSize + 1] != '\n') {
-    _errorStatusCode = 400;
-    _state = ERROR;
+  if (data[_chunkSize] != '\r' || data[_chunkSize + 1] != '\n') {
+    fail(400);
     return false;
   }
   // solo copiamos los datos, no copiamos el \r\n
-  if (_chunkSize > 0)
-    _request.addBody(_buffer.begin(), _buffer.begin() + _chunkSize);
-  _buffer.erase(0, needed);  // datos + CRLF
+  if (_chunkSize > 0) _request.addBody(data, _chunkSize);
+  _pos += needed;  // datos + CRLF
 
   // Límite de body desde config: rechazar si chunked body supera max_body_size
-  if (_maxBodySize > 0 &&
-      _request.getBody().size() > _maxBodySize) {
-    _errorStatusCode = 413;
-    _state = ERROR;
+  if (_maxBodySize > 0 && _request.getBodySize() > _maxBodySize) {
+    fail(413);
     return false;
   }
 
@@ -132,10 +148,11 @@ Expires: Wed, 21 Oct 2025 07:28:00 GMT\r\n  <-- ESTO ES UN TRAILER
 */
 bool HttpParser::handleChunkEndState() {
   // Después de "0\r\n" puede venir "\r\n" final o trailers.
-  std::string line;
-  if (!extractLine(line)) return false;  // falta data
+  std::size_t start = 0;
+  std::size_t len = 0;
+  if (!extractLine(start, len)) return false;  // falta data
 
-  if (line.empty()) {
+  if (len == 0) {
     _stateChunk = CHUNK_COMPLETE;
     _state = COMPLETE;
     return false;
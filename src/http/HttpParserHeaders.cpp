@@ -1,17 +1,51 @@
-#include <cstdlib>
+#include <cstring>
 
-#include "HttpHeaderUtils.hpp"
 #include "HttpParser.hpp"
-
-// Helpers moved to HttpHeaderUtils
+#include "HttpScan.hpp"
+
+// Como strtoul(value, 0, 10) pero sobre un trozo sin '\0' al final.
+static std::size_t parseDecimal(const char* data, std::size_t len) {
+  std::size_t value = 0;
+  for (std::size_t i = 0; i < len; ++i) {
+    if (data[i] < '0' || data[i] > '9') break;
+    std::size_t digit = static_cast<std::size_t>(data[i] - '0');
+    if (value > (static_cast<std::size_t>(-1) - digit) / 10)
+      return static_cast<std::size_t>(-1);  // satura, igual que strtoul
+    value = value * 10 + digit;
+  }
+  return value;
+}
 
 /**
- * @brief Divide una linea de header en key y value
- *
+ * @brief Divide una linea de header en key y value (como spans sobre _in).
+ * La key tiene que ser un token pegado a ':' y el value no puede llevar
+ * caracteres de control; queda sin espacios ni tabuladores alrededor.
  */
-bool HttpParser::splitHeaderLine(const std::string& line, std::string& key,
-                                 std::string& value) {
-  return http_header_utils::splitHeaderLine(line, key, value);
+bool HttpParser::splitHeaderLine(std::size_t start, std::size_t len,
+                                 HttpHeaderField& field) const {
+  const char* line = &_in[0] + start;
+  const char* lineEnd = line + len;
+  const char* colon = http_scan::skipToken(line, lineEnd);
+  if (colon == line || colon == lineEnd || *colon != ':') return false;
+
+  std::size_t nameLen = colon - line;
+  std::size_t valueStart = nameLen + 1;
+  while (valueStart < len &&
+         (line[valueStart] == ' ' || line[valueStart] == '\t'))
+    ++valueStart;
+  if (http_scan::skipFieldValue(line + valueStart, lineEnd) != lineEnd)
+    return false;
+  std::size_t valueEnd = len;
+  while (valueEnd > valueStart &&
+         (line[valueEnd - 1] == ' ' || line[valueEnd - 1] == '\t'))
+    --valueEnd;
+
+  std::size_t base = start - _reqStart;
+  field.name.offset = base;
+  field.name.length = nameLen;
+  field.value.offset = base + valueStart;
+  field.value.length = valueEnd - valueStart;
+  return true;
 }
 
 /**
@@ -19,32 +53,30 @@ bool HttpParser::splitHeaderLine(const std::string& line, std::string& key,
  *   añadirlos al mapa de headers del request ademas de
  *   manejar el content-length y el transfer-encoding activando
  *   el la flag de chunk si es necesario
- * @param key: La key del header
- * @param value: El valor del header
+ * @param field: key y value como spans sobre la cabecera
  */
-void HttpParser::handleHeader(const std::string& key,
-                              const std::string& value) {
-  std::string keyLower;
-  std::string valueLower;
-
-  // Normalizamos una sola vez y usamos la misma clave para:
-  // 1) guardar en el mapa
-  // 2) comparar
-  keyLower = http_header_utils::toLowerCopy(key);
-  _request.addHeaders(keyLower, value);
-  if (keyLower == "content-length") {
-    // convierte el valor a un numero entero
+void HttpParser::handleHeader(const HttpHeaderField& field) {
+  const char* head = getHeadData();
+  const char* key = head + field.name.offset;
+  const char* value = head + field.value.offset;
+
+  // addHeader() normaliza la clave a minúsculas al guardarla y la resuelve
+  // (hash perfecto) a un id si es una de las conocidas
+  HttpHeaderId id =
+      _request.addHeader(key, field.name.length, value, field.value.length);
+  _fields.push_back(field);
+
+  if (id == HTTP_HEADER_CONTENT_LENGTH) {
     // cuántos bytes exactos debe esperar antes de marcar la petición como
     // COMPLETE.
-    _contentLength = std::strtoul(value.c_str(), 0, 10);
+    _contentLength = parseDecimal(value, field.value.length);
     return;
   }
 
-  if (keyLower == "transfer-encoding") {
+  if (id == HTTP_HEADER_TRANSFER_ENCODING) {
     // Esto hará que tu parser ignore el Content-Length y use la lógica
     // de los "vagones" (hexadecimales) que programaste en parseBodyChunked()
-    valueLower = http_header_utils::toLowerCopy(value);
-    if (valueLower.find("chunked") != std::string::npos) _isChunked = true;
+    if (_request.getHeader(id).containsIgnoreCase("chunked")) _isChunked = true;
   }
 }
 
@@ -55,7 +87,7 @@ void HttpParser::handleHeader(const std::string& key,
 bool HttpParser::validateHeaders() const {
   // Host es obligatorio en HTTP/1.1
   if (_request.getVersion() == HTTP_VERSION_1_1 &&
-      _request.getHeader("host").empty())
+      _request.getHeader(HTTP_HEADER_HOST).empty())
     return false;
 
   // Si llegan ambos headers (Transfer-Encoding y Content-Length),
@@ -67,32 +99,20 @@ bool HttpParser::validateHeaders() const {
   return true;
 }
 
-bool HttpParser::processHeaderLine(const std::string& line) {
-  std::string key;
-  std::string value;
-
-  if (!splitHeaderLine(line, key, value)) return false;
-
-  handleHeader(key, value);
-  return true;
-}
-
 // PARSE HEADERS -------------------------------------------------------------
 void HttpParser::parseHeaders() {
   while (true) {
-    std::string line;
-    if (!extractLine(line))
+    std::size_t start = 0;
+    std::size_t len = 0;
+    if (!extractLine(start, len))
       return;  // No hay línea completa, esperamos al siguiente epoll()
     // Caso 1: Línea vacía -> Fin de headers
-    if (line.empty() && !validateHeaders()) {
-      _errorStatusCode = (_maxBodySize > 0 && _contentLength > _maxBodySize)
-                             ? 413
-                             : 400;
-      _state = ERROR;
+    if (len == 0 && !validateHeaders()) {
+      fail((_maxBodySize > 0 && _contentLength > _maxBodySize) ? 413 : 400);
       return;
     }
 
-    if (line.empty())  // fin de headers \r\n\r\n
+    if (len == 0)  // fin de headers \r\n\r\n
     {
       if (_isChunked == true || _contentLength > 0)
         _state = PARSING_BODY;
@@ -102,10 +122,11 @@ void HttpParser::parseHeaders() {
     }
 
     // Caso 2: Línea con datos -> Procesar
-    if (!processHeaderLine(line)) {
-      _errorStatusCode = 400;
-      _state = ERROR;
+    HttpHeaderField field;
+    if (!splitHeaderLine(start, len, field)) {
+      fail(400);
       return;
     }
+    handleHeader(field);
   }
 }
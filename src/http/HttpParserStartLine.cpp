@@ -1,66 +1,85 @@
+#include <cstring>
+
 #include "HttpParser.hpp"
+#include "HttpScan.hpp"
 /**
- * Extrae una línea completa del buffer interno (_buffer) y la guarda en la
- * variable line.
- * @param line: La línea extraída del buffer.
- * @return: true si se extrajo la línea, false si no.
+ * Busca la siguiente línea completa (terminada en "\r\n") a partir de _pos.
+ * No copia nada: devuelve dónde empieza la línea en _in y su longitud (sin
+ * el "\r\n") y avanza _pos detrás de ella ("ya está consumida").
+ * @return: true si hay línea completa, false si falta data (o error).
  * ejemplo de buffer: GET /index.html HTTP/1.1\r\nHost: www.example.com\r\n\r\n
- * extractLine devuelve GET /index.html HTTP/1.1
- * borra el buffer "GET /index.html HTTP/1.1\r\n"
- * buffer queda "Host: www.example.com\r\n\r\n"
- * y line queda "GET /index.html HTTP/1.1"
- * y el estado del parser es PARSING_HEADERS ???
+ * la primera llamada devuelve la zona de "GET /index.html HTTP/1.1" y _pos
+ * queda apuntando a "Host: www.example.com\r\n\r\n"
+ *
+ * _scan recuerda hasta dónde ya se buscó: si la línea llega en varios
+ * recv(), cada byte se mira una sola vez.
  */
-bool HttpParser::extractLine(std::string& line) {
-  std::string::size_type pos;
-
-  pos = _buffer.find("\r\n");
-  if (pos == std::string::npos) return false;
-  // si no la borras, la procesarías otra vez en la siguiente llamada.
-  // Borrarla significa: “ya está consumida”,
-  line = _buffer.substr(0, pos);
-  _buffer.erase(0, pos + 2);
-  // DEBUG:
-  // std::cout << "[extractLine] line=" << line << std::endl;
-  return true;
+bool HttpParser::extractLine(std::size_t& lineStart, std::size_t& lineLen) {
+  bool inHead = (_state == PARSING_START_LINE || _state == PARSING_HEADERS);
+  if (_scan < _pos) _scan = _pos;
+
+  while (_scan < _end) {
+    const char* base = &_in[0];
+    const void* found = std::memchr(base + _scan, '\n', _end - _scan);
+    if (found == 0) {
+      _scan = _end;
+      break;
+    }
+    std::size_t at = static_cast<const char*>(found) - base;
+    _scan = at + 1;
+    // Solo cuenta "\r\n": un '\n' suelto forma parte de la línea
+    if (at == _pos || base[at - 1] != '\r') continue;
+    if (inHead && at + 1 - _reqStart > MAX_HEAD_SIZE) break;
+    lineStart = _pos;
+    lineLen = at - 1 - _pos;
+    _pos = at + 1;
+    if (inHead) _headEnd = _pos;
+    return true;
+  }
+
+  // Límites: no acumular indefinidamente una cabecera o una línea sin fin
+  if (inHead && _scan - _reqStart > MAX_HEAD_SIZE)
+    fail(_state == PARSING_START_LINE ? 414 : 431);
+  else if (!inHead && _scan - _pos > MAX_HEAD_SIZE)
+    fail(400);
+  return false;
 }
 
 /**
  * Divide la línea de inicio de la petición HTTP en method, uri y version.
- * @param line: La línea de inicio de la petición HTTP.
- * @param method: El método HTTP.
- * @param uri: La URI.
- * @param version: La versión de HTTP.
- * @return: true si se dividió la línea correctamente, false si no.
+ * Guarda cada parte como (offset, longitud) desde el inicio de la petición.
+ * @param start: Dónde empieza la línea en _in.
+ * @param len: Longitud de la línea (sin "\r\n").
+ * @return: true si se dividió la línea correctamente, false si no (también
+ * con un método que no es token o una URI vacía o con caracteres de control).
  * ejemplo: line : GET /index.html?query=value HTTP/1.1 METHOD SP URI SP VERSION
  * method: "GET" firstSpace: 3
- * uri: "/index.html" secondSpace: 27
+ * uri: "/index.html?query=value" secondSpace: 27
  * version: "HTTP/1.1"
  */
-bool HttpParser::splitStartLine(const std::string& line, std::string& method,
-                                std::string& uri, std::string& version) {
-  // DEBUG:
-  // std::cout << "[splitStartLine] raw line=" << line << std::endl;
-
-  // METHOD SP URI SP VERSION -> 3 partes
-  std::string::size_type firstSpace;
-  std::string::size_type secondSpace;
-
-  firstSpace = line.find(' ');
-  if (firstSpace == std::string::npos) return false;
-
-  secondSpace = line.find(' ', firstSpace + 1);
-  if (secondSpace == std::string::npos) return false;
-
-  method = line.substr(0, firstSpace);
-  uri = line.substr(firstSpace + 1,
-                    secondSpace - firstSpace - 1);  // size de la uri
-  version = line.substr(secondSpace + 1);
-
-  // DEBUG:
-  // std::cout << "[splitStartLine] method=" << method
-  //           << " uri=" << uri
-  //           << " version=" << version << std::endl;
+bool HttpParser::splitStartLine(std::size_t start, std::size_t len) {
+  // METHOD SP URI SP VERSION -> 3 partes. El mismo recorrido que busca
+  // cada espacio valida lo que va antes (tchar en el método, sin
+  // controles en la URI), de 16/32 bytes en 16/32 bytes.
+  const char* line = &_in[0] + start;
+  const char* lineEnd = line + len;
+
+  const char* firstSpace = http_scan::skipToken(line, lineEnd);
+  if (firstSpace == line || firstSpace == lineEnd || *firstSpace != ' ')
+    return false;
+
+  const char* uri = firstSpace + 1;
+  const char* secondSpace = http_scan::skipTarget(uri, lineEnd);
+  if (secondSpace == uri || secondSpace == lineEnd || *secondSpace != ' ')
+    return false;
+
+  std::size_t base = start - _reqStart;
+  _method.offset = base;
+  _method.length = firstSpace - line;
+  _target.offset = base + (firstSpace + 1 - line);
+  _target.length = secondSpace - firstSpace - 1;  // size de la uri
+  _version.offset = base + (secondSpace + 1 - line);
+  _version.length = lineEnd - secondSpace - 1;
   return true;
 }
 
@@ -72,34 +91,22 @@ bool HttpParser::splitStartLine(const std::string& line, std::string& method,
  * Ejemplos que SÍ rechazamos: /../, /foo/../bar, ../x
  * Ejemplos que NO rechazamos: file..txt, /foto..jpg (son nombres de archivo normales)
  */
-static bool containsParentPathSegment(const std::string& path) {
-  std::string::size_type search_pos = 0;
-
-  while (search_pos < path.length()) {
-    // Buscar la siguiente aparición de ".."
-    std::string::size_type found_at = path.find("..", search_pos);
-
-    if (found_at == std::string::npos) {
-      // No hay más "..", el path está bien
-      return false;
-    }
+static bool containsParentPathSegment(const char* path, std::size_t len) {
+  for (std::size_t i = 0; i + 1 < len; ++i) {
+    if (path[i] != '.' || path[i + 1] != '.') continue;
 
     // ¿Está el ".." justo al inicio del path o después de una barra?
-    bool is_valid_start = (found_at == 0) || (path[found_at - 1] == '/');
+    bool is_valid_start = (i == 0) || (path[i - 1] == '/');
 
     // ¿Termina el ".." al final del path o va seguido de una barra?
-    bool is_valid_end = (found_at + 2 >= path.length()) ||
-                        (path[found_at + 2] == '/');
+    bool is_valid_end = (i + 2 >= len) || (path[i + 2] == '/');
 
     if (is_valid_start && is_valid_end) {
       // Encontramos ".." como segmento de path -> intento de directory traversal
       return true;
     }
-
     // Seguir buscando por si hay otro ".." más adelante
-    search_pos = found_at + 1;
   }
-
   return false;
 }
 
@@ -107,31 +114,23 @@ static bool containsParentPathSegment(const std::string& path) {
  * Extrae el path y el query string de la URI.
  * Ejemplo: "/index.html?nombre=ana" -> path="/index.html", query="nombre=ana"
  */
-void HttpParser::parseUri(const std::string& uri) {
-  std::string path;
-  std::string query;
-
+void HttpParser::parseUri(const char* uri, std::size_t len) {
   // Separar path y query por el ?
-  // Ejemplo: /index.html?nombre=ana -> path="/index.html", query="nombre=ana"
-  std::string::size_type question_mark_pos = uri.find('?');
-
-  if (question_mark_pos != std::string::npos) {
-    path = uri.substr(0, question_mark_pos);
-    query = uri.substr(question_mark_pos + 1);
-  } else {
-    path = uri;
-    query = "";
-  }
+  const char* questionMark =
+      static_cast<const char*>(std::memchr(uri, '?', len));
+  std::size_t pathLen = questionMark ? questionMark - uri : len;
 
   // Seguridad: bloquear intentos de salir del directorio (directory traversal)
-  if (containsParentPathSegment(path)) {
-    _errorStatusCode = 403;
-    _state = ERROR;
+  if (containsParentPathSegment(uri, pathLen)) {
+    fail(403);
     return;
   }
 
-  _request.setPath(path);
-  _request.setQuery(query);
+  _request.setPath(uri, pathLen);
+  if (questionMark)
+    _request.setQuery(questionMark + 1, len - pathLen - 1);
+  else
+    _request.setQuery("", 0);
 }
 
 // PARSE START LINE ----------------------------------------------------------
@@ -141,31 +140,28 @@ void HttpParser::parseUri(const std::string& uri) {
  * version.
  */
 void HttpParser::parseStartLine() {
-  std::string line;
-  std::string method;
-  std::string uri;
-  std::string version;
+  std::size_t start = 0;
+  std::size_t len = 0;
 
-  if (!extractLine(line)) return;
+  if (!extractLine(start, len)) return;
 
   // Ignorar líneas vacías (ej: \r\n al inicio) y esperar la start line real
-  while (line.empty()) {
-    if (!extractLine(line)) return;
+  while (len == 0) {
+    _reqStart = _pos;
+    if (!extractLine(start, len)) return;
   }
 
-  if (!splitStartLine(line, method, uri, version)) {
-    _errorStatusCode = 400;
-    _state = ERROR;
+  if (!splitStartLine(start, len)) {
+    fail(400);
     return;
   }
 
   // Porque HttpRequest es la estructura que guarda la petición ya parseada.
-  _request.setMethod(method);
-  _request.setVersion(version);
-  parseUri(uri);
+  const char* head = getHeadData();
+  _request.setMethod(head + _method.offset, _method.length);
+  _request.setVersion(head + _version.offset, _version.length);
+  parseUri(head + _target.offset, _target.length);
+  if (_state == ERROR) return;
 
-  // actualizo el estado
-  //  DEBUG:
-  //  std::cout << "[parseStartLine] state -> PARSING_HEADERS" << std::endl;
   _state = PARSING_HEADERS;
 }
@@ -1,7 +1,25 @@
 #include "HttpRequest.hpp"
 
-#include <algorithm>  //para convertir a mayúsculas transform
-#include <cctype>     //para convertir a minúsculas
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>  // toupper
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// mkstemp() crea el temporal con 0600 y rename() conserva el modo: antes de
+// moverlo se le da el de cualquier fichero nuevo (0666 menos la umask), el
+// mismo que tiene una subida que se escribio desde memoria. La umask se lee
+// una vez, al arrancar (umask() solo se consulta cambiandola).
+static mode_t currentUmask() {
+  mode_t mask = umask(022);
+  umask(mask);
+  return mask;
+}
+
+static const mode_t UPLOAD_FILE_MODE = 0666 & ~currentUmask();
 
 // ============================================================================
 // CONSTRUCTOR Y DESTRUCTOR
@@ -14,31 +32,60 @@ HttpRequest::HttpRequest()
       _headers(),
       _status(HTTP_STATUS_PENDING),
       _path(),
-      _query() {}
+      _query(),
+      _body(),
+      _bodySize(0),
+      _bodyStorageDecided(false),
+      _spillDir(),
+      _spillLimit(0),
+      _bodyWriteFailed(false),
+      _bodyFd(-1),
+      _bodyFilePath(),
+      _routeServer(0),
+      _routeLocation(0) {}
 // constructor de inicialización
 HttpRequest::HttpRequest(const std::string& method, const std::string& version,
-                         const HeaderMap& headers, const std::string& path,
-                         const std::string& query,
+                         const std::string& path, const std::string& query,
                          const std::vector<char>& body)
     : _method(HTTP_METHOD_UNKNOWN),
       _version(HTTP_VERSION_UNKNOWN),
-      _headers(headers),
+      _headers(),
       _status(HTTP_STATUS_PENDING),
       _path(path),
       _query(query),
-      _body(body) {
+      _body(body),
+      _bodySize(body.size()),
+      _bodyStorageDecided(false),
+      _spillDir(),
+      _spillLimit(0),
+      _bodyWriteFailed(false),
+      _bodyFd(-1),
+      _bodyFilePath(),
+      _routeServer(0),
+      _routeLocation(0) {
   setMethod(method);    // ← Convierte "GET" → HTTP_METHOD_GET
   setVersion(version);  // ← Convierte "HTTP/1.1" → HTTP_VERSION_1_1
 }
 
-// constructor de copia
+// constructor de copia. El fichero temporal del body no se copia: sigue
+// siendo solo del original.
 HttpRequest::HttpRequest(const HttpRequest& other)
     : _method(other._method),
       _version(other._version),
       _headers(other._headers),
       _status(other._status),
       _path(other._path),
-      _query(other._query) {}
+      _query(other._query),
+      _body(other._body),
+      _bodySize(other._body.size()),
+      _bodyStorageDecided(other._bodyStorageDecided),
+      _spillDir(),
+      _spillLimit(0),
+      _bodyWriteFailed(other._bodyWriteFailed),
+      _bodyFd(-1),
+      _bodyFilePath(),
+      _routeServer(other._routeServer),
+      _routeLocation(other._routeLocation) {}
 
 // operador de asignación
 HttpRequest& HttpRequest::operator=(const HttpRequest& other) {
@@ -48,69 +95,108 @@ HttpRequest& HttpRequest::operator=(const HttpRequest& other) {
     _headers = other._headers;
     _path = other._path;
     _query = other._query;
+    discardBodyFile();
     _body = other._body;
+    _bodySize = other._body.size();
+    _bodyStorageDecided = other._bodyStorageDecided;
+    _spillDir.clear();
+    _spillLimit = 0;
+    _bodyWriteFailed = other._bodyWriteFailed;
     _status = other._status;
+    _routeServer = other._routeServer;
+    _routeLocation = other._routeLocation;
   }
   return *this;
 }
 
-HttpRequest::~HttpRequest() {}
+HttpRequest::~HttpRequest() { discardBodyFile(); }
 
 // ============================================================================
 // SETTERS (usados por el parser)
 // ============================================================================
 /**
- * @brief Convierte el método HTTP a mayúsculas y lo asigna al atributo _method
+ * @brief Convierte el método HTTP (sin distinguir mayúsculas) en _method
  *
  * @param method
  */
 void HttpRequest::setMethod(const std::string& method) {
-  std::string upperMethod = method;
-  // transform recibe 3 argumentos:
-  // 1. El inicio del rango de caracteres a transformar
-  // 2. El final del rango de caracteres a transformar
-  // 3. El resultado de la transformación
+  setMethod(method.data(), method.size());
+}
+
+void HttpRequest::setVersion(const std::string& version) {
+  setVersion(version.data(), version.size());
+}
 
-  std::transform(upperMethod.begin(), upperMethod.end(), upperMethod.begin(),
-                 ::toupper);
+// Compara en mayúsculas letra a letra contra un método conocido, sin copiar
+// el método a un string.
+static bool equalsUpper(const char* data, std::size_t len, const char* upper) {
+  std::size_t i = 0;
+  for (; i < len && upper[i] != '\0'; ++i) {
+    if (std::toupper(static_cast<unsigned char>(data[i])) != upper[i])
+      return false;
+  }
+  return i == len && upper[i] == '\0';
+}
 
-  if (upperMethod == "GET")
+void HttpRequest::setMethod(const char* method, std::size_t len) {
+  if (equalsUpper(method, len, "GET"))
     _method = HTTP_METHOD_GET;
-  else if (upperMethod == "POST")
+  else if (equalsUpper(method, len, "POST"))
     _method = HTTP_METHOD_POST;
-  else if (upperMethod == "DELETE")
+  else if (equalsUpper(method, len, "DELETE"))
     _method = HTTP_METHOD_DELETE;
-  else if (upperMethod == "HEAD")
+  else if (equalsUpper(method, len, "HEAD"))
     _method = HTTP_METHOD_HEAD;
   else
     _method = HTTP_METHOD_UNKNOWN;
 }
 
-void HttpRequest::setVersion(const std::string& version) {
-  if (version == "HTTP/1.0")
+void HttpRequest::setVersion(const char* version, std::size_t len) {
+  if (len == 8 && std::memcmp(version, "HTTP/1.0", 8) == 0)
     _version = HTTP_VERSION_1_0;
-  else if (version == "HTTP/1.1")
+  else if (len == 8 && std::memcmp(version, "HTTP/1.1", 8) == 0)
     _version = HTTP_VERSION_1_1;
   else
     _version = HTTP_VERSION_UNKNOWN;
 }
 
 /**
- * @brief Agrega un header al mapa. La clave debe venir ya normalizada en
- * minúsculas.
+ * @brief Agrega un header a la tabla.
  *
- * @param key : nombre del header (ya en minúsculas)
+ * @param key : nombre del header (se guarda en minúsculas)
  * @param value : contenido del header ej: "localhost:8080"
- * @note HTTP es case-insensitive, por eso el parser normaliza antes.
+ * @note HTTP es case-insensitive, por eso se normaliza al guardar.
  */
 void HttpRequest::addHeaders(const std::string& key, const std::string& value) {
-  _headers[key] = value;
+  addHeader(key.data(), key.size(), value.data(), value.size());
 }
 
-void HttpRequest::setPath(const std::string& path) { _path = path; }
+/**
+ * @brief Igual que addHeaders() pero desde el buffer del parser: nombre y
+ * valor se copian a la tabla (que reutiliza su memoria), sin strings.
+ */
+HttpHeaderId HttpRequest::addHeader(const char* key, std::size_t keyLen,
+                                    const char* value, std::size_t valueLen) {
+  return _headers.add(key, keyLen, value, valueLen);
+}
+
+void HttpRequest::setPath(const std::string& path) {
+  _path = path;
+  setRoute(0, 0);
+}
 
 void HttpRequest::setQuery(const std::string& query) { _query = query; }
 
+// assign() reutiliza la capacidad que ya tenían de la petición anterior
+void HttpRequest::setPath(const char* path, std::size_t len) {
+  _path.assign(path, len);
+  setRoute(0, 0);
+}
+
+void HttpRequest::setQuery(const char* query, std::size_t len) {
+  _query.assign(query, len);
+}
+
 // void HttpRequest::addBody(const std::vector<char>& chunk)
 // {
 //     _body.insert(_body.end(), chunk.begin(), chunk.end());
@@ -119,8 +205,75 @@ void HttpRequest::setQuery(const std::string& query) { _query = query; }
 void HttpRequest::addBody(std::string::const_iterator begin,
                           std::string::const_iterator end) {
   if (begin == end) return;
+  addBody(&*begin, static_cast<std::size_t>(end - begin));
+}
+
+void HttpRequest::addBody(const char* data, std::size_t len) {
+  if (len == 0) return;
+  _bodySize += len;
+  if (_bodyFd != -1) {
+    appendToBodyFile(data, len);
+    return;
+  }
+  if (_bodyWriteFailed) return;  // el temporal fallo: ya es un 500
   // vector.insert(donde_pegar, inicio_del_rango, fin_del_rango);
-  _body.insert(_body.end(), begin, end);
+  _body.insert(_body.end(), data, data + len);
+  if (!_spillDir.empty() && _body.size() > _spillLimit) spillBodyToFile();
+}
+
+void HttpRequest::setBodyInMemory() { _bodyStorageDecided = true; }
+
+void HttpRequest::setBodySpill(const std::string& dir,
+                               std::size_t memoryLimit) {
+  _bodyStorageDecided = true;
+  _spillDir = dir;
+  _spillLimit = memoryLimit;
+  if (_body.size() > _spillLimit) spillBodyToFile();
+}
+
+// Crea el temporal (nombre unico con mkstemp) y mueve ahi lo que habia en
+// memoria. A partir de aqui addBody() escribe directo al fichero.
+void HttpRequest::spillBodyToFile() {
+  std::string templ = _spillDir;
+  if (templ.empty() || templ[templ.size() - 1] != '/') templ += '/';
+  templ += ".upload_XXXXXX";
+  std::vector<char> name(templ.begin(), templ.end());
+  name.push_back('\0');
+
+  int fd = mkstemp(&name[0]);
+  if (fd == -1) {
+    _bodyWriteFailed = true;
+    std::vector<char>().swap(_body);
+    return;
+  }
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+  _bodyFd = fd;
+  _bodyFilePath = &name[0];
+  if (!_body.empty()) appendToBodyFile(&_body[0], _body.size());
+  std::vector<char>().swap(_body);  // devolver la memoria, no solo vaciar
+}
+
+void HttpRequest::appendToBodyFile(const char* data, std::size_t len) {
+  while (len > 0 && !_bodyWriteFailed) {
+    ssize_t written = write(_bodyFd, data, len);
+    if (written <= 0) {
+      _bodyWriteFailed = true;  // disco lleno, cuota...
+      return;
+    }
+    data += written;
+    len -= static_cast<std::size_t>(written);
+  }
+}
+
+void HttpRequest::discardBodyFile() {
+  if (_bodyFd != -1) {
+    close(_bodyFd);
+    _bodyFd = -1;
+  }
+  if (!_bodyFilePath.empty()) {
+    unlink(_bodyFilePath.c_str());
+    _bodyFilePath.clear();
+  }
 }
 
 // ============================================================================
@@ -141,41 +294,71 @@ HttpVersion HttpRequest::getVersion() const { return _version; }
  *
  */
 
-const std::string& HttpRequest::getHeader(const std::string& key) const {
-  // TODO: Optimización futura (cachear los resultados)
-
-  std::string lowerKey;
-  // static porque se crea una sola vez y se reutiliza en todas las llamadas a
-  // la función
-  static const std::string empty = "";
-
-  lowerKey = key;
-  std::transform(lowerKey.begin(), lowerKey.end(), lowerKey.begin(), ::tolower);
-  HeaderMap::const_iterator it = _headers.find(lowerKey);
-  if (it != _headers.end()) return it->second;  // value lo que nos interesa
+std::string HttpRequest::getHeader(const std::string& key) const {
+  return _headers.get(key.data(), key.size()).str();
+}
 
-  return empty;
+HttpHeaderView HttpRequest::getHeader(HttpHeaderId id) const {
+  return _headers.get(id);
 }
 
+bool HttpRequest::hasHeader(HttpHeaderId id) const { return _headers.has(id); }
+
 /**
  * @brief Obtiene todos los headers de la petición
  *
- * @return const HttpRequest::HeaderMap& : es un mapa con todos los headers
- * y util para CGI que necesita iterar sobre todos los headers para variables de
+ * @return const HttpHeaderTable& : todos los headers en orden de llegada,
+ * util para CGI que necesita iterar sobre todos los headers para variables de
  * entorno.  Carles
  */
-const HttpRequest::HeaderMap& HttpRequest::getHeaders() const {
-  return _headers;  // Devolver referencia constante al mapa completo
+const HttpHeaderTable& HttpRequest::getHeaders() const {
+  return _headers;  // Devolver referencia constante a la tabla completa
 }
 
 std::string HttpRequest::getPath() const { return _path; }
 
 std::string HttpRequest::getQuery() const { return _query; }
 
-std::vector<char> HttpRequest::getBody() const { return _body; }
+const std::vector<char>& HttpRequest::getBody() const { return _body; }
+
+std::size_t HttpRequest::getBodySize() const { return _bodySize; }
+
+bool HttpRequest::isBodyStorageDecided() const { return _bodyStorageDecided; }
+
+bool HttpRequest::isBodyInFile() const { return !_bodyFilePath.empty(); }
+
+bool HttpRequest::hasBodyWriteError() const { return _bodyWriteFailed; }
+
+bool HttpRequest::moveBodyFileTo(const std::string& dest) const {
+  if (_bodyFilePath.empty() || _bodyWriteFailed) return false;
+  if (_bodyFd != -1) {
+    fchmod(_bodyFd, UPLOAD_FILE_MODE);
+    close(_bodyFd);
+    _bodyFd = -1;
+  } else {
+    chmod(_bodyFilePath.c_str(), UPLOAD_FILE_MODE);
+  }
+  if (std::rename(_bodyFilePath.c_str(), dest.c_str()) != 0) return false;
+  _bodyFilePath.clear();
+  return true;
+}
 
 HttpStatus HttpRequest::getStatus() const { return _status; }
 
+void HttpRequest::setRoute(const ServerConfig* server,
+                           const LocationConfig* location) const {
+  _routeServer = server;
+  _routeLocation = location;
+}
+
+const ServerConfig* HttpRequest::getRouteServer() const {
+  return _routeServer;
+}
+
+const LocationConfig* HttpRequest::getRouteLocation() const {
+  return _routeLocation;
+}
+
 // ============================================================================
 // HELPERS
 // ============================================================================
@@ -190,11 +373,18 @@ HttpStatus HttpRequest::getStatus() const { return _status; }
 void HttpRequest::clear() {
   _method = HTTP_METHOD_UNKNOWN;
   _version = HTTP_VERSION_UNKNOWN;
-  _headers.clear();
+  _headers.clear();  // conserva la memoria para la siguiente petición
   _path.clear();
   _query.clear();
   _body.clear();
+  _bodySize = 0;
+  discardBodyFile();
+  _bodyStorageDecided = false;
+  _spillDir.clear();
+  _spillLimit = 0;
+  _bodyWriteFailed = false;
   _status = HTTP_STATUS_PENDING;  // resetea el status code HTTP a PENDING
+  setRoute(0, 0);
 }
 
 // ============================================================================
@@ -212,16 +402,12 @@ void HttpRequest::clear() {
  * HTTP_VERSION_UNKNOWN o versión no soportada: cerrar por seguridad
  */
 bool HttpRequest::shouldCloseConnection() const {
-  std::string connectionHeader;
-
-  connectionHeader = getHeader("Connection");
-  std::transform(connectionHeader.begin(), connectionHeader.end(),
-                 connectionHeader.begin(), ::tolower);
+  HttpHeaderView connectionHeader = getHeader(HTTP_HEADER_CONNECTION);
 
   if (_version == HTTP_VERSION_1_1) {
-    return (connectionHeader == "close");
+    return connectionHeader.equalsIgnoreCase("close");
   } else if (_version == HTTP_VERSION_1_0) {
-    return (connectionHeader != "keep-alive");
+    return !connectionHeader.equalsIgnoreCase("keep-alive");
   } else {
     // HTTP_VERSION_UNKNOWN o versión no soportada: cerrar por seguridad
     return true;
@@ -231,7 +417,5 @@ bool HttpRequest::shouldCloseConnection() const {
 // Comprueba si el cliente envió Expect: 100-continue (espera confirmación
 // antes de mandar un body grande)
 bool HttpRequest::hasExpect100Continue() const {
-  std::string expect = getHeader("expect");
-  std::transform(expect.begin(), expect.end(), expect.begin(), ::tolower);
-  return expect.find("100-continue") != std::string::npos;
+  return getHeader(HTTP_HEADER_EXPECT).containsIgnoreCase("100-continue");
 }
@@ -2,10 +2,11 @@
 #define HTTP_REQUEST_HPP
 
 #include <iostream>
-#include <map>
 #include <string>
 #include <vector>
 
+#include "HttpHeaderTable.hpp"
+
 enum HttpMethod {
   HTTP_METHOD_GET,
   HTTP_METHOD_POST,
@@ -25,25 +26,45 @@ enum HttpStatus {
 
 enum HttpVersion { HTTP_VERSION_1_0, HTTP_VERSION_1_1, HTTP_VERSION_UNKNOWN };
 
+class ServerConfig;
+class LocationConfig;
+
 class HttpRequest {
  private:
-  typedef std::map<std::string, std::string> HeaderMap;
-
   HttpMethod _method;
   HttpVersion _version;
-  HeaderMap _headers;
+  HttpHeaderTable _headers;  // nombres en minúsculas, acceso O(1) por id
   HttpStatus _status;
   std::string _path;   // URL de la petición ej: "/images/logo.png"
   std::string _query;  // Query string de la petición ej: "?name=John&age=30"
   std::vector<char> _body;  // vector para soportar binarios y texto grande (ej:
                             // videos, imagenes, etc.)
+  std::size_t _bodySize;    // bytes de body recibidos (memoria o fichero)
+
+  // ---- Body en disco (subidas grandes, ver setBodySpill) ----
+  // Pasado el limite en memoria, el body va a un fichero temporal dentro
+  // de _spillDir (mismo sistema de ficheros que el destino: rename()).
+  bool _bodyStorageDecided;
+  std::string _spillDir;
+  std::size_t _spillLimit;
+  bool _bodyWriteFailed;
+  // mutable: moveBodyFileTo() entrega el fichero desde un request const.
+  mutable int _bodyFd;
+  mutable std::string _bodyFilePath;
+
+  // ---- Routing (ver matchLocation en RequestProcessorUtils) ----
+  // La location se busca una vez por petición; el body, el CGI y el
+  // RequestProcessor reutilizan el resultado. mutable: se rellena desde
+  // un request const. Se borra con setPath() y clear().
+  mutable const ServerConfig* _routeServer;
+  mutable const LocationConfig* _routeLocation;
  public:
   // constructors
   HttpRequest();
   HttpRequest(const HttpRequest& other);
   HttpRequest(const std::string& method, const std::string& version,
-              const HeaderMap& headers, const std::string& path,
-              const std::string& query, const std::vector<char>& body);
+              const std::string& path, const std::string& query,
+              const std::vector<char>& body);
   ~HttpRequest();
   HttpRequest& operator=(const HttpRequest& other);
 
@@ -56,19 +77,52 @@ class HttpRequest {
   // void addBody(const std::vector<char>& chunk);
   void addBody(std::string::const_iterator begin,
                std::string::const_iterator end);
+  // Versiones (puntero, longitud) que usa el parser: leen directamente del
+  // buffer de entrada, sin strings temporales.
+  void setMethod(const char* method, std::size_t len);
+  void setVersion(const char* version, std::size_t len);
+  // Guarda la clave en minúsculas (la recibe tal cual llegó).
+  // @return id de la cabecera (HTTP_HEADER_OTHER si no es conocida)
+  HttpHeaderId addHeader(const char* key, std::size_t keyLen,
+                         const char* value, std::size_t valueLen);
+  void setPath(const char* path, std::size_t len);
+  void setQuery(const char* query, std::size_t len);
+  void addBody(const char* data, std::size_t len);
   void setStatus(HttpStatus status);
+  // Donde guardar el body (se decide una vez, tras las cabeceras):
+  // en memoria (por defecto), o en memoria hasta memoryLimit y despues en
+  // un fichero temporal dentro de dir.
+  void setBodyInMemory();
+  void setBodySpill(const std::string& dir, std::size_t memoryLimit);
 
   // getters
   HttpMethod getMethod() const;
   HttpVersion getVersion() const;
   HttpStatus getStatus() const;
   // getters para headers
-  const std::string& getHeader(const std::string& key) const;
-  const HeaderMap& getHeaders() const;
+  // Copia del valor ("" si no llegó); sin distinguir mayúsculas.
+  std::string getHeader(const std::string& key) const;
+  // Cabecera conocida: O(1) y sin copia (vista válida hasta clear()).
+  HttpHeaderView getHeader(HttpHeaderId id) const;
+  bool hasHeader(HttpHeaderId id) const;
+  const HttpHeaderTable& getHeaders() const;
   // getters para path y query
   std::string getPath() const;
   std::string getQuery() const;
-  std::vector<char> getBody() const;
+  // Solo la parte en memoria (vacio si el body se volco a disco).
+  const std::vector<char>& getBody() const;
+  std::size_t getBodySize() const;
+  bool isBodyStorageDecided() const;
+  bool isBodyInFile() const;
+  bool hasBodyWriteError() const;  // fallo al crear/escribir el temporal
+  // rename() del temporal a dest, con el modo de un fichero nuevo (0666
+  // menos la umask); despues el request ya no lo borra.
+  bool moveBodyFileTo(const std::string& dest) const;
+  // Location elegida para este path dentro de server (0 = sin routing).
+  void setRoute(const ServerConfig* server,
+                const LocationConfig* location) const;
+  const ServerConfig* getRouteServer() const;
+  const LocationConfig* getRouteLocation() const;
 
   // clear
   void clear();
@@ -76,6 +130,11 @@ class HttpRequest {
   bool shouldCloseConnection() const;
   // Expect: 100-continue (cliente espera confirmación antes de enviar body grande)
   bool hasExpect100Continue() const;
+
+ private:
+  void spillBodyToFile();
+  void appendToBodyFile(const char* data, std::size_t len);
+  void discardBodyFile();
 };
 
 #endif  // HTTP_REQUEST_HPP
@@ -10,16 +10,32 @@ static std::string reasonPhraseForStatus(int code) {
       return "OK";
     case HTTP_STATUS_CREATED:
       return "Created";
+    case HTTP_STATUS_PARTIAL_CONTENT:
+      return "Partial Content";
+    case HTTP_STATUS_NOT_MODIFIED:
+      return "Not Modified";
     case HTTP_STATUS_BAD_REQUEST:
       return "Bad Request";
+    case HTTP_STATUS_FORBIDDEN:
+      return "Forbidden";
     case HTTP_STATUS_NOT_FOUND:
       return "Not Found";
     case HTTP_STATUS_METHOD_NOT_ALLOWED:
       return "Method Not Allowed";
     case HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE:
       return "Request Entity Too Large";
+    case HTTP_STATUS_URI_TOO_LONG:
+      return "URI Too Long";
+    case HTTP_STATUS_RANGE_NOT_SATISFIABLE:
+      return "Range Not Satisfiable";
+    case HTTP_STATUS_REQUEST_HEADER_FIELDS_TOO_LARGE:
+      return "Request Header Fields Too Large";
     case HTTP_STATUS_INTERNAL_SERVER_ERROR:
       return "Internal Server Error";
+    case HTTP_STATUS_BAD_GATEWAY:
+      return "Bad Gateway";
+    case HTTP_STATUS_GATEWAY_TIMEOUT:
+      return "Gateway Timeout";
     default:
       return "Unknown";
   }
@@ -34,27 +50,53 @@ static std::string versionToString(HttpVersion version) {
 HttpResponse::HttpResponse()
     : _status(HTTP_STATUS_OK),
       _version(HTTP_VERSION_1_1),
-      _headers(),
+      _arena(),
+      _headers(std::less<std::string>(), HeaderMap::allocator_type(&_arena)),
       _reasonPhrase(reasonPhraseForStatus(HTTP_STATUS_OK)),
       _body(),
-      _headOnly(false) {}
+      _bodyFile(),
+      _bodyFileOffset(0),
+      _bodyFileLength(0),
+      _bodyFilePath(),
+      _fileParts(),
+      _sharedBody(),
+      _headOnly(false),
+      _lengthUnknown(false) {}
 
 HttpResponse::HttpResponse(const HttpResponse& other)
     : _status(other._status),
       _version(other._version),
-      _headers(other._headers),
+      _arena(),
+      _headers(other._headers.begin(), other._headers.end(),
+               std::less<std::string>(), HeaderMap::allocator_type(&_arena)),
       _reasonPhrase(other._reasonPhrase),
       _body(other._body),
-      _headOnly(other._headOnly) {}
+      _bodyFile(other._bodyFile),
+      _bodyFileOffset(other._bodyFileOffset),
+      _bodyFileLength(other._bodyFileLength),
+      _bodyFilePath(other._bodyFilePath),
+      _fileParts(other._fileParts),
+      _sharedBody(other._sharedBody),
+      _headOnly(other._headOnly),
+      _lengthUnknown(other._lengthUnknown) {}
 
 HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
   if (this != &other) {
     _status = other._status;
     _version = other._version;
-    _headers = other._headers;
+    _headers.clear();
+    _arena.reset();
+    _headers.insert(other._headers.begin(), other._headers.end());
     _reasonPhrase = other._reasonPhrase;
     _body = other._body;
+    _bodyFile = other._bodyFile;
+    _bodyFileOffset = other._bodyFileOffset;
+    _bodyFileLength = other._bodyFileLength;
+    _bodyFilePath = other._bodyFilePath;
+    _fileParts = other._fileParts;
+    _sharedBody = other._sharedBody;
     _headOnly = other._headOnly;
+    _lengthUnknown = other._lengthUnknown;
   }
   return *this;
 }
@@ -70,6 +112,10 @@ void HttpResponse::setHeader(const std::string& key, const std::string& value) {
   _headers[http_header_utils::toLowerCopy(key)] = value;
 }
 
+void HttpResponse::removeHeader(const std::string& key) {
+  _headers.erase(http_header_utils::toLowerCopy(key));
+}
+
 void HttpResponse::setVersion(const std::string& version) {
   if (version == "HTTP/1.0")
     _version = HTTP_VERSION_1_0;
@@ -86,18 +132,94 @@ void HttpResponse::setReasonPhrase(const std::string& reason) {
 void HttpResponse::setHeadOnly(bool value) { _headOnly = value; }
 // el reto es pegar la cabecera
 // setters para binarios (imagenes)
-void HttpResponse::setBody(const std::vector<char>& body) { _body = body; }
+void HttpResponse::setBody(const std::vector<char>& body) {
+  _bodyFile.reset();
+  _fileParts.clear();
+  _sharedBody = SharedBuffer();
+  _body = body;
+}
 
 void HttpResponse::setBody(const std::string& body) {
+  _bodyFile.reset();
+  _fileParts.clear();
+  _sharedBody = SharedBuffer();
   _body.assign(body.begin(), body.end());
 }
 
+void HttpResponse::setFileBody(const SharedFd& fd, off_t offset,
+                               std::size_t length, const std::string& path) {
+  _body.clear();
+  _fileParts.clear();
+  _sharedBody = SharedBuffer();
+  _bodyFile = fd;
+  _bodyFileOffset = offset;
+  _bodyFileLength = length;
+  _bodyFilePath = path;
+}
+
+void HttpResponse::setMultipartFileBody(const SharedFd& fd,
+                                        const std::vector<FilePart>& parts,
+                                        const std::string& path) {
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < parts.size(); ++i)
+    length += parts[i].header.size() + parts[i].length;
+  setFileBody(fd, 0, length, path);
+  _fileParts = parts;
+}
+
+void HttpResponse::setSharedBody(const SharedBuffer& body) {
+  _body.clear();
+  _bodyFile.reset();
+  _fileParts.clear();
+  _sharedBody = body;
+}
+
+void HttpResponse::setLengthUnknown() { _lengthUnknown = true; }
+
+int HttpResponse::getStatusCode() const { return _status; }
+
+bool HttpResponse::isHeadOnly() const { return _headOnly; }
+
+bool HttpResponse::hasFileBody() const { return _bodyFile.valid(); }
+
+const SharedFd& HttpResponse::getBodyFile() const { return _bodyFile; }
+
+off_t HttpResponse::getBodyFileOffset() const { return _bodyFileOffset; }
+
+std::size_t HttpResponse::getBodyFileLength() const {
+  return _bodyFileLength;
+}
+
+const std::string& HttpResponse::getBodyFilePath() const {
+  return _bodyFilePath;
+}
+
+const std::vector<HttpResponse::FilePart>& HttpResponse::getFileParts() const {
+  return _fileParts;
+}
+
+bool HttpResponse::hasSharedBody() const { return !_sharedBody.empty(); }
+
+const SharedBuffer& HttpResponse::getSharedBody() const { return _sharedBody; }
+
+std::size_t HttpResponse::getBodySize() const {
+  if (_headOnly) return 0;
+  if (hasSharedBody()) return _sharedBody.size();
+  return hasFileBody() ? _bodyFileLength : _body.size();
+}
+
 bool HttpResponse::hasHeader(const std::string& key) const {
   HeaderMap::const_iterator it =
       _headers.find(http_header_utils::toLowerCopy(key));
   return it != _headers.end();
 }
 
+std::string HttpResponse::getHeader(const std::string& key) const {
+  HeaderMap::const_iterator it =
+      _headers.find(http_header_utils::toLowerCopy(key));
+  return it != _headers.end() ? it->second : std::string();
+}
+
 // SERIALIZE
 std::vector<char> HttpResponse::serialize() const {
   std::stringstream buffer;
@@ -105,13 +227,29 @@ std::vector<char> HttpResponse::serialize() const {
   buffer << versionToString(_version) << " " << _status << " " << _reasonPhrase
          << "\r\n";
 
+  const std::string* declaredLength = 0;
   for (HeaderMap::const_iterator it = _headers.begin(); it != _headers.end();
        ++it) {
-    if (http_header_utils::toLowerCopy(it->first) == "content-length") continue;
+    if (http_header_utils::toLowerCopy(it->first) == "content-length") {
+      declaredLength = &it->second;
+      continue;
+    }
     buffer << it->first << ": " << it->second << "\r\n";
   }
 
-  buffer << "Content-Length: " << _body.size() << "\r\n";
+  if (_status == HTTP_STATUS_NOT_MODIFIED) {
+    // sin body: nada que medir
+  } else if (hasFileBody()) {
+    buffer << "Content-Length: " << _bodyFileLength << "\r\n";
+  } else if (hasSharedBody()) {
+    buffer << "Content-Length: " << _sharedBody.size() << "\r\n";
+  } else if (_headOnly && _lengthUnknown) {
+    // sin Content-Length (RFC 9110 9.3.2 lo permite en un HEAD)
+  } else if (_headOnly && declaredLength && _body.empty()) {
+    buffer << "Content-Length: " << *declaredLength << "\r\n";
+  } else {
+    buffer << "Content-Length: " << _body.size() << "\r\n";
+  }
   buffer << "\r\n";
 
   // convertir la parte de texto a vector
@@ -126,7 +264,25 @@ std::vector<char> HttpResponse::serialize() const {
   return (response);
 }
 
+std::vector<char> HttpResponse::serializeHead() const {
+  std::stringstream buffer;
+
+  buffer << versionToString(_version) << " " << _status << " " << _reasonPhrase
+         << "\r\n";
+  for (HeaderMap::const_iterator it = _headers.begin(); it != _headers.end();
+       ++it)
+    buffer << it->first << ": " << it->second << "\r\n";
+  buffer << "\r\n";
+
+  std::string headStr = buffer.str();
+  return std::vector<char>(headStr.begin(), headStr.end());
+}
+
 void HttpResponse::setContentType(const std::string& filename) {
+  setHeader("Content-Type", contentTypeFor(filename));
+}
+
+std::string HttpResponse::contentTypeFor(const std::string& filename) {
   std::string::size_type dotPos = filename.find_last_of('.');
   std::string ext;
 
@@ -159,14 +315,22 @@ void HttpResponse::setContentType(const std::string& filename) {
   else if (ext == "pdf")
     contentType = "application/pdf";
 
-  setHeader("Content-Type", contentType);
+  return contentType;
 }
 
 void HttpResponse::clear() {
   _status = HTTP_STATUS_OK;
   _version = HTTP_VERSION_1_1;
   _headers.clear();
+  _arena.reset();
   _reasonPhrase = reasonPhraseForStatus(HTTP_STATUS_OK);
   _body.clear();
+  _bodyFile.reset();
+  _bodyFileOffset = 0;
+  _bodyFileLength = 0;
+  _bodyFilePath.clear();
+  _fileParts.clear();
+  _sharedBody = SharedBuffer();
   _headOnly = false;
+  _lengthUnknown = false;
 }
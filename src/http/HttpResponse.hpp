@@ -1,34 +1,71 @@
 #ifndef HTTP_RESPONSE_HPP
 #define HTTP_RESPONSE_HPP
 
+#include <sys/types.h>
+
 #include <map>
 #include <string>
 #include <vector>
 
 #include "HttpRequest.hpp"  // para reutilizar HttpVersion
+#include "../common/Arena.hpp"
+#include "../common/SharedBuffer.hpp"
+#include "../common/SharedFd.hpp"
 
 // Códigos de estado mínimos para empezar.
 enum HttpStatusCode {
   HTTP_STATUS_OK = 200,
   HTTP_STATUS_CREATED = 201,
+  HTTP_STATUS_PARTIAL_CONTENT = 206,
+  HTTP_STATUS_NOT_MODIFIED = 304,
   HTTP_STATUS_BAD_REQUEST = 400,
   HTTP_STATUS_FORBIDDEN = 403,
   HTTP_STATUS_NOT_FOUND = 404,
   HTTP_STATUS_METHOD_NOT_ALLOWED = 405,
   HTTP_STATUS_REQUEST_ENTITY_TOO_LARGE = 413,
-  HTTP_STATUS_INTERNAL_SERVER_ERROR = 500
+  HTTP_STATUS_URI_TOO_LONG = 414,
+  HTTP_STATUS_RANGE_NOT_SATISFIABLE = 416,
+  HTTP_STATUS_REQUEST_HEADER_FIELDS_TOO_LARGE = 431,
+  HTTP_STATUS_INTERNAL_SERVER_ERROR = 500,
+  HTTP_STATUS_BAD_GATEWAY = 502,
+  HTTP_STATUS_GATEWAY_TIMEOUT = 504
 };
 
 // Representa una respuesta HTTP que se enviará al cliente.
 class HttpResponse {
+ public:
+  // Una parte de un body multipart/byteranges: su cabecera (boundary,
+  // Content-Type, Content-Range) y el trozo [offset, offset + length) del
+  // fichero. El cierre del multipart va como una parte con length 0.
+  struct FilePart {
+    std::string header;
+    off_t offset;
+    std::size_t length;
+  };
+
  private:
-  typedef std::map<std::string, std::string> HeaderMap;
+  // Igual que en HttpRequest: nodos en _arena, liberados en clear().
+  typedef std::map<std::string, std::string, std::less<std::string>,
+                   ArenaAllocator<std::pair<const std::string, std::string> > >
+      HeaderMap;
   HttpStatusCode _status;
   HttpVersion _version;
+  Arena _arena;  // antes de _headers: se construye primero
   HeaderMap _headers;
   std::string _reasonPhrase;
   std::vector<char> _body;
+  // Body respaldado por fichero: el Client lo envía con sendfile() y nunca
+  // se copia a memoria (solo las cabeceras serializadas).
+  SharedFd _bodyFile;
+  off_t _bodyFileOffset;
+  std::size_t _bodyFileLength;
+  std::string _bodyFilePath;  // ruta en disco (para validar caches)
+  std::vector<FilePart> _fileParts;  // vacio salvo en multipart/byteranges
+  // Body ya en memoria compartida (CompressionCache): el Client lo encola
+  // tal cual, sin copiarlo en la respuesta serializada.
+  SharedBuffer _sharedBody;
   bool _headOnly;
+  bool _lengthUnknown;
 
  public:
   HttpResponse();
@@ -49,18 +86,59 @@ class HttpResponse {
   void setReasonPhrase(const std::string& reason);
   // para cuando envias HTML simple o texto
   void setBody(const std::string& body);
+  // body = [offset, offset + length) del fichero abierto en fd. Sustituye a
+  // cualquier body en memoria (y setBody() sustituye a este).
+  void setFileBody(const SharedFd& fd, off_t offset, std::size_t length,
+                   const std::string& path);
+  // body = las partes, una detras de otra (206 con varios rangos). El
+  // Content-Length es la suma de cabeceras y trozos.
+  void setMultipartFileBody(const SharedFd& fd,
+                            const std::vector<FilePart>& parts,
+                            const std::string& path);
+  // body = esos bytes compartidos. Sustituye a cualquier otro body.
+  void setSharedBody(const SharedBuffer& body);
+  // HEAD cuya longitud no se sabe sin generar el body (gzip on sin la
+  // version comprimida en cache): sale sin Content-Length.
+  void setLengthUnknown();
+  void removeHeader(const std::string& key);
+
+  // GETTERS
+  int getStatusCode() const;
+  bool isHeadOnly() const;
+  bool hasFileBody() const;
+  const SharedFd& getBodyFile() const;
+  off_t getBodyFileOffset() const;
+  std::size_t getBodyFileLength() const;
+  const std::string& getBodyFilePath() const;
+  const std::vector<FilePart>& getFileParts() const;
+  bool hasSharedBody() const;
+  const SharedBuffer& getSharedBody() const;
+  // Bytes de body que salen tras las cabeceras (0 en HEAD): access_log.
+  std::size_t getBodySize() const;
 
   // SERIALIZE
   // lo hago vector para que poder enviarlo bien a send() sin que corte si
   // hay un byte nulo en medio de una imagen.
+  // Con body de fichero o compartido solo devuelve status line + headers:
+  // el body lo envía el Client desde getBodyFile() / getSharedBody().
+  // Un 304 sale sin Content-Length. Un HEAD sin body (respondido solo con
+  // stat()) lleva el Content-Length que haya fijado el handler con
+  // setHeader().
   std::vector<char> serialize() const;
+  // Solo status line + headers tal cual (sin añadir Content-Length): para
+  // bodies que se envían aparte a medida que llegan (CGI en streaming).
+  std::vector<char> serializeHead() const;
 
   // HELPERS
   // segun la extension del archivo
   void setContentType(const std::string& filename);
+  // el MIME type que usaria setContentType() (para precalcularlo y cachearlo)
+  static std::string contentTypeFor(const std::string& filename);
   // comprobar si ya existe un header (se usa para no sobreescribir
   // Content-Type)
   bool hasHeader(const std::string& key) const;
+  // "" si no existe
+  std::string getHeader(const std::string& key) const;
 
   void clear();
 };
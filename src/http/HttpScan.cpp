@@ -0,0 +1,277 @@
+#include "HttpScan.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HTTP_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace http_scan {
+
+namespace {
+
+// ---- Clases de bytes (fallback escalar y bytes raros del camino SIMD) ----
+enum {
+  CLASS_TOKEN = 1,
+  CLASS_FIELD_VALUE = 2,
+  CLASS_TARGET = 4
+};
+
+unsigned char g_classes[256];
+
+void buildClasses() {
+  for (int c = 0; c < 256; ++c) {
+    unsigned char bits = 0;
+    // Controles: 0x00-0x1f y DEL. Lo demas (incluido obs-text >= 0x80)
+    // vale dentro de un valor.
+    bool control = c < 0x20 || c == 0x7f;
+    if (!control || c == '\t') bits |= CLASS_FIELD_VALUE;
+    if (!control && c != ' ') bits |= CLASS_TARGET;
+    g_classes[c] = bits;
+  }
+  const char* tchars =
+      "!#$%&'*+-.^_`|~0123456789"
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+  for (const char* p = tchars; *p; ++p)
+    g_classes[static_cast<unsigned char>(*p)] |= CLASS_TOKEN;
+}
+
+inline bool hasClass(char c, unsigned char cls) {
+  return (g_classes[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+const char* skipClassScalar(const char* p, const char* end,
+                            unsigned char cls) {
+  while (p < end && hasClass(*p, cls)) ++p;
+  return p;
+}
+
+const char* skipTokenScalar(const char* p, const char* end) {
+  return skipClassScalar(p, end, CLASS_TOKEN);
+}
+
+const char* skipFieldValueScalar(const char* p, const char* end) {
+  return skipClassScalar(p, end, CLASS_FIELD_VALUE);
+}
+
+const char* skipTargetScalar(const char* p, const char* end) {
+  return skipClassScalar(p, end, CLASS_TARGET);
+}
+
+#ifdef HTTP_SCAN_X86
+// ---- SSE2 ----
+// Sin comparaciones sin signo en SSE2: x <= k  <=>  min_epu8(x, k) == x.
+// Los tokens se validan por rangos (letras, digitos y '-', que son casi
+// todos los nombres de cabecera); el primer byte fuera de esos rangos se
+// mira en la tabla y, si es otro tchar, se sigue desde el siguiente.
+
+__attribute__((target("sse2"))) inline __m128i atMost16(__m128i v, char k) {
+  return _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(k)), v);
+}
+
+__attribute__((target("sse2"))) inline __m128i tokenFast16(__m128i v) {
+  __m128i alpha = atMost16(
+      _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a')),
+      'z' - 'a');
+  __m128i digit = atMost16(_mm_sub_epi8(v, _mm_set1_epi8('0')), 9);
+  __m128i dash = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), dash);
+}
+
+__attribute__((target("sse2"))) inline __m128i fieldValueBad16(__m128i v) {
+  __m128i control = atMost16(v, 0x1f);
+  __m128i tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+  __m128i del = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f));
+  return _mm_or_si128(_mm_andnot_si128(tab, control), del);
+}
+
+__attribute__((target("sse2"))) inline __m128i targetBad16(__m128i v) {
+  return _mm_or_si128(atMost16(v, 0x20),
+                      _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+}
+
+// Bucles de 16 bytes: paran en el primer byte que no es de la clase o
+// cuando quedan menos de 16. Son inline para que dentro de las funciones
+// AVX2 se compilen con codificacion VEX (mezclar SSE clasico con AVX
+// penaliza cada transicion).
+
+__attribute__((target("sse2"))) inline const char* tokenBlocks16(
+    const char* p, const char* end) {
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    unsigned mask = ~static_cast<unsigned>(
+                        _mm_movemask_epi8(tokenFast16(v))) & 0xffffu;
+    if (mask == 0) {
+      p += 16;
+      continue;
+    }
+    p += __builtin_ctz(mask);
+    if (!hasClass(*p, CLASS_TOKEN)) return p;
+    ++p;
+  }
+  return p;
+}
+
+__attribute__((target("sse2"))) inline const char* fieldValueBlocks16(
+    const char* p, const char* end) {
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(fieldValueBad16(v)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+    p += 16;
+  }
+  return p;
+}
+
+__attribute__((target("sse2"))) inline const char* targetBlocks16(
+    const char* p, const char* end) {
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(targetBad16(v)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+    p += 16;
+  }
+  return p;
+}
+
+__attribute__((target("sse2"))) const char* skipTokenSse2(const char* p,
+                                                         const char* end) {
+  return skipTokenScalar(tokenBlocks16(p, end), end);
+}
+
+__attribute__((target("sse2"))) const char* skipFieldValueSse2(
+    const char* p, const char* end) {
+  return skipFieldValueScalar(fieldValueBlocks16(p, end), end);
+}
+
+__attribute__((target("sse2"))) const char* skipTargetSse2(const char* p,
+                                                          const char* end) {
+  return skipTargetScalar(targetBlocks16(p, end), end);
+}
+
+// ---- AVX2: lo mismo con registros de 32 bytes ----
+
+__attribute__((target("avx2"))) inline __m256i atMost32(__m256i v, char k) {
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(k)), v);
+}
+
+__attribute__((target("avx2"))) inline __m256i tokenFast32(__m256i v) {
+  __m256i alpha = atMost32(
+      _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)),
+                      _mm256_set1_epi8('a')),
+      'z' - 'a');
+  __m256i digit = atMost32(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+  __m256i dash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'));
+  return _mm256_or_si256(_mm256_or_si256(alpha, digit), dash);
+}
+
+__attribute__((target("avx2"))) inline __m256i fieldValueBad32(__m256i v) {
+  __m256i control = atMost32(v, 0x1f);
+  __m256i tab = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'));
+  __m256i del = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f));
+  return _mm256_or_si256(_mm256_andnot_si256(tab, control), del);
+}
+
+__attribute__((target("avx2"))) inline __m256i targetBad32(__m256i v) {
+  return _mm256_or_si256(atMost32(v, 0x20),
+                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)));
+}
+
+__attribute__((target("avx2"))) const char* skipTokenAvx2(const char* p,
+                                                         const char* end) {
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    unsigned mask =
+        ~static_cast<unsigned>(_mm256_movemask_epi8(tokenFast32(v)));
+    if (mask == 0) {
+      p += 32;
+      continue;
+    }
+    p += __builtin_ctz(mask);
+    if (!hasClass(*p, CLASS_TOKEN)) return p;
+    ++p;
+  }
+  return skipTokenScalar(tokenBlocks16(p, end), end);
+}
+
+__attribute__((target("avx2"))) const char* skipFieldValueAvx2(
+    const char* p, const char* end) {
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    unsigned mask =
+        static_cast<unsigned>(_mm256_movemask_epi8(fieldValueBad32(v)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+    p += 32;
+  }
+  return skipFieldValueScalar(fieldValueBlocks16(p, end), end);
+}
+
+__attribute__((target("avx2"))) const char* skipTargetAvx2(const char* p,
+                                                          const char* end) {
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(targetBad32(v)));
+    if (mask != 0) return p + __builtin_ctz(mask);
+    p += 32;
+  }
+  return skipTargetScalar(targetBlocks16(p, end), end);
+}
+#endif  // HTTP_SCAN_X86
+
+// ---- Eleccion en tiempo de ejecucion ----
+
+typedef const char* (*SkipFn)(const char*, const char*);
+
+struct Implementation {
+  SkipFn token;
+  SkipFn fieldValue;
+  SkipFn target;
+  const char* name;
+};
+
+Implementation selectImplementation() {
+  buildClasses();
+  Implementation impl = {skipTokenScalar, skipFieldValueScalar,
+                         skipTargetScalar, "scalar"};
+  // HTTP_SCAN=scalar|sse2 fuerza una implementacion mas simple (pruebas).
+  const char* forced = std::getenv("HTTP_SCAN");
+  if (forced != 0 && std::strcmp(forced, "scalar") == 0) return impl;
+#ifdef HTTP_SCAN_X86
+  // Se ejecuta antes de main(): hay que inicializar la deteccion a mano.
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("sse2")) return impl;
+  impl.token = skipTokenSse2;
+  impl.fieldValue = skipFieldValueSse2;
+  impl.target = skipTargetSse2;
+  impl.name = "sse2";
+  if (forced != 0 && std::strcmp(forced, "sse2") == 0) return impl;
+  if (!__builtin_cpu_supports("avx2")) return impl;
+  impl.token = skipTokenAvx2;
+  impl.fieldValue = skipFieldValueAvx2;
+  impl.target = skipTargetAvx2;
+  impl.name = "avx2";
+#endif
+  return impl;
+}
+
+const Implementation g_impl = selectImplementation();
+
+}  // namespace
+
+const char* skipToken(const char* begin, const char* end) {
+  return g_impl.token(begin, end);
+}
+
+const char* skipFieldValue(const char* begin, const char* end) {
+  return g_impl.fieldValue(begin, end);
+}
+
+const char* skipTarget(const char* begin, const char* end) {
+  return g_impl.target(begin, end);
+}
+
+const char* implementationName() { return g_impl.name; }
+
+}  // namespace http_scan
@@ -0,0 +1,27 @@
+#ifndef HTTP_SCAN_HPP
+#define HTTP_SCAN_HPP
+
+// Escaneo de la cabecera HTTP de 16 en 16 (SSE2) o de 32 en 32 (AVX2)
+// bytes, al estilo de findchar_fast de picohttpparser. La implementacion
+// se elige una vez al arrancar segun la CPU; en otras arquitecturas (o
+// CPUs sin SSE2) se usa una tabla byte a byte.
+//
+// Cada funcion devuelve el primer byte de [begin, end) que NO pertenece a
+// la clase, o end si todos pertenecen: el mismo recorrido encuentra el
+// delimitador (':', ' ', '\r') y valida lo que hay antes.
+
+namespace http_scan {
+
+// tchar de RFC 9110 (nombres de cabecera y metodo).
+const char* skipToken(const char* begin, const char* end);
+// field-value: cualquier byte salvo controles (se permite HTAB).
+const char* skipFieldValue(const char* begin, const char* end);
+// request-target: hasta SP o un control.
+const char* skipTarget(const char* begin, const char* end);
+
+// "avx2", "sse2" o "scalar" (benchmarks y logs).
+const char* implementationName();
+
+}  // namespace http_scan
+
+#endif  // HTTP_SCAN_HPP
@@ -6,10 +6,12 @@
 #include <string>
 #include <vector>
 
+#include "cgi/FastCgiSpawner.hpp"
 #include "config/ConfigException.hpp"
 #include "config/ConfigParser.hpp"
 #include "config/ServerConfig.hpp"
 #include "network/ServerManager.hpp"
+#include "network/WorkerSupervisor.hpp"
 
 /**
  * Función principal del servidor web
@@ -51,8 +53,33 @@ int main(int argc, char* argv[]) {
     std::cout << "Config file path: [" << config::colors::blue << parser.getConfigFilePath() << "]\n" << config::colors::reset;
     parser.parse();
 
+    /**
+     * Modo multi-core (worker_processes N > 1):
+     * el proceso actual pasa a ser el supervisor y cada worker tiene su
+     * propio ServerManager (epoll, listeners con SO_REUSEPORT, clientes).
+     */
+    const GlobalConfig& global = parser.getGlobalConfig();
+
+    // Desde aqui escribe el hilo de logging (common/Log) directamente en
+    // el fd 1: lo que quede en el buffer de std::cout tiene que ir antes.
+    std::cout.flush();
+
+    /**
+     * fastcgi_spawn: los workers FastCGI se arrancan aqui, antes de crear
+     * el supervisor o el ServerManager, que son quienes los reinician.
+     */
+    FastCgiSpawner fastcgi;
+    fastcgi.start(parser.getServers());
+
+    if (global.getWorkerProcesses() > 1) {
+      WorkerSupervisor supervisor(&parser.getServers(), global);
+      supervisor.setFastCgiSpawner(&fastcgi);
+      return supervisor.run();
+    }
+
     // Crear el gestor del servidor con la lista de servers
-    ServerManager server(&parser.getServers());
+    ServerManager server(&parser.getServers(), global);
+    server.setFastCgiSpawner(&fastcgi);
 
     /**
      * Iniciar el servidor en localhost:8080
@@ -68,7 +95,7 @@ int main(int argc, char* argv[]) {
     /**
      * Ejecutar el bucle principal de eventos
      *
-     * IMPORTANTE: Esta función BLOQUEA y NO RETORNA
+     * IMPORTANTE: Esta función BLOQUEA hasta SIGINT/SIGTERM
      *
      * El bucle:
      * 1. Espera eventos con epoll_wait() (bloquea aquí)
@@ -76,8 +103,9 @@ int main(int argc, char* argv[]) {
      * 3. Vuelve a esperar más eventos
      *
      * El servidor corre hasta que:
-     * - Se presiona Ctrl+C (SIGINT)
-     * - Se mata el proceso (kill)
+     * - Se presiona Ctrl+C (SIGINT) o llega SIGTERM (kill): run() retorna
+     *   y el destructor vacia los logs pendientes
+     * - Se mata el proceso (kill -9)
      * - Ocurre un error fatal
      */
     server.run();
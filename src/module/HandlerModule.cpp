@@ -0,0 +1,66 @@
+/**
+ * HandlerModule.cpp
+ */
+
+#include "HandlerModule.hpp"
+
+#include <dlfcn.h>
+
+#include <sstream>
+
+#include "ModuleExchange.hpp"
+
+HandlerModule* HandlerModule::load(const std::string& path,
+                                   std::string& error) {
+  // RTLD_NOW: a missing symbol fails here, not in the middle of a request.
+  void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (library == NULL) {
+    const char* reason = dlerror();
+    error = reason ? reason : "dlopen failed";
+    return NULL;
+  }
+
+  const webserv_module* module = static_cast<const webserv_module*>(
+      dlsym(library, WEBSERV_MODULE_SYMBOL));
+  if (module == NULL) {
+    error = path + ": no " + WEBSERV_MODULE_SYMBOL + " symbol";
+    dlclose(library);
+    return NULL;
+  }
+  if (module->abi_version != WEBSERV_MODULE_ABI_VERSION ||
+      module->handle == NULL) {
+    std::ostringstream message;
+    message << path << ": module ABI " << module->abi_version
+            << ", server ABI " << WEBSERV_MODULE_ABI_VERSION;
+    if (module->handle == NULL) message << " (no handle function)";
+    error = message.str();
+    dlclose(library);
+    return NULL;
+  }
+
+  HandlerModule* loaded = new HandlerModule(path, library, module);
+  if (module->init && module->init(moduleApi(), &loaded->data_) != 0) {
+    error = path + ": init failed";
+    loaded->module_ = NULL;  // no cleanup() for a module that did not start
+    delete loaded;
+    return NULL;
+  }
+  return loaded;
+}
+
+HandlerModule::HandlerModule(const std::string& path, void* library,
+                             const webserv_module* module)
+    : path_(path), library_(library), module_(module), data_(NULL) {}
+
+HandlerModule::~HandlerModule() {
+  if (module_ && module_->cleanup) module_->cleanup(data_);
+  dlclose(library_);
+}
+
+int HandlerModule::handle(webserv_request* req, webserv_response* res) {
+  return module_->handle(data_, req, res);
+}
+
+void HandlerModule::abort(webserv_response* res) {
+  if (module_->abort) module_->abort(data_, res);
+}
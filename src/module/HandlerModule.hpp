@@ -0,0 +1,38 @@
+/**
+ * HandlerModule.hpp
+ *
+ * One content handler module (a 'handler /path/module.so;' location)
+ * loaded in this process. ServerManager loads each path once per worker
+ * and keeps it until shutdown; requests reach it through ModuleExchange.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "webserv_module.h"
+
+class HandlerModule {
+ public:
+  // dlopen()s |path|, checks its webserv_module and runs init().
+  // @return NULL with |error| set when any of that fails
+  static HandlerModule* load(const std::string& path, std::string& error);
+  // cleanup() and dlclose()
+  ~HandlerModule();
+
+  const std::string& getPath() const { return path_; }
+
+  int handle(webserv_request* req, webserv_response* res);
+  void abort(webserv_response* res);
+
+ private:
+  HandlerModule(const std::string& path, void* library,
+                const webserv_module* module);
+  HandlerModule(const HandlerModule&);
+  HandlerModule& operator=(const HandlerModule&);
+
+  std::string path_;
+  void* library_;                // dlopen() handle
+  const webserv_module* module_;
+  void* data_;                   // what init() handed back
+};
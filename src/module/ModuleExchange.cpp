@@ -0,0 +1,310 @@
+/**
+ * ModuleExchange.cpp
+ */
+
+#include "ModuleExchange.hpp"
+
+#include <strings.h>
+#include <sys/epoll.h>
+
+#include <cstring>
+
+#include "HandlerModule.hpp"
+#include "common/Log.hpp"
+
+namespace {
+
+webserv_str makeStr(const char* data, size_t len) {
+  webserv_str str;
+  str.data = data;
+  str.len = len;
+  return str;
+}
+
+webserv_str makeStr(const std::string& text) {
+  return makeStr(text.data(), text.size());
+}
+
+uint32_t toEpoll(unsigned events) {
+  uint32_t mask = 0;
+  if (events & WEBSERV_READABLE) mask |= EPOLLIN | EPOLLRDHUP;
+  if (events & WEBSERV_WRITABLE) mask |= EPOLLOUT;
+  return mask;
+}
+
+unsigned fromEpoll(uint32_t mask) {
+  unsigned events = 0;
+  if (mask & EPOLLIN) events |= WEBSERV_READABLE;
+  if (mask & EPOLLOUT) events |= WEBSERV_WRITABLE;
+  if (mask & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) events |= WEBSERV_HANGUP;
+  return events;
+}
+
+// CR/LF in a name or value would let a module split the response.
+bool isHeaderText(const std::string& text) {
+  return text.find_first_of("\r\n") == std::string::npos;
+}
+
+}  // namespace
+
+ModuleExchange::ModuleExchange(HandlerModule& module,
+                               const HttpRequest& request,
+                               ModuleEventLoop& loop)
+    : module_(module),
+      loop_(loop),
+      request_(),
+      response_(),
+      status_(200),
+      headers_(),
+      output_(),
+      unsent_(0),
+      headersSent_(false),
+      finished_(false),
+      data_(NULL),
+      watches_() {
+  request_.request = &request;
+  request_.path = request.getPath();
+  request_.query = request.getQuery();
+  request_.bodyTaken = false;
+  response_.exchange = this;
+}
+
+ModuleExchange::~ModuleExchange() {
+  // Out of the loop first: abort() closes the fds and their numbers can be
+  // reused right away.
+  for (size_t i = 0; i < watches_.size(); ++i) loop_.removeFd(watches_[i].fd);
+  watches_.clear();
+  if (!finished_) module_.abort(&response_);
+}
+
+int ModuleExchange::start() {
+  int result = module_.handle(&request_, &response_);
+  if (result == WEBSERV_ERROR) {
+    finished_ = true;  // over for the module too: no abort() later
+    output_.clear();
+    return WEBSERV_ERROR;
+  }
+  if (result == WEBSERV_OK) finish();
+  return finished_ ? WEBSERV_OK : WEBSERV_ASYNC;
+}
+
+void ModuleExchange::detach() {
+  if (request_.request == &request_.copy) return;
+  request_.copy = *request_.request;
+  request_.request = &request_.copy;
+}
+
+void ModuleExchange::dispatch(int fd, uint32_t events) {
+  for (size_t i = 0; i < watches_.size(); ++i) {
+    if (watches_[i].fd != fd) continue;
+    // By value: the callback may watch or unwatch and move the vector.
+    Watch watch = watches_[i];
+    watch.callback(&response_, fd, fromEpoll(events), watch.arg);
+    return;
+  }
+}
+
+void ModuleExchange::takeOutput(std::string& out) {
+  out.clear();
+  out.swap(output_);
+}
+
+bool ModuleExchange::setStatus(int status) {
+  if (headersSent_ || finished_ || status < 200 || status > 599) return false;
+  status_ = status;
+  return true;
+}
+
+bool ModuleExchange::setHeader(const std::string& name,
+                               const std::string& value) {
+  if (headersSent_ || finished_ || name.empty() || !isHeaderText(name) ||
+      !isHeaderText(value))
+    return false;
+  for (size_t i = 0; i < headers_.size(); ++i) {
+    if (strcasecmp(headers_[i].first.c_str(), name.c_str()) == 0) {
+      headers_[i].second = value;
+      return true;
+    }
+  }
+  headers_.push_back(std::make_pair(name, value));
+  return true;
+}
+
+bool ModuleExchange::write(const char* data, size_t len) {
+  if (finished_) return false;
+  output_.append(data, len);
+  return true;
+}
+
+bool ModuleExchange::finish() {
+  if (finished_) return false;
+  finished_ = true;
+  return true;
+}
+
+bool ModuleExchange::watch(int fd, unsigned events,
+                           webserv_fd_callback callback, void* arg) {
+  if (finished_ || fd < 0 || callback == NULL ||
+      (events & (WEBSERV_READABLE | WEBSERV_WRITABLE)) == 0)
+    return false;
+  for (size_t i = 0; i < watches_.size(); ++i) {
+    if (watches_[i].fd != fd) continue;
+    watches_[i].events = events;
+    watches_[i].callback = callback;
+    watches_[i].arg = arg;
+    loop_.modifyFd(fd, toEpoll(events));
+    return true;
+  }
+  if (!loop_.addFd(fd, toEpoll(events))) return false;
+  Watch watch = {fd, events, callback, arg};
+  watches_.push_back(watch);
+  return true;
+}
+
+bool ModuleExchange::unwatch(int fd) {
+  for (size_t i = 0; i < watches_.size(); ++i) {
+    if (watches_[i].fd != fd) continue;
+    watches_.erase(watches_.begin() + i);
+    loop_.removeFd(fd);
+    return true;
+  }
+  return false;
+}
+
+// =============================================================================
+// webserv_api: the C entry points a module calls
+// =============================================================================
+
+extern "C" {
+
+static webserv_str apiMethod(const webserv_request* req) {
+  switch (req->request->getMethod()) {
+    case HTTP_METHOD_GET:
+      return makeStr("GET", 3);
+    case HTTP_METHOD_POST:
+      return makeStr("POST", 4);
+    case HTTP_METHOD_DELETE:
+      return makeStr("DELETE", 6);
+    case HTTP_METHOD_HEAD:
+      return makeStr("HEAD", 4);
+    default:
+      return makeStr("", 0);
+  }
+}
+
+static webserv_str apiPath(const webserv_request* req) {
+  return makeStr(req->path);
+}
+
+static webserv_str apiQuery(const webserv_request* req) {
+  return makeStr(req->query);
+}
+
+static webserv_str apiHeader(const webserv_request* req, const char* name) {
+  if (name == NULL) return makeStr("", 0);
+  HttpHeaderView value =
+      req->request->getHeaders().get(name, std::strlen(name));
+  return makeStr(value.data, value.length);
+}
+
+static size_t apiHeaderCount(const webserv_request* req) {
+  return req->request->getHeaders().size();
+}
+
+static int apiHeaderAt(const webserv_request* req, size_t index,
+                       webserv_str* name, webserv_str* value) {
+  const HttpHeaderTable& headers = req->request->getHeaders();
+  if (index >= headers.size()) return -1;
+  HttpHeaderView field = headers.nameAt(index);
+  if (name) *name = makeStr(field.data, field.length);
+  field = headers.valueAt(index);
+  if (value) *value = makeStr(field.data, field.length);
+  return 0;
+}
+
+static size_t apiBodySize(const webserv_request* req) {
+  return req->request->getBodySize();
+}
+
+// The body of a handler location is always kept in memory (see
+// Client::feedParser), so it comes out as a single chunk.
+static int apiBodyChunk(webserv_request* req, webserv_str* chunk) {
+  const std::vector<char>& body = req->request->getBody();
+  if (req->bodyTaken || body.empty() || chunk == NULL) return 0;
+  *chunk = makeStr(&body[0], body.size());
+  req->bodyTaken = true;
+  return 1;
+}
+
+static int apiSetStatus(webserv_response* res, int status) {
+  return res->exchange->setStatus(status) ? 0 : -1;
+}
+
+static int apiSetHeader(webserv_response* res, const char* name,
+                        const char* value) {
+  if (name == NULL || value == NULL) return -1;
+  return res->exchange->setHeader(name, value) ? 0 : -1;
+}
+
+static int apiWrite(webserv_response* res, const void* data, size_t len) {
+  if (data == NULL && len > 0) return -1;
+  return res->exchange->write(static_cast<const char*>(data), len) ? 0 : -1;
+}
+
+static int apiFinish(webserv_response* res) {
+  return res->exchange->finish() ? 0 : -1;
+}
+
+static size_t apiPending(const webserv_response* res) {
+  return res->exchange->pending();
+}
+
+static void apiSetData(webserv_response* res, void* data) {
+  res->exchange->setData(data);
+}
+
+static void* apiGetData(const webserv_response* res) {
+  return res->exchange->getData();
+}
+
+static int apiWatchFd(webserv_response* res, int fd, unsigned events,
+                      webserv_fd_callback callback, void* arg) {
+  return res->exchange->watch(fd, events, callback, arg) ? 0 : -1;
+}
+
+static int apiUnwatchFd(webserv_response* res, int fd) {
+  return res->exchange->unwatch(fd) ? 0 : -1;
+}
+
+static void apiLog(int level, const char* message) {
+  if (level < WEBSERV_LOG_LEVEL_DEBUG) level = WEBSERV_LOG_LEVEL_DEBUG;
+  if (level > WEBSERV_LOG_LEVEL_ERROR) level = WEBSERV_LOG_LEVEL_ERROR;
+  WEBSERV_LOG(level) << (message ? message : "");
+}
+
+}  // extern "C"
+
+const webserv_api* moduleApi() {
+  static const webserv_api api = {
+      WEBSERV_MODULE_ABI_VERSION,
+      apiMethod,
+      apiPath,
+      apiQuery,
+      apiHeader,
+      apiHeaderCount,
+      apiHeaderAt,
+      apiBodySize,
+      apiBodyChunk,
+      apiSetStatus,
+      apiSetHeader,
+      apiWrite,
+      apiFinish,
+      apiPending,
+      apiSetData,
+      apiGetData,
+      apiWatchFd,
+      apiUnwatchFd,
+      apiLog,
+  };
+  return &api;
+}
@@ -0,0 +1,122 @@
+/**
+ * ModuleExchange.hpp
+ *
+ * One request handed to a HandlerModule, and the response it writes.
+ *
+ * The module only talks to the webserv_api functions; they land here.
+ * Nothing in this class touches sockets: after every call into the module
+ * the Client takes the new output (takeOutput) and queues it, the same way
+ * it forwards CGI output. The module's fds reach the event loop through a
+ * ModuleEventLoop the Client provides. This keeps the module ABI
+ * independent of Client and ServerManager.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "http/HttpRequest.hpp"
+#include "webserv_module.h"
+
+class HandlerModule;
+class ModuleExchange;
+
+// Server side of the types the ABI keeps opaque.
+struct webserv_request {
+  const HttpRequest* request;  // the parser's, until detach()
+  HttpRequest copy;
+  std::string path;
+  std::string query;
+  bool bodyTaken;  // body_chunk() already returned the whole body
+};
+
+struct webserv_response {
+  ModuleExchange* exchange;
+};
+
+// The event loop as a ModuleExchange sees it. Calls are made from inside
+// watch_fd() and unwatch_fd(), so an fd is out of the loop before the
+// module closes it.
+class ModuleEventLoop {
+ public:
+  virtual ~ModuleEventLoop() {}
+  // |events| is an epoll mask. false if the loop refuses |fd| (not
+  // pollable, already in use).
+  virtual bool addFd(int fd, uint32_t events) = 0;
+  virtual void modifyFd(int fd, uint32_t events) = 0;
+  virtual void removeFd(int fd) = 0;
+};
+
+class ModuleExchange {
+ public:
+  typedef std::vector<std::pair<std::string, std::string> > HeaderList;
+
+  ModuleExchange(HandlerModule& module, const HttpRequest& request,
+                 ModuleEventLoop& loop);
+  // Stops watching the module's fds, then abort() to the module if the
+  // response did not finish.
+  ~ModuleExchange();
+
+  // Calls the module's handle(). WEBSERV_OK is returned only once the
+  // response finished (a module that forgets finish() gets it done here).
+  int start();
+  // The response goes on after the parser moves to the next request:
+  // the view switches to a copy of the request.
+  void detach();
+  // |fd| is ready; |events| is the epoll mask from the backend.
+  void dispatch(int fd, uint32_t events);
+
+  // The Client's unsent bytes, for pending(); set before each call.
+  void setUnsent(size_t bytes) { unsent_ = bytes; }
+  // Status and headers went out: they can no longer change.
+  void markHeadersSent() { headersSent_ = true; }
+
+  bool isFinished() const { return finished_; }
+  int getStatus() const { return status_; }
+  const HeaderList& getHeaders() const { return headers_; }
+  // Moves the body written since the previous call into |out|.
+  void takeOutput(std::string& out);
+
+  // ---- webserv_api backends ----
+  bool setStatus(int status);
+  bool setHeader(const std::string& name, const std::string& value);
+  bool write(const char* data, size_t len);
+  bool finish();
+  size_t pending() const { return unsent_ + output_.size(); }
+  void setData(void* data) { data_ = data; }
+  void* getData() const { return data_; }
+  bool watch(int fd, unsigned events, webserv_fd_callback callback,
+             void* arg);
+  bool unwatch(int fd);
+
+ private:
+  struct Watch {
+    int fd;
+    unsigned events;  // WEBSERV_READABLE | WEBSERV_WRITABLE
+    webserv_fd_callback callback;
+    void* arg;
+  };
+
+  ModuleExchange(const ModuleExchange&);
+  ModuleExchange& operator=(const ModuleExchange&);
+
+  HandlerModule& module_;
+  ModuleEventLoop& loop_;
+  webserv_request request_;
+  webserv_response response_;
+  int status_;
+  HeaderList headers_;
+  std::string output_;  // written, not yet taken by the Client
+  size_t unsent_;
+  bool headersSent_;
+  bool finished_;
+  void* data_;  // set_data()
+  std::vector<Watch> watches_;
+};
+
+// The function table every module gets in init().
+const webserv_api* moduleApi();
@@ -0,0 +1,145 @@
+/*
+ * Content handler modules: the C ABI between the server and a shared
+ * object loaded with 'handler /path/module.so;' in a location block.
+ *
+ * The module exports one symbol, WEBSERV_MODULE_SYMBOL, of type
+ * webserv_module. Every worker process dlopen()s it and calls init() once;
+ * after that handle() runs inside the event loop for each request that
+ * falls in the location, instead of a CGI fork+exec.
+ *
+ *   static const webserv_api* api;  (saved by init())
+ *
+ *   static int hello(void* module_data, webserv_request* req,
+ *                    webserv_response* res) {
+ *     api->set_status(res, 200);
+ *     api->set_header(res, "Content-Type", "application/json");
+ *     api->write(res, "{\"ok\":true}", 11);
+ *     api->finish(res);
+ *     return WEBSERV_OK;
+ *   }
+ *
+ * Rules:
+ *   - Everything runs on the event loop thread and must not block: a slow
+ *     handler stalls every connection of its worker. Work that waits on
+ *     something (a socket, a timer, a pipe to a helper) returns
+ *     WEBSERV_ASYNC and continues from watch_fd() callbacks.
+ *   - The request view and the response writer stay valid until finish()
+ *     or, if the client goes away first, until abort() returns. They must
+ *     not be used after that.
+ *   - Strings handed to the module are not NUL-terminated, and those of
+ *     the request view only last until the call that got them returns:
+ *     an async handler copies what it needs later.
+ *   - The server frames the body: Content-Length when finish() comes before
+ *     anything has been sent, otherwise chunked (HTTP/1.1) or connection
+ *     close (HTTP/1.0). Bytes written past a Content-Length set by the
+ *     module are dropped.
+ */
+#ifndef WEBSERV_MODULE_H
+#define WEBSERV_MODULE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the structs below. */
+#define WEBSERV_MODULE_ABI_VERSION 1
+#define WEBSERV_MODULE_SYMBOL "webserv_handler_module"
+
+/* handle() results. */
+#define WEBSERV_OK 0      /* finish() was called */
+#define WEBSERV_ASYNC 1   /* the response completes later */
+#define WEBSERV_ERROR -1  /* nothing sent yet: the server answers 500 */
+
+/* watch_fd() interest and callback events. */
+#define WEBSERV_READABLE 1u
+#define WEBSERV_WRITABLE 2u
+#define WEBSERV_HANGUP 4u /* callback only: peer closed or error */
+
+/* log() levels, as in the server log. */
+#define WEBSERV_LOG_LEVEL_DEBUG 0
+#define WEBSERV_LOG_LEVEL_INFO 1
+#define WEBSERV_LOG_LEVEL_WARN 2
+#define WEBSERV_LOG_LEVEL_ERROR 3
+
+typedef struct webserv_request webserv_request;   /* opaque */
+typedef struct webserv_response webserv_response; /* opaque */
+
+typedef struct webserv_str {
+  const char* data;
+  size_t len;
+} webserv_str;
+
+typedef void (*webserv_fd_callback)(webserv_response* res, int fd,
+                                    unsigned events, void* arg);
+
+/* Server functions, handed to init() and valid while the module is
+ * loaded. Functions returning int give 0 on success and -1 on misuse
+ * (after finish(), an fd the event loop cannot poll...). */
+typedef struct webserv_api {
+  unsigned abi_version;
+
+  /* ---- Request view ---- */
+  webserv_str (*method)(const webserv_request* req);
+  webserv_str (*path)(const webserv_request* req); /* without the query */
+  webserv_str (*query)(const webserv_request* req);
+  /* Last header with that name (any case); len 0 when absent. */
+  webserv_str (*header)(const webserv_request* req, const char* name);
+  /* All headers in arrival order; names are lower case. */
+  size_t (*header_count)(const webserv_request* req);
+  int (*header_at)(const webserv_request* req, size_t index,
+                   webserv_str* name, webserv_str* value);
+  size_t (*body_size)(const webserv_request* req);
+  /* Next piece of the body: 1 with |chunk| set, 0 at the end. */
+  int (*body_chunk)(webserv_request* req, webserv_str* chunk);
+
+  /* ---- Response writer ---- */
+  /* Status (200-599) and headers can change until the first byte is
+   * sent. */
+  int (*set_status)(webserv_response* res, int status);
+  /* Replaces an earlier header with the same name (any case). */
+  int (*set_header)(webserv_response* res, const char* name,
+                    const char* value);
+  /* Copies |len| bytes. They are sent after the current callback returns. */
+  int (*write)(webserv_response* res, const void* data, size_t len);
+  int (*finish)(webserv_response* res);
+  /* Bytes written but not yet accepted by the client's socket: a
+   * streaming handler should stop producing while this is large. */
+  size_t (*pending)(const webserv_response* res);
+  /* One pointer of per-request state for the module. */
+  void (*set_data)(webserv_response* res, void* data);
+  void* (*get_data)(const webserv_response* res);
+
+  /* ---- Async ----
+   * Call |callback| from the event loop when |fd| is ready. Watching a
+   * watched fd again replaces its events, callback and arg. The server
+   * stops watching every fd when the response ends but never closes
+   * them: the module does. */
+  int (*watch_fd)(webserv_response* res, int fd, unsigned events,
+                  webserv_fd_callback callback, void* arg);
+  int (*unwatch_fd)(webserv_response* res, int fd);
+
+  /* One line in the server log. */
+  void (*log)(int level, const char* message);
+} webserv_api;
+
+typedef struct webserv_module {
+  unsigned abi_version; /* WEBSERV_MODULE_ABI_VERSION */
+  const char* name;
+  /* Optional. Non-zero stops the server from starting. */
+  int (*init)(const webserv_api* api, void** module_data);
+  /* Optional. Worker shutdown. */
+  void (*cleanup)(void* module_data);
+  int (*handle)(void* module_data, webserv_request* req,
+                webserv_response* res);
+  /* Optional. The response ended before finish() (client gone, timeout):
+   * release the request's state and fds. */
+  void (*abort)(void* module_data, webserv_response* res);
+} webserv_module;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WEBSERV_MODULE_H */
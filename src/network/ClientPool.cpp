@@ -0,0 +1,36 @@
+#include "ClientPool.hpp"
+
+ClientPool::ClientPool(const std::vector<ServerConfig>* configs,
+                       const VirtualHostTable* vhosts)
+    : configs_(configs), vhosts_(vhosts), free_() {}
+
+ClientPool::~ClientPool() {
+  for (size_t i = 0; i < free_.size(); ++i) {
+    delete free_[i];
+  }
+}
+
+Client* ClientPool::acquire(int fd, int listenPort, const sockaddr_in& peer) {
+  Client* client;
+  if (free_.empty()) {
+    client = new Client(fd, configs_, listenPort, vhosts_);
+  } else {
+    client = free_.back();
+    free_.pop_back();
+    client->reopen(fd, listenPort);
+  }
+  client->setPeer(peer);
+  return client;
+}
+
+void ClientPool::release(Client* client) {
+  if (client == NULL) return;
+  if (free_.size() >= MAX_IDLE) {
+    delete client;
+    return;
+  }
+  client->recycle();
+  free_.push_back(client);
+}
+
+size_t ClientPool::idle() const { return free_.size(); }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "../client/Client.hpp"
+#include "../config/ServerConfig.hpp"
+#include "../config/VirtualHostTable.hpp"
+
+// Freelist of Client objects for one worker.
+//
+// A Client is big (parser, request, response, processor, output chain) and
+// every member allocates on its own; new/delete per connection made the
+// allocator show up under connection churn. Released clients are recycled
+// (buffers keep their capacity, arenas keep their first chunk) and handed
+// out again by acquire().
+class ClientPool {
+ public:
+  ClientPool(const std::vector<ServerConfig>* configs,
+             const VirtualHostTable* vhosts);
+  ~ClientPool();
+
+  // A client ready for fd, fresh or recycled.
+  Client* acquire(int fd, int listenPort, const sockaddr_in& peer);
+  // Drops the connection state; the object goes back to the freelist (or is
+  // deleted when MAX_IDLE clients are already waiting).
+  void release(Client* client);
+
+  size_t idle() const;
+
+  static const size_t MAX_IDLE = 1024;
+
+ private:
+  ClientPool(const ClientPool&);
+  ClientPool& operator=(const ClientPool&);
+
+  const std::vector<ServerConfig>* configs_;
+  const VirtualHostTable* vhosts_;
+  std::vector<Client*> free_;
+};
@@ -1,18 +1,20 @@
 #include "EpollWrapper.hpp"
 
 #include <cerrno>
-#include <iostream>
+
+#include "common/Log.hpp"
 
 int EpollWrapper::getFd() const { return epoll_fd_; }
 
+const char* EpollWrapper::name() const { return "epoll"; }
+
 EpollWrapper::EpollWrapper() {
   // epoll_create(size) size is ignored in modern kernels but must be > 0.
   epoll_fd_ = epoll_create(1);
   if (epoll_fd_ == -1) {
     throw std::runtime_error("Failed to create epoll instance");
   }
-  std::cout << "Epoll created successfully (fd: " << epoll_fd_ << ")"
-            << std::endl;
+  LOG_DEBUG << "Epoll created successfully (fd: " << epoll_fd_ << ")";
 }
 
 EpollWrapper::~EpollWrapper() {
@@ -21,20 +23,20 @@ EpollWrapper::~EpollWrapper() {
   }
 }
 
-void EpollWrapper::addFd(int fd, uint32_t events) {
+void EpollWrapper::addFd(int fd, uint32_t events, void* data) {
   epoll_event ev;
   ev.events = events;
-  ev.data.fd = fd;
+  ev.data.ptr = data;
 
   if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
     throw std::runtime_error("Failed to add fd to epoll");
   }
 }
 
-void EpollWrapper::modFd(int fd, uint32_t events) {
+void EpollWrapper::modFd(int fd, uint32_t events, void* data) {
   epoll_event ev;
   ev.events = events;
-  ev.data.fd = fd;
+  ev.data.ptr = data;
 
   if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1) {
     throw std::runtime_error("Failed to modify fd in epoll");
@@ -43,7 +45,7 @@ void EpollWrapper::modFd(int fd, uint32_t events) {
 
 void EpollWrapper::removeFd(int fd) {
   if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL) == -1) {
-    std::cerr << "Warning: Failed to remove fd from epoll" << std::endl;
+    LOG_WARN << "Failed to remove fd from epoll";
   }
 }
 
@@ -8,17 +8,22 @@
 #include <string>
 #include <vector>
 
-class EpollWrapper {
+#include "EventBackend.hpp"
+
+class EpollWrapper : public EventBackend {
  public:
   EpollWrapper();
-  ~EpollWrapper();
+  virtual ~EpollWrapper();
+
+  // data is returned untouched in epoll_event.data.ptr (see FdTable::tag).
+  virtual void addFd(int fd, uint32_t events, void* data);
+  virtual void modFd(int fd, uint32_t events, void* data);
 
-  void addFd(int fd, uint32_t events);
-  void modFd(int fd, uint32_t events);
+  virtual void removeFd(int fd);
 
-  void removeFd(int fd);
+  virtual int wait(epoll_event* events, int maxevents, int timeout);
 
-  int wait(epoll_event* events, int maxevents, int timeout);
+  virtual const char* name() const;
 
   int getFd() const;
 
@@ -0,0 +1,46 @@
+#include "EventBackend.hpp"
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <stdexcept>
+
+#include "EpollWrapper.hpp"
+#include "IoUringBackend.hpp"
+#include "common/Log.hpp"
+#include "common/namespaces.hpp"
+
+EventBackend::~EventBackend() {}
+
+void EventBackend::addListener(int fd, void* data) { addFd(fd, EPOLLIN, data); }
+
+void EventBackend::addClient(int fd, uint32_t events, void* data) {
+  addFd(fd, events, data);
+}
+
+bool EventBackend::acceptsConnections() const { return false; }
+
+int EventBackend::takeAccepted(int, sockaddr_in&) {
+  errno = EAGAIN;
+  return -1;
+}
+
+ssize_t EventBackend::receive(int fd, void* buffer, std::size_t length) {
+  return recv(fd, buffer, length, 0);
+}
+
+EventBackend* EventBackend::create(const std::string& name,
+                                   std::size_t readSize) {
+  if (name != config::section::event_backend_epoll) {
+    try {
+      return new IoUringBackend(readSize);
+    } catch (const std::exception& e) {
+      // auto: epoll is the expected answer on older kernels, say nothing.
+      if (name == config::section::event_backend_io_uring) {
+        LOG_WARN << "io_uring unavailable (" << e.what()
+                 << "), using epoll";
+      }
+    }
+  }
+  return new EpollWrapper();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <string>
+
+// Readiness notification used by ServerManager: epoll or io_uring.
+//
+// Both speak epoll's vocabulary: masks are EPOLLIN/EPOLLOUT/EPOLLRDHUP
+// (EPOLLET for edge-triggered), and wait() fills epoll_event with the
+// data pointer given to addFd()/modFd() (see FdTable::tag). EPOLLERR and
+// EPOLLHUP are always reported, as with epoll.
+//
+// Listeners and client sockets are registered with their own calls so a
+// backend can do their I/O itself: it then accepts connections
+// (acceptsConnections(), takeAccepted()) and reads client sockets
+// (receive()) as the events come in. The defaults only poll, and leave
+// accept4()/recv() to the caller. Writes are always the Client's
+// (writev()/sendfile()).
+class EventBackend {
+ public:
+  virtual ~EventBackend();
+
+  virtual void addFd(int fd, uint32_t events, void* data) = 0;
+  virtual void modFd(int fd, uint32_t events, void* data) = 0;
+  virtual void removeFd(int fd) = 0;
+
+  // Listening socket: EPOLLIN when connections are waiting.
+  virtual void addListener(int fd, void* data);
+  // Client socket; later changes go through modFd()/removeFd().
+  virtual void addClient(int fd, uint32_t events, void* data);
+
+  // true when the backend accepts on its listeners: the caller takes the
+  // connections with takeAccepted() instead of calling accept4().
+  virtual bool acceptsConnections() const;
+  // Next connection accepted on listener fd (non-blocking, close-on-exec)
+  // and its address; -1 when none is left.
+  virtual int takeAccepted(int fd, sockaddr_in& peer);
+  // recv() on a client socket, same results (0 = EOF, -1 with errno, EAGAIN
+  // when nothing is left). A backend that reads the socket itself hands
+  // out the bytes it already has.
+  virtual ssize_t receive(int fd, void* buffer, std::size_t length);
+
+  // timeout in ms, -1 = none. 0 events on timeout or EINTR.
+  virtual int wait(epoll_event* events, int maxevents, int timeout) = 0;
+
+  virtual const char* name() const = 0;
+
+  // name: "epoll", "io_uring" or "auto" (event_backend directive).
+  // io_uring falls back to epoll when the kernel cannot run it.
+  // readSize: bytes per read on client sockets (client_read_size).
+  static EventBackend* create(const std::string& name, std::size_t readSize);
+};
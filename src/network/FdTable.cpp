@@ -0,0 +1,50 @@
+#include "FdTable.hpp"
+
+FdSlot::FdSlot()
+    : kind(FD_FREE), instance(0), fd(-1), listener(NULL), port(0),
+      client(NULL), paused(false), events(0) {}
+
+FdTable::FdTable() : slots_() {}
+
+FdTable::~FdTable() {}
+
+FdSlot* FdTable::open(int fd, FdKind kind) {
+  if (fd < 0) return NULL;
+  while (slots_.size() <= static_cast<size_t>(fd)) slots_.push_back(FdSlot());
+
+  FdSlot& slot = slots_[fd];
+  uintptr_t instance = slot.instance ^ 1;
+  slot = FdSlot();
+  slot.kind = kind;
+  slot.instance = instance;
+  slot.fd = fd;
+  return &slot;
+}
+
+void FdTable::close(int fd) {
+  FdSlot* slot = get(fd);
+  if (slot == NULL) return;
+  slot->kind = FD_FREE;
+  slot->listener = NULL;
+  slot->client = NULL;
+}
+
+FdSlot* FdTable::get(int fd) {
+  if (fd < 0 || static_cast<size_t>(fd) >= slots_.size()) return NULL;
+  FdSlot* slot = &slots_[fd];
+  return slot->kind == FD_FREE ? NULL : slot;
+}
+
+size_t FdTable::capacity() const { return slots_.size(); }
+
+void* FdTable::tag(const FdSlot* slot) {
+  return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(slot) |
+                                 slot->instance);
+}
+
+FdSlot* FdTable::untag(void* ptr) {
+  uintptr_t bits = reinterpret_cast<uintptr_t>(ptr);
+  FdSlot* slot = reinterpret_cast<FdSlot*>(bits & ~static_cast<uintptr_t>(1));
+  if (slot->kind == FD_FREE || slot->instance != (bits & 1)) return NULL;
+  return slot;
+}
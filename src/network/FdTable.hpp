@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <deque>
+
+class Client;
+class TcpListener;
+
+// What an fd registered in epoll is, so the loop knows which handler to run.
+enum FdKind { FD_FREE, FD_LISTENER, FD_CLIENT, FD_CGI_PIPE, FD_INOTIFY };
+
+struct FdSlot {
+  FdKind kind;
+  uintptr_t instance;  // flipped on every reuse of the slot (0 or 1)
+  int fd;
+  TcpListener* listener;  // FD_LISTENER
+  int port;               // FD_LISTENER: port it listens on
+  Client* client;         // FD_CLIENT, FD_CGI_PIPE (owner of the pipe)
+  bool paused;            // FD_CGI_PIPE: out of epoll until resumed
+  uint32_t events;        // FD_CLIENT: mask registered in epoll
+
+  FdSlot();
+};
+
+// Dense table indexed by fd, replacing the listener/client/pipe maps.
+//
+// epoll_event.data.ptr carries tag(slot): the slot address with its
+// instance bit in the lowest bit (slots are pointer-aligned, so that bit
+// is free). Dispatch is untag() plus a switch on kind, no lookups.
+//
+// The instance bit catches stale events: if an fd is closed and reused
+// (accept) while events from the same epoll_wait batch are still being
+// processed, the old events carry the previous instance and are dropped.
+//
+// Slots live in a deque, so growing the table never moves existing slots
+// and the pointers stored in epoll stay valid.
+class FdTable {
+ public:
+  FdTable();
+  ~FdTable();
+
+  // Marks fd as used by kind; the other fields are reset.
+  FdSlot* open(int fd, FdKind kind);
+  void close(int fd);  // only marks the slot free; does not close(2)
+
+  // NULL if fd is not registered.
+  FdSlot* get(int fd);
+  size_t capacity() const;  // every fd < capacity() can be inspected
+
+  static void* tag(const FdSlot* slot);
+  // NULL if the event is stale (slot freed or reused since it was armed).
+  static FdSlot* untag(void* ptr);
+
+ private:
+  FdTable(const FdTable&);
+  FdTable& operator=(const FdTable&);
+
+  std::deque<FdSlot> slots_;
+};
@@ -0,0 +1,624 @@
+#include "IoUringBackend.hpp"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "common/Log.hpp"
+
+namespace {
+
+// What a completion belongs to (bits 32-39 of user_data).
+enum Kind { KIND_INTERNAL, KIND_POLL, KIND_ACCEPT, KIND_RECV };
+
+// Generations are kept to the 24 bits left in user_data.
+const uint32_t TAG_MASK = 0xffffffu;
+
+// Buffer group of the provided buffer ring.
+const uint16_t RECV_GROUP = 0;
+
+// Bits of an epoll mask that poll understands.
+const uint32_t POLL_MASK =
+    EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
+// Clients in MODE_RECV: reads, EOF included, come from the recv.
+const uint32_t RECV_POLL_MASK = EPOLLPRI | EPOLLOUT;
+
+uint64_t userData(uint32_t fd, Kind kind, uint32_t tag) {
+  return (static_cast<uint64_t>(tag & TAG_MASK) << 40) |
+         (static_cast<uint64_t>(kind) << 32) | fd;
+}
+
+uint32_t fdOf(uint64_t data) { return static_cast<uint32_t>(data); }
+Kind kindOf(uint64_t data) { return static_cast<Kind>((data >> 32) & 0xff); }
+uint32_t tagOf(uint64_t data) { return static_cast<uint32_t>(data >> 40); }
+
+// The kernel reads sq tail and writes cq tail concurrently.
+unsigned loadAcquire(const unsigned* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(unsigned* p, unsigned value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T* ringField(void* ring, unsigned offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+long ringRegister(int ring_fd, unsigned opcode, void* arg, unsigned count) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, count);
+}
+
+}  // namespace
+
+IoUringBackend::Watch::Watch()
+    : data(NULL),
+      events(0),
+      mode(MODE_POLL),
+      generation(0),
+      pollTag(0),
+      opTag(0),
+      registered(false),
+      pollArmed(false),
+      opArmed(false),
+      opEnded(false),
+      queued(false),
+      round(0),
+      slot(0),
+      accepted(),
+      received() {}
+
+IoUringBackend::IoUringBackend(std::size_t readSize)
+    : ring_fd_(-1),
+      ring_(MAP_FAILED),
+      ring_size_(0),
+      sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+      sqes_size_(0),
+      sq_head_(NULL),
+      sq_tail_(NULL),
+      sq_array_(NULL),
+      sq_mask_(0),
+      sq_entries_(0),
+      cq_head_(NULL),
+      cq_tail_(NULL),
+      cqes_(NULL),
+      cq_mask_(0),
+      sq_local_tail_(0),
+      offload_(false),
+      recv_ring_(static_cast<io_uring_buf*>(MAP_FAILED)),
+      recv_ring_size_(0),
+      recv_memory_(static_cast<char*>(MAP_FAILED)),
+      recv_memory_size_(0),
+      recv_count_(0),
+      recv_size_(0),
+      recv_tail_(0),
+      watches_(),
+      rearm_(),
+      queued_(),
+      round_(0) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES,
+                                      &params));
+  if (ring_fd_ < 0) {
+    throw std::runtime_error(std::string("io_uring_setup: ") +
+                             std::strerror(errno));
+  }
+
+  const uint32_t needed = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP |
+                          IORING_FEAT_EXT_ARG | IORING_FEAT_RSRC_TAGS;
+  if ((params.features & needed) != needed) {
+    release();
+    throw std::runtime_error("kernel older than 5.13");
+  }
+
+  std::size_t sqSize =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  std::size_t cqSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  ring_size_ = sqSize > cqSize ? sqSize : cqSize;
+  ring_ = mmap(NULL, ring_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+  if (ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    release();
+    throw std::runtime_error("io_uring mmap failed");
+  }
+
+  sq_head_ = ringField<unsigned>(ring_, params.sq_off.head);
+  sq_tail_ = ringField<unsigned>(ring_, params.sq_off.tail);
+  sq_array_ = ringField<unsigned>(ring_, params.sq_off.array);
+  sq_mask_ = *ringField<unsigned>(ring_, params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  cq_head_ = ringField<unsigned>(ring_, params.cq_off.head);
+  cq_tail_ = ringField<unsigned>(ring_, params.cq_off.tail);
+  cqes_ = ringField<io_uring_cqe>(ring_, params.cq_off.cqes);
+  cq_mask_ = *ringField<unsigned>(ring_, params.cq_off.ring_mask);
+
+  // SQE slot i always goes in array slot i.
+  for (unsigned i = 0; i < sq_entries_; ++i) sq_array_[i] = i;
+  sq_local_tail_ = *sq_tail_;
+
+  if (kernelHasOffload()) setupRecvBuffers(readSize);
+  LOG_DEBUG << "io_uring created successfully (fd: " << ring_fd_ << ", "
+            << (offload_ ? "accept/recv in the ring" : "poll only") << ")";
+}
+
+IoUringBackend::~IoUringBackend() {
+  // Connections accepted but never handed out.
+  for (std::size_t fd = 0; fd < watches_.size(); ++fd) {
+    std::deque<int>& accepted = watches_[fd].accepted;
+    for (std::size_t i = 0; i < accepted.size(); ++i) close(accepted[i]);
+  }
+  release();
+}
+
+// Closing the ring cancels every request still in it; only then can the
+// buffers the kernel writes into go away.
+void IoUringBackend::release() {
+  if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+  if (ring_ != MAP_FAILED) munmap(ring_, ring_size_);
+  if (ring_fd_ != -1) close(ring_fd_);
+  if (recv_ring_ != MAP_FAILED) munmap(recv_ring_, recv_ring_size_);
+  if (recv_memory_ != MAP_FAILED) munmap(recv_memory_, recv_memory_size_);
+  sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  ring_ = MAP_FAILED;
+  ring_fd_ = -1;
+  recv_ring_ = static_cast<io_uring_buf*>(MAP_FAILED);
+  recv_memory_ = static_cast<char*>(MAP_FAILED);
+}
+
+// Multishot recv came in 6.0, the same release as IORING_OP_SEND_ZC, which
+// IORING_REGISTER_PROBE can see (it only lists opcodes, not their flags).
+// Multishot accept and provided buffer rings are older (5.19).
+bool IoUringBackend::kernelHasOffload() {
+  const unsigned ops = 256;
+  std::vector<char> memory(sizeof(io_uring_probe) +
+                           ops * sizeof(io_uring_probe_op));
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(&memory[0]);
+  if (ringRegister(ring_fd_, IORING_REGISTER_PROBE, probe, ops) < 0)
+    return false;
+  const io_uring_probe_op* op =
+      reinterpret_cast<const io_uring_probe_op*>(probe + 1);
+  return probe->ops_len > IORING_OP_SEND_ZC &&
+         (op[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+// Buffer ring: recv_count_ io_uring_buf entries the kernel consumes from
+// the head; recycle() puts buffers back at the tail, a 16-bit counter that
+// overlays the resv field of entry 0.
+void IoUringBackend::setupRecvBuffers(std::size_t readSize) {
+  unsigned count = MIN_RECV_BUFFERS;
+  while (count < MAX_RECV_BUFFERS &&
+         static_cast<std::size_t>(count) * 2 * readSize <= RECV_POOL_BYTES)
+    count *= 2;
+
+  recv_ring_size_ = count * sizeof(io_uring_buf);
+  recv_memory_size_ = count * readSize;
+  void* ring = mmap(NULL, recv_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  void* memory = mmap(NULL, recv_memory_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  recv_ring_ = static_cast<io_uring_buf*>(ring);
+  recv_memory_ = static_cast<char*>(memory);
+  if (ring == MAP_FAILED || memory == MAP_FAILED) return;
+
+  io_uring_buf_reg reg;
+  std::memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uintptr_t>(ring);
+  reg.ring_entries = count;
+  reg.bgid = RECV_GROUP;
+  if (ringRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    munmap(ring, recv_ring_size_);
+    munmap(memory, recv_memory_size_);
+    recv_ring_ = static_cast<io_uring_buf*>(MAP_FAILED);
+    recv_memory_ = static_cast<char*>(MAP_FAILED);
+    return;
+  }
+
+  recv_count_ = count;
+  recv_size_ = readSize;
+  recv_tail_ = 0;
+  for (unsigned id = 0; id < count; ++id) recycle(static_cast<int>(id));
+  offload_ = true;
+}
+
+char* IoUringBackend::recvBuffer(int id) const {
+  return recv_memory_ + static_cast<std::size_t>(id) * recv_size_;
+}
+
+void IoUringBackend::recycle(int id) {
+  // Field by field: entry 0's resv is the tail the kernel reads.
+  io_uring_buf& entry = recv_ring_[recv_tail_ & (recv_count_ - 1)];
+  entry.addr = reinterpret_cast<uintptr_t>(recvBuffer(id));
+  entry.len = static_cast<uint32_t>(recv_size_);
+  entry.bid = static_cast<uint16_t>(id);
+  ++recv_tail_;
+  __atomic_store_n(&recv_ring_[0].resv, recv_tail_, __ATOMIC_RELEASE);
+}
+
+const char* IoUringBackend::name() const { return "io_uring"; }
+
+void IoUringBackend::addFd(int fd, uint32_t events, void* data) {
+  registerFd(fd, MODE_POLL, events, data);
+}
+
+void IoUringBackend::addListener(int fd, void* data) {
+  registerFd(fd, offload_ ? MODE_ACCEPT : MODE_POLL, EPOLLIN, data);
+}
+
+void IoUringBackend::addClient(int fd, uint32_t events, void* data) {
+  registerFd(fd, offload_ ? MODE_RECV : MODE_POLL, events, data);
+}
+
+void IoUringBackend::registerFd(int fd, Mode mode, uint32_t events,
+                                void* data) {
+  Watch& entry = watch(fd);
+  if (entry.registered) {
+    throw std::runtime_error("Failed to add fd to io_uring");
+  }
+  entry.registered = true;
+  entry.data = data;
+  entry.events = events;
+  entry.mode = mode;
+  entry.opEnded = false;
+  ++entry.generation;
+  armPoll(fd);
+  armOp(fd);
+}
+
+// Only the poll changes: a client's recv keeps running.
+void IoUringBackend::modFd(int fd, uint32_t events, void* data) {
+  Watch& entry = watch(fd);
+  if (!entry.registered) {
+    throw std::runtime_error("Failed to modify fd in io_uring");
+  }
+  cancelPoll(fd);
+  entry.data = data;
+  entry.events = events;
+  ++entry.generation;
+  armPoll(fd);
+}
+
+void IoUringBackend::removeFd(int fd) {
+  Watch& entry = watch(fd);
+  if (!entry.registered) {
+    LOG_WARN << "Failed to remove fd from io_uring";
+    return;
+  }
+  cancelPoll(fd);
+  cancelOp(fd);
+  dropQueued(entry);
+  entry.registered = false;
+  ++entry.generation;
+}
+
+bool IoUringBackend::acceptsConnections() const { return offload_; }
+
+// The accept is multishot, so there is no per-connection sockaddr to
+// fill: getpeername() gives the address.
+int IoUringBackend::takeAccepted(int fd, sockaddr_in& peer) {
+  if (fd < 0 || static_cast<std::size_t>(fd) >= watches_.size() ||
+      watches_[fd].accepted.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  int client = watches_[fd].accepted.front();
+  watches_[fd].accepted.pop_front();
+  socklen_t length = sizeof(peer);
+  if (getpeername(client, reinterpret_cast<sockaddr*>(&peer), &length) == -1)
+    std::memset(&peer, 0, sizeof(peer));
+  return client;
+}
+
+ssize_t IoUringBackend::receive(int fd, void* buffer, std::size_t length) {
+  if (fd < 0 || static_cast<std::size_t>(fd) >= watches_.size() ||
+      watches_[fd].mode != MODE_RECV)
+    return recv(fd, buffer, length, 0);
+
+  std::deque<Chunk>& received = watches_[fd].received;
+  if (received.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  Chunk& chunk = received.front();
+  // EOF/error stays queued: every later call gets it too, as with recv().
+  if (chunk.buffer < 0) {
+    if (chunk.error == 0) return 0;
+    errno = chunk.error;
+    return -1;
+  }
+  std::size_t n = chunk.length - chunk.offset;
+  if (n > length) n = length;
+  std::memcpy(buffer, recvBuffer(chunk.buffer) + chunk.offset, n);
+  chunk.offset += static_cast<unsigned>(n);
+  if (chunk.offset == chunk.length) {
+    recycle(chunk.buffer);
+    received.pop_front();
+  }
+  return static_cast<ssize_t>(n);
+}
+
+int IoUringBackend::wait(epoll_event* events, int maxevents, int timeout) {
+  ++round_;
+  // Requests that ended since last time (one-shot polls handed out, a
+  // multishot the kernel stopped), unless the fd was removed since or
+  // modFd already armed a new poll.
+  for (std::size_t i = 0; i < rearm_.size(); ++i) {
+    int fd = rearm_[i];
+    Watch& entry = watches_[fd];
+    if (!entry.registered) continue;
+    if (!entry.pollArmed) armPoll(fd);
+    if (!entry.opArmed) armOp(fd);
+  }
+  rearm_.clear();
+
+  // Anything still queued is reported without waiting for the kernel.
+  int count = reportQueued(events, 0, maxevents);
+  while (true) {
+    bool block = timeout != 0 && count == 0 && !completionsReady();
+    bool waited = enter(block, timeout);
+    count = reap(events, count, maxevents);
+    // Only completions of cancelled requests: wait again.
+    if (count > 0 || !block || !waited) return count;
+  }
+}
+
+IoUringBackend::Watch& IoUringBackend::watch(int fd) {
+  if (fd < 0) throw std::runtime_error("Invalid fd for io_uring");
+  if (watches_.size() <= static_cast<std::size_t>(fd)) {
+    watches_.resize(static_cast<std::size_t>(fd) + 1);
+  }
+  return watches_[fd];
+}
+
+uint32_t IoUringBackend::pollMask(const Watch& entry) const {
+  switch (entry.mode) {
+    case MODE_POLL:
+      return entry.events & POLL_MASK;
+    case MODE_RECV:
+      return entry.events & RECV_POLL_MASK;
+    case MODE_ACCEPT:
+      break;
+  }
+  return 0;
+}
+
+// MODE_RECV with nothing to write has no poll at all: the recv also
+// reports errors and hangups.
+void IoUringBackend::armPoll(int fd) {
+  Watch& entry = watches_[fd];
+  uint32_t mask = pollMask(entry);
+  if (entry.mode != MODE_POLL && mask == 0) return;
+  io_uring_sqe* sqe = nextSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = mask;
+  if (entry.events & EPOLLET) sqe->len = IORING_POLL_ADD_MULTI;
+  entry.pollTag = entry.generation;
+  sqe->user_data = userData(static_cast<uint32_t>(fd), KIND_POLL,
+                            entry.pollTag);
+  entry.pollArmed = true;
+}
+
+void IoUringBackend::cancelPoll(int fd) {
+  Watch& entry = watches_[fd];
+  if (!entry.pollArmed) return;
+  io_uring_sqe* sqe = nextSqe();
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = userData(static_cast<uint32_t>(fd), KIND_POLL, entry.pollTag);
+  sqe->user_data = userData(0, KIND_INTERNAL, 0);
+  entry.pollArmed = false;
+}
+
+void IoUringBackend::armOp(int fd) {
+  Watch& entry = watches_[fd];
+  if (entry.mode == MODE_POLL || entry.opEnded) return;
+  io_uring_sqe* sqe = nextSqe();
+  sqe->fd = fd;
+  entry.opTag = entry.generation;
+  if (entry.mode == MODE_ACCEPT) {
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = userData(static_cast<uint32_t>(fd), KIND_ACCEPT,
+                              entry.opTag);
+  } else {
+    // len 0: as much as the buffer the kernel picks holds.
+    sqe->opcode = IORING_OP_RECV;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_GROUP;
+    sqe->user_data = userData(static_cast<uint32_t>(fd), KIND_RECV,
+                              entry.opTag);
+  }
+  entry.opArmed = true;
+}
+
+void IoUringBackend::cancelOp(int fd) {
+  Watch& entry = watches_[fd];
+  if (!entry.opArmed) return;
+  io_uring_sqe* sqe = nextSqe();
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  Kind kind = entry.mode == MODE_ACCEPT ? KIND_ACCEPT : KIND_RECV;
+  sqe->addr = userData(static_cast<uint32_t>(fd), kind, entry.opTag);
+  sqe->user_data = userData(0, KIND_INTERNAL, 0);
+  entry.opArmed = false;
+}
+
+void IoUringBackend::dropQueued(Watch& entry) {
+  for (std::size_t i = 0; i < entry.accepted.size(); ++i)
+    close(entry.accepted[i]);
+  entry.accepted.clear();
+  for (std::size_t i = 0; i < entry.received.size(); ++i)
+    if (entry.received[i].buffer >= 0) recycle(entry.received[i].buffer);
+  entry.received.clear();
+}
+
+io_uring_sqe* IoUringBackend::nextSqe() {
+  // Ring full: hand what is queued to the kernel now.
+  if (sq_local_tail_ - loadAcquire(sq_head_) >= sq_entries_) {
+    enter(false, 0);
+    if (sq_local_tail_ - loadAcquire(sq_head_) >= sq_entries_) {
+      throw std::runtime_error("io_uring submission queue full");
+    }
+  }
+  io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+  ++sq_local_tail_;
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+bool IoUringBackend::enter(bool wait, int timeout) {
+  storeRelease(sq_tail_, sq_local_tail_);
+  unsigned toSubmit = sq_local_tail_ - loadAcquire(sq_head_);
+  if (toSubmit == 0 && !wait) return true;
+
+  unsigned flags = 0;
+  io_uring_getevents_arg arg;
+  __kernel_timespec ts;
+  void* argp = NULL;
+  std::size_t argSize = 0;
+  if (wait) {
+    flags |= IORING_ENTER_GETEVENTS;
+    if (timeout > 0) {
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000L;
+      std::memset(&arg, 0, sizeof(arg));
+      arg.ts = reinterpret_cast<uintptr_t>(&ts);
+      flags |= IORING_ENTER_EXT_ARG;
+      argp = &arg;
+      argSize = sizeof(arg);
+    }
+  }
+
+  long ret = syscall(__NR_io_uring_enter, ring_fd_, toSubmit, wait ? 1 : 0,
+                     flags, argp, argSize);
+  if (ret < 0) {
+    // ETIME: timeout; EBUSY/EAGAIN: completions must be reaped first.
+    if (errno == ETIME || errno == EINTR || errno == EBUSY ||
+        errno == EAGAIN)
+      return false;
+    throw std::runtime_error("io_uring_enter failed");
+  }
+  return true;
+}
+
+bool IoUringBackend::completionsReady() const {
+  return loadAcquire(cq_tail_) != *cq_head_;
+}
+
+// One event per fd and wait(), as epoll gives: a poll and a recv that
+// complete together share it.
+int IoUringBackend::report(epoll_event* events, int count, int fd,
+                           uint32_t bits) {
+  Watch& entry = watches_[fd];
+  if (entry.round == round_) {
+    events[entry.slot].events |= bits;
+    return count;
+  }
+  entry.round = round_;
+  entry.slot = count;
+  events[count].events = bits;
+  events[count].data.ptr = entry.data;
+  return count + 1;
+}
+
+int IoUringBackend::reportQueued(epoll_event* events, int count,
+                                 int maxevents) {
+  std::vector<int> listed;
+  listed.swap(queued_);
+  for (std::size_t i = 0; i < listed.size(); ++i) {
+    int fd = listed[i];
+    Watch& entry = watches_[fd];
+    entry.queued = false;
+    if (!entry.registered ||
+        (entry.accepted.empty() && entry.received.empty()))
+      continue;
+    entry.queued = true;
+    queued_.push_back(fd);
+    if (count < maxevents) count = report(events, count, fd, EPOLLIN);
+  }
+  return count;
+}
+
+int IoUringBackend::reap(epoll_event* events, int count, int maxevents) {
+  unsigned head = *cq_head_;
+  unsigned tail = loadAcquire(cq_tail_);
+  for (; head != tail && count < maxevents; ++head) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    uint32_t fd = fdOf(cqe.user_data);
+    Kind kind = kindOf(cqe.user_data);
+    if (kind == KIND_INTERNAL) continue;
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    Watch* entry = fd < watches_.size() ? &watches_[fd] : NULL;
+    uint32_t armedTag = 0;
+    if (entry) armedTag = kind == KIND_POLL ? entry->pollTag : entry->opTag;
+    if (entry == NULL || !entry->registered ||
+        (armedTag & TAG_MASK) != tagOf(cqe.user_data)) {
+      // Stale, but what it delivered is still ours to give back.
+      if (cqe.flags & IORING_CQE_F_BUFFER)
+        recycle(static_cast<int>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+      else if (kind == KIND_ACCEPT && cqe.res >= 0)
+        close(cqe.res);
+      continue;
+    }
+
+    if (kind == KIND_POLL) {
+      // No IORING_CQE_F_MORE: the poll is over (one-shot, or a multishot
+      // the kernel ended) and has to be armed again.
+      if (!more) {
+        entry->pollArmed = false;
+        rearm_.push_back(static_cast<int>(fd));
+      }
+      if (cqe.res == -ECANCELED) continue;
+      uint32_t bits = cqe.res < 0 ? static_cast<uint32_t>(EPOLLERR)
+                                  : static_cast<uint32_t>(cqe.res);
+      count = report(events, count, static_cast<int>(fd), bits);
+      continue;
+    }
+
+    if (!more) {
+      entry->opArmed = false;
+      rearm_.push_back(static_cast<int>(fd));
+    }
+    if (kind == KIND_ACCEPT) {
+      // EMFILE and friends: the accept is armed again next time.
+      if (cqe.res < 0) continue;
+      entry->accepted.push_back(cqe.res);
+    } else {
+      // ENOBUFS: every buffer is queued somewhere; re-armed next time,
+      // once receive() has given some back.
+      if (cqe.res == -ENOBUFS || cqe.res == -ECANCELED) continue;
+      Chunk chunk = {-1, 0, 0, 0};
+      if (cqe.res > 0) {
+        chunk.buffer = static_cast<int>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        chunk.length = static_cast<unsigned>(cqe.res);
+      } else {
+        chunk.error = -cqe.res;
+        entry->opEnded = true;
+      }
+      entry->received.push_back(chunk);
+    }
+    if (!entry->queued) {
+      entry->queued = true;
+      queued_.push_back(static_cast<int>(fd));
+    }
+    count = report(events, count, static_cast<int>(fd), EPOLLIN);
+  }
+  storeRelease(cq_head_, head);
+  return count;
+}
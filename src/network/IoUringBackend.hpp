@@ -0,0 +1,173 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "EventBackend.hpp"
+
+// EventBackend on an io_uring ring, driven with raw syscalls (no liburing).
+//
+// On Linux 6.0+ the ring does the I/O that readiness would only announce:
+// - every listener has one multishot IORING_OP_ACCEPT in flight: new
+//   connections arrive as completions and takeAccepted() hands them out,
+//   with no accept4() per connection.
+// - every client socket has one multishot IORING_OP_RECV reading into a
+//   ring of provided buffers (IORING_REGISTER_PBUF_RING): the kernel picks
+//   a free buffer for each read, so idle connections pin no memory, and
+//   receive() copies the bytes out (into the parser) and gives the buffer
+//   back. No recv() per read.
+// Listeners and clients with connections or bytes still queued after a
+// wait() are reported again by the next one, so a level-triggered reader
+// that takes one read per event does not stall.
+//
+// The rest (EPOLLOUT on clients, CGI pipes, inotify) is watched with
+// IORING_OP_POLL_ADD, as is everything on kernels without the above:
+// - level-triggered masks use one-shot polls, re-armed by the next wait()
+//   once the event has been handed out. Arming a poll checks readiness
+//   first, so an fd that is still ready is reported again, as with epoll.
+// - EPOLLET masks use multishot polls (IORING_POLL_ADD_MULTI): one report
+//   per wakeup until removed.
+//
+// addFd/modFd/removeFd only queue SQEs; wait() submits them and waits for
+// completions in the same io_uring_enter(), so a loop iteration costs one
+// syscall however many interest changes it made.
+//
+// Completions carry (tag << 40 | kind << 32 | fd). Every add/mod/remove
+// bumps the fd's generation and a request is tagged with the generation it
+// was armed in, so the -ECANCELED completion of a replaced request, or one
+// already in the ring, is dropped (a stale read still gives its buffer
+// back).
+//
+// Needs Linux 5.13 (IORING_FEAT_EXT_ARG for the wait timeout, multishot
+// poll); the constructor throws otherwise.
+class IoUringBackend : public EventBackend {
+ public:
+  // readSize: size of each provided buffer (client_read_size).
+  explicit IoUringBackend(std::size_t readSize);
+  virtual ~IoUringBackend();
+
+  virtual void addFd(int fd, uint32_t events, void* data);
+  virtual void modFd(int fd, uint32_t events, void* data);
+  virtual void removeFd(int fd);
+
+  virtual void addListener(int fd, void* data);
+  virtual void addClient(int fd, uint32_t events, void* data);
+
+  virtual bool acceptsConnections() const;
+  virtual int takeAccepted(int fd, sockaddr_in& peer);
+  virtual ssize_t receive(int fd, void* buffer, std::size_t length);
+
+  virtual int wait(epoll_event* events, int maxevents, int timeout);
+
+  virtual const char* name() const;
+
+ private:
+  // Submission queue size; the completion queue is twice as large.
+  static const unsigned RING_ENTRIES = 256;
+  // Provided buffers: about RECV_POOL_BYTES in all, within these counts.
+  static const std::size_t RECV_POOL_BYTES = 4 * 1024 * 1024;
+  static const unsigned MIN_RECV_BUFFERS = 8;
+  static const unsigned MAX_RECV_BUFFERS = 4096;
+
+  // How an fd is watched.
+  enum Mode {
+    MODE_POLL,    // readiness only
+    MODE_ACCEPT,  // listener: multishot accept
+    MODE_RECV     // client: multishot recv, polled only for EPOLLOUT
+  };
+
+  // What one recv completion left for receive(): bytes of a provided
+  // buffer, or the end of the stream (buffer == -1; error 0 for EOF).
+  struct Chunk {
+    int buffer;
+    int error;
+    unsigned length;
+    unsigned offset;
+  };
+
+  struct Watch {
+    void* data;
+    uint32_t events;  // mask as given to addFd/modFd (EPOLLET included)
+    Mode mode;
+    uint32_t generation;
+    uint32_t pollTag;  // generation the poll in flight was armed in
+    uint32_t opTag;    // same for the accept/recv
+    bool registered;
+    bool pollArmed;  // a poll for pollTag is queued or in the ring
+    bool opArmed;    // same for the accept/recv
+    bool opEnded;    // recv saw EOF or an error: not armed again
+    bool queued;     // listed in queued_
+    unsigned round;  // last wait() that reported it...
+    int slot;        // ...in events[slot]
+    std::deque<int> accepted;
+    std::deque<Chunk> received;
+
+    Watch();
+  };
+
+  IoUringBackend(const IoUringBackend&);
+  IoUringBackend& operator=(const IoUringBackend&);
+
+  void release();
+  bool kernelHasOffload();
+  void setupRecvBuffers(std::size_t readSize);
+  char* recvBuffer(int id) const;
+  void recycle(int id);
+
+  Watch& watch(int fd);
+  void registerFd(int fd, Mode mode, uint32_t events, void* data);
+  uint32_t pollMask(const Watch& entry) const;
+  void armPoll(int fd);
+  void cancelPoll(int fd);
+  void armOp(int fd);
+  void cancelOp(int fd);
+  void dropQueued(Watch& entry);
+  io_uring_sqe* nextSqe();
+  // Submits every queued SQE; with wait, also blocks until a completion
+  // arrives or timeout ms pass. false on timeout or EINTR.
+  bool enter(bool wait, int timeout);
+  bool completionsReady() const;
+  // events[0, count) are this wait()'s; both return the new count.
+  int report(epoll_event* events, int count, int fd, uint32_t bits);
+  int reportQueued(epoll_event* events, int count, int maxevents);
+  int reap(epoll_event* events, int count, int maxevents);
+
+  int ring_fd_;
+  void* ring_;  // SQ and CQ rings (IORING_FEAT_SINGLE_MMAP)
+  std::size_t ring_size_;
+  io_uring_sqe* sqes_;
+  std::size_t sqes_size_;
+
+  // Pointers into ring_
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned* sq_array_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  io_uring_cqe* cqes_;
+  unsigned cq_mask_;
+
+  unsigned sq_local_tail_;  // SQEs written, published by enter()
+
+  // Provided buffer ring; offload_ is false when the kernel cannot run
+  // multishot accept/recv and everything is polled.
+  bool offload_;
+  io_uring_buf* recv_ring_;  // recv_count_ entries, tail in entry 0
+  std::size_t recv_ring_size_;
+  char* recv_memory_;        // recv_count_ buffers of recv_size_ bytes
+  std::size_t recv_memory_size_;
+  unsigned recv_count_;
+  std::size_t recv_size_;
+  uint16_t recv_tail_;
+
+  std::vector<Watch> watches_;  // indexed by fd
+  std::vector<int> rearm_;      // requests ended since the last wait()
+  std::vector<int> queued_;     // fds with connections or bytes queued
+  unsigned round_;              // wait() calls so far
+};
@@ -1,28 +1,68 @@
 #include "ServerManager.hpp"
 
+#include <signal.h>
 #include <sys/epoll.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <cerrno>
+#include <climits>
 #include <cstdio>
 #include <cstring>
-#include <iostream>
 #include <set>
 #include <stdexcept>
 
 #include "client/Client.hpp"
-
-#define CLIENT_TIMEOUT_SECONDS 60
-
-ServerManager::ServerManager(const std::vector<ServerConfig>* configs)
-    : configs_(configs) {
+#include "common/Log.hpp"
+#include "common/TimeUtils.hpp"
+
+static volatile sig_atomic_t g_stop_requested = 0;
+
+static void onStopSignal(int) { g_stop_requested = 1; }
+
+ServerManager::ServerManager(const std::vector<ServerConfig>* configs,
+                             const GlobalConfig& global, bool reusePort)
+    : backend_(EventBackend::create(
+          global.getEventBackend(),
+          static_cast<size_t>(global.getClientReadSize()))),
+      configs_(configs),
+      global_(global),
+      client_events_(EPOLLIN | EPOLLRDHUP |
+                     (global.getEdgeTriggered() ? EPOLLET : 0u)),
+      vhosts_(configs),
+      client_pool_(configs, &vhosts_),
+      file_cache_(global.getOpenFileCacheMax(),
+                  global.getOpenFileCacheInactive()),
+      response_cache_(global.getResponseCacheSize(),
+                      global.getResponseCacheMaxObject(),
+                      file_cache_.enabled() ? &file_cache_ : NULL),
+      compression_cache_(global.getGzipCacheSize(),
+                         global.getGzipCacheMaxObject()),
+      access_logs_(),
+      fastcgi_upstreams_(),
+      handler_modules_(),
+      fastcgi_spawner_(NULL) {
   std::set<int> bound_ports;
 
   if (configs_ == NULL || configs_->empty()) {
     throw std::runtime_error("No servers provided in config list");
   }
 
+  // Every worker opens the files itself (O_APPEND: their lines interleave
+  // whole); servers sharing a path share the sink.
+  access_logs_.assign(configs_->size(), NULL);
+  for (size_t i = 0; i < configs_->size(); ++i) {
+    const std::string& path = (*configs_)[i].getAccessLogPath();
+    if (path.empty()) continue;
+    int sink = logging::openSink(path);
+    if (sink < 0) {
+      throw std::runtime_error("access_log " + path + ": " +
+                               std::strerror(errno));
+    }
+    access_logs_[i] =
+        new AccessLog(sink, (*configs_)[i].getAccessLogFormat());
+  }
+
   for (size_t i = 0; i < configs_->size(); ++i) {
     const ServerConfig& server = (*configs_)[i];
     int port = server.getPort();
@@ -32,20 +72,25 @@ ServerManager::ServerManager(const std::vector<ServerConfig>* configs)
     }
     bound_ports.insert(port);
 
-    TcpListener* listener = new TcpListener(server.getHost(), port);
+    TcpListener* listener =
+        new TcpListener(server.getHost(), port, reusePort);
     try {
-      listener->listen();
+      const ServerConfig& options = listenOptions(port);
+      listener->listen(options.getListenBacklog(), options.getListenDeferred(),
+                       options.getListenFastOpen());
       int fd = listener->getFd();
 
-      listeners_[fd] = listener;
-      listener_ports_[fd] = port;
+      listeners_.push_back(listener);
+      FdSlot* slot = fds_.open(fd, FD_LISTENER);
+      slot->listener = listener;
+      slot->port = port;
 
       // El servidor no lee ni escribe datos solo acepta conexiones. (EPOLLIN)
       // Por defecto epoll esta en modo Level Trigger, y para listeners
       // usualmente es lo correcto/seguro.
-      epoll_.addFd(fd, EPOLLIN);
+      backend_->addListener(fd, FdTable::tag(slot));
 
-      std::cout << "Server listening on port " << port << std::endl;
+      LOG_INFO << "Server listening on port " << port;
     } catch (const std::exception& e) {
       delete listener;
       throw;
@@ -56,60 +101,153 @@ ServerManager::ServerManager(const std::vector<ServerConfig>* configs)
     throw std::runtime_error(
         "No servers could be started (check config ports)");
   }
+
+  if (file_cache_.enabled()) {
+    int fd = file_cache_.getInotifyFd();
+    backend_->addFd(fd, EPOLLIN, FdTable::tag(fds_.open(fd, FD_INOTIFY)));
+  }
+
+  // Keep-alive budget per upstream when the config does not give one: a
+  // spawned pool leaves one worker free to accept and splits the rest
+  // between the event loop processes; external servers get one-shot
+  // connections since their worker count is unknown.
+  int processes = global.getWorkerProcesses() > 0 ? global.getWorkerProcesses()
+                                                  : 1;
+  for (size_t i = 0; i < configs_->size(); ++i) {
+    const std::vector<LocationConfig>& locations =
+        (*configs_)[i].getLocations();
+    for (size_t l = 0; l < locations.size(); ++l) {
+      const LocationConfig& loc = locations[l];
+      const std::string& address = loc.getFastCgiPass();
+      if (address.empty() || fastcgi_upstreams_.count(address)) continue;
+      int keepalive = loc.getFastCgiKeepalive();
+      if (keepalive < 0) {
+        keepalive = loc.getFastCgiSpawn().empty()
+                        ? 0
+                        : (loc.getFastCgiWorkers() - 1) / processes;
+      }
+      fastcgi_upstreams_[address] =
+          new FastCgiUpstream(address, static_cast<size_t>(keepalive));
+    }
+  }
+
+  // Handler modules are loaded here, after fork(): each worker runs its
+  // own init() and a crash in one module takes down a single worker.
+  for (size_t i = 0; i < configs_->size(); ++i) {
+    const std::vector<LocationConfig>& locations =
+        (*configs_)[i].getLocations();
+    for (size_t l = 0; l < locations.size(); ++l) {
+      const std::string& path = locations[l].getHandler();
+      if (path.empty() || handler_modules_.count(path)) continue;
+      std::string error;
+      HandlerModule* module = HandlerModule::load(path, error);
+      if (module == NULL) throw std::runtime_error("handler " + error);
+      handler_modules_[path] = module;
+      LOG_INFO << "Loaded handler module " << path;
+    }
+  }
+}
+
+// The server on |port| that sets backlog=/deferred/fastopen= (the parser
+// allows only one), else the first one on the port.
+const ServerConfig& ServerManager::listenOptions(int port) const {
+  const ServerConfig* first = NULL;
+  for (size_t i = 0; i < configs_->size(); ++i) {
+    const ServerConfig& server = (*configs_)[i];
+    if (server.getPort() != port) continue;
+    if (server.hasListenOptions()) return server;
+    if (first == NULL) first = &server;
+  }
+  return *first;
 }
 
 ServerManager::~ServerManager() {
-  for (std::map<int, Client*>::iterator it = clients_.begin();
-       it != clients_.end(); ++it) {
-    delete it->second;
+  for (size_t fd = 0; fd < fds_.capacity(); ++fd) {
+    FdSlot* slot = fds_.get(fd);
+    if (slot == NULL || slot->kind != FD_CLIENT) continue;
+    delete slot->client;
+    fds_.close(fd);
+    close(fd);
   }
-  clients_.clear();
 
-  for (std::map<int, TcpListener*>::iterator it = listeners_.begin();
-       it != listeners_.end(); ++it) {
-    delete it->second;
+  for (size_t i = 0; i < listeners_.size(); ++i) {
+    delete listeners_[i];
   }
 
-  std::cout << "ServerManager shut down" << std::endl;
+  for (std::map<std::string, FastCgiUpstream*>::iterator it =
+           fastcgi_upstreams_.begin();
+       it != fastcgi_upstreams_.end(); ++it)
+    delete it->second;
+
+  // After the clients: their unfinished responses call the module's abort().
+  for (std::map<std::string, HandlerModule*>::iterator it =
+           handler_modules_.begin();
+       it != handler_modules_.end(); ++it)
+    delete it->second;
+
+  for (size_t i = 0; i < access_logs_.size(); ++i) delete access_logs_[i];
+
+  delete backend_;
+
+  LOG_INFO << "ServerManager shut down";
+  logging::flush();
 }
 
 void ServerManager::run() {
   epoll_event events[MAX_EVENTS];
 
-  std::cout << "Server started. Waiting for events..." << std::endl;
+  // SIGINT/SIGTERM end the loop instead of the process, so the destructor
+  // runs and queued log lines (access_log included) reach the disk. No
+  // SA_RESTART: the backend's wait() returns on EINTR.
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = onStopSignal;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
 
-  while (true) {
+  LOG_INFO << "Server started (" << backend_->name()
+           << "). Waiting for events...";
+
+  while (!g_stop_requested) {
     try {
-      int num_events = epoll_.wait(events, MAX_EVENTS,
-                                   3000);  // TODO: 3s timeout for maintenance
-                                           // tasks. make it configurable.
+      // Sleep until the nearest client deadline (or the file cache sweep).
+      int num_events = backend_->wait(events, MAX_EVENTS, nextWaitTimeout());
 
       for (int i = 0; i < num_events; ++i) {
-        int fd = events[i].data.fd;
+        // Closed (or closed and reused) earlier in this batch: skip.
+        FdSlot* slot = FdTable::untag(events[i].data.ptr);
+        if (slot == NULL) continue;
         uint32_t event_mask = events[i].events;
 
-        if (listeners_.count(fd)) {
-          handleNewConnection(fd);
-        } else if (clients_.count(fd)) {
-          handleClientEvent(fd, event_mask);
-        } else if (cgi_pipes_.count(fd)) {
-          handleCgiPipeEvent(fd, event_mask);
+        switch (slot->kind) {
+          case FD_LISTENER:
+            handleNewConnection(*slot);
+            break;
+          case FD_CLIENT:
+            handleClientEvent(*slot, event_mask);
+            break;
+          case FD_CGI_PIPE:
+            handleCgiPipeEvent(*slot, event_mask);
+            break;
+          case FD_INOTIFY:
+            file_cache_.handleEvents();
+            break;
+          case FD_FREE:
+            break;
         }
       }
 
-      if (num_events == 0) {
-        // Idle cycle or timeout, good time to check timeouts
-        // TODO: remove log
-        std::cout << " Server idle..." << std::endl;
-      }
+      if (num_events == 0) LOG_DEBUG << "Server idle...";
 
       // Reap any terminated child CGI processes to prevent zombies
       // Non-blocking call - returns immediately if no children have exited
 
       reapChildren();
-      checkTimeouts();
+      expireTimers();
+      file_cache_.expireInactive(time(NULL));
     } catch (const std::exception& e) {
-      std::cerr << "Error in event loop: " << e.what() << std::endl;
+      LOG_ERROR << "Error in event loop: " << e.what();
     }
   }
 }
@@ -119,62 +257,99 @@ void ServerManager::reapChildren() {
     pid_t pid = waitpid(-1, NULL, WNOHANG);
 
     if (pid > 0) {
-#ifdef DEBUG
-      std::cout << "[CDI] Reaped child PID: " << pid << std::endl;
-#endif  // DEBUG
+      if (fastcgi_spawner_ && fastcgi_spawner_->handleExit(pid)) continue;
+      LOG_DEBUG << "Reaped child PID: " << pid;
     } else if (pid == 0) {
       break;
     } else {  // pid == -1
       if (errno == ECHILD) break;
       // Real error here
-      std::cerr << "waitpid failed: " << std::strerror(errno) << std::endl;
+      LOG_ERROR << "waitpid failed: " << std::strerror(errno);
     }
   }
 }
 
-void ServerManager::checkTimeouts() {
-  time_t now = time(NULL);
-  std::vector<int> timeout_fds;
+void ServerManager::scheduleClientTimer(int client_fd) {
+  FdSlot* slot = fds_.get(client_fd);
+  if (slot == NULL || slot->kind != FD_CLIENT) return;
+
+  // Only move the timer earlier; a later deadline is picked up when the
+  // current one fires. Keeps busy keep-alive connections off the heap.
+  long deadline = slot->client->getDeadline(global_);
+  if (!timers_.contains(client_fd) || deadline < timers_.deadlineOf(client_fd))
+    timers_.schedule(client_fd, deadline);
+}
+
+void ServerManager::expireTimers() {
+  long now = time_utils::monotonicMs();
+  int client_fd;
 
-  // Iterate over all clients and identify those who timed out
-  // TODO: Make timeout configurable via ServerBlock
-  double timeout_seconds = CLIENT_TIMEOUT_SECONDS;
+  while ((client_fd = timers_.popExpired(now)) != -1) {
+    FdSlot* slot = fds_.get(client_fd);
+    if (slot == NULL || slot->kind != FD_CLIENT) continue;
 
-  for (std::map<int, Client*>::iterator it = clients_.begin();
-       it != clients_.end(); ++it) {
-    if (difftime(now, it->second->getLastActivity()) > timeout_seconds) {
-      timeout_fds.push_back(it->first);
+    Client* client = slot->client;
+    long deadline = client->getDeadline(global_);
+    if (deadline > now) {
+      timers_.schedule(client_fd, deadline);
+      continue;
     }
-  }
 
-  for (size_t i = 0; i < timeout_fds.size(); ++i) {
-    std::cout << "Client " << timeout_fds[i] << " timed out." << std::endl;
-    handleClientDisconnect(timeout_fds[i]);
+    LOG_DEBUG << "Client " << client_fd << " timed out";
+    if (client->handleTimeout()) {
+      handleClientDisconnect(client_fd);
+    } else {
+      updateClientEvents(client_fd);
+      scheduleClientTimer(client_fd);
+    }
   }
 }
 
-void ServerManager::handleNewConnection(int listener_fd) {
-  TcpListener* listener = listeners_[listener_fd];
-  int port = listener_ports_[listener_fd];
+int ServerManager::nextWaitTimeout() const {
+  long wait = -1;
+  if (!timers_.empty()) {
+    wait = timers_.nextDeadline() - time_utils::monotonicMs();
+    if (wait < 0) wait = 0;
+  }
+  if (file_cache_.enabled()) {
+    int inactive = global_.getOpenFileCacheInactive();
+    long sweep = (inactive > 0 ? inactive : 1) * 1000L;
+    if (wait < 0 || sweep < wait) wait = sweep;
+  }
+  return wait > INT_MAX ? INT_MAX : static_cast<int>(wait);
+}
 
-  while (true) {
-    int client_fd = listener->acceptConnection();
+void ServerManager::handleNewConnection(FdSlot& listener_slot) {
+  TcpListener* listener = listener_slot.listener;
+  int port = listener_slot.port;
+
+  // Listeners are level-triggered: whatever is left after the budget is
+  // reported again by the next wait(), after the clients already queued
+  // in this batch have been served. io_uring accepts by itself; the
+  // connections are then already waiting in the backend.
+  bool queued = backend_->acceptsConnections();
+  for (int accepted = 0; accepted < ACCEPT_BUDGET; ++accepted) {
+    sockaddr_in peer;
+    int client_fd = queued ? backend_->takeAccepted(listener->getFd(), peer)
+                           : listener->acceptConnection(peer);
     if (client_fd == -1) break;
 
-    // INFO: Add to Epoll - Level Triggered (no EPOLLET) for safety
-    epoll_.addFd(client_fd, EPOLLIN | EPOLLRDHUP);
-
-    Client* new_client = new Client(client_fd, configs_, port);
+    Client* new_client = client_pool_.acquire(client_fd, port, peer);
     new_client->setServerManager(this);
-    clients_[client_fd] = new_client;
-
-    std::cout << "New client connected on port " << listener->getPort()
-              << " (FD: " << client_fd << ")" << std::endl;
+    FdSlot* slot = fds_.open(client_fd, FD_CLIENT);
+    slot->client = new_client;
+
+    // Level-triggered unless 'edge_triggered on': the Client then drains
+    // the socket on every event.
+    slot->events = client_events_;
+    backend_->addClient(client_fd, slot->events, FdTable::tag(slot));
+    scheduleClientTimer(client_fd);
   }
 }
 
-void ServerManager::handleClientEvent(int client_fd, uint32_t events) {
-  Client* client = clients_[client_fd];
+void ServerManager::handleClientEvent(FdSlot& slot, uint32_t events) {
+  Client* client = slot.client;
+  int client_fd = slot.fd;
 
   if (events & (EPOLLERR | EPOLLHUP)) {
     handleClientDisconnect(client_fd);
@@ -194,8 +369,15 @@ void ServerManager::handleClientEvent(int client_fd, uint32_t events) {
     }
   }
 
-  if (events & EPOLLOUT) {
+  // Whatever handleRead() queued is sent right away: it usually fits in the
+  // socket buffer, and EPOLLOUT is only armed for what does not.
+  if ((events & EPOLLOUT) || client->needsWrite()) {
     client->handleWrite();
+    // Respuesta con "Connection: close" terminada (o error de envio).
+    if (client->getState() == STATE_CLOSED) {
+      handleClientDisconnect(client_fd);
+      return;
+    }
   }
 
   if (pendingClose && !client->hasPendingData()) {
@@ -203,63 +385,154 @@ void ServerManager::handleClientEvent(int client_fd, uint32_t events) {
     return;
   }
 
-  updateClientEvents(client_fd);
+  updateClientEvents(slot);
+  scheduleClientTimer(client_fd);
 }
 
 void ServerManager::updateClientEvents(int client_fd) {
-  if (!clients_.count(client_fd)) return;
+  FdSlot* slot = fds_.get(client_fd);
+  if (slot == NULL || slot->kind != FD_CLIENT) return;
+  updateClientEvents(*slot);
+}
 
-  Client* client = clients_[client_fd];
-  uint32_t new_events = EPOLLIN | EPOLLRDHUP;
-  if (client->needsWrite()) {
+// epoll_ctl() only when the mask actually changes: most events leave a
+// client with the read-only mask it already has.
+void ServerManager::updateClientEvents(FdSlot& slot) {
+  uint32_t new_events = client_events_;
+  if (slot.client->needsWrite()) {
     new_events |= EPOLLOUT;
   }
-  epoll_.modFd(client_fd, new_events);
+  if (new_events == slot.events) return;
+  slot.events = new_events;
+  backend_->modFd(slot.fd, new_events, FdTable::tag(&slot));
 }
 
 void ServerManager::handleClientDisconnect(int client_fd) {
-  epoll_.removeFd(client_fd);
+  backend_->removeFd(client_fd);
+  timers_.cancel(client_fd);
+
+  FdSlot* slot = fds_.get(client_fd);
+  if (slot != NULL && slot->kind == FD_CLIENT) {
+    Client* client = slot->client;
+    fds_.close(client_fd);
+    client_pool_.release(client);
+    // The socket was accept()ed here, so it is closed here too; without
+    // this the peer never sees EOF for "Connection: close" and the fd leaks.
+    close(client_fd);
+  }
+}
+
+void ServerManager::handleCgiPipeEvent(FdSlot& slot, uint32_t events) {
+  Client* client = slot.client;
+  int client_fd = client->getFd();
 
-  if (clients_.count(client_fd)) {
-    delete clients_[client_fd];
-    clients_.erase(client_fd);
+  client->handleCgiPipe(slot.fd, events);
+  // Send the new output now instead of waiting for EPOLLOUT.
+  if (client->needsWrite()) {
+    client->handleWrite();
+    if (client->getState() == STATE_CLOSED) {
+      handleClientDisconnect(client_fd);
+      return;
+    }
   }
+  updateClientEvents(client_fd);
+  scheduleClientTimer(client_fd);
+}
 
-  std::cout << "Client " << client_fd << " disconnected." << std::endl;
+ssize_t ServerManager::receive(int client_fd, void* buffer, size_t length) {
+  return backend_->receive(client_fd, buffer, length);
 }
 
-void ServerManager::handleCgiPipeEvent(int pipe_fd, uint32_t events) {
-  if (!cgi_pipes_.count(pipe_fd)) {
-    return;
-  }
+OpenFileCache* ServerManager::getOpenFileCache() {
+  return file_cache_.enabled() ? &file_cache_ : NULL;
+}
 
-  Client* client = cgi_pipes_[pipe_fd];
-  if (client) {
-    client->handleCgiPipe(pipe_fd, events);
-    updateClientEvents(client->getFd());
-  }
+ResponseCache* ServerManager::getResponseCache() {
+  return response_cache_.enabled() ? &response_cache_ : NULL;
 }
 
+AccessLog* ServerManager::getAccessLog(const ServerConfig* server) {
+  if (server == NULL || access_logs_.empty()) return NULL;
+  size_t index = static_cast<size_t>(server - &(*configs_)[0]);
+  return index < access_logs_.size() ? access_logs_[index] : NULL;
+}
+
+CompressionCache* ServerManager::getCompressionCache() {
+  return &compression_cache_;
+}
+
+const GlobalConfig& ServerManager::getGlobalConfig() const { return global_; }
+
 void ServerManager::registerCgiPipe(int pipe_fd, uint32_t events,
                                     Client* client) {
   if (pipe_fd < 0 || client == NULL) {
     return;
   }
 
-  // Add pipe to epoll for monitoring
-  epoll_.addFd(pipe_fd, events);
+  // A handler module can pass any fd: never take over one already in use.
+  if (fds_.get(pipe_fd) != NULL) {
+    throw std::runtime_error("fd already registered");
+  }
 
   // Track mapping from pipe FD to Client
-  cgi_pipes_[pipe_fd] = client;
+  FdSlot* slot = fds_.open(pipe_fd, FD_CGI_PIPE);
+  slot->client = client;
 
-  std::cout << "Registered CGI pipe " << pipe_fd << " for events " << events
-            << std::endl;
+  // Add pipe to epoll for monitoring
+  try {
+    backend_->addFd(pipe_fd, events, FdTable::tag(slot));
+  } catch (...) {
+    fds_.close(pipe_fd);  // e.g. a regular file, which epoll refuses
+    throw;
+  }
+
+  LOG_DEBUG << "Registered CGI pipe " << pipe_fd << " for events " << events;
 }
 
 void ServerManager::unregisterCgiPipe(int pipe_fd) {
-  if (cgi_pipes_.count(pipe_fd)) {
-    epoll_.removeFd(pipe_fd);
-    cgi_pipes_.erase(pipe_fd);
-    std::cout << "Unregistered CGI pipe " << pipe_fd << std::endl;
+  FdSlot* slot = fds_.get(pipe_fd);
+  if (slot != NULL && slot->kind == FD_CGI_PIPE) {
+    if (!slot->paused) backend_->removeFd(pipe_fd);
+    fds_.close(pipe_fd);
+    LOG_DEBUG << "Unregistered CGI pipe " << pipe_fd;
   }
 }
+
+// Removed from epoll rather than modified to 0 events: epoll still reports
+// EPOLLHUP for a pipe whose writer has exited, which would spin the loop.
+void ServerManager::pauseCgiPipe(int pipe_fd) {
+  FdSlot* slot = fds_.get(pipe_fd);
+  if (slot == NULL || slot->kind != FD_CGI_PIPE || slot->paused) return;
+  backend_->removeFd(pipe_fd);
+  slot->paused = true;
+}
+
+void ServerManager::resumeCgiPipe(int pipe_fd, uint32_t events) {
+  FdSlot* slot = fds_.get(pipe_fd);
+  if (slot == NULL || slot->kind != FD_CGI_PIPE || !slot->paused) return;
+  backend_->addFd(pipe_fd, events, FdTable::tag(slot));
+  slot->paused = false;
+}
+
+void ServerManager::modifyCgiPipe(int pipe_fd, uint32_t events) {
+  FdSlot* slot = fds_.get(pipe_fd);
+  if (slot == NULL || slot->kind != FD_CGI_PIPE || slot->paused) return;
+  backend_->modFd(pipe_fd, events, FdTable::tag(slot));
+}
+
+FastCgiUpstream* ServerManager::getFastCgiUpstream(
+    const std::string& address) {
+  std::map<std::string, FastCgiUpstream*>::iterator it =
+      fastcgi_upstreams_.find(address);
+  return it != fastcgi_upstreams_.end() ? it->second : NULL;
+}
+
+HandlerModule* ServerManager::getHandlerModule(const std::string& path) {
+  std::map<std::string, HandlerModule*>::iterator it =
+      handler_modules_.find(path);
+  return it != handler_modules_.end() ? it->second : NULL;
+}
+
+void ServerManager::setFastCgiSpawner(FastCgiSpawner* spawner) {
+  fastcgi_spawner_ = spawner;
+}
@@ -1,55 +1,140 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 
+#include "../client/AccessLog.hpp"
 #include "../client/Client.hpp"
+#include "../client/CompressionCache.hpp"
+#include "../client/OpenFileCache.hpp"
+#include "../client/ResponseCache.hpp"
+#include "../cgi/FastCgiSpawner.hpp"
+#include "../cgi/FastCgiUpstream.hpp"
+#include "../config/GlobalConfig.hpp"
 #include "../config/ServerConfig.hpp"
-#include "EpollWrapper.hpp"
+#include "../config/VirtualHostTable.hpp"
+#include "../module/HandlerModule.hpp"
+#include "ClientPool.hpp"
+#include "EventBackend.hpp"
+#include "FdTable.hpp"
 #include "TcpListener.hpp"
+#include "TimerHeap.hpp"
 
 class ServerManager {
  public:
-  ServerManager(const std::vector<ServerConfig>* configs);
+  // reusePort: bind listeners with SO_REUSEPORT so several workers (one
+  // ServerManager per process) can listen on the same ports.
+  ServerManager(const std::vector<ServerConfig>* configs,
+                const GlobalConfig& global, bool reusePort = false);
   ~ServerManager();
 
+  // Event loop; returns after SIGINT or SIGTERM.
   void run();
 
-  // CGI pipe registration (called by Client when starting CGI)
+  // CGI pipe registration (called by Client when starting CGI). Handler
+  // modules' fds go through the same calls: their events reach the Client.
   void updateClientEvents(int client_fd);
 
+  // Throws if pipe_fd is already registered or cannot be polled.
   void registerCgiPipe(int pipe_fd, uint32_t events, Client* client);
   void unregisterCgiPipe(int pipe_fd);
+  // Backpressure: stop polling a CGI pipe while the client's output is
+  // full, and start again once it drains.
+  void pauseCgiPipe(int pipe_fd);
+  void resumeCgiPipe(int pipe_fd, uint32_t events);
+  // New interest mask for a registered pipe or FastCGI socket.
+  void modifyCgiPipe(int pipe_fd, uint32_t events);
+
+  // recv() on a client socket, through the backend (io_uring may already
+  // have read the bytes).
+  ssize_t receive(int client_fd, void* buffer, size_t length);
+
+  // Connection pool for a fastcgi_pass address; NULL if unknown.
+  FastCgiUpstream* getFastCgiUpstream(const std::string& address);
+  // Module loaded for a 'handler' path; NULL if unknown.
+  HandlerModule* getHandlerModule(const std::string& path);
+  // Managed FastCGI workers are children of this process: reapChildren()
+  // hands their exits to the spawner so they are restarted.
+  void setFastCgiSpawner(FastCgiSpawner* spawner);
+
+  // Shared by every Client of this worker; NULL when open_file_cache is off.
+  OpenFileCache* getOpenFileCache();
+  // Shared by every Client of this worker; NULL when response_cache is off.
+  ResponseCache* getResponseCache();
+  // Shared by every Client of this worker; always set (gzip_cache off
+  // only stops it from keeping what it compresses).
+  CompressionCache* getCompressionCache();
+  // access_log of |server|; NULL when it has none.
+  AccessLog* getAccessLog(const ServerConfig* server);
+
+  // Timeouts and other main-context directives.
+  const GlobalConfig& getGlobalConfig() const;
 
  private:
   // Maximum number of events to process at once
   static const int MAX_EVENTS = 64;
+  // accept4() calls per listener event, so a connection storm cannot keep
+  // the loop from serving the clients it already has.
+  static const int ACCEPT_BUDGET = 32;
 
   // Disable copying
   ServerManager(const ServerManager&);
   ServerManager& operator=(const ServerManager&);
 
-  // Event handlers
-  void handleNewConnection(int listener_fd);
-  void handleClientEvent(int client_fd, uint32_t events);
+  // Event handlers: the slot comes straight from epoll_event.data.ptr
+  void handleNewConnection(FdSlot& listener_slot);
+  void handleClientEvent(FdSlot& slot, uint32_t events);
   void handleClientDisconnect(int client_fd);
-  void handleCgiPipeEvent(int pipe_fd,
-                          uint32_t events);  // NEW: Handle CGI output
-  void checkTimeouts();
+  void handleCgiPipeEvent(FdSlot& slot, uint32_t events);
+  void updateClientEvents(FdSlot& slot);
+
+  const ServerConfig& listenOptions(int port) const;
 
-  EpollWrapper epoll_;
+  // Timeouts: one timer per client fd, ordered by deadline.
+  void scheduleClientTimer(int client_fd);
+  void expireTimers();
+  int nextWaitTimeout() const;  // epoll_wait timeout in ms, -1 = none
 
-  std::map<int, TcpListener*> listeners_;
+  // epoll or io_uring (event_backend); owned.
+  EventBackend* backend_;
+
+  // Owned listeners; lookups go through fds_.
+  std::vector<TcpListener*> listeners_;
 
   const std::vector<ServerConfig>* configs_;
+  GlobalConfig global_;
+  // Read interest of every client socket (EPOLLET when edge_triggered).
+  uint32_t client_events_;
+
+  // (port, Host) -> server { }, built once; every client resolves through it.
+  VirtualHostTable vhosts_;
+
+  // Every fd in backend_ (listeners, clients, CGI pipes, inotify), indexed by
+  // fd. Client slots own their Client; pipe slots point at the owner.
+  FdTable fds_;
+
+  // Client objects are recycled instead of new/delete per connection.
+  ClientPool client_pool_;
 
-  // Map Listener FD -> Port
-  std::map<int, int> listener_ports_;
+  // Client deadlines (header/body/keep-alive/send/CGI). A timer may fire
+  // early: the client's real deadline is recomputed before acting, so
+  // activity that only pushes a deadline later never touches the heap.
+  TimerHeap timers_;
 
-  // Active clients
-  std::map<int, Client*> clients_;
+  // open_file_cache: its inotify fd is registered in backend_.
+  OpenFileCache file_cache_;
+  // response_cache: validated through file_cache_ when it is enabled.
+  ResponseCache response_cache_;
+  // gzip_cache: files compressed by 'gzip on' locations.
+  CompressionCache compression_cache_;
+  // Owned; indexed like configs_, NULL for servers without access_log.
+  std::vector<AccessLog*> access_logs_;
 
-  // Map CGI pipe FD -> Client (for CGI output handling)
-  std::map<int, Client*> cgi_pipes_;
+  // One pool of keep-alive connections per fastcgi_pass address.
+  std::map<std::string, FastCgiUpstream*> fastcgi_upstreams_;
+  // Every 'handler' module, loaded once per process by path.
+  std::map<std::string, HandlerModule*> handler_modules_;
+  FastCgiSpawner* fastcgi_spawner_;  // not owned; NULL in worker processes
   void reapChildren();
 };
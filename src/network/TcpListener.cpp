@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <strings.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -12,14 +13,13 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
-#include <iostream>
-#include <sstream>
 #include <stdexcept>
 
+#include "common/Log.hpp"
 #include "common/StringUtils.hpp"
 
-TcpListener::TcpListener(const std::string& host, int port)
-    : socket_fd_(-1), port_(port), host_(host) {
+TcpListener::TcpListener(const std::string& host, int port, bool reusePort)
+    : socket_fd_(-1), port_(port), host_(host), reuse_port_(reusePort) {
   createSocket();
   setSocketOptions();
   bindSocket();
@@ -59,7 +59,7 @@ void TcpListener::createSocket() {
   if (socket_fd_ == -1) {
     throw std::runtime_error("Failed to create socket");
   }
-  std::cout << "Socket created (fd: " << socket_fd_ << ")" << std::endl;
+  LOG_DEBUG << "Socket created (fd: " << socket_fd_ << ")";
 }
 
 /// Configures socket options for optimal server operation.
@@ -81,7 +81,13 @@ void TcpListener::createSocket() {
 ///
 ///    Level: SOL_SOCKET (generic, not TCP-specific)
 ///
-/// 2. O_NONBLOCK (file status flag):
+/// 2. SO_REUSEPORT (only in multi-worker mode, see WorkerSupervisor):
+///    Every worker process binds its OWN listening socket to the same
+///    host:port. The kernel keeps one accept queue per socket and hashes
+///    incoming connections across them, so accepts are spread over the
+///    workers without a shared lock or thundering herd on a single fd.
+///
+/// 3. O_NONBLOCK (file status flag):
 ///    Enables non-blocking I/O on the socket.
 ///
 ///    Behavior change:
@@ -111,6 +117,11 @@ void TcpListener::setSocketOptions() {
     close(socket_fd_);
     throw std::runtime_error("Failed to set socket options");
   }
+  if (reuse_port_ &&
+      setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+    close(socket_fd_);
+    throw std::runtime_error("Failed to set SO_REUSEPORT");
+  }
 
   // INFO: El subject prohibe usar otros flags que no sean F_SETFL
   // O_NONBLOCK, FD_CLOEXEC, sin embargo la buena practica para c++ es recuperar
@@ -217,8 +228,8 @@ void TcpListener::bindSocket() {
 
   freeaddrinfo(result);
 
-  std::cout << "Socket bound to " << (host_.empty() ? "0.0.0.0" : host_) << ":"
-            << port_ << std::endl;
+  LOG_DEBUG << "Socket bound to " << (host_.empty() ? "0.0.0.0" : host_) << ":"
+            << port_;
 }
 
 /// Activates listening mode on the socket, enabling it to accept connections.
@@ -227,11 +238,11 @@ void TcpListener::bindSocket() {
 /// than active (initiating connections). Transitions the socket state from
 /// UNCONNECTED to LISTEN.
 ///
-/// Backlog parameter: SOMAXCONN
+/// Backlog parameter (listen ... backlog=N, SOMAXCONN by default)
 ///
 /// Definition:
 /// Maximum size of the accept queue (completed connections).
-/// - Typical Linux value: 128 (see /proc/sys/net/core/somaxconn)
+/// - The kernel caps it at /proc/sys/net/core/somaxconn (4096 since 5.4)
 /// - Can be increased system-wide via sysctl
 ///
 /// Purpose:
@@ -249,54 +260,57 @@ void TcpListener::bindSocket() {
 ///    - Connections in ESTABLISHED state
 ///    - Size: min(backlog, somaxconn)
 ///    - Handshake complete; waiting for accept()
-///    - Controlled by SOMAXCONN
 ///
 /// Queue overflow behavior:
 /// - Accept queue full and a new connection completes the handshake:
 ///   → Connection is dropped silently (no RST sent)
 ///   → Client retransmits SYN (interpreting loss)
-///   → Provides basic protection against SYN flood attacks
 ///
-/// Why SOMAXCONN instead of a fixed value:
+/// A connection storm fills a small queue between two loop iterations;
+/// backlog= lets a busy port keep more of them waiting.
 ///
-/// - Small value (e.g., 10):
-///   - Issue: burst of 50 connections → 40 dropped
-///   - Suitable only for low-traffic internal services
+/// Options set before listen():
 ///
-/// - Large value (e.g., 100000):
-///   - Issue: unnecessary memory consumption; facilitates DoS
-///   - Suitable use case: none (kernel limits exist for safety)
+/// 1. TCP_DEFER_ACCEPT (listen ... deferred):
+///    The listener only becomes readable once the client has sent data,
+///    not when the handshake completes. The first recv() after accept()
+///    finds the request already there instead of EAGAIN, and idle
+///    connections (port scans, pre-connects) never wake the event loop.
+///    Value: seconds the kernel waits for that data (1 as in nginx).
 ///
-/// - SOMAXCONN (128):
-///   - Balanced default for typical workloads
-///   - Tunable by system administrators via sysctl
-///   - Kernel-enforced upper bound limits abuse
+/// 2. TCP_FASTOPEN (listen ... fastopen=N):
+///    Clients holding a TFO cookie send the request in the SYN and save a
+///    round trip. N bounds the pending TFO requests not yet accepted.
+///    Also needs net.ipv4.tcp_fastopen & 2 on the host.
 ///
-/// After listen(), the socket can:
-/// - Receive SYN packets from clients
-/// - Complete TCP three-way handshakes automatically
-/// - Queue established connections for accept()
+/// Failures of either option are reported but not fatal: the socket still
+/// works, only without the optimisation.
 ///
 /// State transition:
 /// - Before: bind()  → socket bound to 0.0.0.0:8080
 /// - After:  listen() → socket in TCP_LISTEN state
 ///
-/// Kernel actions:
-/// 1. Transitions sk->sk_state to TCP_LISTEN
-/// 2. Allocates the SYN and accept queues
-/// 3. Registers the socket in the listening hash table
-/// 4. Begins processing SYN packets for this port
-///
 /// Error conditions:
 /// - EADDRINUSE: another socket is already listening on this port
 /// - EOPNOTSUPP: socket type does not support listen() (e.g., SOCK_DGRAM)
 ///
 /// @throws std::runtime_error if listen() fails
-void TcpListener::listen() {
-  if (::listen(socket_fd_, SOMAXCONN) < 0) {
+void TcpListener::listen(int backlog, bool deferred, int fastopen) {
+  if (deferred) {
+    int seconds = 1;
+    if (setsockopt(socket_fd_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds,
+                   sizeof(seconds)) < 0)
+      LOG_WARN << "TCP_DEFER_ACCEPT failed on port " << port_;
+  }
+  if (fastopen > 0 &&
+      setsockopt(socket_fd_, IPPROTO_TCP, TCP_FASTOPEN, &fastopen,
+                 sizeof(fastopen)) < 0)
+    LOG_WARN << "TCP_FASTOPEN failed on port " << port_;
+
+  if (::listen(socket_fd_, backlog > 0 ? backlog : SOMAXCONN) < 0) {
     throw std::runtime_error("Failed to listen on socket");
   }
-  std::cout << "Listening for connections..." << std::endl;
+  LOG_DEBUG << "Listening for connections...";
 }
 
 /// Accepts a pending client connection from the accept queue.
@@ -308,130 +322,55 @@ void TcpListener::listen() {
 ///
 /// Accept mechanics:
 ///
-/// 1. Kernel state before accept():
+/// 1. Kernel state before accept4():
 ///    - Listening socket: fd 3, state TCP_LISTEN, queue: [conn1, conn2, ...]
 ///    - Each queued connection has completed the TCP three-way handshake
-///    - Client connections waiting to be extracted by the application
 ///
-/// 2. accept() operation:
+/// 2. accept4() operation:
 ///    - Dequeues the oldest connection from the accept queue (FIFO)
 ///    - Allocates a NEW socket (distinct file descriptor)
-///    - Copies peer address into client_addr (IP + ephemeral port)
+///    - Copies peer address into peer (IP + ephemeral port)
 ///    - Returns new socket fd in ESTABLISHED state
 ///
-/// 3. After accept():
-///    - Listening socket: fd 3, remains in TCP_LISTEN (unchanged)
-///    - New socket: fd N, state TCP_ESTABLISHED, connected to specific client
-///    - Two independent sockets: one listens, one communicates
-///
 /// Non-blocking behavior:
 ///
 /// - Accept queue empty:
-///   → accept() returns -1 immediately
-///   → errno set to EAGAIN or EWOULDBLOCK
-///   → Caller must retry after epoll_wait() indicates readiness
-///
-/// - Accept queue has connections:
-///   → accept() returns instantly with client_fd
-///   → No blocking, even if new connections arrive concurrently
-///
-/// Why O_NONBLOCK on the new socket is CRITICAL:
-///
-/// - accept() does NOT inherit flags from the listening socket
-/// - New client_fd starts in blocking mode (kernel default)
-/// - Without fcntl(O_NONBLOCK): read/write on client_fd would block
-/// - Consequence: one slow client stalls the entire server
-///
-/// Implementation: fcntl() read–modify–write pattern
-/// - F_GETFL: read current flags (preserves O_LARGEFILE, etc.)
-/// - OR with O_NONBLOCK: atomically add flag
-/// - F_SETFL: write modified flags back
-///
-/// Alternative (Linux ≥ 2.6.28):
-/// - accept4(fd, addr, len, SOCK_NONBLOCK | SOCK_CLOEXEC)
-/// - Reason not used: portability; POSIX compliance
+///   → returns -1 immediately, errno EAGAIN or EWOULDBLOCK
+///   → Caller must retry after the event backend reports readiness
 ///
-/// sockaddr_in extraction:
+/// Why accept4(SOCK_NONBLOCK | SOCK_CLOEXEC):
 ///
-/// 1. sin_addr.s_addr:
-///    Client IP address in network byte order (big-endian).
-///    - Example: 192.168.1.100 → 0xC0A80164 in memory
-///    - inet_ntop() converts to human-readable "192.168.1.100"
+/// - accept() does NOT inherit O_NONBLOCK from the listening socket; the
+///   new fd would need fcntl(F_GETFL) + fcntl(F_SETFL) afterwards
+/// - accept4() sets both flags atomically: one syscall per connection
+///   instead of three, which matters under connection storms
+/// - SOCK_CLOEXEC: CGI children (fork + execve) no longer inherit every
+///   client socket open at the time of the fork
 ///
-/// 2. sin_port:
-///    Client ephemeral port in network byte order.
-///    - Range: 32768–60999 (Linux default
-///    /proc/sys/net/ipv4/ip_local_port_range)
-///    - ntohs() converts to host order for logging
+/// Peer address:
 ///
-/// 3. addr_len (value-result parameter):
-///    - Input: size of client_addr buffer
-///    - Output: actual size written (unchanged for IPv4)
-///    - Needed for IPv6 (larger sockaddr_in6) or protocol flexibility
+/// - Returned in binary form (sockaddr_in, network byte order) and kept on
+///   the Client; it is only turned into text where it is printed
+/// - Nothing is formatted or logged here: a line per accept to std::cout
+///   (with a flush) cost more than the accept itself
 ///
-/// Security considerations:
-///
-/// - bzero() before use: ensures uninitialized memory doesn't leak
-/// - inet_ntop() with INET_ADDRSTRLEN: buffer overflow protection
-/// - Failed fcntl() doesn't abort: graceful degradation
-///
-/// Why client IP/port logging is useful:
-/// - Debugging: correlate requests with specific clients
-/// - Security: identify attack sources (rate limiting, ban lists)
-/// - Analytics: geographic distribution, connection patterns
-///
-/// Error conditions and handling:
-///
-/// - accept() returns -1:
-///   → EAGAIN/EWOULDBLOCK: no connections available (non-blocking)
-///   → EMFILE/ENFILE: process/system file descriptor limit reached
-///   → ENOMEM: kernel out of memory
-///   → EINTR: interrupted by signal (handled by retry)
-///   → Function returns -1; caller must check and handle
+/// Error conditions:
 ///
-/// - fcntl() failure:
-///   → Client socket remains blocking (degraded, but functional)
-///   → Server can still communicate; performance impact only
-///   → Silent failure (no exception); logged implicitly
+/// - EAGAIN/EWOULDBLOCK: no connections available
+/// - EMFILE/ENFILE: process/system file descriptor limit reached
+/// - ECONNABORTED: the client reset the connection while queued
+/// - Function returns -1; caller checks errno
 ///
 /// Resource management:
 ///
 /// - Caller MUST close(client_fd) when done
-/// - Failure to close causes file descriptor leak
-/// - Leak consequence: eventually hits EMFILE → server stops accepting
-///
-/// State after successful accept():
-/// - Listening socket: UNCHANGED, can accept more connections
-/// - New socket: fd = client_fd, state = ESTABLISHED, peer = client_addr
-/// - TCP connection: fully established, ready for send/recv
 ///
 /// @return New socket file descriptor (≥ 0) on success
 ///         -1 on failure (check errno: EAGAIN, EMFILE, ENOMEM, etc.)
-int TcpListener::acceptConnection() {
-  struct sockaddr_in client_addr;
-  socklen_t addr_len = sizeof(client_addr);
-
-  std::memset(&client_addr, 0, size_t(addr_len));
-  int client_fd = accept(socket_fd_, (struct sockaddr*)&client_addr, &addr_len);
-
-  if (client_fd < 0) return -1;
-
-  int flags = fcntl(client_fd, F_GETFL, 0);
-  if (flags != -1) {
-    fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
-  }
-
-  // Manual IP formatting to replace inet_ntop (forbidden)
-  unsigned char* ip_bytes = (unsigned char*)&client_addr.sin_addr;
-  std::ostringstream oss;
-  oss << (int)ip_bytes[0] << "." << (int)ip_bytes[1] << "." << (int)ip_bytes[2]
-      << "." << (int)ip_bytes[3];
-  std::string client_ip = oss.str();
-  std::cout << "New connection from " << client_ip << ":"
-            << ntohs(client_addr.sin_port) << " (fd: " << client_fd << ")"
-            << std::endl;
-
-  return client_fd;
+int TcpListener::acceptConnection(sockaddr_in& peer) {
+  socklen_t addr_len = sizeof(peer);
+  return accept4(socket_fd_, reinterpret_cast<sockaddr*>(&peer), &addr_len,
+                 SOCK_NONBLOCK | SOCK_CLOEXEC);
 }
 
 int TcpListener::getFd() const { return socket_fd_; }
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <netinet/in.h>
+
 #include <string>
 
 class TcpListener {
  public:
-  TcpListener(const std::string& host, int port);
+  TcpListener(const std::string& host, int port, bool reusePort = false);
   ~TcpListener();
 
-  void listen();
+  // backlog <= 0: SOMAXCONN. deferred: TCP_DEFER_ACCEPT. fastopen: queue
+  // length for TCP_FASTOPEN, 0 = off.
+  void listen(int backlog = 0, bool deferred = false, int fastopen = 0);
 
-  int acceptConnection();
+  // Non-blocking, close-on-exec client fd and its address; -1 when the
+  // queue is empty (or on error, see errno).
+  int acceptConnection(sockaddr_in& peer);
 
   int getFd() const;
 
@@ -19,6 +25,7 @@ class TcpListener {
   int socket_fd_;
   int port_;
   std::string host_;
+  bool reuse_port_;
 
   void createSocket();
   void setSocketOptions();
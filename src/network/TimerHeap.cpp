@@ -0,0 +1,93 @@
+#include "TimerHeap.hpp"
+
+TimerHeap::TimerHeap() : heap_(), slot_() {}
+
+TimerHeap::~TimerHeap() {}
+
+void TimerHeap::schedule(int id, long deadline) {
+  if (id < 0) return;
+  if (static_cast<size_t>(id) >= slot_.size()) slot_.resize(id + 1, -1);
+
+  Node node;
+  node.deadline = deadline;
+  node.id = id;
+
+  int index = slot_[id];
+  if (index < 0) {
+    heap_.push_back(node);
+    slot_[id] = static_cast<int>(heap_.size() - 1);
+    siftUp(heap_.size() - 1);
+    return;
+  }
+  long previous = heap_[index].deadline;
+  heap_[index].deadline = deadline;
+  if (deadline < previous)
+    siftUp(index);
+  else
+    siftDown(index);
+}
+
+void TimerHeap::cancel(int id) {
+  if (!contains(id)) return;
+  removeAt(slot_[id]);
+}
+
+bool TimerHeap::contains(int id) const {
+  return id >= 0 && static_cast<size_t>(id) < slot_.size() && slot_[id] >= 0;
+}
+
+long TimerHeap::deadlineOf(int id) const { return heap_[slot_[id]].deadline; }
+
+bool TimerHeap::empty() const { return heap_.empty(); }
+
+size_t TimerHeap::size() const { return heap_.size(); }
+
+long TimerHeap::nextDeadline() const { return heap_[0].deadline; }
+
+int TimerHeap::popExpired(long now) {
+  if (heap_.empty() || heap_[0].deadline > now) return -1;
+  int id = heap_[0].id;
+  removeAt(0);
+  return id;
+}
+
+void TimerHeap::siftUp(size_t index) {
+  Node node = heap_[index];
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (heap_[parent].deadline <= node.deadline) break;
+    place(index, heap_[parent]);
+    index = parent;
+  }
+  place(index, node);
+}
+
+void TimerHeap::siftDown(size_t index) {
+  Node node = heap_[index];
+  size_t count = heap_.size();
+  while (true) {
+    size_t child = index * 2 + 1;
+    if (child >= count) break;
+    if (child + 1 < count && heap_[child + 1].deadline < heap_[child].deadline)
+      ++child;
+    if (node.deadline <= heap_[child].deadline) break;
+    place(index, heap_[child]);
+    index = child;
+  }
+  place(index, node);
+}
+
+void TimerHeap::place(size_t index, const Node& node) {
+  heap_[index] = node;
+  slot_[node.id] = static_cast<int>(index);
+}
+
+void TimerHeap::removeAt(size_t index) {
+  slot_[heap_[index].id] = -1;
+  Node last = heap_.back();
+  heap_.pop_back();
+  if (index == heap_.size()) return;
+  place(index, last);
+  siftUp(index);
+  siftDown(slot_[last.id]);
+}
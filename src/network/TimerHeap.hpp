@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Indexed binary min-heap of deadlines (milliseconds), one per id.
+//
+// Ids are file descriptors, so a plain vector maps id -> heap slot and
+// schedule()/cancel() on an existing timer are O(log n) without searching.
+// nextDeadline() is O(1): ServerManager turns it into the epoll_wait
+// timeout instead of scanning every connection.
+class TimerHeap {
+ public:
+  TimerHeap();
+  ~TimerHeap();
+
+  // Insert, or move an existing timer for id to deadline.
+  void schedule(int id, long deadline);
+  void cancel(int id);
+
+  bool contains(int id) const;
+  long deadlineOf(int id) const;  // only valid if contains(id)
+
+  bool empty() const;
+  size_t size() const;
+  long nextDeadline() const;  // only valid if !empty()
+
+  // Removes and returns the id of one timer with deadline <= now,
+  // or -1 when nothing has expired.
+  int popExpired(long now);
+
+ private:
+  struct Node {
+    long deadline;
+    int id;
+  };
+
+  TimerHeap(const TimerHeap&);
+  TimerHeap& operator=(const TimerHeap&);
+
+  void siftUp(size_t index);
+  void siftDown(size_t index);
+  void place(size_t index, const Node& node);
+  void removeAt(size_t index);
+
+  std::vector<Node> heap_;
+  std::vector<int> slot_;  // id -> index in heap_, -1 when not scheduled
+};
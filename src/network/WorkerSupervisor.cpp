@@ -0,0 +1,145 @@
+#include "WorkerSupervisor.hpp"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "ServerManager.hpp"
+#include "common/Log.hpp"
+
+static volatile sig_atomic_t g_stop_requested = 0;
+
+static void onStopSignal(int) { g_stop_requested = 1; }
+
+// No SA_RESTART: waitpid() must return EINTR so run() sees the stop flag.
+static void installSignal(int sig, void (*handler)(int)) {
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handler;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sigaction(sig, &sa, NULL);
+}
+
+WorkerSupervisor::WorkerSupervisor(const std::vector<ServerConfig>* configs,
+                                   const GlobalConfig& global)
+    : configs_(configs),
+      global_(global),
+      workers_(global.getWorkerProcesses() > 0 ? global.getWorkerProcesses()
+                                               : 1,
+               -1),
+      started_at_(workers_.size(), 0),
+      fastcgi_spawner_(NULL) {}
+
+WorkerSupervisor::~WorkerSupervisor() { stopWorkers(); }
+
+int WorkerSupervisor::run() {
+  installSignal(SIGINT, onStopSignal);
+  installSignal(SIGTERM, onStopSignal);
+
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (spawnWorker(i) == -1) {
+      stopWorkers();
+      return 1;
+    }
+  }
+  LOG_INFO << "Supervisor started " << workers_.size() << " workers";
+
+  while (!g_stop_requested) {
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid == -1) {
+      if (errno == EINTR) continue;
+      if (errno == ECHILD) break;
+      LOG_ERROR << "waitpid failed: " << std::strerror(errno);
+      break;
+    }
+
+    int slot = findSlot(pid);
+    if (slot == -1) {
+      if (fastcgi_spawner_) fastcgi_spawner_->handleExit(pid);
+      continue;
+    }
+    workers_[slot] = -1;
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+      LOG_ERROR << "Worker " << slot << " (pid " << pid
+                << ") exited with status " << WEXITSTATUS(status)
+                << ", shutting down";
+      stopWorkers();
+      return 1;
+    }
+
+    if (WIFSIGNALED(status)) {
+      LOG_WARN << "Worker " << slot << " (pid " << pid
+               << ") killed by signal " << WTERMSIG(status) << ", restarting";
+    }
+    if (std::time(NULL) - started_at_[slot] < MIN_WORKER_LIFETIME_SECONDS)
+      sleep(MIN_WORKER_LIFETIME_SECONDS);
+    if (!g_stop_requested && spawnWorker(slot) == -1) {
+      stopWorkers();
+      return 1;
+    }
+  }
+
+  stopWorkers();
+  return 0;
+}
+
+void WorkerSupervisor::setFastCgiSpawner(FastCgiSpawner* spawner) {
+  fastcgi_spawner_ = spawner;
+}
+
+pid_t WorkerSupervisor::spawnWorker(size_t slot) {
+  // Unflushed output would otherwise be written once per process.
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t pid = fork();
+  if (pid == -1) {
+    LOG_ERROR << "Failed to fork worker: " << std::strerror(errno);
+    return -1;
+  }
+
+  if (pid == 0) {
+    // WORKER PROCESS: own event loop. Default signal behaviour until
+    // ServerManager::run() installs its stop handlers.
+    installSignal(SIGINT, SIG_DFL);
+    installSignal(SIGTERM, SIG_DFL);
+    try {
+      ServerManager server(configs_, global_, true);
+      server.run();
+    } catch (const std::exception& e) {
+      LOG_ERROR << "Worker " << slot << " failed: " << e.what();
+      std::exit(1);
+    }
+    std::exit(0);
+  }
+
+  workers_[slot] = pid;
+  started_at_[slot] = std::time(NULL);
+  return pid;
+}
+
+void WorkerSupervisor::stopWorkers() {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i] > 0) kill(workers_[i], SIGTERM);
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i] > 0) {
+      waitpid(workers_[i], NULL, 0);
+      workers_[i] = -1;
+    }
+  }
+}
+
+int WorkerSupervisor::findSlot(pid_t pid) const {
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (workers_[i] == pid) return static_cast<int>(i);
+  }
+  return -1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <vector>
+
+#include "../cgi/FastCgiSpawner.hpp"
+#include "../config/GlobalConfig.hpp"
+#include "../config/ServerConfig.hpp"
+
+// Multi-core mode (worker_processes N > 1).
+//
+// The supervisor (master process) never accepts connections itself. It forks
+// N workers; each worker builds its own ServerManager, which means its own
+// event backend (epoll fd or io_uring ring), its own TcpListener sockets
+// (bound with SO_REUSEPORT) and its own client map. Nothing is shared
+// between workers, so no locking is needed.
+//
+// If a worker dies from a signal (crash) the supervisor forks a replacement
+// in the same slot. If a worker exits with an error status (bind failure,
+// invalid config...) the whole server is shut down, because restarting it
+// would fail in exactly the same way.
+class WorkerSupervisor {
+ public:
+  // Starts global.getWorkerProcesses() workers.
+  WorkerSupervisor(const std::vector<ServerConfig>* configs,
+                   const GlobalConfig& global);
+  ~WorkerSupervisor();
+
+  // Blocks until SIGINT/SIGTERM or a fatal worker exit.
+  // Returns the process exit status for main().
+  int run();
+
+  // Managed FastCGI workers are children of the supervisor too; their exits
+  // are handed to the spawner so they are restarted.
+  void setFastCgiSpawner(FastCgiSpawner* spawner);
+
+ private:
+  // A worker that crashes faster than this is respawned with a delay, so a
+  // crash loop does not burn a whole CPU forking.
+  static const int MIN_WORKER_LIFETIME_SECONDS = 1;
+
+  // Disable copying
+  WorkerSupervisor(const WorkerSupervisor&);
+  WorkerSupervisor& operator=(const WorkerSupervisor&);
+
+  pid_t spawnWorker(size_t slot);
+  void stopWorkers();
+  int findSlot(pid_t pid) const;
+
+  const std::vector<ServerConfig>* configs_;
+  const GlobalConfig& global_;
+  std::vector<pid_t> workers_;
+  std::vector<time_t> started_at_;
+  FastCgiSpawner* fastcgi_spawner_;  // not owned
+};
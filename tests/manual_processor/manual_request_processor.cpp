@@ -15,7 +15,7 @@ int main()
     request.setPath("/index.html");
     request.addHeaders("host", "localhost");
 
-    processor.process(request, 0, 8080, false, response);
+    processor.process(request, 0, false, response);
 
     std::vector<char> raw = response.serialize();
     std::cout.write(&raw[0], raw.size());
@@ -0,0 +1,165 @@
+/*
+ * Benchmark del parser HTTP (sin framework, como los tests manuales).
+ *
+ * Mide peticiones/s y MB/s en tres escenarios:
+ *   1) una peticion tipica (~20 cabeceras) en una sola lectura
+ *   2) 64 peticiones pipelined llegando en trozos de 4 KB
+ *   3) una peticion con 100 cabeceras llegando de 16 en 16 bytes
+ *      (el caso que era cuadratico: cada trozo re-escaneaba el buffer)
+ *   4) una peticion de navegador con ~1.5 KB de cookies
+ *
+ * HTTP_SCAN=scalar|sse2 fuerza la implementacion del escaneo (HttpScan).
+ *
+ * Los datos entran como en Client::handleRead(): copiados en
+ * prepareRead() (el recv()) y luego commitRead() + parse().
+ *
+ * make bench_http_parser
+ */
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "../../src/http/HttpParser.hpp"
+#include "../../src/http/HttpScan.hpp"
+
+static double nowSeconds() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static std::string typicalRequest() {
+  return "GET /api/v1/items?id=42&sort=desc HTTP/1.1\r\n"
+         "Host: www.example.com\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:120.0) "
+         "Gecko/20100101 Firefox/120.0\r\n"
+         "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+         "*/*;q=0.8\r\n"
+         "Accept-Language: en-US,en;q=0.5\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Referer: https://www.example.com/index.html\r\n"
+         "Connection: keep-alive\r\n"
+         "Cookie: session=8f2a1c9e4b7d6a5f3e2d1c0b; theme=dark; lang=es\r\n"
+         "Upgrade-Insecure-Requests: 1\r\n"
+         "Sec-Fetch-Dest: document\r\n"
+         "Sec-Fetch-Mode: navigate\r\n"
+         "Sec-Fetch-Site: same-origin\r\n"
+         "Sec-Fetch-User: ?1\r\n"
+         "Cache-Control: max-age=0\r\n"
+         "If-None-Match: \"5e8f-1a2b3c4d\"\r\n"
+         "If-Modified-Since: Tue, 14 Oct 2025 10:00:00 GMT\r\n"
+         "DNT: 1\r\n"
+         "Pragma: no-cache\r\n"
+         "X-Requested-With: XMLHttpRequest\r\n"
+         "X-Forwarded-For: 203.0.113.7\r\n"
+         "\r\n";
+}
+
+static std::string browserRequest() {
+  std::string cookie = "session=8f2a1c9e4b7d6a5f3e2d1c0b; theme=dark; lang=es";
+  for (int i = 0; cookie.size() < 1500; ++i) {
+    std::ostringstream part;
+    part << "; _ga_" << i << "=GS1.1.1697040000.12.1.1697041234.0.0."
+         << 1000000 + i;
+    cookie += part.str();
+  }
+  std::string req = typicalRequest();
+  req.insert(req.size() - 2, "Cookie: " + cookie + "\r\n");
+  return req;
+}
+
+static std::string manyHeadersRequest(int headers) {
+  std::ostringstream req;
+  req << "GET /many HTTP/1.1\r\nHost: example.com\r\n";
+  for (int i = 0; i < headers; ++i)
+    req << "X-Custom-Header-" << i << ": some-value-for-header-" << i
+        << "\r\n";
+  req << "\r\n";
+  return req.str();
+}
+
+static void report(const char* name, int requests, std::size_t bytes,
+                   double seconds, int failures) {
+  std::printf("%-28s %9.0f req/s %8.1f MB/s%s\n", name, requests / seconds,
+              bytes / seconds / (1024.0 * 1024.0),
+              failures ? "  (PARSE ERRORS)" : "");
+}
+
+// Entrega data en trozos de slice bytes; cuenta las peticiones completas.
+static int feed(HttpParser& parser, const std::string& data,
+                std::size_t slice, int& failures) {
+  int done = 0;
+  for (std::size_t off = 0; off < data.size(); off += slice) {
+    std::size_t len = std::min(slice, data.size() - off);
+    std::size_t space = 0;
+    std::memcpy(parser.prepareRead(len, space), data.data() + off, len);
+    parser.commitRead(len);
+    parser.parse();
+    while (parser.getState() == COMPLETE) {
+      ++done;
+      parser.reset();
+      parser.parse();
+    }
+    if (parser.getState() == ERROR) {
+      ++failures;
+      parser.clear();
+    }
+  }
+  return done;
+}
+
+int main(int argc, char** argv) {
+  int scale = argc > 1 ? std::atoi(argv[1]) : 1;
+  if (scale < 1) scale = 1;
+
+  const std::string single = typicalRequest();
+  std::string pipelined;
+  for (int i = 0; i < 64; ++i) pipelined += single;
+  const std::string many = manyHeadersRequest(100);
+
+  const std::string browser = browserRequest();
+
+  HttpParser parser;
+  int failures = 0;
+  std::printf("scan: %s\n", http_scan::implementationName());
+
+  int rounds = 100000 * scale;
+  double start = nowSeconds();
+  int done = 0;
+  for (int i = 0; i < rounds; ++i)
+    done += feed(parser, single, single.size(), failures);
+  report("single request", done, single.size() * rounds,
+         nowSeconds() - start, failures || done != rounds);
+
+  rounds = 2000 * scale;
+  failures = 0;
+  done = 0;
+  start = nowSeconds();
+  for (int i = 0; i < rounds; ++i)
+    done += feed(parser, pipelined, 4096, failures);
+  report("64 pipelined, 4K reads", done, pipelined.size() * rounds,
+         nowSeconds() - start, failures || done != rounds * 64);
+
+  rounds = 2000 * scale;
+  failures = 0;
+  done = 0;
+  start = nowSeconds();
+  for (int i = 0; i < rounds; ++i) done += feed(parser, many, 16, failures);
+  report("100 headers, 16-byte reads", done, many.size() * rounds,
+         nowSeconds() - start, failures || done != rounds);
+
+  rounds = 50000 * scale;
+  failures = 0;
+  done = 0;
+  start = nowSeconds();
+  for (int i = 0; i < rounds; ++i)
+    done += feed(parser, browser, browser.size(), failures);
+  report("browser, 1.5 KB cookies", done, browser.size() * rounds,
+         nowSeconds() - start, failures || done != rounds);
+  return 0;
+}
@@ -108,6 +108,32 @@ int main()
         assertTrue(parser.getState() == ERROR, "Header sin ':' -> ERROR");
     }
 
+    // Caso 6: Carácter de control en el valor de un header
+    {
+        HttpParser parser;
+        parser.consume("GET / HTTP/1.1\r\nHost: example.com\r\nX-A: a\x01b\r\n\r\n");
+        assertTrue(parser.getState() == ERROR, "Control en valor -> ERROR");
+    }
+
+    // Caso 7: Nombre de header que no es token (espacio antes de ':')
+    {
+        HttpParser parser;
+        parser.consume("GET / HTTP/1.1\r\nHost : example.com\r\n\r\n");
+        assertTrue(parser.getState() == ERROR, "Espacio antes de ':' -> ERROR");
+    }
+
+    // Caso 8: Cookie y User-Agent largos (camino SIMD) con obs-text y HTAB
+    {
+        HttpParser parser;
+        std::string cookie(1500, 'c');
+        cookie[700] = '\t';
+        cookie[900] = '\xe9';
+        parser.consume("GET / HTTP/1.1\r\nHost: example.com\r\nCookie: " + cookie +
+                       "\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n\r\n");
+        assertTrue(parser.getState() == COMPLETE, "Cabeceras largas -> COMPLETE");
+        assertTrue(parser.getRequest().getHeader("cookie") == cookie, "Cookie intacta");
+    }
+
     if (g_failures == 0)
         std::cout << "\nTodos los tests pasaron." << std::endl;
     else
@@ -69,6 +69,40 @@ int main()
     req.addHeaders("Connection", "keep-alive");
     assertTrue(!req.shouldCloseConnection(), "HTTP/1.0 + keep-alive -> mantener");
 
+    // Test 6: ids de cabeceras conocidas (hash perfecto)
+    {
+        const char* names[HTTP_HEADER_COUNT] = {
+            "Host", "Connection", "Content-Length", "Content-Type",
+            "Transfer-Encoding", "Expect", "Cookie", "If-None-Match",
+            "If-Modified-Since", "If-Range", "Range", "Accept-Encoding",
+            "User-Agent", "Referer"};
+        bool allMatch = true;
+        for (int i = 0; i < HTTP_HEADER_COUNT; ++i) {
+            std::string name(names[i]);
+            if (HttpHeaderTable::lookupId(name.data(), name.size()) != i)
+                allMatch = false;
+        }
+        assertTrue(allMatch, "Cada cabecera conocida -> su id");
+        assertTrue(HttpHeaderTable::lookupId("x-host", 6) == HTTP_HEADER_OTHER,
+                   "Cabecera desconocida -> HTTP_HEADER_OTHER");
+        assertTrue(HttpHeaderTable::lookupId("hosx", 4) == HTTP_HEADER_OTHER,
+                   "Misma casilla del hash, otro nombre -> HTTP_HEADER_OTHER");
+    }
+
+    // Test 7: repetidas (gana la última) y acceso por id
+    req.clear();
+    req.addHeaders("X-Trace", "1");
+    req.addHeaders("Cookie", "a=1");
+    req.addHeaders("x-trace", "2");
+    req.addHeaders("COOKIE", "b=2");
+    assertTrue(req.getHeader("X-TRACE") == "2", "Repetida desconocida -> la última");
+    assertTrue(req.getHeader(HTTP_HEADER_COOKIE).str() == "b=2", "Repetida conocida -> la última");
+    assertTrue(req.getHeaders().size() == 4, "Se conservan todas en orden");
+    assertTrue(!req.getHeaders().isLastWithName(0) && req.getHeaders().isLastWithName(2),
+               "isLastWithName");
+    assertTrue(!req.hasHeader(HTTP_HEADER_HOST) && req.getHeader("host").empty(),
+               "Cabecera ausente -> vacía");
+
     if (g_failures == 0)
         std::cout << "\nTodos los tests pasaron." << std::endl;
     else
@@ -0,0 +1,129 @@
+/*
+ * Example content handler module (see src/module/webserv_module.h).
+ *
+ *   make test_module
+ *   ./webserv tests/test_module/module_test.conf
+ *
+ *   curl -s 'localhost:8082/api/echo?x=1' -d 'hello'   -> JSON, synchronous
+ *   curl -sN localhost:8082/api/ticks                   -> 3 chunks, 200 ms
+ *                                                          apart (timerfd)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "webserv_module.h"
+
+#define TICKS 3
+
+static const webserv_api* api;
+
+typedef struct ticks_state {
+  int timer;
+  int sent;
+} ticks_state;
+
+static int starts_with(webserv_str str, const char* prefix) {
+  size_t len = strlen(prefix);
+  return str.len >= len && memcmp(str.data, prefix, len) == 0;
+}
+
+static int json_init(const webserv_api* server_api, void** module_data) {
+  (void)module_data;
+  if (server_api->abi_version != WEBSERV_MODULE_ABI_VERSION) return -1;
+  api = server_api;
+  api->log(WEBSERV_LOG_LEVEL_INFO, "json_module ready");
+  return 0;
+}
+
+static void end_ticks(webserv_response* res, ticks_state* state) {
+  api->unwatch_fd(res, state->timer);
+  close(state->timer);
+  free(state);
+  api->set_data(res, NULL);
+}
+
+static void on_tick(webserv_response* res, int fd, unsigned events,
+                    void* arg) {
+  ticks_state* state = (ticks_state*)arg;
+  unsigned long long expirations;
+  char line[64];
+  int len;
+
+  (void)events;
+  if (read(fd, &expirations, sizeof(expirations)) < 0) return;
+  len = snprintf(line, sizeof(line), "{\"tick\":%d,\"pending\":%lu}\n",
+                 ++state->sent, (unsigned long)api->pending(res));
+  api->write(res, line, (size_t)len);
+  if (state->sent < TICKS) return;
+  end_ticks(res, state);
+  api->finish(res);
+}
+
+static int start_ticks(webserv_response* res) {
+  struct itimerspec interval;
+  ticks_state* state = (ticks_state*)malloc(sizeof(*state));
+
+  if (state == NULL) return WEBSERV_ERROR;
+  state->sent = 0;
+  state->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (state->timer < 0) {
+    free(state);
+    return WEBSERV_ERROR;
+  }
+  memset(&interval, 0, sizeof(interval));
+  interval.it_value.tv_nsec = 200000000;
+  interval.it_interval.tv_nsec = 200000000;
+  timerfd_settime(state->timer, 0, &interval, NULL);
+  if (api->watch_fd(res, state->timer, WEBSERV_READABLE, on_tick, state) !=
+      0) {
+    close(state->timer);
+    free(state);
+    return WEBSERV_ERROR;
+  }
+  api->set_data(res, state);
+  api->set_header(res, "Content-Type", "application/x-ndjson");
+  return WEBSERV_ASYNC;
+}
+
+static int json_handle(void* module_data, webserv_request* req,
+                       webserv_response* res) {
+  webserv_str method = api->method(req);
+  webserv_str path = api->path(req);
+  webserv_str query = api->query(req);
+  webserv_str chunk;
+  size_t body_bytes = 0;
+  char json[512];
+  int len;
+
+  (void)module_data;
+  if (starts_with(path, "/api/ticks")) return start_ticks(res);
+
+  while (api->body_chunk(req, &chunk)) body_bytes += chunk.len;
+  len = snprintf(json, sizeof(json),
+                 "{\"method\":\"%.*s\",\"path\":\"%.*s\",\"query\":\"%.*s\","
+                 "\"headers\":%lu,\"body_bytes\":%lu}\n",
+                 (int)method.len, method.data, (int)path.len, path.data,
+                 (int)query.len, query.data,
+                 (unsigned long)api->header_count(req),
+                 (unsigned long)body_bytes);
+  if (len < 0 || (size_t)len >= sizeof(json)) return WEBSERV_ERROR;
+  api->set_status(res, 200);
+  api->set_header(res, "Content-Type", "application/json");
+  api->write(res, json, (size_t)len);
+  api->finish(res);
+  return WEBSERV_OK;
+}
+
+/* Client gone or timeout in the middle of /api/ticks. */
+static void json_abort(void* module_data, webserv_response* res) {
+  ticks_state* state = (ticks_state*)api->get_data(res);
+  (void)module_data;
+  if (state) end_ticks(res, state);
+}
+
+const webserv_module webserv_handler_module = {
+    WEBSERV_MODULE_ABI_VERSION, "json_module", json_init, NULL,
+    json_handle,                json_abort};
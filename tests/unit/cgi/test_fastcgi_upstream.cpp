@@ -0,0 +1,107 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "../../lib/catch2/catch.hpp"
+#include "../../src/cgi/CgiProcess.hpp"
+#include "../../src/cgi/FastCgiUpstream.hpp"
+
+// ============================================================================
+// FastCgiUpstream keep-alive slots against a local unix socket
+// ============================================================================
+
+namespace {
+
+// Listening unix socket standing in for the FastCGI application.
+class FakeFastCgiServer {
+ public:
+  FakeFastCgiServer() : fd_(-1) {
+    std::ostringstream path;
+    path << "/tmp/webserv_test_fcgi_" << getpid() << ".sock";
+    path_ = path.str();
+    std::remove(path_.c_str());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path_.c_str());
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(fd_, 16) == -1) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+  ~FakeFastCgiServer() {
+    if (fd_ != -1) close(fd_);
+    std::remove(path_.c_str());
+  }
+
+  bool ok() const { return fd_ != -1; }
+  std::string address() const { return "unix:" + path_; }
+  int accept() { return ::accept(fd_, NULL, NULL); }
+
+ private:
+  int fd_;
+  std::string path_;
+};
+
+// True once the server side sees the connection closed.
+bool peerClosed(int peer) {
+  char byte;
+  return recv(peer, &byte, 1, MSG_DONTWAIT) == 0;
+}
+
+}  // namespace
+
+TEST_CASE("FastCgiUpstream: timed-out requests give their slot back",
+          "[cgi][fastcgi]") {
+  FakeFastCgiServer server;
+  REQUIRE(server.ok());
+  // One keep-alive slot: a single leaked slot shows on the next acquire().
+  FastCgiUpstream upstream(server.address(), 1);
+
+  SECTION("Aborted like Client::abortCgi (close pipes, then delete)") {
+    for (int i = 0; i < 3; ++i) {
+      bool keepConn = false;
+      int fd = upstream.acquire(keepConn);
+      REQUIRE(fd != -1);
+      REQUIRE(keepConn);
+      int peer = server.accept();
+      REQUIRE(peer != -1);
+
+      // timeout 0: already past its deadline, nothing received yet
+      CgiProcess* process =
+          new CgiProcess("/app", fd, &upstream, keepConn, 0, "records");
+      REQUIRE(process->isTimedOut());
+      process->closePipeIn();
+      process->closePipeOut();
+      CHECK(process->getPipeOut() == -1);
+      delete process;
+
+      // Cut short mid-request: closed, not parked in the idle list.
+      CHECK(peerClosed(peer));
+      close(peer);
+    }
+  }
+
+  SECTION("Deleted with the socket still open") {
+    for (int i = 0; i < 3; ++i) {
+      bool keepConn = false;
+      int fd = upstream.acquire(keepConn);
+      REQUIRE(fd != -1);
+      REQUIRE(keepConn);
+      int peer = server.accept();
+      REQUIRE(peer != -1);
+
+      delete new CgiProcess("/app", fd, &upstream, keepConn, 0, "records");
+
+      CHECK(peerClosed(peer));
+      close(peer);
+    }
+  }
+}
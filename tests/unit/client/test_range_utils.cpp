@@ -0,0 +1,169 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../lib/catch2/catch.hpp"
+#include "../../src/client/RangeUtils.hpp"
+
+// ============================================================================
+// parseRangeHeader: Range: bytes=... against a file of a given size
+// ============================================================================
+
+namespace {
+
+RangeResult parse(const char* value, off_t size,
+                  std::vector<ByteRange>& ranges) {
+  HttpHeaderView view;
+  view.data = value;
+  view.length = std::strlen(value);
+  return parseRangeHeader(view, size, ranges);
+}
+
+bool isRange(const ByteRange& range, off_t first, off_t last) {
+  return range.first == first && range.last == last;
+}
+
+}  // namespace
+
+TEST_CASE("parseRangeHeader - single ranges", "[client][range]") {
+  std::vector<ByteRange> ranges;
+
+  SECTION("Closed range") {
+    REQUIRE(parse("bytes=0-99", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(isRange(ranges[0], 0, 99));
+  }
+
+  SECTION("Last byte past the end is clipped") {
+    REQUIRE(parse("bytes=900-5000", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 900, 999));
+  }
+
+  SECTION("Open-ended range") {
+    REQUIRE(parse("bytes=900-", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 900, 999));
+    REQUIRE(parse("bytes=0-", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 0, 999));
+  }
+
+  SECTION("Suffix range") {
+    REQUIRE(parse("bytes=-100", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 900, 999));
+  }
+
+  SECTION("Suffix longer than the file is the whole file") {
+    REQUIRE(parse("bytes=-5000", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 0, 999));
+  }
+
+  SECTION("Unit is case-insensitive") {
+    REQUIRE(parse("Bytes=0-0", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 0, 0));
+  }
+
+  SECTION("Huge offsets saturate instead of overflowing") {
+    REQUIRE(parse("bytes=0-99999999999999999999999", 1000, ranges) ==
+            RANGE_SATISFIABLE);
+    REQUIRE(isRange(ranges[0], 0, 999));
+  }
+}
+
+TEST_CASE("parseRangeHeader - multiple ranges", "[client][range]") {
+  std::vector<ByteRange> ranges;
+
+  SECTION("Kept in request order") {
+    REQUIRE(parse("bytes=500-599,0-99,-10", 1000, ranges) ==
+            RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == 3);
+    REQUIRE(isRange(ranges[0], 500, 599));
+    REQUIRE(isRange(ranges[1], 0, 99));
+    REQUIRE(isRange(ranges[2], 990, 999));
+  }
+
+  SECTION("Whitespace around the commas") {
+    REQUIRE(parse("bytes=0-9, 20-29 ,\t40-49", 1000, ranges) ==
+            RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == 3);
+    REQUIRE(isRange(ranges[2], 40, 49));
+  }
+
+  SECTION("Unsatisfiable ranges among satisfiable ones are dropped") {
+    REQUIRE(parse("bytes=2000-2100,0-9", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(isRange(ranges[0], 0, 9));
+  }
+
+  SECTION("Small overlaps are served as asked") {
+    REQUIRE(parse("bytes=0-99,50-149", 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == 2);
+    REQUIRE(isRange(ranges[1], 50, 149));
+  }
+
+  SECTION("Overlaps asking for more than the file are ignored") {
+    REQUIRE(parse("bytes=0-599,400-999", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=0-,0-", 1000, ranges) == RANGE_IGNORE);
+  }
+
+  SECTION("More than MAX_BYTE_RANGES ranges are ignored") {
+    std::string many = "bytes=0-0";
+    for (std::size_t i = 1; i < MAX_BYTE_RANGES; ++i)
+      many += "," + std::to_string(i) + "-" + std::to_string(i);
+    REQUIRE(parse(many.c_str(), 1000, ranges) == RANGE_SATISFIABLE);
+    REQUIRE(ranges.size() == MAX_BYTE_RANGES);
+    many += ",999-999";
+    REQUIRE(parse(many.c_str(), 1000, ranges) == RANGE_IGNORE);
+  }
+}
+
+TEST_CASE("parseRangeHeader - unsatisfiable", "[client][range]") {
+  std::vector<ByteRange> ranges;
+
+  SECTION("First byte at or past the end") {
+    REQUIRE(parse("bytes=1000-", 1000, ranges) == RANGE_UNSATISFIABLE);
+    REQUIRE(parse("bytes=1000-1999", 1000, ranges) == RANGE_UNSATISFIABLE);
+    REQUIRE(ranges.empty());
+  }
+
+  SECTION("Zero-length suffix") {
+    REQUIRE(parse("bytes=-0", 1000, ranges) == RANGE_UNSATISFIABLE);
+  }
+
+  SECTION("Empty file") {
+    REQUIRE(parse("bytes=0-", 0, ranges) == RANGE_UNSATISFIABLE);
+    REQUIRE(parse("bytes=-10", 0, ranges) == RANGE_UNSATISFIABLE);
+  }
+
+  SECTION("Every range out of the file") {
+    REQUIRE(parse("bytes=1000-1001,-0,5000-", 1000, ranges) ==
+            RANGE_UNSATISFIABLE);
+  }
+}
+
+TEST_CASE("parseRangeHeader - malformed headers are ignored",
+          "[client][range]") {
+  std::vector<ByteRange> ranges;
+
+  SECTION("Other unit or no unit") {
+    REQUIRE(parse("items=0-9", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("0-9", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("", 1000, ranges) == RANGE_IGNORE);
+  }
+
+  SECTION("No range after the unit") {
+    REQUIRE(parse("bytes=", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=,", 1000, ranges) == RANGE_IGNORE);
+  }
+
+  SECTION("Bad range specs") {
+    REQUIRE(parse("bytes=abc", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=-", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=10", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=9-5", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=0-9x", 1000, ranges) == RANGE_IGNORE);
+  }
+
+  SECTION("One bad spec spoils the whole header") {
+    REQUIRE(parse("bytes=0-9,oops", 1000, ranges) == RANGE_IGNORE);
+    REQUIRE(parse("bytes=0-9,20", 1000, ranges) == RANGE_IGNORE);
+  }
+}
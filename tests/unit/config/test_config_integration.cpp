@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <fstream>
 
 #include "../../lib/catch2/catch.hpp"
 #include "../../src/config/ConfigException.hpp"
 #include "../../src/config/ConfigParser.hpp"
+#include "../../src/config/VirtualHostTable.hpp"
 
 // ============================================================================
 // INTEGRATION TESTS: Full configuration file parsing with validations
@@ -289,3 +291,922 @@ TEST_CASE("Integration: Invalid body size limits",
     std::remove("test_invalid_bodysize_large.conf");
   }
 }
+
+TEST_CASE("Integration: worker_processes directive",
+          "[config][integration][workers]") {
+  SECTION("Default is a single worker") {
+    std::ofstream file("test_workers_default.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_workers_default.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getWorkerProcesses() == 1);
+    std::remove("test_workers_default.conf");
+  }
+
+  SECTION("Explicit number of workers") {
+    std::ofstream file("test_workers_four.conf");
+    file << "worker_processes 4;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_workers_four.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getWorkerProcesses() == 4);
+    REQUIRE(parser.getServers().size() == 1);
+    std::remove("test_workers_four.conf");
+  }
+
+  SECTION("auto uses at least one worker") {
+    std::ofstream file("test_workers_auto.conf");
+    file << "worker_processes auto;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_workers_auto.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getWorkerProcesses() >= 1);
+    std::remove("test_workers_auto.conf");
+  }
+
+  SECTION("Zero workers") {
+    std::ofstream file("test_workers_zero.conf");
+    file << "worker_processes 0;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_workers_zero.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_workers_zero.conf");
+  }
+
+  SECTION("Non numeric value") {
+    std::ofstream file("test_workers_text.conf");
+    file << "worker_processes many;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_workers_text.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_workers_text.conf");
+  }
+}
+
+TEST_CASE("Integration: open_file_cache directive",
+          "[config][integration][open_file_cache]") {
+  SECTION("Disabled by default") {
+    std::ofstream file("test_ofc_default.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_ofc_default.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getOpenFileCacheMax() == 0);
+    std::remove("test_ofc_default.conf");
+  }
+
+  SECTION("max and inactive") {
+    std::ofstream file("test_ofc_max.conf");
+    file << "open_file_cache max=500 inactive=2m;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_ofc_max.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getOpenFileCacheMax() == 500);
+    REQUIRE(parser.getGlobalConfig().getOpenFileCacheInactive() == 120);
+    std::remove("test_ofc_max.conf");
+  }
+
+  SECTION("Explicit off") {
+    std::ofstream file("test_ofc_off.conf");
+    file << "open_file_cache off;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_ofc_off.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getOpenFileCacheMax() == 0);
+    std::remove("test_ofc_off.conf");
+  }
+
+  SECTION("Invalid arguments") {
+    std::ofstream file("test_ofc_invalid.conf");
+    file << "open_file_cache max=abc inactive=10x;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_ofc_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_ofc_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: response_cache directive",
+          "[config][integration][response_cache]") {
+  SECTION("Disabled by default") {
+    std::ofstream file("test_rc_default.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_rc_default.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getResponseCacheSize() == 0);
+    std::remove("test_rc_default.conf");
+  }
+
+  SECTION("size and max_object") {
+    std::ofstream file("test_rc_size.conf");
+    file << "response_cache size=8m max_object=32k;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_rc_size.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getResponseCacheSize() == 8 * 1024 * 1024);
+    REQUIRE(parser.getGlobalConfig().getResponseCacheMaxObject() == 32 * 1024);
+    std::remove("test_rc_size.conf");
+  }
+
+  SECTION("max_object larger than size") {
+    std::ofstream file("test_rc_invalid.conf");
+    file << "response_cache size=16k max_object=1m;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_rc_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_rc_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: timeout directives",
+          "[config][integration][timeouts]") {
+  SECTION("Defaults") {
+    std::ofstream file("test_timeouts_default.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_timeouts_default.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getClientHeaderTimeout() == 60);
+    REQUIRE(parser.getGlobalConfig().getKeepaliveTimeout() == 60);
+    REQUIRE(parser.getGlobalConfig().getCgiTimeout() == 5);
+    std::remove("test_timeouts_default.conf");
+  }
+
+  SECTION("Durations with suffixes") {
+    std::ofstream file("test_timeouts_values.conf");
+    file << "client_header_timeout 10s;\n"
+         << "client_body_timeout 20;\n"
+         << "keepalive_timeout 2m;\n"
+         << "send_timeout 30s;\n"
+         << "cgi_timeout 1m;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_timeouts_values.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getClientHeaderTimeout() == 10);
+    REQUIRE(parser.getGlobalConfig().getClientBodyTimeout() == 20);
+    REQUIRE(parser.getGlobalConfig().getKeepaliveTimeout() == 120);
+    REQUIRE(parser.getGlobalConfig().getSendTimeout() == 30);
+    REQUIRE(parser.getGlobalConfig().getCgiTimeout() == 60);
+    std::remove("test_timeouts_values.conf");
+  }
+
+  SECTION("Zero is rejected") {
+    std::ofstream file("test_timeouts_invalid.conf");
+    file << "keepalive_timeout 0;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_timeouts_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_timeouts_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: client_body_buffer_size directive",
+          "[config][integration][body]") {
+  SECTION("Default and explicit value") {
+    std::ofstream file("test_body_buffer.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8081;\n"
+         << "    client_body_buffer_size 64k;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_body_buffer.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getServers().size() == 2);
+    REQUIRE(parser.getServers()[0].getBodyBufferSize() == 16384);
+    REQUIRE(parser.getServers()[1].getBodyBufferSize() == 64 * 1024);
+    std::remove("test_body_buffer.conf");
+  }
+
+  SECTION("Zero is rejected") {
+    std::ofstream file("test_body_buffer_invalid.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    client_body_buffer_size 0;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_body_buffer_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_body_buffer_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: fastcgi_pass and fastcgi_spawn directives",
+          "[config][integration][fastcgi]") {
+  SECTION("Socket addresses, keepalive and spawned pool") {
+    std::ofstream file("test_fastcgi.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /php {\n"
+         << "        fastcgi_pass unix:/tmp/php.sock;\n"
+         << "        fastcgi_spawn /usr/bin/php-cgi 8;\n"
+         << "    }\n"
+         << "    location /app {\n"
+         << "        fastcgi_pass 127.0.0.1:9000 keepalive=4;\n"
+         << "    }\n"
+         << "    location /py {\n"
+         << "        fastcgi_pass .py /usr/bin/python3;\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_fastcgi.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<LocationConfig>& locations =
+        parser.getServers()[0].getLocations();
+    REQUIRE(locations.size() == 3);
+    REQUIRE(locations[0].getFastCgiPass() == "unix:/tmp/php.sock");
+    REQUIRE(locations[0].getFastCgiSpawn() == "/usr/bin/php-cgi");
+    REQUIRE(locations[0].getFastCgiWorkers() == 8);
+    REQUIRE(locations[0].getFastCgiKeepalive() == -1);
+    REQUIRE(locations[1].getFastCgiPass() == "127.0.0.1:9000");
+    REQUIRE(locations[1].getFastCgiSpawn().empty());
+    REQUIRE(locations[1].getFastCgiKeepalive() == 4);
+    // Legacy form: same as 'cgi .py /usr/bin/python3;'
+    REQUIRE(locations[2].getFastCgiPass().empty());
+    REQUIRE(locations[2].getCgiPath(".py") == "/usr/bin/python3");
+    std::remove("test_fastcgi.conf");
+  }
+
+  SECTION("Invalid port is rejected") {
+    std::ofstream file("test_fastcgi_port.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /app {\n"
+         << "        fastcgi_pass 127.0.0.1:70000;\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_fastcgi_port.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_fastcgi_port.conf");
+  }
+
+  SECTION("fastcgi_spawn requires fastcgi_pass") {
+    std::ofstream file("test_fastcgi_spawn.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /app {\n"
+         << "        fastcgi_spawn /usr/bin/php-cgi;\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_fastcgi_spawn.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_fastcgi_spawn.conf");
+  }
+}
+
+TEST_CASE("Integration: expires and cache_control directives",
+          "[config][integration][expires]") {
+  SECTION("Durations, max, off and extra directives") {
+    std::ofstream file("test_expires.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /css {\n"
+         << "        expires 7d;\n"
+         << "    }\n"
+         << "    location /images {\n"
+         << "        expires max;\n"
+         << "        cache_control public, immutable;\n"
+         << "    }\n"
+         << "    location /docs {\n"
+         << "        expires off;\n"
+         << "    }\n"
+         << "    location / {\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_expires.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<LocationConfig>& locations =
+        parser.getServers()[0].getLocations();
+    REQUIRE(locations.size() == 4);
+    REQUIRE(locations[0].getExpires() == 7 * 86400);
+    REQUIRE(locations[0].getCacheControl().empty());
+    REQUIRE(locations[1].getExpires() == 315360000);
+    REQUIRE(locations[1].getCacheControl() == "public, immutable");
+    REQUIRE(locations[2].getExpires() == -1);
+    REQUIRE(locations[3].getExpires() == -1);
+    std::remove("test_expires.conf");
+  }
+
+  SECTION("Invalid values are rejected") {
+    const char* lines[] = {"expires soon;", "expires 1h 2h;",
+                           "cache_control ;"};
+    for (size_t i = 0; i < 3; ++i) {
+      std::ofstream file("test_expires_invalid.conf");
+      file << "server {\n"
+           << "    listen 8080;\n"
+           << "    location / {\n"
+           << "        " << lines[i] << "\n"
+           << "    }\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_expires_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+    std::remove("test_expires_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: gzip, gzip_static and gzip_cache directives",
+          "[config][integration][gzip]") {
+  SECTION("Per-location switches and the default cache") {
+    std::ofstream file("test_gzip.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /static {\n"
+         << "        gzip_static on;\n"
+         << "    }\n"
+         << "    location /app {\n"
+         << "        gzip on;\n"
+         << "        gzip_static off;\n"
+         << "    }\n"
+         << "    location / {\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_gzip.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<LocationConfig>& locations =
+        parser.getServers()[0].getLocations();
+    REQUIRE(locations.size() == 3);
+    REQUIRE(locations[0].getGzipStatic());
+    REQUIRE_FALSE(locations[0].getGzip());
+    REQUIRE(locations[1].getGzip());
+    REQUIRE_FALSE(locations[1].getGzipStatic());
+    REQUIRE_FALSE(locations[2].getGzip());
+    REQUIRE_FALSE(locations[2].getGzipStatic());
+    REQUIRE(parser.getGlobalConfig().getGzipCacheSize() == 4 * 1024 * 1024);
+    REQUIRE(parser.getGlobalConfig().getGzipCacheMaxObject() == 1024 * 1024);
+    std::remove("test_gzip.conf");
+  }
+
+  SECTION("gzip_cache size, max_object and off") {
+    std::ofstream file("test_gzip_cache.conf");
+    file << "gzip_cache size=16m max_object=256k;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_gzip_cache.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getGzipCacheSize() == 16 * 1024 * 1024);
+    REQUIRE(parser.getGlobalConfig().getGzipCacheMaxObject() == 256 * 1024);
+
+    std::ofstream off("test_gzip_cache.conf");
+    off << "gzip_cache off;\n"
+        << "server {\n"
+        << "    listen 8080;\n"
+        << "}\n";
+    off.close();
+
+    ConfigParser offParser("test_gzip_cache.conf");
+    REQUIRE_NOTHROW(offParser.parse());
+    REQUIRE(offParser.getGlobalConfig().getGzipCacheSize() == 0);
+    REQUIRE(offParser.getGlobalConfig().getGzipCacheMaxObject() ==
+            1024 * 1024);
+    std::remove("test_gzip_cache.conf");
+  }
+
+  SECTION("Invalid values are rejected") {
+    const char* lines[] = {"gzip yes;", "gzip_static on off;",
+                           "gzip_static maybe;"};
+    for (size_t i = 0; i < 3; ++i) {
+      std::ofstream file("test_gzip_invalid.conf");
+      file << "server {\n"
+           << "    listen 8080;\n"
+           << "    location / {\n"
+           << "        " << lines[i] << "\n"
+           << "    }\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_gzip_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+
+    std::ofstream file("test_gzip_invalid.conf");
+    file << "gzip_cache size=64k max_object=1m;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+    ConfigParser parser("test_gzip_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_gzip_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: edge_triggered and client_read_size directives",
+          "[config][integration][edge_triggered]") {
+  SECTION("Defaults: level-triggered, 16k reads") {
+    std::ofstream file("test_edge.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_edge.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE_FALSE(parser.getGlobalConfig().getEdgeTriggered());
+    REQUIRE(parser.getGlobalConfig().getClientReadSize() == 16 * 1024);
+    std::remove("test_edge.conf");
+  }
+
+  SECTION("Both directives set") {
+    std::ofstream file("test_edge.conf");
+    file << "edge_triggered on;\n"
+         << "client_read_size 64k;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_edge.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    REQUIRE(parser.getGlobalConfig().getEdgeTriggered());
+    REQUIRE(parser.getGlobalConfig().getClientReadSize() == 64 * 1024);
+    std::remove("test_edge.conf");
+  }
+
+  SECTION("Invalid values are rejected") {
+    const char* lines[] = {"edge_triggered yes;", "client_read_size 512;",
+                           "client_read_size 2m;", "client_read_size abc;"};
+    for (size_t i = 0; i < 4; ++i) {
+      std::ofstream file("test_edge_invalid.conf");
+      file << lines[i] << "\n"
+           << "server {\n"
+           << "    listen 8080;\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_edge_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+    std::remove("test_edge_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: event_backend directive",
+          "[config][integration][event_backend]") {
+  SECTION("auto by default, epoll and io_uring accepted") {
+    const char* names[] = {"", "epoll", "io_uring", "auto"};
+    const char* expected[] = {"auto", "epoll", "io_uring", "auto"};
+    for (size_t i = 0; i < 4; ++i) {
+      std::ofstream file("test_event_backend.conf");
+      if (names[i][0] != '\0')
+        file << "event_backend " << names[i] << ";\n";
+      file << "server {\n"
+           << "    listen 8080;\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_event_backend.conf");
+      REQUIRE_NOTHROW(parser.parse());
+      REQUIRE(parser.getGlobalConfig().getEventBackend() == expected[i]);
+    }
+    std::remove("test_event_backend.conf");
+  }
+
+  SECTION("Unknown backend is rejected") {
+    std::ofstream file("test_event_backend.conf");
+    file << "event_backend kqueue;\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_event_backend.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_event_backend.conf");
+  }
+}
+
+TEST_CASE("Integration: static CGI environment per location",
+          "[config][integration][cgi]") {
+  std::ofstream file("test_cgi_env.conf");
+  file << "server {\n"
+       << "    location /cgi-bin {\n"
+       << "        cgi .py /usr/bin/python3;\n"
+       << "    }\n"
+       << "    listen 8085;\n"
+       << "    server_name example.com;\n"
+       << "}\n";
+  file.close();
+
+  ConfigParser parser("test_cgi_env.conf");
+  REQUIRE_NOTHROW(parser.parse());
+  // Built after the whole block: listen/server_name come after the location.
+  const std::vector<std::string>& env =
+      parser.getServers()[0].getLocations()[0].getCgiEnvironment();
+  REQUIRE(std::find(env.begin(), env.end(), "SERVER_PORT=8085") != env.end());
+  REQUIRE(std::find(env.begin(), env.end(), "SERVER_NAME=example.com") !=
+          env.end());
+  REQUIRE(std::find(env.begin(), env.end(), "GATEWAY_INTERFACE=CGI/1.1") !=
+          env.end());
+  std::remove("test_cgi_env.conf");
+}
+
+TEST_CASE("Integration: location routing", "[config][integration][location]") {
+  std::ofstream file("test_location_routing.conf");
+  file << "server {\n"
+       << "    listen 8080;\n"
+       << "    location / {\n"
+       << "    }\n"
+       << "    location /api {\n"
+       << "    }\n"
+       << "    location /api/v1 {\n"
+       << "    }\n"
+       << "    location /apple {\n"
+       << "    }\n"
+       << "    location = /api/status {\n"
+       << "    }\n"
+       << "    location /api {\n"
+       << "        root /duplicate;\n"
+       << "    }\n"
+       << "}\n";
+  file.close();
+
+  ConfigParser parser("test_location_routing.conf");
+  REQUIRE_NOTHROW(parser.parse());
+  std::remove("test_location_routing.conf");
+  const ServerConfig& server = parser.getServers()[0];
+  const std::vector<LocationConfig>& locations = server.getLocations();
+  REQUIRE(locations.size() == 6);
+  REQUIRE(locations[4].isExactMatch());
+  REQUIRE_FALSE(locations[1].isExactMatch());
+
+  SECTION("Longest prefix on a segment boundary") {
+    REQUIRE(server.matchLocation("/") == &locations[0]);
+    REQUIRE(server.matchLocation("/index.html") == &locations[0]);
+    REQUIRE(server.matchLocation("/api") == &locations[1]);
+    REQUIRE(server.matchLocation("/api/users") == &locations[1]);
+    REQUIRE(server.matchLocation("/api/v1") == &locations[2]);
+    REQUIRE(server.matchLocation("/api/v1/x") == &locations[2]);
+    REQUIRE(server.matchLocation("/api/v10") == &locations[1]);
+    REQUIRE(server.matchLocation("/apix") == &locations[0]);
+    REQUIRE(server.matchLocation("/apple/pie") == &locations[3]);
+    REQUIRE(server.matchLocation("/app") == &locations[0]);
+  }
+
+  SECTION("Exact match only for the exact path") {
+    REQUIRE(server.matchLocation("/api/status") == &locations[4]);
+    REQUIRE(server.matchLocation("/api/status/x") == &locations[1]);
+    REQUIRE(server.matchLocation("/api/statu") == &locations[1]);
+  }
+
+  SECTION("The first of two identical paths wins") {
+    REQUIRE(server.matchLocation("/api/x") == &locations[1]);
+  }
+
+  SECTION("Copies route to their own locations") {
+    ServerConfig copy(server);
+    REQUIRE(copy.matchLocation("/api/v1") == &copy.getLocations()[2]);
+  }
+}
+
+TEST_CASE("Integration: location fallback without a match",
+          "[config][integration][location]") {
+  std::ofstream file("test_location_fallback.conf");
+  file << "server {\n"
+       << "    listen 8080;\n"
+       << "    location = /exact {\n"
+       << "    }\n"
+       << "    location /static {\n"
+       << "    }\n"
+       << "}\n";
+  file.close();
+
+  ConfigParser parser("test_location_fallback.conf");
+  REQUIRE_NOTHROW(parser.parse());
+  std::remove("test_location_fallback.conf");
+  const ServerConfig& server = parser.getServers()[0];
+  REQUIRE(server.matchLocation("/other") == &server.getLocations()[1]);
+  REQUIRE(server.matchLocation("/exact") == &server.getLocations()[0]);
+  REQUIRE(ServerConfig().matchLocation("/") == 0);
+}
+
+TEST_CASE("Integration: virtual hosts by port and Host",
+          "[config][integration][server_name]") {
+  std::ofstream file("test_vhosts.conf");
+  file << "server {\n"
+       << "    listen 8080;\n"
+       << "    server_name first.test;\n"
+       << "}\n"
+       << "server {\n"
+       << "    listen 8080 default_server;\n"
+       << "    server_name Example.com www.example.com;\n"
+       << "    client_max_body_size 10M;\n"
+       << "}\n"
+       << "server {\n"
+       << "    listen 8080;\n"
+       << "    server_name *.example.com *.api.example.com;\n"
+       << "    client_max_body_size 2M;\n"
+       << "}\n"
+       << "server {\n"
+       << "    listen 8081;\n"
+       << "    server_name example.com;\n"
+       << "}\n";
+  file.close();
+
+  ConfigParser parser("test_vhosts.conf");
+  REQUIRE_NOTHROW(parser.parse());
+  std::remove("test_vhosts.conf");
+  const std::vector<ServerConfig>& servers = parser.getServers();
+  REQUIRE(servers[1].getServerNames().size() == 2);
+  REQUIRE(servers[1].getServerName() == "example.com");
+  REQUIRE(servers[1].isDefaultServer());
+
+  VirtualHostTable vhosts(&servers);
+
+  SECTION("Exact names, case and port of the Host value ignored") {
+    REQUIRE(vhosts.resolve(8080, "first.test", 10) == &servers[0]);
+    REQUIRE(vhosts.resolve(8080, "EXAMPLE.com:8080", 16) == &servers[1]);
+    REQUIRE(vhosts.resolve(8080, "www.example.com.", 16) == &servers[1]);
+    REQUIRE(vhosts.resolve(8081, "example.com", 11) == &servers[3]);
+  }
+
+  SECTION("Wildcards: longest suffix, never the bare domain") {
+    REQUIRE(vhosts.resolve(8080, "a.example.com", 13) == &servers[2]);
+    REQUIRE(vhosts.resolve(8080, "v1.api.example.com", 18) == &servers[2]);
+    REQUIRE(vhosts.resolve(8081, "a.example.com", 13) == &servers[3]);
+  }
+
+  SECTION("Unknown or missing Host goes to the default server") {
+    REQUIRE(vhosts.resolve(8080, "other.test", 10) == &servers[1]);
+    REQUIRE(vhosts.resolve(8080, "", 0) == &servers[1]);
+    REQUIRE(vhosts.resolve(8080, "[::1]:8080", 10) == &servers[1]);
+    REQUIRE(vhosts.defaultServer(8081) == &servers[3]);
+    REQUIRE(vhosts.resolve(9999, "example.com", 11) == 0);
+  }
+
+  SECTION("Body limit before Host is known: the largest on the port") {
+    REQUIRE(vhosts.maxBodySize(8080) == 10 * 1024 * 1024);
+  }
+}
+
+TEST_CASE("Integration: listen socket options",
+          "[config][integration][listen]") {
+  SECTION("backlog, deferred and fastopen next to default_server") {
+    std::ofstream file("test_listen_options.conf");
+    file << "server {\n"
+         << "    listen 8080 default_server backlog=4096 deferred "
+            "fastopen=256;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8080;\n"
+         << "    server_name other.test;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_listen_options.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<ServerConfig>& servers = parser.getServers();
+    REQUIRE(servers[0].isDefaultServer());
+    REQUIRE(servers[0].getListenBacklog() == 4096);
+    REQUIRE(servers[0].getListenDeferred());
+    REQUIRE(servers[0].getListenFastOpen() == 256);
+    REQUIRE(servers[0].hasListenOptions());
+    REQUIRE(servers[1].getListenBacklog() == -1);
+    REQUIRE_FALSE(servers[1].getListenDeferred());
+    REQUIRE(servers[1].getListenFastOpen() == 0);
+    REQUIRE_FALSE(servers[1].hasListenOptions());
+    std::remove("test_listen_options.conf");
+  }
+
+  SECTION("Invalid or repeated options are rejected") {
+    const char* lines[] = {"listen 8080 backlog=0;", "listen 8080 backlog=x;",
+                           "listen 8080 fastopen=-1;", "listen 8080 reuse;"};
+    for (size_t i = 0; i < 4; ++i) {
+      std::ofstream file("test_listen_invalid.conf");
+      file << "server {\n"
+           << "    " << lines[i] << "\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_listen_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+
+    std::ofstream file("test_listen_invalid.conf");
+    file << "server {\n"
+         << "    listen 8080 backlog=1024;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8080 deferred;\n"
+         << "}\n";
+    file.close();
+    ConfigParser parser("test_listen_invalid.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_listen_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: invalid virtual host settings",
+          "[config][integration][server_name]") {
+  SECTION("Two default servers on one port") {
+    std::ofstream file("test_vhosts_default.conf");
+    file << "server {\n"
+         << "    listen 8080 default_server;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8080 default_server;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_vhosts_default.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_vhosts_default.conf");
+  }
+
+  SECTION("Wildcard not at the start") {
+    std::ofstream file("test_vhosts_wildcard.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    server_name www.*.com;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_vhosts_wildcard.conf");
+    REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    std::remove("test_vhosts_wildcard.conf");
+  }
+}
+
+TEST_CASE("Integration: access_log directive",
+          "[config][integration][access_log]") {
+  SECTION("Path with the default and a custom format") {
+    std::ofstream file("test_access_log.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    access_log /tmp/webserv_access.log;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8081;\n"
+         << "    access_log /tmp/webserv_timing.log "
+            "'$remote_addr \"$request\" $status $request_time';\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8082;\n"
+         << "    access_log off;\n"
+         << "}\n"
+         << "server {\n"
+         << "    listen 8083;\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_access_log.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<ServerConfig>& servers = parser.getServers();
+    REQUIRE(servers[0].getAccessLogPath() == "/tmp/webserv_access.log");
+    REQUIRE(servers[0].getAccessLogFormat().uses(LogFormat::HTTP_USER_AGENT));
+    REQUIRE(servers[0].getAccessLogFormat().uses(LogFormat::TIME_LOCAL));
+
+    const LogFormat& timing = servers[1].getAccessLogFormat();
+    REQUIRE(servers[1].getAccessLogPath() == "/tmp/webserv_timing.log");
+    REQUIRE(timing.uses(LogFormat::REQUEST_TIME));
+    REQUIRE_FALSE(timing.uses(LogFormat::TIME_LOCAL));
+    const std::vector<LogFormat::Piece>& pieces = timing.getPieces();
+    REQUIRE(pieces.size() == 7);
+    REQUIRE(pieces[0].variable == LogFormat::REMOTE_ADDR);
+    REQUIRE(pieces[1].variable == LogFormat::LITERAL);
+    REQUIRE(pieces[1].text == " \"");
+    REQUIRE(pieces[2].variable == LogFormat::REQUEST);
+
+    REQUIRE(servers[2].getAccessLogPath().empty());
+    REQUIRE(servers[3].getAccessLogPath().empty());
+    std::remove("test_access_log.conf");
+  }
+
+  SECTION("Unknown variables and off with a format are rejected") {
+    const char* lines[] = {"access_log /tmp/a.log '$remote_addr $nope';",
+                           "access_log off '$status';", "access_log ;"};
+    for (size_t i = 0; i < 3; ++i) {
+      std::ofstream file("test_access_log_invalid.conf");
+      file << "server {\n"
+           << "    listen 8080;\n"
+           << "    " << lines[i] << "\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_access_log_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+    std::remove("test_access_log_invalid.conf");
+  }
+}
+
+TEST_CASE("Integration: handler directive", "[config][integration][handler]") {
+  SECTION("Module path per location") {
+    std::ofstream file("test_handler.conf");
+    file << "server {\n"
+         << "    listen 8080;\n"
+         << "    location /api {\n"
+         << "        handler /usr/lib/webserv/json.so;\n"
+         << "    }\n"
+         << "    location / {\n"
+         << "        root ./www;\n"
+         << "    }\n"
+         << "}\n";
+    file.close();
+
+    ConfigParser parser("test_handler.conf");
+    REQUIRE_NOTHROW(parser.parse());
+    const std::vector<LocationConfig>& locations =
+        parser.getServers()[0].getLocations();
+    REQUIRE(locations.size() == 2);
+    REQUIRE(locations[0].getHandler() == "/usr/lib/webserv/json.so");
+    REQUIRE(locations[1].getHandler().empty());
+    std::remove("test_handler.conf");
+  }
+
+  SECTION("Wrong arity and cgi in the same location are rejected") {
+    const char* lines[] = {"handler ;", "handler /a.so /b.so;",
+                           "handler /a.so; cgi .py /usr/bin/python3;",
+                           "handler /a.so; fastcgi_pass 127.0.0.1:9000;"};
+    for (size_t i = 0; i < 4; ++i) {
+      std::ofstream file("test_handler_invalid.conf");
+      file << "server {\n"
+           << "    listen 8080;\n"
+           << "    location /api {\n"
+           << "        " << lines[i] << "\n"
+           << "    }\n"
+           << "}\n";
+      file.close();
+
+      ConfigParser parser("test_handler_invalid.conf");
+      REQUIRE_THROWS_AS(parser.parse(), ConfigException);
+    }
+    std::remove("test_handler_invalid.conf");
+  }
+}
@@ -0,0 +1,142 @@
+#include "../../lib/catch2/catch.hpp"
+#include "../../src/config/LocationRouter.hpp"
+
+// ============================================================================
+// LocationRouter: exact table + longest-prefix radix trie
+// ============================================================================
+
+TEST_CASE("LocationRouter - longest prefix wins",
+          "[config][router][prefix]") {
+  LocationRouter router;
+  router.add("/", false, 0);
+  router.add("/api", false, 1);
+  router.add("/api/v1", false, 2);
+  router.add("/api/v1/users", false, 3);
+  router.add("/static", false, 4);
+
+  SECTION("Root") {
+    REQUIRE(router.match("/") == 0);
+    REQUIRE(router.match("/index.html") == 0);
+  }
+
+  SECTION("Each level of a nested prefix") {
+    REQUIRE(router.match("/api") == 1);
+    REQUIRE(router.match("/api/") == 1);
+    REQUIRE(router.match("/api/v2") == 1);
+    REQUIRE(router.match("/api/v1") == 2);
+    REQUIRE(router.match("/api/v1/users") == 3);
+    REQUIRE(router.match("/api/v1/users/42") == 3);
+  }
+
+  SECTION("Sibling branch") {
+    REQUIRE(router.match("/static/css/app.css") == 4);
+  }
+
+  SECTION("Deepest match even when declared first") {
+    LocationRouter reversed;
+    reversed.add("/a/b/c", false, 0);
+    reversed.add("/a", false, 1);
+    reversed.add("/", false, 2);
+    REQUIRE(reversed.match("/a/b/c/d") == 0);
+    REQUIRE(reversed.match("/a/b") == 1);
+    REQUIRE(reversed.match("/x") == 2);
+  }
+
+  SECTION("Explicit length ignores the rest of the buffer") {
+    const char path[] = "/api/v1/users?id=1";
+    REQUIRE(router.match(path, 7) == 2);
+  }
+}
+
+TEST_CASE("LocationRouter - prefixes match on segment boundaries",
+          "[config][router][prefix]") {
+  LocationRouter router;
+  router.add("/", false, 0);
+  router.add("/api", false, 1);
+  router.add("/images/", false, 2);
+
+  SECTION("Prefix followed by more of the same segment does not match") {
+    REQUIRE(router.match("/apix") == 0);
+    REQUIRE(router.match("/api-docs/x") == 0);
+  }
+
+  SECTION("Prefix ending in a slash") {
+    REQUIRE(router.match("/images/a.png") == 2);
+    REQUIRE(router.match("/images") == 0);
+  }
+
+  SECTION("Split edges keep both locations") {
+    LocationRouter split;
+    split.add("/", false, 0);
+    split.add("/abcd", false, 1);
+    split.add("/abxy", false, 2);
+    split.add("/ab", false, 3);
+    REQUIRE(split.match("/abcd/1") == 1);
+    REQUIRE(split.match("/abxy") == 2);
+    REQUIRE(split.match("/ab/c") == 3);
+    REQUIRE(split.match("/abc") == 0);
+  }
+}
+
+TEST_CASE("LocationRouter - exact locations", "[config][router][exact]") {
+  LocationRouter router;
+  router.add("/", false, 0);
+  router.add("/login", true, 1);
+  router.add("/login", false, 2);
+
+  SECTION("Exact path beats a prefix of the same path") {
+    REQUIRE(router.match("/login") == 1);
+  }
+
+  SECTION("Exact location does not match below its path") {
+    REQUIRE(router.match("/login/") == 2);
+    REQUIRE(router.match("/login/reset") == 2);
+  }
+
+  SECTION("Many exact locations (table growth)") {
+    LocationRouter many;
+    many.add("/", false, 0);
+    for (int i = 1; i <= 100; ++i) {
+      std::string path = "/page" + std::to_string(i);
+      many.add(path, true, i);
+    }
+    for (int i = 1; i <= 100; ++i)
+      REQUIRE(many.match("/page" + std::to_string(i)) == i);
+    REQUIRE(many.match("/page101") == 0);
+  }
+}
+
+TEST_CASE("LocationRouter - duplicates and fallbacks",
+          "[config][router][fallback]") {
+  SECTION("First declaration of a path wins") {
+    LocationRouter router;
+    router.add("/", false, 0);
+    router.add("/dup", false, 1);
+    router.add("/dup", false, 2);
+    router.add("/only", true, 3);
+    router.add("/only", true, 4);
+    REQUIRE(router.match("/dup/x") == 1);
+    REQUIRE(router.match("/only") == 3);
+  }
+
+  SECTION("No match falls back to the first prefix location") {
+    LocationRouter router;
+    router.add("/exact", true, 0);
+    router.add("/api", false, 1);
+    router.add("/static", false, 2);
+    REQUIRE(router.match("/other") == 1);
+  }
+
+  SECTION("Only exact locations: the first location") {
+    LocationRouter router;
+    router.add("/a", true, 0);
+    router.add("/b", true, 1);
+    REQUIRE(router.match("/c") == 0);
+    REQUIRE(router.match("/b") == 1);
+  }
+
+  SECTION("No locations") {
+    LocationRouter router;
+    REQUIRE(router.match("/") == -1);
+  }
+}
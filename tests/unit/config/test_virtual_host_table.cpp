@@ -0,0 +1,190 @@
+#include <string>
+#include <vector>
+
+#include "../../lib/catch2/catch.hpp"
+#include "../../src/config/ServerConfig.hpp"
+#include "../../src/config/VirtualHostTable.hpp"
+
+// ============================================================================
+// VirtualHostTable: (port, Host) -> server { }
+// ============================================================================
+
+namespace {
+
+ServerConfig makeServer(int port, const std::vector<std::string>& names,
+                        bool isDefault = false) {
+  ServerConfig server;
+  server.setPort(port);
+  for (size_t i = 0; i < names.size(); ++i) server.addServerName(names[i]);
+  server.setDefaultServer(isDefault);
+  return server;
+}
+
+// Index of the server |host| resolves to on |port|; -1 for none.
+int resolveIndex(const VirtualHostTable& table,
+                 const std::vector<ServerConfig>& servers, int port,
+                 const std::string& host) {
+  const ServerConfig* server = table.resolve(port, host.data(), host.size());
+  return server == 0 ? -1 : static_cast<int>(server - &servers[0]);
+}
+
+}  // namespace
+
+TEST_CASE("VirtualHostTable - exact server_name", "[config][vhost][exact]") {
+  std::vector<ServerConfig> servers;
+  servers.push_back(makeServer(8080, {"first.test"}));
+  servers.push_back(makeServer(8080, {"www.example.com", "example.com"}));
+  servers.push_back(makeServer(9090, {"example.com"}));
+  VirtualHostTable table(&servers);
+
+  SECTION("Every name of a server") {
+    REQUIRE(resolveIndex(table, servers, 8080, "www.example.com") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "example.com") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "first.test") == 0);
+  }
+
+  SECTION("Same name on another port") {
+    REQUIRE(resolveIndex(table, servers, 9090, "example.com") == 2);
+  }
+
+  SECTION("Host is normalized: case, port, trailing dot") {
+    REQUIRE(resolveIndex(table, servers, 8080, "WWW.Example.COM") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "example.com:8080") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "example.com.") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "Example.Com.:8080") == 1);
+  }
+
+  SECTION("server_name is stored lowercased") {
+    std::vector<ServerConfig> upper;
+    upper.push_back(makeServer(8080, {"default.test"}));
+    upper.push_back(makeServer(8080, {"MiXeD.Test"}));
+    VirtualHostTable mixed(&upper);
+    REQUIRE(resolveIndex(mixed, upper, 8080, "mixed.test") == 1);
+  }
+
+  SECTION("First server wins a name claimed twice") {
+    std::vector<ServerConfig> twice;
+    twice.push_back(makeServer(8080, {"dup.test"}));
+    twice.push_back(makeServer(8080, {"dup.test"}));
+    VirtualHostTable dup(&twice);
+    REQUIRE(resolveIndex(dup, twice, 8080, "dup.test") == 0);
+  }
+}
+
+TEST_CASE("VirtualHostTable - wildcard server_name",
+          "[config][vhost][wildcard]") {
+  std::vector<ServerConfig> servers;
+  servers.push_back(makeServer(8080, {"default.test"}));
+  servers.push_back(makeServer(8080, {"*.example.com"}));
+  servers.push_back(makeServer(8080, {"*.api.example.com"}));
+  servers.push_back(makeServer(8080, {"exact.api.example.com"}));
+  VirtualHostTable table(&servers);
+
+  SECTION("One and several labels under the suffix") {
+    REQUIRE(resolveIndex(table, servers, 8080, "a.example.com") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "a.b.example.com") == 1);
+  }
+
+  SECTION("Longest suffix wins") {
+    REQUIRE(resolveIndex(table, servers, 8080, "v1.api.example.com") == 2);
+    REQUIRE(resolveIndex(table, servers, 8080, "x.v1.api.example.com") == 2);
+  }
+
+  SECTION("Exact name beats a wildcard") {
+    REQUIRE(resolveIndex(table, servers, 8080, "exact.api.example.com") == 3);
+  }
+
+  SECTION("Wildcard does not match the bare suffix") {
+    REQUIRE(resolveIndex(table, servers, 8080, "example.com") == 0);
+    REQUIRE(resolveIndex(table, servers, 8080, "api.example.com") == 1);
+  }
+
+  SECTION("Wildcard needs a dot before the suffix") {
+    REQUIRE(resolveIndex(table, servers, 8080, "notexample.com") == 0);
+  }
+}
+
+TEST_CASE("VirtualHostTable - default server", "[config][vhost][default]") {
+  SECTION("First server of the port when none is marked") {
+    std::vector<ServerConfig> servers;
+    servers.push_back(makeServer(8080, {"a.test"}));
+    servers.push_back(makeServer(8080, {"b.test"}));
+    VirtualHostTable table(&servers);
+    REQUIRE(resolveIndex(table, servers, 8080, "unknown.test") == 0);
+    REQUIRE(table.defaultServer(8080) == &servers[0]);
+  }
+
+  SECTION("default_server overrides declaration order") {
+    std::vector<ServerConfig> servers;
+    servers.push_back(makeServer(8080, {"a.test"}));
+    servers.push_back(makeServer(8080, {"b.test"}, true));
+    servers.push_back(makeServer(9090, {"c.test"}));
+    VirtualHostTable table(&servers);
+    REQUIRE(resolveIndex(table, servers, 8080, "unknown.test") == 1);
+    REQUIRE(resolveIndex(table, servers, 8080, "a.test") == 0);
+    REQUIRE(resolveIndex(table, servers, 9090, "unknown.test") == 2);
+  }
+
+  SECTION("Name from another port gets the default") {
+    std::vector<ServerConfig> servers;
+    servers.push_back(makeServer(8080, {"a.test"}));
+    servers.push_back(makeServer(9090, {"x.test"}));
+    servers.push_back(makeServer(9090, {"b.test"}));
+    VirtualHostTable table(&servers);
+    REQUIRE(resolveIndex(table, servers, 9090, "a.test") == 1);
+  }
+
+  SECTION("Empty and oversized Host values") {
+    std::vector<ServerConfig> servers;
+    servers.push_back(makeServer(8080, {"a.test"}));
+    servers.push_back(makeServer(8080, {"b.test"}));
+    VirtualHostTable table(&servers);
+    REQUIRE(resolveIndex(table, servers, 8080, "") == 0);
+    std::string huge(VirtualHostTable::MAX_HOST_LENGTH + 1, 'b');
+    REQUIRE(resolveIndex(table, servers, 8080, huge) == 0);
+  }
+
+  SECTION("Unknown port") {
+    std::vector<ServerConfig> servers;
+    servers.push_back(makeServer(8080, {"a.test"}));
+    VirtualHostTable table(&servers);
+    REQUIRE(resolveIndex(table, servers, 1234, "a.test") == -1);
+    REQUIRE(table.defaultServer(1234) == 0);
+  }
+}
+
+TEST_CASE("VirtualHostTable - many names on one port",
+          "[config][vhost][exact]") {
+  std::vector<ServerConfig> servers;
+  for (int i = 0; i < 200; ++i) {
+    std::string name = "host" + std::to_string(i) + ".test";
+    servers.push_back(makeServer(8080, {name}));
+  }
+  VirtualHostTable table(&servers);
+  for (int i = 0; i < 200; ++i) {
+    std::string name = "host" + std::to_string(i) + ".test";
+    REQUIRE(resolveIndex(table, servers, 8080, name) == i);
+  }
+}
+
+TEST_CASE("VirtualHostTable - body size bound per port",
+          "[config][vhost][body]") {
+  std::vector<ServerConfig> servers;
+  servers.push_back(makeServer(8080, {"a.test"}));
+  servers.push_back(makeServer(8080, {"b.test"}));
+  servers.push_back(makeServer(9090, {"c.test"}));
+  servers.push_back(makeServer(9090, {"d.test"}));
+  servers[0].setMaxBodySize(1000);
+  servers[1].setMaxBodySize(5000);
+  servers[2].setMaxBodySize(1000);
+  servers[3].setMaxBodySize(0);
+  VirtualHostTable table(&servers);
+
+  SECTION("Largest limit among the port's servers") {
+    REQUIRE(table.maxBodySize(8080) == 5000);
+  }
+
+  SECTION("Unlimited when any server is") {
+    REQUIRE(table.maxBodySize(9090) == 0);
+  }
+}